@@ -27,14 +27,17 @@ SPVTOOLS_SRC_FILES := \
 		source/table.cpp \
 		source/text.cpp \
 		source/text_handler.cpp \
+		source/util/arena.cpp \
 		source/util/bit_vector.cpp \
 		source/util/parse_number.cpp \
+		source/util/sparse_bit_vector.cpp \
 		source/util/string_utils.cpp \
 		source/util/timer.cpp \
 		source/val/basic_block.cpp \
 		source/val/construct.cpp \
 		source/val/function.cpp \
 		source/val/instruction.cpp \
+		source/val/validation_profile.cpp \
 		source/val/validation_state.cpp \
 		source/val/validate.cpp \
 		source/val/validate_adjacency.cpp \
@@ -116,6 +119,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/graphics_robust_access_pass.cpp \
 		source/opt/if_conversion.cpp \
 		source/opt/inline_pass.cpp \
+		source/opt/inline_bottom_up_pass.cpp \
 		source/opt/inline_exhaustive_pass.cpp \
 		source/opt/inline_opaque_pass.cpp \
 		source/opt/inst_bindless_check_pass.cpp \
@@ -123,6 +127,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/inst_debug_printf_pass.cpp \
 		source/opt/instruction.cpp \
 		source/opt/instruction_list.cpp \
+		source/opt/instruction_numbering.cpp \
 		source/opt/instrument_pass.cpp \
 		source/opt/ir_context.cpp \
 		source/opt/ir_loader.cpp \
@@ -145,9 +150,11 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/mem_pass.cpp \
 		source/opt/merge_return_pass.cpp \
 		source/opt/module.cpp \
+		source/opt/optimization_cache.cpp \
 		source/opt/optimizer.cpp \
 		source/opt/pass.cpp \
 		source/opt/pass_manager.cpp \
+		source/opt/pass_profile.cpp \
 		source/opt/private_to_local_pass.cpp \
 		source/opt/process_lines_pass.cpp \
 		source/opt/propagator.cpp \
@@ -606,6 +606,12 @@ SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetScalarBlockLayout(
 SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetSkipBlockLayout(
     spv_validator_options options, bool val);
 
+// Records the maximum number of threads the validator may use to check
+// functions in parallel.  A value of 0 or 1 disables threading.  The
+// diagnostics reported are the same whatever the number of threads.
+SPIRV_TOOLS_EXPORT void spvValidatorOptionsSetNumThreads(
+    spv_validator_options options, uint32_t val);
+
 // Creates an optimizer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvOptimizerOptionsDestroy|.
@@ -638,6 +644,11 @@ SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveBindings(
 SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetPreserveSpecConstants(
     spv_optimizer_options options, bool val);
 
+// Records the maximum number of threads the optimizer may use to process
+// independent functions in parallel.  A value of 0 or 1 disables threading.
+SPIRV_TOOLS_EXPORT void spvOptimizerOptionsSetNumThreads(
+    spv_optimizer_options options, uint32_t val);
+
 // Creates a reducer options object with default options. Returns a valid
 // options object. The object remains valid until it is passed into
 // |spvReducerOptionsDestroy|.
@@ -729,6 +740,24 @@ SPIRV_TOOLS_EXPORT spv_result_t spvBinaryToText(const spv_const_context context,
                                                 spv_text* text,
                                                 spv_diagnostic* diagnostic);
 
+// A pointer to a function that accepts a chunk of disassembled text.  The
+// |text| holds |length| characters, is not null-terminated, and is only valid
+// for the duration of the call.  A return value other than SPV_SUCCESS stops
+// the disassembly, and is returned to the caller.
+typedef spv_result_t (*spv_text_chunk_fn_t)(void* user_data, const char* text,
+                                            size_t length);
+
+// Decodes the given SPIR-V binary representation to its assembly text, like
+// spvBinaryToText, but hands the text to |chunk_fn| one instruction at a time
+// instead of accumulating it.  The |user_data| is passed through to
+// |chunk_fn|.  SPV_BINARY_TO_TEXT_OPTION_PRINT is ignored.  Any error will be
+// written into *diagnostic if diagnostic is non-null, otherwise the context's
+// message consumer will be used.
+SPIRV_TOOLS_EXPORT spv_result_t spvBinaryToTextStream(
+    const spv_const_context context, const uint32_t* binary,
+    const size_t word_count, const uint32_t options, void* user_data,
+    spv_text_chunk_fn_t chunk_fn, spv_diagnostic* diagnostic);
+
 // Frees a binary stream from memory. This is a no-op if binary is a null
 // pointer.
 SPIRV_TOOLS_EXPORT void spvBinaryDestroy(spv_binary binary);
@@ -15,8 +15,10 @@
 #ifndef INCLUDE_SPIRV_TOOLS_LIBSPIRV_HPP_
 #define INCLUDE_SPIRV_TOOLS_LIBSPIRV_HPP_
 
+#include <cstdio>
 #include <functional>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -31,6 +33,12 @@ using MessageConsumer = std::function<void(
     const spv_position_t& /* position */, const char* /* message */
     )>;
 
+// Receives a chunk of disassembled text.  The |text| holds |length|
+// characters, is not null-terminated, and is only alive for the specific
+// invocation.  Returns false to stop disassembling.
+using TextSink =
+    std::function<bool(const char* /* text */, size_t /* length */)>;
+
 // C++ RAII wrapper around the C context object spv_context.
 class Context {
  public:
@@ -109,6 +117,12 @@ class ValidatorOptions {
     spvValidatorOptionsSetSkipBlockLayout(options_, val);
   }
 
+  // Records the maximum number of threads the validator may use to check
+  // functions in parallel.
+  void SetNumThreads(uint32_t val) {
+    spvValidatorOptionsSetNumThreads(options_, val);
+  }
+
   // Records whether or not the validator should relax the rules on pointer
   // usage in logical addressing mode.
   //
@@ -134,6 +148,12 @@ class ValidatorOptions {
     spvValidatorOptionsSetBeforeHlslLegalization(options_, val);
   }
 
+  // Records where the validator should write the wall time taken by each of
+  // its checks, both in total and for each opcode, once it is done with a
+  // module.  A null |out| disables the report, which is the default.  The
+  // report is only produced if the library was built with timers enabled.
+  void SetTimeReport(std::ostream* out);
+
  private:
   spv_validator_options options_;
 };
@@ -176,6 +196,12 @@ class OptimizerOptions {
                                                 preserve_spec_constants);
   }
 
+  // Records the maximum number of threads the optimizer may use to process
+  // independent functions in parallel.
+  void set_num_threads(uint32_t num_threads) {
+    spvOptimizerOptionsSetNumThreads(options_, num_threads);
+  }
+
  private:
   spv_optimizer_options options_;
 };
@@ -308,6 +334,17 @@ class SpirvTools {
   bool Disassemble(const uint32_t* binary, size_t binary_size,
                    std::string* text,
                    uint32_t options = kDefaultDisassembleOption) const;
+  // Disassembles the given SPIR-V |binary| with the given |options| and hands
+  // the assembly to |sink| one instruction at a time, without accumulating the
+  // whole text.  The |sink| returns false to stop disassembling.  Returns true
+  // on successful disassembling.
+  bool Disassemble(const uint32_t* binary, size_t binary_size,
+                   const TextSink& sink,
+                   uint32_t options = kDefaultDisassembleOption) const;
+  // Like the above, but writes the assembly to |file| as it is produced.
+  bool Disassemble(const uint32_t* binary, size_t binary_size,
+                   std::FILE* file,
+                   uint32_t options = kDefaultDisassembleOption) const;
 
   // Validates the given SPIR-V |binary|. Returns true if no issues are found.
   // Otherwise, returns false and communicates issues via the message consumer
@@ -177,6 +177,10 @@ class Optimizer {
   // In that case, no further passes are executed and the contents in
   // |optimized_binary| may be invalid.
   //
+  // The passes are used up by a run.  Run() can be called again, for another
+  // module, if every pass was registered from a flag: the passes are then
+  // registered again from their flags.  Otherwise a second call fails.
+  //
   // By default, the binary is validated before any transforms are performed,
   // and optionally after each transform.  Validation uses SPIR-V spec rules
   // for the SPIR-V version named in the binary's header (at word offset 1).
@@ -226,9 +230,62 @@ class Optimizer {
   // |out| output stream.
   Optimizer& SetTimeReport(std::ostream* out);
 
+  // The formats in which SetPassProfile can write the profile.
+  enum class ProfileFormat {
+    kJson,         // A JSON document with one object for each pass.
+    kChromeTrace,  // Trace events, for chrome://tracing or Perfetto.
+  };
+
+  // Sets the option to profile each pass: its wall time, the number of
+  // instructions and the id bound before and after it ran, and the number
+  // and time of the analyses it caused to be built.  If |out| is null, then
+  // no profile is collected.  Otherwise, the profile is written to |out| in
+  // the given |format| after the passes have run.
+  Optimizer& SetPassProfile(std::ostream* out,
+                            ProfileFormat format = ProfileFormat::kJson);
+
   // Sets the option to validate the module after each pass.
   Optimizer& SetValidateAfterAll(bool validate);
 
+  // Sets the option to run the registered passes again, in the same order,
+  // until a round of them leaves the module unchanged or |max_rounds| rounds
+  // have run.  A pass is skipped when nothing changed since it last ran, and
+  // a pass that only looks at one function at a time is only run on the
+  // functions that changed.  Passes are told apart by the flags they were
+  // registered from, arguments included, and the passes of the later rounds
+  // are registered again from those flags.  The passes registered by
+  // RegisterPerformancePasses(), RegisterSizePasses() and the other
+  // Register*Passes() functions have flags too.  If a pass was registered
+  // with RegisterPass() instead, the passes run once and are never skipped,
+  // as they do when |max_rounds| is 0, which is the default.
+  Optimizer& SetFixedPointRounds(uint32_t max_rounds);
+
+  // Sets the option to cache the results of Run() in |directory|, which must
+  // already exist.  The results are keyed by a digest of the input module,
+  // the target environment, the options passed to Run(), the version of this
+  // library, and the passes registered with this optimizer, so a later call
+  // to Run() with the same inputs returns the cached module without
+  // validating or optimizing it again.  When that happens, no diagnostics
+  // are reported and the output of SetPrintAll(), SetTimeReport() and
+  // SetPassProfile() is empty.  The least recently used modules are removed
+  // from the directory to keep their total size under |max_size| bytes.  The
+  // directory can be shared by several optimizers and processes.  If
+  // |directory| is empty, caching is turned off.
+  //
+  // Passes registered with RegisterPassFromFlag() are identified by their
+  // flag, arguments included.  The arguments given to the functions that
+  // created the passes registered with RegisterPass() are not known, so the
+  // results are not cached if there are such passes, unless a salt is set
+  // with SetCacheKeySalt().
+  Optimizer& SetCacheDirectory(const std::string& directory,
+                               uint64_t max_size = 256u * 1024 * 1024);
+
+  // Sets the salt added to the cache key, which must identify the passes
+  // registered with RegisterPass(), arguments included: two optimizers with
+  // the same salt and the same flags must give the same results.  Setting a
+  // salt allows the results of an optimizer with such passes to be cached.
+  Optimizer& SetCacheKeySalt(const std::string& salt);
+
  private:
   struct Impl;                  // Opaque struct for holding internal data.
   std::unique_ptr<Impl> impl_;  // Unique pointer to internal data.
@@ -382,6 +439,23 @@ Optimizer::PassToken CreateBlockMergePass();
 // that are not in the call tree of an entry point are not changed.
 Optimizer::PassToken CreateInlineExhaustivePass();
 
+// Creates a bottom-up inline pass.
+// Unlike the exhaustive inline pass, this pass uses a cost model to decide
+// which calls to inline, and is meant for modules with deep call trees where
+// exhaustive inlining makes the code size explode.  Functions are processed
+// in bottom-up order of the call graph, so a callee is complete before it is
+// inlined, and the calls brought in by inlining it are not considered again.
+// A call is inlined if:
+// - the callee is small enough to cost about as much as the call; or
+// - it is the only call to the callee; or
+// - the callee has at most |max_callee_size| instructions, and the caller
+//   stays within its growth budget.
+// The growth budget of a caller is |max_growth_percent| of its size before
+// the pass, but at least |max_callee_size| instructions.  All the functions
+// in the module are processed, not only the entry point call trees.
+Optimizer::PassToken CreateInlineBottomUpPass(uint32_t max_growth_percent = 100,
+                                              uint32_t max_callee_size = 64);
+
 // Creates an opaque inline pass.
 // An opaque inline pass inlines all function calls in all functions in all
 // entry point call trees where the called function contains an opaque type
@@ -640,6 +714,13 @@ Optimizer::PassToken CreateLoopUnswitchPass();
 // paths leading to the instruction.  Those instructions are deleted.
 Optimizer::PassToken CreateRedundancyEliminationPass();
 
+// Create a global value numbering pass that also removes partial redundancies.
+// An instruction is partially redundant if the same value is computed on some,
+// but not all, of the paths leading to it.  The instruction is computed on the
+// remaining paths, in the predecessors of its block, and replaced by an OpPhi.
+// Total redundancies are then removed as in the redundancy elimination pass.
+Optimizer::PassToken CreatePartialRedundancyEliminationPass();
+
 // Create scalar replacement pass.
 // This pass replaces composite function scope variables with variables for each
 // element if those elements are accessed individually.  The parameter is a
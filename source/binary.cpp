@@ -152,9 +152,11 @@ class Parser {
   // Returns the endian-corrected word at the current position.
   uint32_t peek() const { return peekAt(_.word_index); }
 
-  // Returns the endian-corrected word at the given position.
+  // Returns the endian-corrected word at the given position.  When the module
+  // is in host byte order the word is returned as is.
   uint32_t peekAt(size_t index) const {
     assert(index < _.num_words);
+    if (!_.requires_endian_conversion) return _.words[index];
     return spvFixWord(_.words[index], _.endian);
   }
 
@@ -283,9 +285,12 @@ spv_result_t Parser::parseInstruction() {
 
   // If the module's endianness is different from the host native endianness,
   // then converted_words contains the the endian-translated words in the
-  // instruction.
-  _.endian_converted_words.clear();
-  _.endian_converted_words.push_back(first_word);
+  // instruction.  Otherwise the instruction words are read straight from the
+  // input and the vector is left untouched.
+  if (_.requires_endian_conversion) {
+    _.endian_converted_words.clear();
+    _.endian_converted_words.push_back(first_word);
+  }
 
   // After a successful parse of the instruction, the inst.operands member
   // will point to this vector's storage.
@@ -360,12 +365,9 @@ spv_result_t Parser::parseInstruction() {
   // Check the computed length of the endian-converted words vector against
   // the declared number of words in the instruction.  If endian conversion
   // is required, then they should match.  If no endian conversion was
-  // performed, then the vector only contains the initial opcode/word-count
-  // word.
+  // performed, then the vector was never filled.
   assert(!_.requires_endian_conversion ||
          (inst_word_count == _.endian_converted_words.size()));
-  assert(_.requires_endian_conversion ||
-         (_.endian_converted_words.size() == 1));
 
   recordNumberType(inst_offset, &inst);
 
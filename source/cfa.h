@@ -39,18 +39,6 @@ class CFA {
     cbb_ptr block;  ///< pointer to the block
     bb_iter iter;   ///< Iterator to the current child node being processed
   };
-
-  /// Returns true if a block with @p id is found in the @p work_list vector
-  ///
-  /// @param[in] work_list  Set of blocks visited in the the depth first
-  /// traversal
-  ///                       of the CFG
-  /// @param[in] id         The ID of the block being checked
-  ///
-  /// @return true if the edge work_list.back().block->id() => id is a back-edge
-  static bool FindInWorkList(const std::vector<block_info>& work_list,
-                             uint32_t id);
-
  public:
   /// @brief Depth first traversal starting from the \p entry BasicBlock
   ///
@@ -80,29 +68,25 @@ class CFA {
 
   /// @brief Calculates dominator edges for a set of blocks
   ///
-  /// Computes dominators using the algorithm of Cooper, Harvey, and Kennedy
-  /// "A Simple, Fast Dominance Algorithm", 2001.
+  /// Computes dominators using the Semi-NCA algorithm, a variant of
+  /// Lengauer-Tarjan described in Georgiadis, "Linear-Time Algorithms for
+  /// Dominators and Related Problems", 2005.  Blocks are numbered densely
+  /// and all the per-block state is kept in flat vectors, so the cost is
+  /// close to linear in the size of the CFG.
   ///
   /// The algorithm assumes there is a unique root node (a node without
   /// predecessors), and it is therefore at the end of the postorder vector.
   ///
-  /// This function calculates the dominator edges for a set of blocks in the
-  /// CFG.
-  /// Uses the dominator algorithm by Cooper et al.
-  ///
   /// @param[in] postorder        A vector of blocks in post order traversal
-  /// order
-  ///                             in a CFG
+  ///                             order in a CFG
   /// @param[in] predecessor_func Function used to get the predecessor nodes of
-  /// a
-  ///                             block
+  ///                             a block
   ///
-  /// @return the dominator tree of the graph, as a vector of pairs of nodes.
-  /// The first node in the pair is a node in the graph. The second node in the
-  /// pair is its immediate dominator in the sense of Cooper et.al., where a
-  /// block
-  /// without predecessors (such as the root node) is its own immediate
-  /// dominator.
+  /// @return the dominator tree of the graph, as a vector of pairs of nodes,
+  /// ordered by the postorder index of the first node.  The first node in the
+  /// pair is a node in the graph. The second node in the pair is its immediate
+  /// dominator.  A block without predecessors (such as the root node) is its
+  /// own immediate dominator.
   static std::vector<std::pair<BB*, BB*>> CalculateDominators(
       const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func);
 
@@ -124,15 +108,6 @@ class CFA {
       get_blocks_func succ_func, get_blocks_func pred_func);
 };
 
-template <class BB>
-bool CFA<BB>::FindInWorkList(const std::vector<block_info>& work_list,
-                             uint32_t id) {
-  for (const auto b : work_list) {
-    if (b.block->id() == id) return true;
-  }
-  return false;
-}
-
 template <class BB>
 void CFA<BB>::DepthFirstTraversal(
     const BB* entry, get_blocks_func successor_func,
@@ -142,23 +117,27 @@ void CFA<BB>::DepthFirstTraversal(
   std::unordered_set<uint32_t> processed;
 
   /// NOTE: work_list is the sequence of nodes from the root node to the node
-  /// being processed in the traversal
+  /// being processed in the traversal, and |in_work_list| holds their ids so
+  /// that back edges are found without walking the work list.
   std::vector<block_info> work_list;
+  std::unordered_set<uint32_t> in_work_list;
   work_list.reserve(10);
 
   work_list.push_back({entry, std::begin(*successor_func(entry))});
   preorder(entry);
   processed.insert(entry->id());
+  in_work_list.insert(entry->id());
 
   while (!work_list.empty()) {
     block_info& top = work_list.back();
     if (top.iter == end(*successor_func(top.block))) {
       postorder(top.block);
+      in_work_list.erase(top.block->id());
       work_list.pop_back();
     } else {
       BB* child = *top.iter;
       top.iter++;
-      if (FindInWorkList(work_list, child->id())) {
+      if (in_work_list.count(child->id())) {
         backedge(top.block, child);
       }
       if (processed.count(child->id()) == 0) {
@@ -166,6 +145,7 @@ void CFA<BB>::DepthFirstTraversal(
         work_list.emplace_back(
             block_info{child, std::begin(*successor_func(child))});
         processed.insert(child->id());
+        in_work_list.insert(child->id());
       }
     }
   }
@@ -174,85 +154,138 @@ void CFA<BB>::DepthFirstTraversal(
 template <class BB>
 std::vector<std::pair<BB*, BB*>> CFA<BB>::CalculateDominators(
     const std::vector<cbb_ptr>& postorder, get_blocks_func predecessor_func) {
-  struct block_detail {
-    size_t dominator;  ///< The index of blocks's dominator in post order array
-    size_t postorder_index;  ///< The index of the block in the post order array
-  };
-  const size_t undefined_dom = postorder.size();
-
-  std::unordered_map<cbb_ptr, block_detail> idoms;
-  for (size_t i = 0; i < postorder.size(); i++) {
-    idoms[postorder[i]] = {undefined_dom, i};
+  std::vector<std::pair<bb_ptr, bb_ptr>> out;
+  if (postorder.empty()) return out;
+
+  // Blocks are identified by their index in |postorder|.  Predecessors that
+  // are not in |postorder| are unreachable, and are ignored.
+  const uint32_t count = static_cast<uint32_t>(postorder.size());
+  std::unordered_map<cbb_ptr, uint32_t> postorder_index;
+  postorder_index.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) postorder_index[postorder[i]] = i;
+
+  // The predecessors and successors of each block, in compressed sparse row
+  // form: the edges of block |i| are in [begin[i], begin[i + 1]).
+  std::vector<uint32_t> pred_begin(count + 1, 0);
+  std::vector<uint32_t> preds;
+  std::vector<uint32_t> succ_begin(count + 1, 0);
+  for (uint32_t i = 0; i < count; ++i) {
+    pred_begin[i] = static_cast<uint32_t>(preds.size());
+    for (const BB* pred : *predecessor_func(postorder[i])) {
+      const auto it = postorder_index.find(pred);
+      if (it == postorder_index.end()) continue;
+      preds.push_back(it->second);
+      ++succ_begin[it->second + 1];
+    }
   }
-  idoms[postorder.back()].dominator = idoms[postorder.back()].postorder_index;
-
-  bool changed = true;
-  while (changed) {
-    changed = false;
-    for (auto b = postorder.rbegin() + 1; b != postorder.rend(); ++b) {
-      const std::vector<BB*>& predecessors = *predecessor_func(*b);
-      // Find the first processed/reachable predecessor that is reachable
-      // in the forward traversal.
-      auto res = std::find_if(std::begin(predecessors), std::end(predecessors),
-                              [&idoms, undefined_dom](BB* pred) {
-                                return idoms.count(pred) &&
-                                       idoms[pred].dominator != undefined_dom;
-                              });
-      if (res == end(predecessors)) continue;
-      const BB* idom = *res;
-      size_t idom_idx = idoms[idom].postorder_index;
-
-      // all other predecessors
-      for (const auto* p : predecessors) {
-        if (idom == p) continue;
-        // Only consider nodes reachable in the forward traversal.
-        // Otherwise the intersection doesn't make sense and will never
-        // terminate.
-        if (!idoms.count(p)) continue;
-        if (idoms[p].dominator != undefined_dom) {
-          size_t finger1 = idoms[p].postorder_index;
-          size_t finger2 = idom_idx;
-          while (finger1 != finger2) {
-            while (finger1 < finger2) {
-              finger1 = idoms[postorder[finger1]].dominator;
-            }
-            while (finger2 < finger1) {
-              finger2 = idoms[postorder[finger2]].dominator;
-            }
-          }
-          idom_idx = finger1;
-        }
+  pred_begin[count] = static_cast<uint32_t>(preds.size());
+  for (uint32_t i = 0; i < count; ++i) succ_begin[i + 1] += succ_begin[i];
+  std::vector<uint32_t> succs(preds.size());
+  {
+    std::vector<uint32_t> next(succ_begin.begin(), succ_begin.end() - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+      for (uint32_t e = pred_begin[i]; e < pred_begin[i + 1]; ++e) {
+        succs[next[preds[e]]++] = i;
       }
-      if (idoms[*b].dominator != idom_idx) {
-        idoms[*b].dominator = idom_idx;
-        changed = true;
+    }
+  }
+
+  // Number the blocks in the preorder of a depth first traversal from the
+  // root, and record the parent of each block in the spanning tree.  From
+  // here on, blocks are identified by their preorder number.
+  const uint32_t kUnvisited = count;
+  std::vector<uint32_t> preorder_number(count, kUnvisited);
+  std::vector<uint32_t> vertex;  // The postorder index of each preorder number.
+  std::vector<uint32_t> parent;
+  vertex.reserve(count);
+  parent.reserve(count);
+  {
+    const uint32_t root = count - 1;
+    preorder_number[root] = 0;
+    vertex.push_back(root);
+    parent.push_back(0);
+    // Pairs of a block and the position of the next successor to visit.
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(root, succ_begin[root]);
+    while (!stack.empty()) {
+      const uint32_t block = stack.back().first;
+      const uint32_t edge = stack.back().second;
+      if (edge == succ_begin[block + 1]) {
+        stack.pop_back();
+        continue;
       }
+      ++stack.back().second;
+      const uint32_t succ = succs[edge];
+      if (preorder_number[succ] != kUnvisited) continue;
+      preorder_number[succ] = static_cast<uint32_t>(vertex.size());
+      vertex.push_back(succ);
+      parent.push_back(preorder_number[block]);
+      stack.emplace_back(succ, succ_begin[succ]);
+    }
+  }
+  const uint32_t reached = static_cast<uint32_t>(vertex.size());
+
+  // Compute the semidominators, in decreasing preorder.  |ancestor| and
+  // |label| hold the link-eval forest: a block is linked to its spanning
+  // tree parent once its semidominator is known, and evaluating a block
+  // returns the block of minimum semidominator on its path to the root of
+  // its tree in the forest, compressing that path.
+  std::vector<uint32_t> semi(reached);
+  std::vector<uint32_t> label(reached);
+  std::vector<uint32_t> ancestor(parent);
+  std::vector<uint32_t> path;
+  for (uint32_t v = 0; v < reached; ++v) semi[v] = label[v] = v;
+  // Blocks numbered |last_linked| or higher have been linked.
+  auto eval = [&semi, &label, &ancestor, &path](
+                  uint32_t v, uint32_t last_linked) -> uint32_t {
+    if (ancestor[v] < last_linked) return label[v];
+    uint32_t root = v;
+    do {
+      path.push_back(root);
+      root = ancestor[root];
+    } while (ancestor[root] >= last_linked);
+    uint32_t prev = root;
+    while (!path.empty()) {
+      const uint32_t node = path.back();
+      path.pop_back();
+      ancestor[node] = ancestor[prev];
+      if (semi[label[prev]] < semi[label[node]]) label[node] = label[prev];
+      prev = node;
+    }
+    return label[v];
+  };
+  for (uint32_t w = reached - 1; w > 0; --w) {
+    semi[w] = parent[w];
+    const uint32_t block = vertex[w];
+    for (uint32_t e = pred_begin[block]; e < pred_begin[block + 1]; ++e) {
+      const uint32_t v = preorder_number[preds[e]];
+      if (v == kUnvisited) continue;
+      const uint32_t candidate = semi[eval(v, w + 1)];
+      if (candidate < semi[w]) semi[w] = candidate;
     }
   }
 
-  std::vector<std::pair<bb_ptr, bb_ptr>> out;
-  for (auto idom : idoms) {
-    // NOTE: performing a const cast for convenient usage with
-    // UpdateImmediateDominators
-    out.push_back({const_cast<BB*>(std::get<0>(idom)),
-                   const_cast<BB*>(postorder[std::get<1>(idom).dominator])});
+  // The immediate dominator of each block is the nearest common ancestor, in
+  // the dominator tree built so far, of its semidominator and its parent.
+  std::vector<uint32_t> idom(parent);
+  for (uint32_t w = 1; w < reached; ++w) {
+    uint32_t candidate = idom[w];
+    while (candidate > semi[w]) candidate = idom[candidate];
+    idom[w] = candidate;
   }
 
-  // Sort by postorder index to generate a deterministic ordering of edges.
-  std::sort(
-      out.begin(), out.end(),
-      [&idoms](const std::pair<bb_ptr, bb_ptr>& lhs,
-               const std::pair<bb_ptr, bb_ptr>& rhs) {
-        assert(lhs.first);
-        assert(lhs.second);
-        assert(rhs.first);
-        assert(rhs.second);
-        auto lhs_indices = std::make_pair(idoms[lhs.first].postorder_index,
-                                          idoms[lhs.second].postorder_index);
-        auto rhs_indices = std::make_pair(idoms[rhs.first].postorder_index,
-                                          idoms[rhs.second].postorder_index);
-        return lhs_indices < rhs_indices;
-      });
+  // NOTE: performing a const cast for convenient usage with
+  // UpdateImmediateDominators
+  out.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    BB* block = const_cast<BB*>(postorder[i]);
+    const uint32_t number = preorder_number[i];
+    if (number == kUnvisited) {
+      out.push_back({block, block});
+    } else {
+      out.push_back({block, const_cast<BB*>(postorder[vertex[idom[number]]])});
+    }
+  }
   return out;
 }
 
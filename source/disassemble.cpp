@@ -46,10 +46,17 @@ namespace {
 // representation.
 class Disassembler {
  public:
+  // Disassembles with the given |options|.  Ids are named by
+  // |friendly_mapper|, or by their decimal value if it is null.  If |sink_fn|
+  // is not null, the text of each instruction is handed to it as soon as it
+  // is produced, and nothing is accumulated or printed.
   Disassembler(const spvtools::AssemblyGrammar& grammar, uint32_t options,
-               spvtools::NameMapper name_mapper)
+               const spvtools::FriendlyNameMapper* friendly_mapper,
+               spv_text_chunk_fn_t sink_fn = nullptr,
+               void* sink_user_data = nullptr)
       : grammar_(grammar),
-        print_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PRINT, options)),
+        print_(!sink_fn &&
+               spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_PRINT, options)),
         color_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_COLOR, options)),
         indent_(spvIsInBitfield(SPV_BINARY_TO_TEXT_OPTION_INDENT, options)
                     ? kStandardIndent
@@ -61,7 +68,9 @@ class Disassembler {
         show_byte_offset_(spvIsInBitfield(
             SPV_BINARY_TO_TEXT_OPTION_SHOW_BYTE_OFFSET, options)),
         byte_offset_(0),
-        name_mapper_(std::move(name_mapper)) {}
+        friendly_mapper_(friendly_mapper),
+        sink_fn_(sink_fn),
+        sink_user_data_(sink_user_data) {}
 
   // Emits the assembly header for the module, and sets up internal state
   // so subsequent callbacks can handle the cases where the entire module
@@ -89,6 +98,14 @@ class Disassembler {
   // Emits a mask expression for the given mask word of the specified type.
   void EmitMaskOperand(const spv_operand_type_t type, const uint32_t word);
 
+  // Emits '%' and the name of the given id.  The '%' is right-aligned in a
+  // field wide enough that the name ends at column |width|, if possible.
+  void EmitIdName(uint32_t id, int width = 0);
+
+  // Hands the text accumulated so far to the sink, if there is one, and
+  // starts over with an empty buffer.
+  spv_result_t FlushToSink();
+
   // Resets the output color, if color is turned on.
   void ResetColor() {
     if (color_) out_.get() << spvtools::clr::reset{print_};
@@ -125,7 +142,9 @@ class Disassembler {
   const bool header_;     // Should we output header as the leading comment?
   const bool show_byte_offset_;  // Should we print byte offset, in hex?
   size_t byte_offset_;           // The number of bytes processed so far.
-  spvtools::NameMapper name_mapper_;
+  const spvtools::FriendlyNameMapper* friendly_mapper_;
+  const spv_text_chunk_fn_t sink_fn_;  // Receives the text, if not null.
+  void* const sink_user_data_;         // Context for sink_fn_.
 };
 
 spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
@@ -155,17 +174,14 @@ spv_result_t Disassembler::HandleHeader(spv_endianness_t endian,
 
   byte_offset_ = SPV_INDEX_INSTRUCTION * sizeof(uint32_t);
 
-  return SPV_SUCCESS;
+  return FlushToSink();
 }
 
 spv_result_t Disassembler::HandleInstruction(
     const spv_parsed_instruction_t& inst) {
   if (inst.result_id) {
     SetBlue();
-    const std::string id_name = name_mapper_(inst.result_id);
-    if (indent_)
-      stream_ << std::setw(std::max(0, indent_ - 3 - int(id_name.size())));
-    stream_ << "%" << id_name;
+    EmitIdName(inst.result_id, indent_ ? indent_ - 3 : 0);
     ResetColor();
     stream_ << " = ";
   } else {
@@ -196,7 +212,7 @@ spv_result_t Disassembler::HandleInstruction(
   byte_offset_ += inst.num_words * sizeof(uint32_t);
 
   stream_ << "\n";
-  return SPV_SUCCESS;
+  return FlushToSink();
 }
 
 void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
@@ -208,14 +224,14 @@ void Disassembler::EmitOperand(const spv_parsed_instruction_t& inst,
     case SPV_OPERAND_TYPE_RESULT_ID:
       assert(false && "<result-id> is not supposed to be handled here");
       SetBlue();
-      stream_ << "%" << name_mapper_(word);
+      EmitIdName(word);
       break;
     case SPV_OPERAND_TYPE_ID:
     case SPV_OPERAND_TYPE_TYPE_ID:
     case SPV_OPERAND_TYPE_SCOPE_ID:
     case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       SetYellow();
-      stream_ << "%" << name_mapper_(word);
+      EmitIdName(word);
       break;
     case SPV_OPERAND_TYPE_EXTENSION_INSTRUCTION_NUMBER: {
       spv_ext_inst_desc ext_inst;
@@ -340,12 +356,41 @@ void Disassembler::EmitMaskOperand(const spv_operand_type_t type,
   }
 }
 
+void Disassembler::EmitIdName(uint32_t id, int width) {
+  const std::string* name =
+      friendly_mapper_ ? friendly_mapper_->FindNameForId(id) : nullptr;
+  if (width) {
+    int name_size = 1;
+    if (name) {
+      name_size = int(name->size());
+    } else {
+      for (uint32_t rest = id / 10; rest; rest /= 10) ++name_size;
+    }
+    stream_ << std::setw(std::max(0, width - name_size));
+  }
+  stream_ << "%";
+  if (name) {
+    stream_ << *name;
+  } else {
+    stream_ << id;
+  }
+}
+
+spv_result_t Disassembler::FlushToSink() {
+  if (!sink_fn_) return SPV_SUCCESS;
+  const std::string chunk = text_.str();
+  text_.str(std::string());
+  if (chunk.empty()) return SPV_SUCCESS;
+  return sink_fn_(sink_user_data_, chunk.data(), chunk.size());
+}
+
 spv_result_t Disassembler::SaveTextResult(spv_text* text_result) const {
   if (!print_) {
-    size_t length = text_.str().size();
+    const std::string accumulated = text_.str();
+    size_t length = accumulated.size();
     char* str = new char[length + 1];
     if (!str) return SPV_ERROR_OUT_OF_MEMORY;
-    strncpy(str, text_.str().c_str(), length + 1);
+    strncpy(str, accumulated.c_str(), length + 1);
     spv_text text = new spv_text_t();
     if (!text) {
       delete[] str;
@@ -438,15 +483,13 @@ spv_result_t spvBinaryToText(const spv_const_context context,
 
   // Generate friendly names for Ids if requested.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
-  spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
   if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
     friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
         &hijack_context, code, wordCount);
-    name_mapper = friendly_mapper->GetNameMapper();
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, friendly_mapper.get());
   if (auto error = spvBinaryParse(&hijack_context, &disassembler, code,
                                   wordCount, DisassembleHeader,
                                   DisassembleInstruction, pDiagnostic)) {
@@ -456,6 +499,37 @@ spv_result_t spvBinaryToText(const spv_const_context context,
   return disassembler.SaveTextResult(pText);
 }
 
+spv_result_t spvBinaryToTextStream(const spv_const_context context,
+                                   const uint32_t* code, const size_t wordCount,
+                                   const uint32_t options, void* user_data,
+                                   spv_text_chunk_fn_t chunk_fn,
+                                   spv_diagnostic* pDiagnostic) {
+  spv_context_t hijack_context = *context;
+  if (pDiagnostic) {
+    *pDiagnostic = nullptr;
+    spvtools::UseDiagnosticAsMessageConsumer(&hijack_context, pDiagnostic);
+  }
+
+  if (!chunk_fn) return SPV_ERROR_INVALID_POINTER;
+
+  const spvtools::AssemblyGrammar grammar(&hijack_context);
+  if (!grammar.isValid()) return SPV_ERROR_INVALID_TABLE;
+
+  std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
+  if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
+    friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
+        &hijack_context, code, wordCount);
+  }
+
+  // Each instruction is handed to |chunk_fn| as soon as it is disassembled,
+  // so only the text of one instruction is held at a time.
+  Disassembler disassembler(grammar, options, friendly_mapper.get(), chunk_fn,
+                            user_data);
+  return spvBinaryParse(&hijack_context, &disassembler, code, wordCount,
+                        DisassembleHeader, DisassembleInstruction,
+                        pDiagnostic);
+}
+
 std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
                                                  const uint32_t* instCode,
                                                  const size_t instWordCount,
@@ -471,15 +545,13 @@ std::string spvtools::spvInstructionBinaryToText(const spv_target_env env,
 
   // Generate friendly names for Ids if requested.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper;
-  spvtools::NameMapper name_mapper = spvtools::GetTrivialNameMapper();
   if (options & SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES) {
     friendly_mapper = spvtools::MakeUnique<spvtools::FriendlyNameMapper>(
         context, code, wordCount);
-    name_mapper = friendly_mapper->GetNameMapper();
   }
 
   // Now disassemble!
-  Disassembler disassembler(grammar, options, name_mapper);
+  Disassembler disassembler(grammar, options, friendly_mapper.get());
   WrappedDisassembler wrapped(&disassembler, instCode, instWordCount);
   spvBinaryParse(context, &wrapped, code, wordCount, DisassembleTargetHeader,
                  DisassembleTargetInstruction, nullptr);
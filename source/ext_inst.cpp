@@ -14,6 +14,7 @@
 
 #include "source/ext_inst.h"
 
+#include <algorithm>
 #include <cstring>
 
 // DebugInfo extended instruction set.
@@ -38,22 +39,29 @@
 #include "spv-amd-shader-trinary-minmax.insts.inc"
 
 static const spv_ext_inst_group_t kGroups_1_0[] = {
-    {SPV_EXT_INST_TYPE_GLSL_STD_450, ARRAY_SIZE(glsl_entries), glsl_entries},
-    {SPV_EXT_INST_TYPE_OPENCL_STD, ARRAY_SIZE(opencl_entries), opencl_entries},
+    {SPV_EXT_INST_TYPE_GLSL_STD_450, ARRAY_SIZE(glsl_entries), glsl_entries,
+     glsl_name_index},
+    {SPV_EXT_INST_TYPE_OPENCL_STD, ARRAY_SIZE(opencl_entries), opencl_entries,
+     opencl_name_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_EXPLICIT_VERTEX_PARAMETER,
      ARRAY_SIZE(spv_amd_shader_explicit_vertex_parameter_entries),
-     spv_amd_shader_explicit_vertex_parameter_entries},
+     spv_amd_shader_explicit_vertex_parameter_entries,
+     spv_amd_shader_explicit_vertex_parameter_name_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_TRINARY_MINMAX,
      ARRAY_SIZE(spv_amd_shader_trinary_minmax_entries),
-     spv_amd_shader_trinary_minmax_entries},
+     spv_amd_shader_trinary_minmax_entries,
+     spv_amd_shader_trinary_minmax_name_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_GCN_SHADER,
-     ARRAY_SIZE(spv_amd_gcn_shader_entries), spv_amd_gcn_shader_entries},
+     ARRAY_SIZE(spv_amd_gcn_shader_entries), spv_amd_gcn_shader_entries,
+     spv_amd_gcn_shader_name_index},
     {SPV_EXT_INST_TYPE_SPV_AMD_SHADER_BALLOT,
-     ARRAY_SIZE(spv_amd_shader_ballot_entries), spv_amd_shader_ballot_entries},
+     ARRAY_SIZE(spv_amd_shader_ballot_entries), spv_amd_shader_ballot_entries,
+     spv_amd_shader_ballot_name_index},
     {SPV_EXT_INST_TYPE_DEBUGINFO, ARRAY_SIZE(debuginfo_entries),
-     debuginfo_entries},
+     debuginfo_entries, debuginfo_name_index},
     {SPV_EXT_INST_TYPE_OPENCL_DEBUGINFO_100,
-     ARRAY_SIZE(opencl_debuginfo_100_entries), opencl_debuginfo_100_entries},
+     ARRAY_SIZE(opencl_debuginfo_100_entries), opencl_debuginfo_100_entries,
+     opencl_debuginfo_100_name_index},
 };
 
 static const spv_ext_inst_table_t kTable_1_0 = {ARRAY_SIZE(kGroups_1_0),
@@ -156,12 +164,16 @@ spv_result_t spvExtInstTableNameLookup(const spv_ext_inst_table table,
   for (uint32_t groupIndex = 0; groupIndex < table->count; groupIndex++) {
     const auto& group = table->groups[groupIndex];
     if (type != group.type) continue;
-    for (uint32_t index = 0; index < group.count; index++) {
-      const auto& entry = group.entries[index];
-      if (!strcmp(name, entry.name)) {
-        *pEntry = &entry;
-        return SPV_SUCCESS;
-      }
+    // The name index orders the entries by name.
+    const auto beg = group.nameIndex;
+    const auto end = group.nameIndex + group.count;
+    const auto it = std::lower_bound(
+        beg, end, name, [&group](uint16_t index, const char* needle) {
+          return strcmp(group.entries[index].name, needle) < 0;
+        });
+    if (it != end && !strcmp(name, group.entries[*it].name)) {
+      *pEntry = &group.entries[*it];
+      return SPV_SUCCESS;
     }
   }
 
@@ -178,12 +190,16 @@ spv_result_t spvExtInstTableValueLookup(const spv_ext_inst_table table,
   for (uint32_t groupIndex = 0; groupIndex < table->count; groupIndex++) {
     const auto& group = table->groups[groupIndex];
     if (type != group.type) continue;
-    for (uint32_t index = 0; index < group.count; index++) {
-      const auto& entry = group.entries[index];
-      if (value == entry.ext_inst) {
-        *pEntry = &entry;
-        return SPV_SUCCESS;
-      }
+    // The entries are sorted by extended instruction number.
+    const auto beg = group.entries;
+    const auto end = group.entries + group.count;
+    const auto it = std::lower_bound(
+        beg, end, value, [](const spv_ext_inst_desc_t& entry, uint32_t needle) {
+          return entry.ext_inst < needle;
+        });
+    if (it != end && it->ext_inst == value) {
+      *pEntry = it;
+      return SPV_SUCCESS;
     }
   }
 
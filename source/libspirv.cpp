@@ -20,6 +20,7 @@
 #include <utility>
 #include <vector>
 
+#include "source/spirv_validator_options.h"
 #include "source/table.h"
 
 namespace spvtools {
@@ -48,6 +49,10 @@ spv_context& Context::CContext() { return context_; }
 
 const spv_context& Context::CContext() const { return context_; }
 
+void ValidatorOptions::SetTimeReport(std::ostream* out) {
+  options_->time_report_stream = out;
+}
+
 // Structs for holding the data members for SpvTools.
 struct SpirvTools::Impl {
   explicit Impl(spv_target_env env) : context(spvContextCreate(env)) {
@@ -104,6 +109,29 @@ bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
   return status == SPV_SUCCESS;
 }
 
+bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
+                             const TextSink& sink, uint32_t options) const {
+  auto forward = [](void* user_data, const char* text,
+                    size_t length) -> spv_result_t {
+    return (*static_cast<const TextSink*>(user_data))(text, length)
+               ? SPV_SUCCESS
+               : SPV_REQUESTED_TERMINATION;
+  };
+  return spvBinaryToTextStream(impl_->context, binary, binary_size, options,
+                               const_cast<TextSink*>(&sink), forward,
+                               nullptr) == SPV_SUCCESS;
+}
+
+bool SpirvTools::Disassemble(const uint32_t* binary, const size_t binary_size,
+                             std::FILE* file, uint32_t options) const {
+  return Disassemble(
+      binary, binary_size,
+      [file](const char* text, size_t length) {
+        return fwrite(text, 1, length, file) == length;
+      },
+      options);
+}
+
 bool SpirvTools::Validate(const std::vector<uint32_t>& binary) const {
   return Validate(binary.data(), binary.size());
 }
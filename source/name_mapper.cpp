@@ -61,10 +61,15 @@ std::string FriendlyNameMapper::NameForId(uint32_t id) {
     // We don't care about uniqueness.
     return to_string(id);
   } else {
-    return iter->second;
+    return *iter->second;
   }
 }
 
+const std::string* FriendlyNameMapper::FindNameForId(uint32_t id) const {
+  auto iter = name_for_id_.find(id);
+  return iter == name_for_id_.end() ? nullptr : iter->second;
+}
+
 std::string FriendlyNameMapper::Sanitize(const std::string& suggested_name) {
   if (suggested_name.empty()) return "_";
   // Otherwise, replace invalid characters by '_'.
@@ -85,16 +90,16 @@ void FriendlyNameMapper::SaveName(uint32_t id,
   if (name_for_id_.find(id) != name_for_id_.end()) return;
 
   const std::string sanitized_suggested_name = Sanitize(suggested_name);
-  std::string name = sanitized_suggested_name;
-  auto inserted = used_names_.insert(name);
+  auto inserted = used_names_.insert(sanitized_suggested_name);
   if (!inserted.second) {
     const std::string base_name = sanitized_suggested_name + "_";
     for (uint32_t index = 0; !inserted.second; ++index) {
-      name = base_name + to_string(index);
-      inserted = used_names_.insert(name);
+      inserted = used_names_.insert(base_name + to_string(index));
     }
   }
-  name_for_id_[id] = name;
+  // Elements of an unordered_set never move, so the id can refer to the
+  // interned name directly.
+  name_for_id_[id] = &*inserted.first;
 }
 
 void FriendlyNameMapper::SaveBuiltInName(uint32_t target_id,
@@ -78,6 +78,12 @@ class FriendlyNameMapper {
   // NameMapper.
   std::string NameForId(uint32_t id);
 
+  // Returns the interned friendly name for the given id, or nullptr if the
+  // module parsed during construction does not define it.  The name stays
+  // valid for the lifetime of this mapper, so callers that emit many names
+  // can avoid building a string per use.
+  const std::string* FindNameForId(uint32_t id) const;
+
  private:
   // Transforms the given string so that it is acceptable as an Id name in
   // assembly language.  Two distinct inputs can map to the same output.
@@ -108,9 +114,9 @@ class FriendlyNameMapper {
   // Returns the friendly name for an enumerant.
   std::string NameForEnumOperand(spv_operand_type_t type, uint32_t word);
 
-  // Maps an id to its friendly name.  This will have an entry for each Id
-  // defined in the module.
-  std::unordered_map<uint32_t, std::string> name_for_id_;
+  // Maps an id to its friendly name, which is interned in used_names_.  This
+  // will have an entry for each Id defined in the module.
+  std::unordered_map<uint32_t, const std::string*> name_for_id_;
   // The set of names that have a mapping in name_for_id_;
   std::unordered_set<std::string> used_names_;
   // The assembly grammar for the current context.
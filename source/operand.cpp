@@ -56,12 +56,29 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
   if (!table) return SPV_ERROR_INVALID_TABLE;
   if (!name || !pEntry) return SPV_ERROR_INVALID_POINTER;
 
+  // |name| need not be null-terminated, so entries are compared against its
+  // first |nameLength| characters.
+  auto matches = [name, nameLength](const spv_operand_desc_t& entry) {
+    return !strncmp(entry.name, name, nameLength) &&
+           entry.name[nameLength] == '\0';
+  };
+
   const auto version = spvVersionForTargetEnv(env);
   for (uint64_t typeIndex = 0; typeIndex < table->count; ++typeIndex) {
     const auto& group = table->types[typeIndex];
     if (type != group.type) continue;
-    for (uint64_t index = 0; index < group.count; ++index) {
-      const auto& entry = group.entries[index];
+
+    // The name index orders the entries by name, keeping entries with the
+    // same name in table order.
+    const auto beg = group.nameIndex;
+    const auto end = group.nameIndex + group.count;
+    for (auto it = std::partition_point(
+             beg, end,
+             [&group, name, nameLength](uint16_t index) {
+               return strncmp(group.entries[index].name, name, nameLength) < 0;
+             });
+         it != end && matches(group.entries[*it]); ++it) {
+      const auto& entry = group.entries[*it];
       // We consider the current operand as available as long as
       // 1. The target environment satisfies the minimal requirement of the
       //    operand; or
@@ -71,10 +88,8 @@ spv_result_t spvOperandTableNameLookup(spv_target_env env,
       // Note that the second rule assumes the extension enabling this operand
       // is indeed requested in the SPIR-V code; checking that should be
       // validator's work.
-      if (((version >= entry.minVersion && version <= entry.lastVersion) ||
-           entry.numExtensions > 0u || entry.numCapabilities > 0u) &&
-          nameLength == strlen(entry.name) &&
-          !strncmp(entry.name, name, nameLength)) {
+      if ((version >= entry.minVersion && version <= entry.lastVersion) ||
+          entry.numExtensions > 0u || entry.numCapabilities > 0u) {
         *pEntry = &entry;
         return SPV_SUCCESS;
       }
@@ -29,6 +29,7 @@
 #include "source/opt/instruction.h"
 #include "source/opt/instruction_list.h"
 #include "source/opt/iterator.h"
+#include "source/util/arena.h"
 
 namespace spvtools {
 namespace opt {
@@ -37,7 +38,7 @@ class Function;
 class IRContext;
 
 // A SPIR-V basic block.
-class BasicBlock {
+class BasicBlock : public utils::ArenaAllocatable<BasicBlock> {
  public:
   using iterator = InstructionList::iterator;
   using const_iterator = InstructionList::const_iterator;
@@ -56,7 +57,8 @@ class BasicBlock {
   // the user.
   //
   // If the inst-to-block map in |context| is valid, then the new instructions
-  // will be inserted into the map.
+  // will be inserted into the map.  The new block and its instructions are
+  // allocated from the arena of |context| if it has one.
   BasicBlock* Clone(IRContext*) const;
 
   // Sets the enclosing function for this basic block.
@@ -39,11 +39,13 @@ class BlockMergePass : public Pass {
   BlockMergePass();
   const char* name() const override { return "merge-blocks"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
            IRContext::kAnalysisInstrToBlockMapping |
            IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
            IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
            IRContext::kAnalysisTypes;
   }
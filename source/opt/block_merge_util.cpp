@@ -160,10 +160,22 @@ void MergeWithSuccessor(IRContext* context, Function* func,
     context->set_instr_block(&inst, &*bi);
   }
 
+  // Update the CFG and the dominator trees, if they have been built, rather
+  // than invalidating them.
+  const bool update_cfg = context->AreAnalysesValid(IRContext::kAnalysisCFG);
+  if (update_cfg) context->cfg()->ForgetBlock(&*sbi);
+  if (auto dominators = context->FindDominatorAnalysis(func)) {
+    dominators->MergeSuccessorIntoBlock(&*bi, &*sbi);
+  }
+  if (auto postdominators = context->FindPostDominatorAnalysis(func)) {
+    postdominators->MergeSuccessorIntoBlock(&*bi, &*sbi);
+  }
+
   EliminateOpPhiInstructions(context, &*sbi);
 
   // Now actually move the instructions.
   bi->AddInstructions(&*sbi);
+  if (update_cfg) context->cfg()->AddEdges(&*bi);
 
   if (merge_inst) {
     if (pred_is_header && lab_id == merge_inst->GetSingleWordInOperand(0u)) {
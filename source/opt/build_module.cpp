@@ -49,11 +49,15 @@ spv_result_t SetSpvInst(void* builder, const spv_parsed_instruction_t* inst) {
 std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
                                             MessageConsumer consumer,
                                             const uint32_t* binary,
-                                            const size_t size) {
+                                            const size_t size,
+                                            bool use_arena) {
   auto context = spvContextCreate(env);
   SetContextMessageConsumer(context, consumer);
 
   auto irContext = MakeUnique<opt::IRContext>(env, consumer);
+  if (use_arena) {
+    irContext->EnableArena();
+  }
   opt::IrLoader loader(consumer, irContext->module());
 
   spv_result_t status = spvBinaryParse(context, &loader, binary, size,
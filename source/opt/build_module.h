@@ -27,11 +27,14 @@ namespace spvtools {
 // Builds an Module returns the owning IRContext from the given SPIR-V
 // |binary|. |size| specifies number of words in |binary|. The |binary| will be
 // decoded according to the given target |env|. Returns nullptr if errors occur
-// and sends the errors to |consumer|.
+// and sends the errors to |consumer|. If |use_arena| is true, the instructions
+// and basic blocks of the module are allocated from the arena of the context;
+// see IRContext::EnableArena.
 std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
                                             MessageConsumer consumer,
                                             const uint32_t* binary,
-                                            size_t size);
+                                            size_t size,
+                                            bool use_arena = false);
 
 // Builds an Module and returns the owning IRContext from the given
 // SPIR-V assembly |text|.  The |text| will be encoded according to the given
@@ -34,6 +34,7 @@ class CCPPass : public MemPass {
 
   const char* name() const override { return "ccp"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
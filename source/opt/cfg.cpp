@@ -21,6 +21,8 @@
 #include "source/opt/ir_builder.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
+#include "source/util/bit_vector.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace opt {
@@ -33,6 +35,160 @@ const int kMaxResultId = 0x400000;
 
 }  // namespace
 
+FunctionGraph::FunctionGraph(Function* func) : function_(func) {
+  for (auto& blk : *func) {
+    id2index_[blk.id()] = size();
+    blocks_.push_back(&blk);
+    labels_.push_back(blk.id());
+  }
+
+  // Collects the edges leaving each block.  A block without a terminator is
+  // still being built, and has no successors yet.
+  const auto add_edge = [this](uint32_t label_id,
+                               std::vector<uint32_t>* edges) {
+    const uint32_t target = index(label_id);
+    if (target == kNoIndex) {
+      complete_ = false;
+    } else {
+      edges->push_back(target);
+    }
+  };
+  succ_offsets_.reserve(blocks_.size() + 1);
+  structured_offsets_.reserve(blocks_.size() + 1);
+  for (const BasicBlock* blk : blocks_) {
+    succ_offsets_.push_back(static_cast<uint32_t>(succs_.size()));
+    structured_offsets_.push_back(
+        static_cast<uint32_t>(structured_succs_.size()));
+    if (blk->cbegin() == blk->cend() || !blk->ctail()->IsBlockTerminator()) {
+      continue;
+    }
+    const uint32_t merge_id = blk->MergeBlockIdIfAny();
+    if (merge_id != 0) {
+      add_edge(merge_id, &structured_succs_);
+      const uint32_t continue_id = blk->ContinueBlockIdIfAny();
+      if (continue_id != 0) add_edge(continue_id, &structured_succs_);
+    }
+    blk->ForEachSuccessorLabel([this, &add_edge](const uint32_t label_id) {
+      add_edge(label_id, &succs_);
+      add_edge(label_id, &structured_succs_);
+    });
+  }
+  succ_offsets_.push_back(static_cast<uint32_t>(succs_.size()));
+  structured_offsets_.push_back(
+      static_cast<uint32_t>(structured_succs_.size()));
+
+  // The predecessors are the successors transposed: count the edges into
+  // each block, then place each edge at the next free slot of its target.
+  pred_offsets_.assign(blocks_.size() + 1, 0);
+  for (uint32_t succ : succs_) ++pred_offsets_[succ + 1];
+  for (uint32_t i = 0; i < size(); ++i) {
+    pred_offsets_[i + 1] += pred_offsets_[i];
+  }
+  preds_.resize(succs_.size());
+  std::vector<uint32_t> next(pred_offsets_.begin(), pred_offsets_.end() - 1);
+  for (uint32_t i = 0; i < size(); ++i) {
+    for (uint32_t succ : successors(i)) preds_[next[succ]++] = i;
+  }
+}
+
+void FunctionGraph::PostOrder(uint32_t root, bool structured,
+                              std::vector<uint32_t>* order) const {
+  const std::vector<uint32_t>& offsets =
+      structured ? structured_offsets_ : succ_offsets_;
+  const std::vector<uint32_t>& edges =
+      structured ? structured_succs_ : succs_;
+
+  // Each entry of the stack is a block and the position in |edges| of the
+  // next successor to visit.
+  utils::BitVector visited(size());
+  std::vector<std::pair<uint32_t, uint32_t>> stack;
+  visited.Set(root);
+  stack.emplace_back(root, offsets[root]);
+  while (!stack.empty()) {
+    auto& top = stack.back();
+    if (top.second == offsets[top.first + 1]) {
+      order->push_back(top.first);
+      stack.pop_back();
+      continue;
+    }
+    const uint32_t succ = edges[top.second++];
+    if (!visited.Set(succ)) stack.emplace_back(succ, offsets[succ]);
+  }
+}
+
+const std::vector<uint32_t>& FunctionGraph::ReversePostOrder() {
+  if (reverse_post_order_.empty() && size() != 0) {
+    PostOrder(0, false, &reverse_post_order_);
+    std::reverse(reverse_post_order_.begin(), reverse_post_order_.end());
+  }
+  return reverse_post_order_;
+}
+
+const std::vector<uint32_t>& FunctionGraph::StructuredOrder() {
+  if (structured_order_.empty() && size() != 0) {
+    PostOrder(0, true, &structured_order_);
+    std::reverse(structured_order_.begin(), structured_order_.end());
+  }
+  return structured_order_;
+}
+
+bool FunctionGraph::IsCurrent() const {
+  if (!complete_) return false;
+
+  // The targets of the current block, compared with its rows of the graph.
+  std::vector<uint32_t> targets;
+  const auto row_matches = [this,
+                            &targets](IteratorRange<const uint32_t*> row) {
+    if (row.size() != targets.size()) return false;
+    auto target = targets.begin();
+    for (uint32_t index : row) {
+      if (labels_[index] != *target++) return false;
+    }
+    return true;
+  };
+
+  uint32_t index = 0;
+  for (const BasicBlock& blk : *function_) {
+    // Only the pointers are compared, since the blocks of the graph may have
+    // been deleted.
+    if (index == size() || blocks_[index] != &blk ||
+        labels_[index] != blk.id()) {
+      return false;
+    }
+    const bool has_terminator =
+        blk.cbegin() != blk.cend() && blk.ctail()->IsBlockTerminator();
+    const auto add_target = [&targets](uint32_t label_id) {
+      targets.push_back(label_id);
+    };
+
+    targets.clear();
+    if (has_terminator) blk.ForEachSuccessorLabel(add_target);
+    if (!row_matches(successors(index))) return false;
+
+    targets.clear();
+    if (has_terminator) {
+      const uint32_t merge_id = blk.MergeBlockIdIfAny();
+      if (merge_id != 0) {
+        targets.push_back(merge_id);
+        const uint32_t continue_id = blk.ContinueBlockIdIfAny();
+        if (continue_id != 0) targets.push_back(continue_id);
+      }
+      blk.ForEachSuccessorLabel(add_target);
+    }
+    if (!row_matches(structured_successors(index))) return false;
+    ++index;
+  }
+  return index == size();
+}
+
+bool FunctionGraph::operator==(const FunctionGraph& that) const {
+  return function_ == that.function_ && complete_ == that.complete_ &&
+         blocks_ == that.blocks_ && succ_offsets_ == that.succ_offsets_ &&
+         succs_ == that.succs_ &&
+         structured_offsets_ == that.structured_offsets_ &&
+         structured_succs_ == that.structured_succs_;
+}
+
 CFG::CFG(Module* module)
     : module_(module),
       pseudo_entry_block_(std::unique_ptr<Instruction>(
@@ -57,6 +213,7 @@ void CFG::AddEdges(BasicBlock* blk) {
 }
 
 void CFG::RemoveNonExistingEdges(uint32_t blk_id) {
+  ClearFunctionGraphs();
   std::vector<uint32_t> updated_pred_list;
   for (uint32_t id : preds(blk_id)) {
     const BasicBlock* pred_blk = block(id);
@@ -72,12 +229,43 @@ void CFG::RemoveNonExistingEdges(uint32_t blk_id) {
   label2preds_.at(blk_id) = std::move(updated_pred_list);
 }
 
+FunctionGraph* CFG::GetFunctionGraph(Function* func) {
+  std::unique_ptr<FunctionGraph>& graph = function_graphs_[func];
+  if (!graph || !graph->IsCurrent()) graph = MakeUnique<FunctionGraph>(func);
+  return graph.get();
+}
+
+FunctionGraph* CFG::GraphForTraversal(Function* func, const BasicBlock* root,
+                                      uint32_t* root_index) {
+  if (func == nullptr) return nullptr;
+  FunctionGraph* graph = GetFunctionGraph(func);
+  *root_index = graph->index(root->id());
+  if (!graph->complete() || *root_index == FunctionGraph::kNoIndex ||
+      graph->block(*root_index) != root) {
+    return nullptr;
+  }
+  return graph;
+}
+
 void CFG::ComputeStructuredOrder(Function* func, BasicBlock* root,
                                  std::list<BasicBlock*>* order) {
   assert(module_->context()->get_feature_mgr()->HasCapability(
              SpvCapabilityShader) &&
          "This only works on structured control flow");
 
+  uint32_t root_index = 0;
+  if (FunctionGraph* graph = GraphForTraversal(func, root, &root_index)) {
+    std::vector<uint32_t> post_order;
+    if (root_index == 0) {
+      const std::vector<uint32_t>& structured_order = graph->StructuredOrder();
+      post_order.assign(structured_order.rbegin(), structured_order.rend());
+    } else {
+      graph->PostOrder(root_index, true, &post_order);
+    }
+    for (uint32_t index : post_order) order->push_front(graph->block(index));
+    return;
+  }
+
   // Compute structured successors and do DFS.
   ComputeStructuredSuccessors(func);
   auto ignore_block = [](cbb_ptr) {};
@@ -98,8 +286,7 @@ void CFG::ComputeStructuredOrder(Function* func, BasicBlock* root,
 void CFG::ForEachBlockInPostOrder(BasicBlock* bb,
                                   const std::function<void(BasicBlock*)>& f) {
   std::vector<BasicBlock*> po;
-  std::unordered_set<BasicBlock*> seen;
-  ComputePostOrderTraversal(bb, &po, &seen);
+  ComputePostOrder(bb, &po);
 
   for (BasicBlock* current_bb : po) {
     if (!IsPseudoExitBlock(current_bb) && !IsPseudoEntryBlock(current_bb)) {
@@ -119,8 +306,7 @@ void CFG::ForEachBlockInReversePostOrder(
 bool CFG::WhileEachBlockInReversePostOrder(
     BasicBlock* bb, const std::function<bool(BasicBlock*)>& f) {
   std::vector<BasicBlock*> po;
-  std::unordered_set<BasicBlock*> seen;
-  ComputePostOrderTraversal(bb, &po, &seen);
+  ComputePostOrder(bb, &po);
 
   for (auto current_bb = po.rbegin(); current_bb != po.rend(); ++current_bb) {
     if (!IsPseudoExitBlock(*current_bb) && !IsPseudoEntryBlock(*current_bb)) {
@@ -132,6 +318,30 @@ bool CFG::WhileEachBlockInReversePostOrder(
   return true;
 }
 
+void CFG::ComputePostOrder(BasicBlock* bb, std::vector<BasicBlock*>* order) {
+  // The order is copied out of the graph, because the callbacks of the
+  // traversals may change the CFG and drop the graph.
+  uint32_t root_index = 0;
+  if (FunctionGraph* graph =
+          GraphForTraversal(bb->GetParent(), bb, &root_index)) {
+    if (root_index == 0) {
+      const std::vector<uint32_t>& rpo = graph->ReversePostOrder();
+      order->reserve(order->size() + rpo.size());
+      for (auto it = rpo.rbegin(); it != rpo.rend(); ++it) {
+        order->push_back(graph->block(*it));
+      }
+    } else {
+      std::vector<uint32_t> post_order;
+      graph->PostOrder(root_index, false, &post_order);
+      for (uint32_t index : post_order) order->push_back(graph->block(index));
+    }
+    return;
+  }
+
+  std::unordered_set<BasicBlock*> seen;
+  ComputePostOrderTraversal(bb, order, &seen);
+}
+
 void CFG::ComputeStructuredSuccessors(Function* func) {
   block2structured_succs_.clear();
   for (auto& blk : *func) {
@@ -305,6 +515,7 @@ BasicBlock* CFG::SplitLoopHeader(BasicBlock* bb) {
   context->AnalyzeUses(latch_branch);
   label2preds_[new_header->id()].push_back(latch_block->id());
 
+  ClearFunctionGraphs();
   auto& block_preds = label2preds_[bb->id()];
   auto latch_pos =
       std::find(block_preds.begin(), block_preds.end(), latch_block->id());
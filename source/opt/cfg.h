@@ -17,15 +17,123 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "source/opt/basic_block.h"
+#include "source/opt/iterator.h"
 
 namespace spvtools {
 namespace opt {
 
+// The control flow graph of one function in a flat form.  The blocks are
+// numbered densely in the order they appear in the function, and the edges
+// are kept as arrays of block indices in compressed sparse row form.  The
+// graph is a snapshot of the function: it does not follow later changes, but
+// IsCurrent tells whether the function has changed since.
+class FunctionGraph {
+ public:
+  // The index returned for a block that is not in the function.
+  static const uint32_t kNoIndex = 0xFFFFFFFF;
+
+  explicit FunctionGraph(Function* func);
+
+  Function* function() const { return function_; }
+
+  // Returns the number of blocks in the function.
+  uint32_t size() const { return static_cast<uint32_t>(blocks_.size()); }
+
+  // Returns the block with index |index|.  The entry block has index 0.
+  BasicBlock* block(uint32_t index) const { return blocks_[index]; }
+
+  // Returns the index of the block with label |label_id|, or kNoIndex if the
+  // function has no such block.
+  uint32_t index(uint32_t label_id) const {
+    const auto it = id2index_.find(label_id);
+    return it == id2index_.end() ? kNoIndex : it->second;
+  }
+
+  // Returns the indices of the blocks that block |index| branches to, in the
+  // order of the operands of its terminator.
+  IteratorRange<const uint32_t*> successors(uint32_t index) const {
+    return Row(succ_offsets_, succs_, index);
+  }
+
+  // Returns the indices of the blocks that branch to block |index|.
+  IteratorRange<const uint32_t*> predecessors(uint32_t index) const {
+    return Row(pred_offsets_, preds_, index);
+  }
+
+  // Returns the structured successors of block |index|: its merge block and
+  // continue target if it is a header, followed by its successors.
+  IteratorRange<const uint32_t*> structured_successors(uint32_t index) const {
+    return Row(structured_offsets_, structured_succs_, index);
+  }
+
+  // Returns false if a block branches to, or declares as merge block or
+  // continue target, a label that is not a block of the function.  The
+  // edges to such labels are left out of the graph.
+  bool complete() const { return complete_; }
+
+  // Appends to |order| the indices of the blocks reachable from block |root|
+  // in post order, following the structured successors if |structured| is
+  // true.
+  void PostOrder(uint32_t root, bool structured,
+                 std::vector<uint32_t>* order) const;
+
+  // Returns the indices of the blocks reachable from the entry block in
+  // reverse post order.  It is computed on the first call.
+  const std::vector<uint32_t>& ReversePostOrder();
+
+  // Returns the indices of the blocks reachable from the entry block in
+  // structured order (see CFG::ComputeStructuredOrder).  It is computed on
+  // the first call.
+  const std::vector<uint32_t>& StructuredOrder();
+
+  // Returns true if the function still has the blocks of the graph, in the
+  // same order, and their terminators and merge instructions still have the
+  // targets of the graph.  Only complete graphs can be checked: this returns
+  // false for the others.  Takes time linear in the size of the graph, but
+  // does not look up any block.
+  bool IsCurrent() const;
+
+  // Returns true if |this| and |that| have the same blocks and edges.
+  bool operator==(const FunctionGraph& that) const;
+
+ private:
+  static IteratorRange<const uint32_t*> Row(
+      const std::vector<uint32_t>& offsets, const std::vector<uint32_t>& edges,
+      uint32_t index) {
+    return make_range(edges.data() + offsets[index],
+                      edges.data() + offsets[index + 1]);
+  }
+
+  Function* function_;
+  bool complete_ = true;
+
+  // The blocks of the function, in order, their ids, and the index of each
+  // block id.  The ids are kept apart so that IsCurrent does not read blocks
+  // that may have been deleted.
+  std::vector<BasicBlock*> blocks_;
+  std::vector<uint32_t> labels_;
+  std::unordered_map<uint32_t, uint32_t> id2index_;
+
+  // The edges leaving block i are in the range [offsets[i], offsets[i + 1])
+  // of the edge array.
+  std::vector<uint32_t> succ_offsets_;
+  std::vector<uint32_t> succs_;
+  std::vector<uint32_t> pred_offsets_;
+  std::vector<uint32_t> preds_;
+  std::vector<uint32_t> structured_offsets_;
+  std::vector<uint32_t> structured_succs_;
+
+  // The memoized block orders, empty until they are first requested.
+  std::vector<uint32_t> reverse_post_order_;
+  std::vector<uint32_t> structured_order_;
+};
+
 class CFG {
  public:
   explicit CFG(Module* module);
@@ -58,6 +166,27 @@ class CFG {
     return block_ptr == &pseudo_exit_block_;
   }
 
+  // Returns the flat graph of |func|.  It is built on the first call, and is
+  // dropped when the CFG is changed through any of the functions below.  Since
+  // passes also change blocks and terminators directly, it is built again if
+  // it is no longer current.  The block orders computed by the CFG are
+  // memoized in these graphs.
+  FunctionGraph* GetFunctionGraph(Function* func);
+
+  // Returns the flat graph of |func| if it has been built, and nullptr
+  // otherwise.
+  const FunctionGraph* FindFunctionGraph(const Function* func) const {
+    const auto it = function_graphs_.find(func);
+    return it == function_graphs_.end() ? nullptr : it->second.get();
+  }
+
+  // Drops the flat graphs of the functions.  The functions below that change
+  // the CFG call this, to free the graphs early; a graph that is kept across a
+  // change is still not used, see GetFunctionGraph.
+  void ClearFunctionGraphs() {
+    if (!function_graphs_.empty()) function_graphs_.clear();
+  }
+
   // Compute structured block order into |order| for |func| starting at |root|.
   // This order has the property that dominators come before all blocks they
   // dominate, merge blocks come after all blocks that are in the control
@@ -96,12 +225,14 @@ class CFG {
 
   // Removes from the CFG any mapping for the basic block id |blk_id|.
   void ForgetBlock(const BasicBlock* blk) {
+    ClearFunctionGraphs();
     id2block_.erase(blk->id());
     label2preds_.erase(blk->id());
     RemoveSuccessorEdges(blk);
   }
 
   void RemoveEdge(uint32_t pred_blk_id, uint32_t succ_blk_id) {
+    ClearFunctionGraphs();
     auto pred_it = label2preds_.find(succ_blk_id);
     if (pred_it == label2preds_.end()) return;
     auto& preds_list = pred_it->second;
@@ -115,6 +246,7 @@ class CFG {
   // Registers the basic block id |pred_blk_id| as being a predecessor of the
   // basic block id |succ_blk_id|.
   void AddEdge(uint32_t pred_blk_id, uint32_t succ_blk_id) {
+    ClearFunctionGraphs();
     label2preds_[succ_blk_id].push_back(pred_blk_id);
   }
 
@@ -137,6 +269,17 @@ class CFG {
   BasicBlock* SplitLoopHeader(BasicBlock* bb);
 
  private:
+  // Returns the flat graph of |func| if the blocks reachable from |root| can
+  // be traversed with it, and sets |*root_index| to the index of |root|.
+  // Returns nullptr if they have to be traversed through the blocks
+  // themselves: when |root| is not a block of |func|, or the graph of |func|
+  // is not complete.
+  FunctionGraph* GraphForTraversal(Function* func, const BasicBlock* root,
+                                   uint32_t* root_index);
+
+  // Appends the blocks reachable from |bb| to |order| in post order.
+  void ComputePostOrder(BasicBlock* bb, std::vector<BasicBlock*>* order);
+
   // Compute structured successors for function |func|. A block's structured
   // successors are the blocks it branches to together with its declared merge
   // block and continue block if it has them. When order matters, the merge
@@ -173,6 +316,11 @@ class CFG {
 
   // Map from block's label id to block.
   std::unordered_map<uint32_t, BasicBlock*> id2block_;
+
+  // The flat graphs of the functions that have been traversed since the CFG
+  // was last changed.
+  std::unordered_map<const Function*, std::unique_ptr<FunctionGraph>>
+      function_graphs_;
 };
 
 }  // namespace opt
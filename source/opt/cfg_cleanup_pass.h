@@ -30,8 +30,9 @@ class CFGCleanupPass : public MemPass {
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
-    return IRContext::kAnalysisDefUse | IRContext::kAnalysisConstants |
-           IRContext::kAnalysisTypes;
+    return IRContext::kAnalysisDefUse | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
   }
 };
 
@@ -14,6 +14,7 @@
 
 #include "source/opt/constants.h"
 
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -22,6 +23,36 @@
 namespace spvtools {
 namespace opt {
 namespace analysis {
+namespace {
+
+void AddPointer(std::u32string* h, const void* p) {
+  uint64_t ptr_val = reinterpret_cast<uint64_t>(p);
+  h->push_back(static_cast<uint32_t>(ptr_val >> 32));
+  h->push_back(static_cast<uint32_t>(ptr_val));
+}
+
+}  // namespace
+
+size_t Constant::ComputeHashValue() const {
+  std::u32string h;
+  AddPointer(&h, type());
+  if (const auto scalar = AsScalarConstant()) {
+    for (const auto& w : scalar->words()) {
+      h.push_back(w);
+    }
+  } else if (const auto composite = AsCompositeConstant()) {
+    for (const auto& c : composite->GetComponents()) {
+      AddPointer(&h, c);
+    }
+  } else if (AsNullConstant()) {
+    h.push_back(0);
+  } else {
+    assert(false &&
+           "Tried to compute the hash value of an invalid Constant instance.");
+  }
+
+  return std::hash<std::u32string>()(h);
+}
 
 float Constant::GetFloat() const {
   assert(type()->AsFloat() != nullptr && type()->AsFloat()->width() == 32);
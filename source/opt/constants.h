@@ -134,11 +134,29 @@ class Constant {
   std::vector<const Constant*> GetVectorComponents(
       ConstantManager* const_mgr) const;
 
+  // Returns the hash value of this constant.  It is computed from the type and
+  // the components by pointer, since both are unique, and only once.
+  size_t HashValue() const {
+    if (!has_hash_) {
+      hash_ = ComputeHashValue();
+      has_hash_ = true;
+    }
+    return hash_;
+  }
+
  protected:
   Constant(const Type* ty) : type_(ty) {}
 
   // The type of this constant.
   const Type* type_;
+
+ private:
+  size_t ComputeHashValue() const;
+
+  // A constant is not modified once it is created, so its hash value is
+  // cached.
+  mutable size_t hash_ = 0;
+  mutable bool has_hash_ = false;
 };
 
 // Abstract class for scalar type constants.
@@ -446,39 +464,19 @@ class NullConstant : public Constant {
 // Hash function for Constant instances. Use the structure of the constant as
 // the key.
 struct ConstantHash {
-  void add_pointer(std::u32string* h, const void* p) const {
-    uint64_t ptr_val = reinterpret_cast<uint64_t>(p);
-    h->push_back(static_cast<uint32_t>(ptr_val >> 32));
-    h->push_back(static_cast<uint32_t>(ptr_val));
-  }
-
   size_t operator()(const Constant* const_val) const {
-    std::u32string h;
-    add_pointer(&h, const_val->type());
-    if (const auto scalar = const_val->AsScalarConstant()) {
-      for (const auto& w : scalar->words()) {
-        h.push_back(w);
-      }
-    } else if (const auto composite = const_val->AsCompositeConstant()) {
-      for (const auto& c : composite->GetComponents()) {
-        add_pointer(&h, c);
-      }
-    } else if (const_val->AsNullConstant()) {
-      h.push_back(0);
-    } else {
-      assert(
-          false &&
-          "Tried to compute the hash value of an invalid Constant instance.");
-    }
-
-    return std::hash<std::u32string>()(h);
+    return const_val->HashValue();
   }
 };
 
 // Equality comparison structure for two constants.
 struct ConstantEqual {
   bool operator()(const Constant* c1, const Constant* c2) const {
-    if (c1->type() != c2->type()) {
+    if (c1 == c2) {
+      return true;
+    }
+
+    if (c1->type() != c2->type() || c1->HashValue() != c2->HashValue()) {
       return false;
     }
 
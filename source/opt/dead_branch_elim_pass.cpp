@@ -88,6 +88,14 @@ void DeadBranchElimPass::AddBranch(uint32_t labelId, BasicBlock* bp) {
   bp->AddInstruction(std::move(newBranch));
 }
 
+std::vector<uint32_t> DeadBranchElimPass::Successors(
+    const BasicBlock* block) {
+  std::vector<uint32_t> successors;
+  block->ForEachSuccessorLabel(
+      [&successors](const uint32_t id) { successors.push_back(id); });
+  return successors;
+}
+
 BasicBlock* DeadBranchElimPass::GetParentBlock(uint32_t id) {
   return context()->get_instr_block(get_def_use_mgr()->GetDef(id));
 }
@@ -194,6 +202,7 @@ bool DeadBranchElimPass::SimplifyBranch(BasicBlock* block,
                                         uint32_t live_lab_id) {
   Instruction* merge_inst = block->GetMergeInst();
   Instruction* terminator = block->terminator();
+  const std::vector<uint32_t> old_successors = Successors(block);
   if (merge_inst && merge_inst->opcode() == SpvOpSelectionMerge) {
     if (merge_inst->NextNode()->opcode() == SpvOpSwitch &&
         SwitchHasNestedBreak(block->id())) {
@@ -236,6 +245,7 @@ bool DeadBranchElimPass::SimplifyBranch(BasicBlock* block,
     AddBranch(live_lab_id, block);
     context()->KillInst(terminator);
   }
+  context()->UpdateCFGForNewTerminator(block, old_successors);
   return true;
 }
 
@@ -355,7 +365,7 @@ bool DeadBranchElimPass::FixPhiNodesInLiveBlocks(
             // the used ids in this phi.
             get_def_use_mgr()->EraseUseRecordsOfOperandIds(inst);
             inst->ReplaceOperands(operands);
-            get_def_use_mgr()->AnalyzeInstUse(inst);
+            context()->AnalyzeUses(inst);
             ++iter;
           }
         } else {
@@ -373,40 +383,51 @@ bool DeadBranchElimPass::EraseDeadBlocks(
     const std::unordered_set<BasicBlock*>& unreachable_merges,
     const std::unordered_map<BasicBlock*, BasicBlock*>& unreachable_continues) {
   bool modified = false;
-  for (auto ebi = func->begin(); ebi != func->end();) {
-    if (unreachable_continues.count(&*ebi)) {
-      uint32_t cont_id = unreachable_continues.find(&*ebi)->second->id();
-      if (ebi->begin() != ebi->tail() ||
-          ebi->terminator()->opcode() != SpvOpBranch ||
-          ebi->terminator()->GetSingleWordInOperand(0u) != cont_id) {
+  // The unreachable merges and continues are rewritten before the dead blocks
+  // are removed, since they can branch to dead blocks.  Once they no longer
+  // do, each dead block is only branched to by other dead blocks, which lets
+  // the CFG and the dominator trees forget them one at a time.
+  for (auto& block : *func) {
+    if (unreachable_continues.count(&block)) {
+      uint32_t cont_id = unreachable_continues.find(&block)->second->id();
+      if (block.begin() != block.tail() ||
+          block.terminator()->opcode() != SpvOpBranch ||
+          block.terminator()->GetSingleWordInOperand(0u) != cont_id) {
+        const std::vector<uint32_t> old_successors = Successors(&block);
         // Make unreachable, but leave the label.
-        KillAllInsts(&*ebi, false);
+        KillAllInsts(&block, false);
         // Add unconditional branch to header.
-        assert(unreachable_continues.count(&*ebi));
-        ebi->AddInstruction(MakeUnique<Instruction>(
+        block.AddInstruction(MakeUnique<Instruction>(
             context(), SpvOpBranch, 0, 0,
             std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {cont_id}}}));
-        get_def_use_mgr()->AnalyzeInstUse(&*ebi->tail());
-        context()->set_instr_block(&*ebi->tail(), &*ebi);
+        get_def_use_mgr()->AnalyzeInstUse(&*block.tail());
+        context()->set_instr_block(&*block.tail(), &block);
+        context()->UpdateCFGForNewTerminator(&block, old_successors);
         modified = true;
       }
-      ++ebi;
-    } else if (unreachable_merges.count(&*ebi)) {
-      if (ebi->begin() != ebi->tail() ||
-          ebi->terminator()->opcode() != SpvOpUnreachable) {
+    } else if (unreachable_merges.count(&block)) {
+      if (block.begin() != block.tail() ||
+          block.terminator()->opcode() != SpvOpUnreachable) {
+        const std::vector<uint32_t> old_successors = Successors(&block);
         // Make unreachable, but leave the label.
-        KillAllInsts(&*ebi, false);
+        KillAllInsts(&block, false);
         // Add unreachable terminator.
-        ebi->AddInstruction(
+        block.AddInstruction(
             MakeUnique<Instruction>(context(), SpvOpUnreachable, 0, 0,
                                     std::initializer_list<Operand>{}));
-        context()->AnalyzeUses(ebi->terminator());
-        context()->set_instr_block(ebi->terminator(), &*ebi);
+        context()->AnalyzeUses(block.terminator());
+        context()->set_instr_block(block.terminator(), &block);
+        context()->UpdateCFGForNewTerminator(&block, old_successors);
         modified = true;
       }
-      ++ebi;
-    } else if (!live_blocks.count(&*ebi)) {
+    }
+  }
+
+  for (auto ebi = func->begin(); ebi != func->end();) {
+    if (!live_blocks.count(&*ebi) && !unreachable_merges.count(&*ebi) &&
+        !unreachable_continues.count(&*ebi)) {
       // Kill this block.
+      context()->ForgetBlockInCFG(&*ebi);
       KillAllInsts(&*ebi);
       ebi = ebi.Erase();
       modified = true;
@@ -435,6 +456,9 @@ bool DeadBranchElimPass::EliminateDeadBranches(Function* func) {
 }
 
 void DeadBranchElimPass::FixBlockOrder() {
+  // The CFG and the dominator trees are updated as branches and blocks are
+  // removed, and reordering blocks does not change them, so they are kept
+  // after the pass.
   context()->BuildInvalidAnalyses(IRContext::kAnalysisCFG |
                                   IRContext::kAnalysisDominatorAnalysis);
   // Reorders blocks according to DFS of dominator tree.
@@ -474,6 +498,8 @@ void DeadBranchElimPass::FixBlockOrder() {
   } else {
     context()->ProcessReachableCallTree(reorder_dominators);
   }
+  // The blocks are numbered in their new order when next traversed.
+  context()->cfg()->ClearFunctionGraphs();
 }
 
 Pass::Status DeadBranchElimPass::Process() {
@@ -42,10 +42,13 @@ class DeadBranchElimPass : public MemPass {
 
   const char* name() const override { return "eliminate-dead-branches"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
+  bool KeepsChangeJournal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
-           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisInstrToBlockMapping | IRContext::kAnalysisCFG |
+           IRContext::kAnalysisDominatorAnalysis |
            IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
   }
 
@@ -69,6 +72,10 @@ class DeadBranchElimPass : public MemPass {
   // blocks.
   bool EliminateDeadBranches(Function* func);
 
+  // Returns the labels of the successors of |block|, in the order of the
+  // operands of its terminator.
+  std::vector<uint32_t> Successors(const BasicBlock* block);
+
   // Returns the basic block containing |id|.
   // Note: this pass only requires correct instruction block mappings for the
   // input. This pass does not preserve the block mapping, so it is not kept
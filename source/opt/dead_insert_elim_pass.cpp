@@ -65,7 +65,8 @@ uint32_t DeadInsertElimPass::NumComponents(Instruction* typeInst) {
 
 void DeadInsertElimPass::MarkInsertChain(
     Instruction* insertChain, std::vector<uint32_t>* pExtIndices,
-    uint32_t extOffset, std::unordered_set<uint32_t>* visited_phis) {
+    uint32_t extOffset, std::unordered_set<uint32_t>* visited_phis,
+    std::unordered_set<uint32_t>* live_inserts) {
   // Not currently optimizing array inserts.
   Instruction* typeInst = get_def_use_mgr()->GetDef(insertChain->type_id());
   if (typeInst->opcode() == SpvOpTypeArray) return;
@@ -83,7 +84,8 @@ void DeadInsertElimPass::MarkInsertChain(
         extIndices.clear();
         extIndices.push_back(i);
         std::unordered_set<uint32_t> sub_visited_phis;
-        MarkInsertChain(insertChain, &extIndices, 0, &sub_visited_phis);
+        MarkInsertChain(insertChain, &extIndices, 0, &sub_visited_phis,
+                        live_inserts);
       }
       return;
     }
@@ -98,23 +100,23 @@ void DeadInsertElimPass::MarkInsertChain(
     // EliminateDeadInsertsOnePass) because in some cases, we can do it
     // more accurately here.
     if (pExtIndices == nullptr) {
-      liveInserts_.insert(insInst->result_id());
+      live_inserts->insert(insInst->result_id());
       uint32_t objId = insInst->GetSingleWordInOperand(kInsertObjectIdInIdx);
       std::unordered_set<uint32_t> obj_visited_phis;
       MarkInsertChain(get_def_use_mgr()->GetDef(objId), nullptr, 0,
-                      &obj_visited_phis);
+                      &obj_visited_phis, live_inserts);
     // If extract indices match insert, we are done. Mark insert and
     // inserted object.
     } else if (ExtInsMatch(*pExtIndices, insInst, extOffset)) {
-      liveInserts_.insert(insInst->result_id());
+      live_inserts->insert(insInst->result_id());
       uint32_t objId = insInst->GetSingleWordInOperand(kInsertObjectIdInIdx);
       std::unordered_set<uint32_t> obj_visited_phis;
       MarkInsertChain(get_def_use_mgr()->GetDef(objId), nullptr, 0,
-                      &obj_visited_phis);
+                      &obj_visited_phis, live_inserts);
       break;
     // If non-matching intersection, mark insert
     } else if (ExtInsConflict(*pExtIndices, insInst, extOffset)) {
-      liveInserts_.insert(insInst->result_id());
+      live_inserts->insert(insInst->result_id());
       // If more extract indices than insert, we are done. Use remaining
       // extract indices to mark inserted object.
       uint32_t numInsertIndices = insInst->NumInOperands() - 2;
@@ -122,7 +124,8 @@ void DeadInsertElimPass::MarkInsertChain(
         uint32_t objId = insInst->GetSingleWordInOperand(kInsertObjectIdInIdx);
         std::unordered_set<uint32_t> obj_visited_phis;
         MarkInsertChain(get_def_use_mgr()->GetDef(objId), pExtIndices,
-                        extOffset + numInsertIndices, &obj_visited_phis);
+                        extOffset + numInsertIndices, &obj_visited_phis,
+                        live_inserts);
         break;
       // If fewer extract indices than insert, also mark inserted object and
       // continue up chain.
@@ -130,7 +133,7 @@ void DeadInsertElimPass::MarkInsertChain(
         uint32_t objId = insInst->GetSingleWordInOperand(kInsertObjectIdInIdx);
         std::unordered_set<uint32_t> obj_visited_phis;
         MarkInsertChain(get_def_use_mgr()->GetDef(objId), nullptr, 0,
-                        &obj_visited_phis);
+                        &obj_visited_phis, live_inserts);
       }
     }
     // Get next insert in chain
@@ -155,27 +158,27 @@ void DeadInsertElimPass::MarkInsertChain(
   auto new_end = std::unique(ids.begin(), ids.end());
   for (auto id_iter = ids.begin(); id_iter != new_end; ++id_iter) {
     Instruction* pi = get_def_use_mgr()->GetDef(*id_iter);
-    MarkInsertChain(pi, pExtIndices, extOffset, visited_phis);
+    MarkInsertChain(pi, pExtIndices, extOffset, visited_phis, live_inserts);
   }
 }
 
-bool DeadInsertElimPass::EliminateDeadInserts(Function* func) {
+bool DeadInsertElimPass::EliminateDeadInserts(
+    Function* func, std::unordered_set<uint32_t>* live_inserts) {
   bool modified = false;
-  bool lastmodified = true;
+  bool lastmodified = EliminateDeadInsertsOnePass(func, *live_inserts);
   // Each pass can delete dead instructions, thus potentially revealing
   // new dead insertions ie insertions with no uses.
   while (lastmodified) {
-    lastmodified = EliminateDeadInsertsOnePass(func);
-    modified |= lastmodified;
+    modified = true;
+    live_inserts->clear();
+    MarkLiveInserts(func, live_inserts);
+    lastmodified = EliminateDeadInsertsOnePass(func, *live_inserts);
   }
   return modified;
 }
 
-bool DeadInsertElimPass::EliminateDeadInsertsOnePass(Function* func) {
-  bool modified = false;
-  liveInserts_.clear();
-  visitedPhis_.clear();
-  // Mark all live inserts
+void DeadInsertElimPass::MarkLiveInserts(
+    Function* func, std::unordered_set<uint32_t>* live_inserts) {
   for (auto bi = func->begin(); bi != func->end(); ++bi) {
     for (auto ii = bi->begin(); ii != bi->end(); ++ii) {
       // Only process Inserts and composite Phis
@@ -190,12 +193,13 @@ bool DeadInsertElimPass::EliminateDeadInsertsOnePass(Function* func) {
       // TODO(greg-lunarg): Eliminate dead array inserts
       if (op == SpvOpCompositeInsert) {
         if (typeInst->opcode() == SpvOpTypeArray) {
-          liveInserts_.insert(ii->result_id());
+          live_inserts->insert(ii->result_id());
           continue;
         }
       }
       const uint32_t id = ii->result_id();
-      get_def_use_mgr()->ForEachUser(id, [&ii, this](Instruction* user) {
+      get_def_use_mgr()->ForEachUser(id, [&ii, live_inserts,
+                                          this](Instruction* user) {
         switch (user->opcode()) {
           case SpvOpCompositeInsert:
           case SpvOpPhi:
@@ -211,23 +215,29 @@ bool DeadInsertElimPass::EliminateDeadInsertsOnePass(Function* func) {
             });
             // Mark all inserts in chain that intersect with extract
             std::unordered_set<uint32_t> visited_phis;
-            MarkInsertChain(&*ii, &extIndices, 0, &visited_phis);
+            MarkInsertChain(&*ii, &extIndices, 0, &visited_phis,
+                            live_inserts);
           } break;
           default: {
             // Mark inserts in chain for all components
-            MarkInsertChain(&*ii, nullptr, 0, nullptr);
+            MarkInsertChain(&*ii, nullptr, 0, nullptr, live_inserts);
           } break;
         }
       });
     }
   }
+}
+
+bool DeadInsertElimPass::EliminateDeadInsertsOnePass(
+    Function* func, const std::unordered_set<uint32_t>& live_inserts) {
+  bool modified = false;
   // Find and disconnect dead inserts
   std::vector<Instruction*> dead_instructions;
   for (auto bi = func->begin(); bi != func->end(); ++bi) {
     for (auto ii = bi->begin(); ii != bi->end(); ++ii) {
       if (ii->opcode() != SpvOpCompositeInsert) continue;
       const uint32_t id = ii->result_id();
-      if (liveInserts_.find(id) != liveInserts_.end()) continue;
+      if (live_inserts.count(id) != 0) continue;
       const uint32_t replId =
           ii->GetSingleWordInOperand(kInsertCompositeIdInIdx);
       (void)context()->ReplaceAllUsesWith(id, replId);
@@ -251,9 +261,25 @@ bool DeadInsertElimPass::EliminateDeadInsertsOnePass(Function* func) {
 }
 
 Pass::Status DeadInsertElimPass::Process() {
+  // Marking the live inserts only reads the module, so the first marking is
+  // done for all functions in parallel.  Removing the dead inserts updates the
+  // def-use manager, so it is done one function at a time afterwards, along
+  // with the markings of the later rounds.
+  std::unordered_map<const Function*, std::unordered_set<uint32_t>>
+      live_inserts;
+  for (Function& function : *get_module()) {
+    live_inserts[&function];
+  }
+  ProcessEachFunctionInParallel(
+      [this, &live_inserts](Function* function, uint32_t) {
+        MarkLiveInserts(function, &live_inserts.at(function));
+        return false;
+      },
+      IRContext::kAnalysisDefUse);
+
   // Process all entry point functions.
-  ProcessFunction pfn = [this](Function* fp) {
-    return EliminateDeadInserts(fp);
+  ProcessFunction pfn = [this, &live_inserts](Function* fp) {
+    return EliminateDeadInserts(fp, &live_inserts.at(fp));
   };
   bool modified = context()->ProcessEntryPointCallTree(pfn);
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
@@ -59,29 +59,34 @@ class DeadInsertElimPass : public MemPass {
   // indices that intersect with extract indices |extIndices| starting with
   // index at |extOffset|. Chains are composed solely of Inserts and Phis.
   // Mark all inserts in chain if |extIndices| is nullptr.
+  // The ids of the marked inserts are added to |live_inserts|.
   void MarkInsertChain(Instruction* insertChain,
                        std::vector<uint32_t>* extIndices, uint32_t extOffset,
-                       std::unordered_set<uint32_t>* visited_phis);
+                       std::unordered_set<uint32_t>* visited_phis,
+                       std::unordered_set<uint32_t>* live_inserts);
+
+  // Add the ids of the live inserts of |func| to |live_inserts|. Only reads
+  // the module, so it may be called for several functions at once.
+  void MarkLiveInserts(Function* func,
+                       std::unordered_set<uint32_t>* live_inserts);
 
   // Perform EliminateDeadInsertsOnePass(|func|) until no modification is
-  // made. Return true if modified.
-  bool EliminateDeadInserts(Function* func);
+  // made, starting from the live inserts |live_inserts| of |func| and marking
+  // them again after each modification. Return true if modified.
+  bool EliminateDeadInserts(Function* func,
+                            std::unordered_set<uint32_t>* live_inserts);
 
-  // DCE all dead struct, matrix and vector inserts in |func|. An insert is
-  // dead if the value it inserts is never used. Replace any reference to the
-  // insert with its original composite. Return true if modified. Dead inserts
-  // in dependence cycles are not currently eliminated. Dead inserts into
-  // arrays are not currently eliminated.
-  bool EliminateDeadInsertsOnePass(Function* func);
+  // DCE all dead struct, matrix and vector inserts in |func|, given the live
+  // inserts |live_inserts|. An insert is dead if the value it inserts is never
+  // used. Replace any reference to the insert with its original composite.
+  // Return true if modified. Dead inserts in dependence cycles are not
+  // currently eliminated. Dead inserts into arrays are not currently
+  // eliminated.
+  bool EliminateDeadInsertsOnePass(
+      Function* func, const std::unordered_set<uint32_t>& live_inserts);
 
   // Return true if all extensions in this module are allowed by this pass.
   bool AllExtensionsSupported() const;
-
-  // Live inserts
-  std::unordered_set<uint32_t> liveInserts_;
-
-  // Visited phis as insert chain is traversed; used to avoid infinite loop
-  std::unordered_map<uint32_t, bool> visitedPhis_;
 };
 
 }  // namespace opt
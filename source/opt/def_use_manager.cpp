@@ -14,6 +14,7 @@
 
 #include "source/opt/def_use_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "source/opt/log.h"
@@ -26,11 +27,12 @@ namespace analysis {
 void DefUseManager::AnalyzeInstDef(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
   if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter != id_to_def_.end()) {
+    if (def_id >= id_to_def_.size()) {
+      id_to_def_.resize(def_id + 1, nullptr);
+    } else if (Instruction* old_def = id_to_def_[def_id]) {
       // Clear the original instruction that defining the same result id of the
       // new instruction.
-      ClearInst(iter->second);
+      ClearInst(old_def);
     }
     id_to_def_[def_id] = inst;
   } else {
@@ -57,9 +59,8 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
       case SPV_OPERAND_TYPE_MEMORY_SEMANTICS_ID:
       case SPV_OPERAND_TYPE_SCOPE_ID: {
         uint32_t use_id = inst->GetSingleWordOperand(i);
-        Instruction* def = GetDef(use_id);
-        assert(def && "Definition is not registered.");
-        id_to_users_.insert(UserEntry(def, inst));
+        assert(GetDef(use_id) && "Definition is not registered.");
+        AddUser(use_id, inst);
         used_ids->push_back(use_id);
       } break;
       default:
@@ -75,42 +76,69 @@ void DefUseManager::AnalyzeInstDefUse(Instruction* inst) {
 
 void DefUseManager::UpdateDefUse(Instruction* inst) {
   const uint32_t def_id = inst->result_id();
-  if (def_id != 0) {
-    auto iter = id_to_def_.find(def_id);
-    if (iter == id_to_def_.end()) {
-      AnalyzeInstDef(inst);
-    }
+  if (def_id != 0 && GetDef(def_id) == nullptr) {
+    AnalyzeInstDef(inst);
   }
   AnalyzeInstUse(inst);
 }
 
-Instruction* DefUseManager::GetDef(uint32_t id) {
-  auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
-}
-
-const Instruction* DefUseManager::GetDef(uint32_t id) const {
-  const auto iter = id_to_def_.find(id);
-  if (iter == id_to_def_.end()) return nullptr;
-  return iter->second;
-}
+void DefUseManager::AddUser(uint32_t id, Instruction* user) {
+  if (id >= id_to_users_.size()) id_to_users_.resize(id + 1);
+  UserList& list = id_to_users_[id];
+  std::vector<UserRecord>& records = list.records;
+  const uint32_t unique_id = user->unique_id();
+
+  // New instructions get increasing unique ids, so appending is the common
+  // case.
+  if (records.empty() || records.back().unique_id < unique_id) {
+    records.push_back({unique_id, user});
+    return;
+  }
 
-DefUseManager::IdToUsersMap::const_iterator DefUseManager::UsersBegin(
-    const Instruction* def) const {
-  return id_to_users_.lower_bound(
-      UserEntry(const_cast<Instruction*>(def), nullptr));
+  auto iter = std::lower_bound(
+      records.begin(), records.end(), unique_id,
+      [](const UserRecord& record, uint32_t needle) {
+        return record.unique_id < needle;
+      });
+  if (iter != records.end() && iter->unique_id == unique_id) {
+    if (iter->user == nullptr) {
+      iter->user = user;
+      --list.num_erased;
+    }
+    return;
+  }
+  records.insert(iter, {unique_id, user});
 }
 
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const IdToUsersMap::const_iterator& cached_end,
-                                const Instruction* inst) const {
-  return (iter != cached_end && iter->first == inst);
+void DefUseManager::RemoveUser(uint32_t id, const Instruction* user) {
+  if (id >= id_to_users_.size()) return;
+  UserList& list = id_to_users_[id];
+  std::vector<UserRecord>& records = list.records;
+  const uint32_t unique_id = user->unique_id();
+
+  auto iter = std::lower_bound(
+      records.begin(), records.end(), unique_id,
+      [](const UserRecord& record, uint32_t needle) {
+        return record.unique_id < needle;
+      });
+  if (iter == records.end() || iter->unique_id != unique_id ||
+      iter->user == nullptr) {
+    return;
+  }
+  iter->user = nullptr;
+  ++list.num_erased;
+  if (2 * list.num_erased >= records.size()) CompactUsers(&list);
 }
 
-bool DefUseManager::UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                                const Instruction* inst) const {
-  return UsersNotEnd(iter, id_to_users_.end(), inst);
+void DefUseManager::CompactUsers(UserList* list) {
+  if (iteration_depth_ != 0) return;
+  std::vector<UserRecord>& records = list->records;
+  records.erase(std::remove_if(records.begin(), records.end(),
+                               [](const UserRecord& record) {
+                                 return record.user == nullptr;
+                               }),
+                records.end());
+  list->num_erased = 0;
 }
 
 bool DefUseManager::WhileEachUser(
@@ -120,11 +148,21 @@ bool DefUseManager::WhileEachUser(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    if (!f(iter->second)) return false;
+  // |f| may add users, which can reallocate the user lists, so index into
+  // them afresh on every step.
+  const uint32_t id = def->result_id();
+  bool result = true;
+  ++iteration_depth_;
+  for (size_t i = 0;
+       id < id_to_users_.size() && i < id_to_users_[id].records.size(); ++i) {
+    Instruction* user = id_to_users_[id].records[i].user;
+    if (user != nullptr && !f(user)) {
+      result = false;
+      break;
+    }
   }
-  return true;
+  --iteration_depth_;
+  return result;
 }
 
 bool DefUseManager::WhileEachUser(
@@ -153,9 +191,7 @@ bool DefUseManager::WhileEachUse(
          "Definition is not registered.");
   if (!def->HasResultId()) return true;
 
-  auto end = id_to_users_.end();
-  for (auto iter = UsersBegin(def); UsersNotEnd(iter, end, def); ++iter) {
-    Instruction* user = iter->second;
+  return WhileEachUser(def, [def, &f](Instruction* user) {
     for (uint32_t idx = 0; idx != user->NumOperands(); ++idx) {
       const Operand& op = user->GetOperand(idx);
       if (op.type != SPV_OPERAND_TYPE_RESULT_ID && spvIsIdType(op.type)) {
@@ -164,8 +200,8 @@ bool DefUseManager::WhileEachUse(
         }
       }
     }
-  }
-  return true;
+    return true;
+  });
 }
 
 bool DefUseManager::WhileEachUse(
@@ -220,8 +256,29 @@ std::vector<Instruction*> DefUseManager::GetAnnotations(uint32_t id) const {
   return annos;
 }
 
+DefUseManager::IdToDefMap DefUseManager::id_to_defs() const {
+  IdToDefMap defs;
+  for (uint32_t id = 0; id < id_to_def_.size(); ++id) {
+    if (id_to_def_[id]) defs[id] = id_to_def_[id];
+  }
+  return defs;
+}
+
+DefUseManager::IdToUsersMap DefUseManager::id_to_users() const {
+  IdToUsersMap users;
+  for (uint32_t id = 0; id < id_to_users_.size(); ++id) {
+    Instruction* def = id < id_to_def_.size() ? id_to_def_[id] : nullptr;
+    for (const UserRecord& record : id_to_users_[id].records) {
+      if (record.user) users.insert(UserEntry(def, record.user));
+    }
+  }
+  return users;
+}
+
 void DefUseManager::AnalyzeDefUse(Module* module) {
   if (!module) return;
+  id_to_def_.reserve(module->IdBound());
+  id_to_users_.reserve(module->IdBound());
   // Analyze all the defs before any uses to catch forward references.
   module->ForEachInst(
       std::bind(&DefUseManager::AnalyzeInstDef, this, std::placeholders::_1));
@@ -233,15 +290,19 @@ void DefUseManager::ClearInst(Instruction* inst) {
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     EraseUseRecordsOfOperandIds(inst);
-    if (inst->result_id() != 0) {
+    const uint32_t def_id = inst->result_id();
+    if (def_id != 0) {
       // Remove all uses of this inst.
-      auto users_begin = UsersBegin(inst);
-      auto end = id_to_users_.end();
-      auto new_end = users_begin;
-      for (; UsersNotEnd(new_end, end, inst); ++new_end) {
+      if (def_id < id_to_users_.size()) {
+        UserList& list = id_to_users_[def_id];
+        if (iteration_depth_ == 0) {
+          list = UserList();
+        } else {
+          for (UserRecord& record : list.records) record.user = nullptr;
+          list.num_erased = static_cast<uint32_t>(list.records.size());
+        }
       }
-      id_to_users_.erase(users_begin, new_end);
-      id_to_def_.erase(inst->result_id());
+      if (def_id < id_to_def_.size()) id_to_def_[def_id] = nullptr;
     }
   }
 }
@@ -252,29 +313,18 @@ void DefUseManager::EraseUseRecordsOfOperandIds(const Instruction* inst) {
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     for (auto use_id : iter->second) {
-      id_to_users_.erase(
-          UserEntry(GetDef(use_id), const_cast<Instruction*>(inst)));
+      RemoveUser(use_id, inst);
     }
-    inst_to_used_ids_.erase(inst);
+    inst_to_used_ids_.erase(iter);
   }
 }
 
 bool operator==(const DefUseManager& lhs, const DefUseManager& rhs) {
-  if (lhs.id_to_def_ != rhs.id_to_def_) {
+  if (lhs.id_to_defs() != rhs.id_to_defs()) {
     return false;
   }
 
-  if (lhs.id_to_users_ != rhs.id_to_users_) {
-    for (auto p : lhs.id_to_users_) {
-      if (rhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
-    }
-    for (auto p : rhs.id_to_users_) {
-      if (lhs.id_to_users_.count(p) == 0) {
-        return false;
-      }
-    }
+  if (lhs.id_to_users() != rhs.id_to_users()) {
     return false;
   }
 
@@ -15,6 +15,7 @@
 #ifndef SOURCE_OPT_DEF_USE_MANAGER_H_
 #define SOURCE_OPT_DEF_USE_MANAGER_H_
 
+#include <atomic>
 #include <list>
 #include <set>
 #include <unordered_map>
@@ -94,6 +95,9 @@ struct UserEntryLess {
 };
 
 // A class for analyzing and managing defs and uses in an Module.
+//
+// Since result ids are dense in [1, id bound), definitions and users are kept
+// in vectors indexed by id rather than in associative containers.
 class DefUseManager {
  public:
   using IdToDefMap = std::unordered_map<uint32_t, Instruction*>;
@@ -103,7 +107,9 @@ class DefUseManager {
   // will be communicated to the outside via the given message |consumer|. This
   // instance only keeps a reference to the |consumer|, so the |consumer| should
   // outlive this instance.
-  DefUseManager(Module* module) { AnalyzeDefUse(module); }
+  DefUseManager(Module* module) : iteration_depth_(0) {
+    AnalyzeDefUse(module);
+  }
 
   DefUseManager(const DefUseManager&) = delete;
   DefUseManager(DefUseManager&&) = delete;
@@ -123,8 +129,12 @@ class DefUseManager {
 
   // Returns the def instruction for the given |id|. If there is no instruction
   // defining |id|, returns nullptr.
-  Instruction* GetDef(uint32_t id);
-  const Instruction* GetDef(uint32_t id) const;
+  Instruction* GetDef(uint32_t id) {
+    return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
+  }
+  const Instruction* GetDef(uint32_t id) const {
+    return id < id_to_def_.size() ? id_to_def_[id] : nullptr;
+  }
 
   // Runs the given function |f| on each unique user instruction of |def| (or
   // |id|).
@@ -195,10 +205,12 @@ class DefUseManager {
   // instructions which decorate the decoration group will not be returned.
   std::vector<Instruction*> GetAnnotations(uint32_t id) const;
 
-  // Returns the map from ids to their def instructions.
-  const IdToDefMap& id_to_defs() const { return id_to_def_; }
-  // Returns the map from instructions to their users.
-  const IdToUsersMap& id_to_users() const { return id_to_users_; }
+  // Returns a map from ids to their def instructions. The map is built on each
+  // call, so this is meant for testing and debugging.
+  IdToDefMap id_to_defs() const;
+  // Returns a map from instructions to their users. The map is built on each
+  // call, so this is meant for testing and debugging.
+  IdToUsersMap id_to_users() const;
 
   // Clear the internal def-use record of the given instruction |inst|. This
   // method will update the use information of the operand ids of |inst|. The
@@ -223,30 +235,49 @@ class DefUseManager {
   using InstToUsedIdsMap =
       std::unordered_map<const Instruction*, std::vector<uint32_t>>;
 
-  // Returns the first location that {|def|, nullptr} could be inserted into the
-  // users map without violating ordering.
-  IdToUsersMap::const_iterator UsersBegin(const Instruction* def) const;
+  // A user of a definition. |user| is nullptr if the record has been erased
+  // but not yet compacted away; |unique_id| is kept so that the records stay
+  // ordered.
+  struct UserRecord {
+    uint32_t unique_id;
+    Instruction* user;
+  };
 
-  // Returns true if |iter| has not reached the end of |def|'s users.
-  //
-  // In the first version |iter| is compared against the end of the map for
-  // validity before other checks. In the second version, |iter| is compared
-  // against |cached_end| for validity before other checks. This allows caching
-  // the map's end which is a performance improvement on some platforms.
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const Instruction* def) const;
-  bool UsersNotEnd(const IdToUsersMap::const_iterator& iter,
-                   const IdToUsersMap::const_iterator& cached_end,
-                   const Instruction* def) const;
+  // The users of a single id, ordered by the unique id of the user. Erasing a
+  // user only clears its record; the list is compacted once at least half of
+  // its records are erased.
+  struct UserList {
+    std::vector<UserRecord> records;
+    uint32_t num_erased = 0;
+  };
+
+  // Records that |user| uses |id|. Does nothing if that is already recorded.
+  void AddUser(uint32_t id, Instruction* user);
+
+  // Erases the record that |user| uses |id|, if any.
+  void RemoveUser(uint32_t id, const Instruction* user);
+
+  // Removes the erased records from |list|, unless the users of some id are
+  // being iterated over.
+  void CompactUsers(UserList* list);
 
   // Analyzes the defs and uses in the given |module| and populates data
   // structures in this class. Does nothing if |module| is nullptr.
   void AnalyzeDefUse(Module* module);
 
-  IdToDefMap id_to_def_;      // Mapping from ids to their definitions
-  IdToUsersMap id_to_users_;  // Mapping from ids to their users
+  // Mapping from ids to their definitions. Ids without a definition map to
+  // nullptr.
+  std::vector<Instruction*> id_to_def_;
+  // Mapping from ids to their users.
+  std::vector<UserList> id_to_users_;
   // Mapping from instructions to the ids used in the instruction.
   InstToUsedIdsMap inst_to_used_ids_;
+  // The number of iterations over users currently in progress. The user lists
+  // are not compacted while this is non-zero, so that the callbacks of
+  // |WhileEachUser| and |WhileEachUse| may erase records. Atomic because the
+  // callbacks of Pass::ProcessEachFunctionInParallel may iterate over users
+  // from several threads at once.
+  mutable std::atomic<uint32_t> iteration_depth_;
 };
 
 }  // namespace analysis
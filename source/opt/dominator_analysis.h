@@ -33,6 +33,29 @@ class DominatorAnalysisBase {
     tree_.InitializeTree(cfg, f);
   }
 
+  // Updates the tree after the edge from |from| to |to| has been added to the
+  // CFG |cfg|.  See DominatorTree::InsertEdge.
+  inline void InsertEdge(const CFG& cfg, BasicBlock* from, BasicBlock* to) {
+    tree_.InsertEdge(cfg, from->GetParent(), from, to);
+  }
+
+  // Updates the tree after the edge from |from| to |to| has been removed from
+  // the CFG |cfg|.  See DominatorTree::DeleteEdge.
+  inline void DeleteEdge(const CFG& cfg, BasicBlock* from, BasicBlock* to) {
+    tree_.DeleteEdge(cfg, from->GetParent(), from, to);
+  }
+
+  // Updates the tree after |successor| has been merged into |block|.  See
+  // DominatorTree::MergeSuccessorIntoBlock.
+  inline void MergeSuccessorIntoBlock(BasicBlock* block,
+                                      BasicBlock* successor) {
+    tree_.MergeSuccessorIntoBlock(block, successor);
+  }
+
+  // Removes the unreachable block |bb| from the tree.  See
+  // DominatorTree::ForgetBlock.
+  inline void ForgetBlock(const BasicBlock* bb) { tree_.ForgetBlock(bb); }
+
   // Returns true if BasicBlock |a| dominates BasicBlock |b|.
   inline bool Dominates(const BasicBlock* a, const BasicBlock* b) const {
     if (!a || !b) return false;
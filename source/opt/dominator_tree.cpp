@@ -15,6 +15,8 @@
 #include <iostream>
 #include <memory>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "source/cfa.h"
 #include "source/opt/dominator_tree.h"
@@ -81,6 +83,23 @@ static void DepthFirstSearchPostOrder(const BBType* bb,
   DepthFirstSearch(bb, successors, nop_preorder, post);
 }
 
+// Numbers the nodes of the subtree rooted at |root| in depth first pre and
+// post order, starting after |*index|, and leaves the last number used in
+// |*index|.
+void NumberSubtree(const DominatorTreeNode* root, int* index) {
+  auto preFunc = [index](const DominatorTreeNode* node) {
+    const_cast<DominatorTreeNode*>(node)->dfs_num_pre_ = ++*index;
+  };
+
+  auto postFunc = [index](const DominatorTreeNode* node) {
+    const_cast<DominatorTreeNode*>(node)->dfs_num_post_ = ++*index;
+  };
+
+  auto getSucc = [](const DominatorTreeNode* node) { return &node->children_; };
+
+  DepthFirstSearch(root, getSucc, preFunc, postFunc);
+}
+
 // Small type trait to get the function class type.
 template <typename BBType>
 struct GetFunctionClass {
@@ -103,7 +122,8 @@ class BasicBlockSuccessorHelper {
   using Function = typename GetFunctionClass<BBType>::FunctionType;
 
   using BasicBlockListTy = std::vector<BasicBlock*>;
-  using BasicBlockMapTy = std::map<const BasicBlock*, BasicBlockListTy>;
+  using BasicBlockMapTy =
+      std::unordered_map<const BasicBlock*, BasicBlockListTy>;
 
  public:
   // For compliance with the dominance tree computation, entry nodes are
@@ -156,18 +176,10 @@ BasicBlockSuccessorHelper<BBType>::BasicBlockSuccessorHelper(
 template <typename BBType>
 void BasicBlockSuccessorHelper<BBType>::CreateSuccessorMap(
     Function& f, const BasicBlock* dummy_start_node) {
-  std::map<uint32_t, BasicBlock*> id_to_BB_map;
-  auto GetSuccessorBasicBlock = [&f, &id_to_BB_map](uint32_t successor_id) {
-    BasicBlock*& Succ = id_to_BB_map[successor_id];
-    if (!Succ) {
-      for (BasicBlock& BBIt : f) {
-        if (successor_id == BBIt.id()) {
-          Succ = &BBIt;
-          break;
-        }
-      }
-    }
-    return Succ;
+  std::unordered_map<uint32_t, BasicBlock*> id_to_BB_map;
+  for (BasicBlock& bb : f) id_to_BB_map[bb.id()] = &bb;
+  auto GetSuccessorBasicBlock = [&id_to_BB_map](uint32_t successor_id) {
+    return id_to_BB_map[successor_id];
   };
 
   if (invert_graph_) {
@@ -260,10 +272,8 @@ BasicBlock* DominatorTree::ImmediateDominator(const BasicBlock* A) const {
 
 BasicBlock* DominatorTree::ImmediateDominator(uint32_t a) const {
   // Check that A is a valid node in the tree.
-  auto a_itr = nodes_.find(a);
-  if (a_itr == nodes_.end()) return nullptr;
-
-  const DominatorTreeNode* node = &a_itr->second;
+  const DominatorTreeNode* node = GetTreeNode(a);
+  if (node == nullptr) return nullptr;
 
   if (node->parent_ == nullptr) {
     return nullptr;
@@ -273,17 +283,11 @@ BasicBlock* DominatorTree::ImmediateDominator(uint32_t a) const {
 }
 
 DominatorTreeNode* DominatorTree::GetOrInsertNode(BasicBlock* bb) {
-  DominatorTreeNode* dtn = nullptr;
-
-  std::map<uint32_t, DominatorTreeNode>::iterator node_iter =
-      nodes_.find(bb->id());
-  if (node_iter == nodes_.end()) {
-    dtn = &nodes_.emplace(std::make_pair(bb->id(), DominatorTreeNode{bb}))
-               .first->second;
-  } else {
-    dtn = &node_iter->second;
+  DominatorTreeNode*& dtn = nodes_[bb->id()];
+  if (dtn == nullptr) {
+    node_storage_.emplace_back(bb);
+    dtn = &node_storage_.back();
   }
-
   return dtn;
 }
 
@@ -338,6 +342,7 @@ void DominatorTree::InitializeTree(const CFG& cfg, const Function* f) {
 
   // Transform the vector<pair> into the tree structure which we can use to
   // efficiently query dominance.
+  nodes_.reserve(edges.size());
   for (auto edge : edges) {
     DominatorTreeNode* first = GetOrInsertNode(edge.first);
 
@@ -357,17 +362,209 @@ void DominatorTree::InitializeTree(const CFG& cfg, const Function* f) {
 
 void DominatorTree::ResetDFNumbering() {
   int index = 0;
-  auto preFunc = [&index](const DominatorTreeNode* node) {
-    const_cast<DominatorTreeNode*>(node)->dfs_num_pre_ = ++index;
-  };
+  for (auto root : roots_) NumberSubtree(root, &index);
+}
 
-  auto postFunc = [&index](const DominatorTreeNode* node) {
-    const_cast<DominatorTreeNode*>(node)->dfs_num_post_ = ++index;
-  };
+std::vector<uint32_t> DominatorTree::GraphSuccessors(
+    const CFG& cfg, const BasicBlock* bb) const {
+  if (postdominator_) return cfg.preds(bb->id());
+  std::vector<uint32_t> successors;
+  bb->ForEachSuccessorLabel(
+      [&successors](const uint32_t id) { successors.push_back(id); });
+  return successors;
+}
 
-  auto getSucc = [](const DominatorTreeNode* node) { return &node->children_; };
+std::vector<uint32_t> DominatorTree::GraphPredecessors(
+    const CFG& cfg, const Function* f, const BasicBlock* bb) const {
+  if (!postdominator_) {
+    std::vector<uint32_t> predecessors = cfg.preds(bb->id());
+    if (bb == f->entry().get()) {
+      predecessors.push_back(cfg.pseudo_entry_block()->id());
+    }
+    return predecessors;
+  }
+  std::vector<uint32_t> predecessors;
+  bb->ForEachSuccessorLabel(
+      [&predecessors](const uint32_t id) { predecessors.push_back(id); });
+  if (predecessors.empty()) {
+    predecessors.push_back(cfg.pseudo_exit_block()->id());
+  }
+  return predecessors;
+}
+
+DominatorTreeNode* DominatorTree::NearestCommonDominator(
+    DominatorTreeNode* a, DominatorTreeNode* b) const {
+  while (!Dominates(a, b)) a = a->parent_;
+  return a;
+}
+
+void DominatorTree::RebuildSubtree(const CFG& cfg, const Function* f,
+                                   DominatorTreeNode* root) {
+  // The edges from the pseudo entry or exit block at the root of the tree are
+  // not in |cfg|, so the whole tree is rebuilt instead.
+  if (root->parent_ == nullptr) {
+    InitializeTree(cfg, f);
+    return;
+  }
+
+  std::vector<DominatorTreeNode*> subtree;
+  std::unordered_set<const DominatorTreeNode*> in_subtree;
+  for (auto node = root->df_begin(); node != root->df_end(); ++node) {
+    subtree.push_back(&*node);
+    in_subtree.insert(&*node);
+  }
 
-  for (auto root : roots_) DepthFirstSearch(root, getSucc, preFunc, postFunc);
+  // Only the edges between blocks of the subtree matter: all the other edges
+  // into the subtree enter it at |root|.
+  using NodeList = std::vector<DominatorTreeNode*>;
+  std::unordered_map<const DominatorTreeNode*, NodeList> successors;
+  std::unordered_map<const DominatorTreeNode*, NodeList> predecessors;
+  for (DominatorTreeNode* node : subtree) {
+    NodeList& node_successors = successors[node];
+    predecessors[node];
+    for (uint32_t id : GraphSuccessors(cfg, node->bb_)) {
+      DominatorTreeNode* successor = GetTreeNode(id);
+      if (!in_subtree.count(successor)) continue;
+      node_successors.push_back(successor);
+      predecessors[successor].push_back(node);
+    }
+  }
+
+  std::vector<const DominatorTreeNode*> postorder;
+  DepthFirstSearchPostOrder(
+      static_cast<const DominatorTreeNode*>(root),
+      [&successors](const DominatorTreeNode* node) {
+        return &successors[node];
+      },
+      [&postorder](const DominatorTreeNode* node) {
+        postorder.push_back(node);
+      });
+  if (postorder.size() != subtree.size()) {
+    // Some block of the subtree is no longer reachable from |root|.
+    InitializeTree(cfg, f);
+    return;
+  }
+
+  auto edges = CFA<DominatorTreeNode>::CalculateDominators(
+      postorder, [&predecessors](const DominatorTreeNode* node) {
+        return &predecessors[node];
+      });
+  for (DominatorTreeNode* node : subtree) node->children_.clear();
+  for (auto edge : edges) {
+    if (edge.first == edge.second) continue;
+    edge.first->parent_ = edge.second;
+    edge.second->children_.push_back(edge.first);
+  }
+
+  // The subtree holds the same blocks as before, so it is renumbered within
+  // the range of DFS numbers it already had.
+  int index = root->dfs_num_pre_ - 1;
+  NumberSubtree(root, &index);
+}
+
+void DominatorTree::InsertEdge(const CFG& cfg, const Function* f,
+                               BasicBlock* from, BasicBlock* to) {
+  // The edges of the graph of a post-dominator tree are reversed.
+  BasicBlock* source = postdominator_ ? to : from;
+  BasicBlock* target = postdominator_ ? from : to;
+  DominatorTreeNode* source_node = GetTreeNode(source);
+  DominatorTreeNode* target_node = GetTreeNode(target);
+
+  // An edge from an unreachable block changes nothing.
+  if (source_node == nullptr) return;
+
+  // If |target| was unreachable, it and the blocks it reaches are added to the
+  // tree.  If |from| was an exit block, the pseudo exit block loses its edge
+  // to it.
+  uint32_t from_successors = 0;
+  from->ForEachSuccessorLabel(
+      [&from_successors](const uint32_t) { ++from_successors; });
+  if (target_node == nullptr || (postdominator_ && from_successors == 1)) {
+    InitializeTree(cfg, f);
+    return;
+  }
+
+  RebuildSubtree(cfg, f, NearestCommonDominator(source_node, target_node));
+}
+
+void DominatorTree::DeleteEdge(const CFG& cfg, const Function* f,
+                               BasicBlock* from, BasicBlock* to) {
+  BasicBlock* source = postdominator_ ? to : from;
+  BasicBlock* target = postdominator_ ? from : to;
+  DominatorTreeNode* source_node = GetTreeNode(source);
+  DominatorTreeNode* target_node = GetTreeNode(target);
+
+  // An edge between unreachable blocks changes nothing.
+  if (source_node == nullptr || target_node == nullptr) return;
+
+  // |target| stays reachable if one of its predecessors is reachable without
+  // going through |target|.  Otherwise |target| and all the blocks it
+  // dominates become unreachable.  If |from| is now an exit block, the pseudo
+  // exit block gains an edge to it.
+  bool target_reachable = false;
+  for (uint32_t id : GraphPredecessors(cfg, f, target)) {
+    const DominatorTreeNode* pred = GetTreeNode(id);
+    if (pred && !Dominates(target_node, pred)) {
+      target_reachable = true;
+      break;
+    }
+  }
+  if (!target_reachable || (postdominator_ && !from->hasSuccessor())) {
+    InitializeTree(cfg, f);
+    return;
+  }
+
+  RebuildSubtree(cfg, f, NearestCommonDominator(source_node, target_node));
+}
+
+void DominatorTree::MergeSuccessorIntoBlock(BasicBlock* block,
+                                            BasicBlock* successor) {
+  DominatorTreeNode* kept = GetTreeNode(block);
+  DominatorTreeNode* removed = GetTreeNode(successor);
+  if (removed == nullptr) return;
+  assert(kept != nullptr &&
+         "A block and its only successor are either both reachable or not.");
+
+  // In a dominator tree |block| is the parent of |successor|, and in a
+  // post-dominator tree it is the other way around.  The children of the lower
+  // node take its place among the children of the upper one.
+  DominatorTreeNode* upper = postdominator_ ? removed : kept;
+  DominatorTreeNode* lower = postdominator_ ? kept : removed;
+  assert(lower->parent_ == upper);
+  auto position =
+      std::find(upper->children_.begin(), upper->children_.end(), lower);
+  position = upper->children_.erase(position);
+  upper->children_.insert(position, lower->children_.begin(),
+                          lower->children_.end());
+  for (DominatorTreeNode* child : lower->children_) child->parent_ = upper;
+  lower->children_.clear();
+
+  if (upper == removed) {
+    // The merged block takes the place of |successor|, and its DFS numbers.
+    kept->parent_ = removed->parent_;
+    kept->children_ = std::move(removed->children_);
+    for (DominatorTreeNode* child : kept->children_) child->parent_ = kept;
+    DominatorTreeNodeList& siblings =
+        kept->parent_ ? kept->parent_->children_ : roots_;
+    std::replace(siblings.begin(), siblings.end(), removed, kept);
+    kept->dfs_num_pre_ = removed->dfs_num_pre_;
+    kept->dfs_num_post_ = removed->dfs_num_post_;
+  }
+  nodes_.erase(successor->id());
+}
+
+void DominatorTree::ForgetBlock(const BasicBlock* bb) {
+  auto node_iter = nodes_.find(bb->id());
+  if (node_iter == nodes_.end()) return;
+  DominatorTreeNode* node = node_iter->second;
+  if (node->parent_) {
+    auto& siblings = node->parent_->children_;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), node));
+  }
+  // The children of |node| can only be blocks that branch to |bb|, which are
+  // removed as well.
+  for (DominatorTreeNode* child : node->children_) child->parent_ = nullptr;
+  nodes_.erase(node_iter);
 }
 
 void DominatorTree::DumpTreeAsDot(std::ostream& out_stream) const {
@@ -17,7 +17,8 @@
 
 #include <algorithm>
 #include <cstdint>
-#include <map>
+#include <deque>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -93,7 +94,8 @@ struct DominatorTreeNode {
 class DominatorTree {
  public:
   // Map OpLabel ids to dominator tree nodes
-  using DominatorTreeNodeMap = std::map<uint32_t, DominatorTreeNode>;
+  using DominatorTreeNodeMap =
+      std::unordered_map<uint32_t, DominatorTreeNode*>;
   using iterator = TreeDFIterator<DominatorTreeNode>;
   using const_iterator = TreeDFIterator<const DominatorTreeNode>;
   using post_iterator = PostOrderTreeDFIterator<DominatorTreeNode>;
@@ -205,6 +207,7 @@ class DominatorTree {
   // Clean up the tree.
   void ClearTree() {
     nodes_.clear();
+    node_storage_.clear();
     roots_.clear();
   }
 
@@ -257,7 +260,7 @@ class DominatorTree {
     if (node_iter == nodes_.end()) {
       return nullptr;
     }
-    return &node_iter->second;
+    return node_iter->second;
   }
   // Returns the DominatorTreeNode associated with the basic block id |id|.
   // If the id |id| is unknown to the dominator tree, it returns null.
@@ -266,7 +269,7 @@ class DominatorTree {
     if (node_iter == nodes_.end()) {
       return nullptr;
     }
-    return &node_iter->second;
+    return node_iter->second;
   }
 
   // Adds the basic block |bb| to the tree structure if it doesn't already
@@ -276,6 +279,36 @@ class DominatorTree {
   // Recomputes the DF numbering of the tree.
   void ResetDFNumbering();
 
+  // The following functions update the tree after a change to the CFG of the
+  // function |f| it was built for, instead of building it again.  |cfg| and
+  // the terminators of the blocks of |f| must already reflect the change, and
+  // must differ from the graph the tree was built on by that change only.
+  // Edges are always given in the direction of the control flow, also for a
+  // post-dominator tree.
+  //
+  // Only the subtree below the nearest common dominator of the ends of the
+  // edge is recomputed.  Changes that make blocks reachable or unreachable,
+  // or that add or remove an exit block of a post-dominator tree, rebuild the
+  // whole tree.
+
+  // Updates the tree after the edge from |from| to |to| has been added.
+  void InsertEdge(const CFG& cfg, const Function* f, BasicBlock* from,
+                  BasicBlock* to);
+
+  // Updates the tree after the edge from |from| to |to| has been removed.
+  void DeleteEdge(const CFG& cfg, const Function* f, BasicBlock* from,
+                  BasicBlock* to);
+
+  // Updates the tree after |successor| has been merged into |block|, where
+  // |successor| was the only successor of |block| and |block| the only
+  // predecessor of |successor|.  Must be called before |successor| is
+  // destroyed.
+  void MergeSuccessorIntoBlock(BasicBlock* block, BasicBlock* successor);
+
+  // Removes |bb| from the tree.  |bb| must be unreachable from the entry of
+  // the function, and each block that branches to it must be removed as well.
+  void ForgetBlock(const BasicBlock* bb);
+
  private:
   // Wrapper function which gets the list of pairs of each BasicBlocks to its
   // immediately  dominating BasicBlock and stores the result in the the edges
@@ -289,9 +322,36 @@ class DominatorTree {
       const Function* f, const BasicBlock* dummy_start_node,
       std::vector<std::pair<BasicBlock*, BasicBlock*>>* edges);
 
+  // Returns the ids of the successors of |bb| in the graph the tree is built
+  // on: its successors in |cfg|, or its predecessors for a post-dominator
+  // tree.  The edges from the pseudo entry or exit block are not included.
+  std::vector<uint32_t> GraphSuccessors(const CFG& cfg,
+                                        const BasicBlock* bb) const;
+
+  // Returns the ids of the predecessors of |bb| in the graph the tree is
+  // built on, including the pseudo entry or exit block of |cfg| when it has
+  // an edge to |bb|.
+  std::vector<uint32_t> GraphPredecessors(const CFG& cfg, const Function* f,
+                                          const BasicBlock* bb) const;
+
+  // Returns the deepest node that dominates both |a| and |b|.
+  DominatorTreeNode* NearestCommonDominator(DominatorTreeNode* a,
+                                            DominatorTreeNode* b) const;
+
+  // Recomputes the dominators of the blocks in the subtree rooted at |root|,
+  // which must still dominate all of them.
+  void RebuildSubtree(const CFG& cfg, const Function* f,
+                      DominatorTreeNode* root);
+
   // The roots of the tree.
   std::vector<DominatorTreeNode*> roots_;
 
+  // The nodes of the tree, in the order they were created.  A deque keeps
+  // the nodes in a few large allocations, and keeps them in place when
+  // nodes are added to a tree that is already built.  Nodes removed from the
+  // tree stay here until the tree is cleared.
+  std::deque<DominatorTreeNode> node_storage_;
+
   // Pairs each basic block id to the tree node containing that basic block.
   DominatorTreeNodeMap nodes_;
 
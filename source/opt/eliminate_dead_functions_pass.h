@@ -28,6 +28,7 @@ class EliminateDeadFunctionsPass : public MemPass {
  public:
   const char* name() const override { return "eliminate-dead-functions"; }
   Status Process() override;
+  bool KeepsChangeJournal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse | IRContext::kAnalysisConstants |
@@ -0,0 +1,210 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "source/opt/inline_bottom_up_pass.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kFunctionCallFunctionIdInIdx = 0;
+
+// Functions up to this size cost about as much to call as to inline, so
+// they are always inlined.
+const uint32_t kSmallFunctionSize = 8;
+
+uint32_t CountInstructions(const Function& func) {
+  uint32_t size = 0;
+  func.ForEachInst([&size](const Instruction*) { ++size; });
+  return size;
+}
+
+uint32_t GetCalleeId(const Instruction* call) {
+  return call->GetSingleWordInOperand(kFunctionCallFunctionIdInIdx);
+}
+
+}  // namespace
+
+InlineBottomUpPass::InlineBottomUpPass(uint32_t max_growth_percent,
+                                       uint32_t max_callee_size)
+    : max_growth_percent_(max_growth_percent),
+      max_callee_size_(max_callee_size) {}
+
+std::vector<Function*> InlineBottomUpPass::BottomUpOrder() {
+  std::unordered_map<uint32_t, std::vector<uint32_t>> callees;
+  for (auto& func : *get_module()) {
+    std::vector<uint32_t>& func_callees = callees[func.result_id()];
+    func.ForEachInst([&func_callees](const Instruction* inst) {
+      if (inst->opcode() == SpvOpFunctionCall) {
+        func_callees.push_back(GetCalleeId(inst));
+      }
+    });
+  }
+
+  // A depth-first search of the call graph from each function, which adds
+  // the functions in post-order.  Recursion is not allowed, but a function
+  // that is already on the stack is skipped so that the search ends.
+  std::vector<Function*> order;
+  std::unordered_set<uint32_t> visited;
+  std::vector<std::pair<uint32_t, size_t>> stack;
+  for (auto& root : *get_module()) {
+    if (!visited.insert(root.result_id()).second) continue;
+    stack.push_back({root.result_id(), 0});
+    while (!stack.empty()) {
+      const uint32_t func_id = stack.back().first;
+      const std::vector<uint32_t>& func_callees = callees[func_id];
+      if (stack.back().second < func_callees.size()) {
+        const uint32_t callee_id = func_callees[stack.back().second++];
+        if (id2function_.count(callee_id) && visited.insert(callee_id).second) {
+          stack.push_back({callee_id, 0});
+        }
+        continue;
+      }
+      order.push_back(id2function_[func_id]);
+      stack.pop_back();
+    }
+  }
+  return order;
+}
+
+bool InlineBottomUpPass::ShouldInline(const Instruction* call,
+                                      uint64_t caller_size,
+                                      uint64_t budget) const {
+  const uint32_t callee_id = GetCalleeId(call);
+  const uint32_t callee_size = function_size_.at(callee_id);
+  if (callee_size <= kSmallFunctionSize) return true;
+
+  // Inlining the only call to a function does not grow the module, once the
+  // function is removed.
+  if (call_count_.at(callee_id) == 1) return true;
+
+  return callee_size <= max_callee_size_ && caller_size + callee_size <= budget;
+}
+
+Pass::Status InlineBottomUpPass::InlineCalls(Function* func) {
+  // The calls in |func| before inlining.
+  std::unordered_set<uint32_t> calls;
+  func->ForEachInst([&calls](const Instruction* inst) {
+    if (inst->opcode() == SpvOpFunctionCall) calls.insert(inst->result_id());
+  });
+  if (calls.empty()) return Status::SuccessWithoutChange;
+
+  // The caller may grow by |max_growth_percent_|, but always has room for one
+  // callee of the largest size.
+  uint64_t size = function_size_[func->result_id()];
+  const uint64_t budget =
+      size + std::max<uint64_t>(size * max_growth_percent_ / 100,
+                                max_callee_size_);
+
+  bool modified = false;
+  // Using block iterators here because of block erasures and insertions.
+  for (auto bi = func->begin(); bi != func->end(); ++bi) {
+    for (auto ii = bi->begin(); ii != bi->end();) {
+      if (ii->opcode() != SpvOpFunctionCall || !calls.erase(ii->result_id())) {
+        ++ii;
+        continue;
+      }
+      if (!IsInlinableFunctionCall(&*ii) || !ShouldInline(&*ii, size, budget)) {
+        ++statistics_.calls_kept;
+        ++ii;
+        continue;
+      }
+
+      const uint32_t callee_id = GetCalleeId(&*ii);
+      const uint32_t callee_size = function_size_[callee_id];
+      std::vector<std::unique_ptr<BasicBlock>> newBlocks;
+      std::vector<std::unique_ptr<Instruction>> newVars;
+      if (!GenInlineCode(&newBlocks, &newVars, ii, bi)) {
+        return Status::Failure;
+      }
+      // If call block is replaced with more than one block, point
+      // succeeding phis at new last block.
+      if (newBlocks.size() > 1) UpdateSucceedingPhis(newBlocks);
+
+      // Kill the name and decorations of the call, which is deleted.  The
+      // other instructions in the block are moved to |newBlocks|.
+      context()->KillNamesAndDecorates(&*ii);
+
+      bi = bi.Erase();
+      for (auto& bb : newBlocks) {
+        bb->SetParent(func);
+      }
+      bi = bi.InsertBefore(&newBlocks);
+      // Insert new function variables.
+      if (newVars.size() > 0) {
+        func->begin()->begin().InsertBefore(std::move(newVars));
+      }
+
+      // The calls in the callee now also appear in |func|.
+      id2function_[callee_id]->ForEachInst([this](const Instruction* inst) {
+        if (inst->opcode() == SpvOpFunctionCall) {
+          ++call_count_[GetCalleeId(inst)];
+        }
+      });
+
+      // Continue at the beginning of the calling block.  The calls that were
+      // inlined with the callee are skipped, since they are not in |calls|.
+      ii = bi->begin();
+      size += callee_size;
+      ++statistics_.calls_inlined;
+      modified = true;
+    }
+  }
+
+  if (!modified) return Status::SuccessWithoutChange;
+  function_size_[func->result_id()] = CountInstructions(*func);
+  return Status::SuccessWithChange;
+}
+
+Pass::Status InlineBottomUpPass::Process() {
+  InitializeInline();
+  statistics_ = Statistics();
+  function_size_.clear();
+  call_count_.clear();
+
+  for (auto& func : *get_module()) {
+    const uint32_t size = CountInstructions(func);
+    function_size_[func.result_id()] = size;
+    statistics_.size_before += size;
+    func.ForEachInst([this](const Instruction* inst) {
+      if (inst->opcode() == SpvOpFunctionCall) ++call_count_[GetCalleeId(inst)];
+    });
+  }
+
+  Status status = Status::SuccessWithoutChange;
+  for (Function* func : BottomUpOrder()) {
+    status = CombineStatus(status, InlineCalls(func));
+    if (status == Status::Failure) return status;
+  }
+
+  for (auto& func : *get_module()) {
+    statistics_.size_after += function_size_[func.result_id()];
+  }
+  return status;
+}
+
+void InlineBottomUpPass::PrintStatistics(std::ostream& out) const {
+  out << name() << ": " << statistics_.calls_inlined << " calls inlined, "
+      << statistics_.calls_kept << " kept; " << statistics_.size_before
+      << " instructions before, " << statistics_.size_after << " after"
+      << std::endl;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,92 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SOURCE_OPT_INLINE_BOTTOM_UP_PASS_H_
+#define SOURCE_OPT_INLINE_BOTTOM_UP_PASS_H_
+
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/inline_pass.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class InlineBottomUpPass : public InlinePass {
+ public:
+  // Counts gathered by the last run of the pass.
+  struct Statistics {
+    // The number of calls that were inlined, and that were kept.
+    uint32_t calls_inlined = 0;
+    uint32_t calls_kept = 0;
+
+    // The number of instructions in the functions of the module before and
+    // after the pass.
+    uint64_t size_before = 0;
+    uint64_t size_after = 0;
+  };
+
+  InlineBottomUpPass(uint32_t max_growth_percent, uint32_t max_callee_size);
+  Status Process() override;
+
+  const char* name() const override { return "inline-bottom-up"; }
+
+  const Statistics& statistics() const { return statistics_; }
+
+  void PrintStatistics(std::ostream& out) const override;
+
+ private:
+  // Returns the functions in the module, ordered so that every function
+  // comes after the functions it calls.
+  std::vector<Function*> BottomUpOrder();
+
+  // Inlines the calls in |func| that the cost model accepts.  The calls that
+  // are brought in by inlining are not considered again: they were already
+  // considered when their caller was processed.
+  Status InlineCalls(Function* func);
+
+  // Returns true if the call |call| should be inlined into a caller with
+  // |caller_size| instructions, whose size must stay within |budget|.
+  bool ShouldInline(const Instruction* call, uint64_t caller_size,
+                    uint64_t budget) const;
+
+  // How much a caller may grow, in percent of its size before the pass.
+  const uint32_t max_growth_percent_;
+
+  // Functions larger than this are inlined only at their single call site.
+  const uint32_t max_callee_size_;
+
+  // The number of instructions in each function.  The size of a function is
+  // final once its calls have been inlined, which is before it is inlined
+  // anywhere, so it is computed once rather than at each call.
+  std::unordered_map<uint32_t, uint32_t> function_size_;
+
+  // The number of calls to each function in the module.  Inlining a function
+  // copies the calls in it into the caller, so their counts are updated after
+  // each call that is inlined.  The inlined calls are not subtracted, so a
+  // function is treated as having one call only if it never had more.
+  std::unordered_map<uint32_t, uint32_t> call_count_;
+
+  Statistics statistics_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_INLINE_BOTTOM_UP_PASS_H_
@@ -42,6 +42,23 @@ const uint32_t kDebugNoScopeNumWords = 5;
 // Number of operands of an OpBranchConditional instruction
 // with weights.
 const uint32_t kOpBranchConditionalWithWeightsNumOperands = 5;
+
+// Returns the words of |operand| in the parsed instruction |inst|.  Operands
+// that fit in the inline storage of OperandData are copied directly, without
+// a temporary vector.
+Operand::OperandData GetOperandWords(const spv_parsed_instruction_t& inst,
+                                     const spv_parsed_operand_t& operand) {
+  const uint32_t* begin = inst.words + operand.offset;
+  const uint32_t* end = begin + operand.num_words;
+  if (operand.num_words > 2) {
+    return Operand::OperandData(std::vector<uint32_t>(begin, end));
+  }
+  Operand::OperandData words;
+  for (const uint32_t* word = begin; word != end; ++word) {
+    words.push_back(*word);
+  }
+  return words;
+}
 }  // namespace
 
 Instruction::Instruction(IRContext* c)
@@ -73,12 +90,11 @@ Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
       dbg_scope_(kNoDebugScope, kNoInlinedAt) {
   assert((!IsDebugLineInst(opcode_) || dbg_line.empty()) &&
          "Op(No)Line attaching to Op(No)Line found");
+  operands_.reserve(inst.num_operands);
   for (uint32_t i = 0; i < inst.num_operands; ++i) {
     const auto& current_payload = inst.operands[i];
-    std::vector<uint32_t> words(
-        inst.words + current_payload.offset,
-        inst.words + current_payload.offset + current_payload.num_words);
-    operands_.emplace_back(current_payload.type, std::move(words));
+    operands_.emplace_back(current_payload.type,
+                           GetOperandWords(inst, current_payload));
   }
 }
 
@@ -90,12 +106,11 @@ Instruction::Instruction(IRContext* c, const spv_parsed_instruction_t& inst,
       has_result_id_(inst.result_id != 0),
       unique_id_(c->TakeNextUniqueId()),
       dbg_scope_(dbg_scope) {
+  operands_.reserve(inst.num_operands);
   for (uint32_t i = 0; i < inst.num_operands; ++i) {
     const auto& current_payload = inst.operands[i];
-    std::vector<uint32_t> words(
-        inst.words + current_payload.offset,
-        inst.words + current_payload.offset + current_payload.num_words);
-    operands_.emplace_back(current_payload.type, std::move(words));
+    operands_.emplace_back(current_payload.type,
+                           GetOperandWords(inst, current_payload));
   }
 }
 
@@ -146,7 +161,7 @@ Instruction& Instruction::operator=(Instruction&& that) {
 }
 
 Instruction* Instruction::Clone(IRContext* c) const {
-  Instruction* clone = new Instruction(c);
+  Instruction* clone = new (c->arena()) Instruction(c);
   clone->opcode_ = opcode_;
   clone->has_type_id_ = has_type_id_;
   clone->has_result_id_ = has_result_id_;
@@ -517,6 +532,16 @@ Instruction* Instruction::InsertBefore(
   return first_node;
 }
 
+void Instruction::InsertBefore(Instruction* pos) {
+  utils::IntrusiveNodeBase<Instruction>::InsertBefore(pos);
+  if (context_) context_->RecordChangedInstruction(this);
+}
+
+void Instruction::InsertAfter(Instruction* pos) {
+  utils::IntrusiveNodeBase<Instruction>::InsertAfter(pos);
+  if (context_) context_->RecordChangedInstruction(this);
+}
+
 bool Instruction::IsValidBasePointer() const {
   uint32_t tid = type_id();
   if (tid == 0) {
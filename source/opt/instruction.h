@@ -28,6 +28,7 @@
 #include "source/opcode.h"
 #include "source/operand.h"
 #include "source/opt/reflect.h"
+#include "source/util/arena.h"
 #include "source/util/ilist_node.h"
 #include "source/util/small_vector.h"
 #include "spirv-tools/libspirv.h"
@@ -160,7 +161,8 @@ class DebugScope {
 // appearing before this instruction. Note that the result id of an instruction
 // should never change after the instruction being built. If the result id
 // needs to change, the user should create a new instruction instead.
-class Instruction : public utils::IntrusiveNodeBase<Instruction> {
+class Instruction : public utils::IntrusiveNodeBase<Instruction>,
+                    public utils::ArenaAllocatable<Instruction> {
  public:
   using OperandList = std::vector<Operand>;
   using iterator = OperandList::iterator;
@@ -211,7 +213,8 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // and type as |this|.  The new instruction is not linked into any list.
   // It is the responsibility of the caller to make sure that the storage is
   // removed. It is the caller's responsibility to make sure that there is only
-  // one instruction for each result id.
+  // one instruction for each result id.  The new instruction is allocated from
+  // the arena of |c| if it has one.
   Instruction* Clone(IRContext* c) const;
 
   IRContext* context() const { return context_; }
@@ -503,7 +506,11 @@ class Instruction : public utils::IntrusiveNodeBase<Instruction> {
   // immediately before |this|.  Returns the first inserted instruction.
   // Assumes the list is non-empty.
   Instruction* InsertBefore(std::vector<std::unique_ptr<Instruction>>&& list);
-  using utils::IntrusiveNodeBase<Instruction>::InsertBefore;
+
+  // Same semantics as in the base class, except that the insertion is
+  // recorded in the change journal of the context, if it is being recorded.
+  void InsertBefore(Instruction* pos);
+  void InsertAfter(Instruction* pos);
 
   // Returns true if |this| is an instruction defining a constant, but not a
   // Spec constant.
@@ -0,0 +1,43 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/instruction_numbering.h"
+
+namespace spvtools {
+namespace opt {
+
+const uint32_t InstructionNumbering::kNoNumber;
+
+InstructionNumbering::InstructionNumbering(Function* func) {
+  for (auto& bb : *func) {
+    blocks_.push_back(&bb);
+    GetOrAssign(bb.GetLabelInst());
+  }
+  func->ForEachInst([this](Instruction* inst) { GetOrAssign(inst); });
+}
+
+uint32_t InstructionNumbering::GetOrAssign(Instruction* inst) {
+  const uint32_t page = inst->unique_id() >> kPageBits;
+  if (page >= pages_.size()) pages_.resize(page + 1);
+  if (pages_[page].empty()) pages_[page].assign(1u << kPageBits, kNoNumber);
+  uint32_t& number = pages_[page][inst->unique_id() & kPageMask];
+  if (number == kNoNumber) {
+    number = size();
+    instructions_.push_back(inst);
+  }
+  return number;
+}
+
+}  // namespace opt
+}  // namespace spvtools
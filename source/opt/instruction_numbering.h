@@ -0,0 +1,91 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_INSTRUCTION_NUMBERING_H_
+#define SOURCE_OPT_INSTRUCTION_NUMBERING_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+// Numbers the blocks and instructions of a function densely from 0, so that
+// an analysis of the function can keep its data in flat arrays and bit
+// vectors indexed by these numbers instead of in hash tables keyed by
+// pointers.
+//
+// The labels of the blocks are numbered first, in the order of the blocks in
+// the function, so the number of a block is the number of its label and is
+// less than num_blocks().  The other instructions of the function follow.
+// Instructions from outside the function, such as global values, can be
+// numbered on demand with GetOrAssign.
+//
+// The numbers are found through the unique ids of the instructions, in a
+// table allocated in pages, so only the ranges of unique ids that are used
+// take memory.  The numbering is a snapshot: instructions added to the
+// function later are not numbered.
+class InstructionNumbering {
+ public:
+  // The number of an instruction that has not been numbered.
+  static const uint32_t kNoNumber = 0xFFFFFFFF;
+
+  explicit InstructionNumbering(Function* func);
+
+  // Returns the number of instructions that have been numbered.
+  uint32_t size() const { return static_cast<uint32_t>(instructions_.size()); }
+
+  // Returns the number of blocks in the function.
+  uint32_t num_blocks() const { return static_cast<uint32_t>(blocks_.size()); }
+
+  // Returns the number of |inst|, or kNoNumber if it has not been numbered.
+  uint32_t Get(const Instruction* inst) const {
+    const uint32_t page = inst->unique_id() >> kPageBits;
+    if (page >= pages_.size() || pages_[page].empty()) return kNoNumber;
+    return pages_[page][inst->unique_id() & kPageMask];
+  }
+
+  // Returns the number of |inst|, numbering it first if needed.
+  uint32_t GetOrAssign(Instruction* inst);
+
+  // Returns the number of |bb|, or kNoNumber if it is not a block of the
+  // function.
+  uint32_t Get(const BasicBlock* bb) const { return Get(bb->GetLabelInst()); }
+
+  // Returns the instruction with number |number|.
+  Instruction* instruction(uint32_t number) const {
+    return instructions_[number];
+  }
+
+  // Returns the block with number |number|, which must be less than
+  // num_blocks().
+  BasicBlock* block(uint32_t number) const { return blocks_[number]; }
+
+ private:
+  // Each page maps 2^kPageBits consecutive unique ids to numbers.
+  static const uint32_t kPageBits = 10;
+  static const uint32_t kPageMask = (1u << kPageBits) - 1;
+
+  std::vector<std::vector<uint32_t>> pages_;
+  std::vector<Instruction*> instructions_;
+  std::vector<BasicBlock*> blocks_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_INSTRUCTION_NUMBERING_H_
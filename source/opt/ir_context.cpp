@@ -14,6 +14,7 @@
 
 #include "source/opt/ir_context.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "OpenCLDebugInfo100.h"
@@ -88,6 +89,50 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDebugInfo) {
     BuildDebugInfoManager();
   }
+  if (set & kAnalysisCombinators) {
+    InitializeCombinators();
+  }
+}
+
+const char* IRContext::GetAnalysisName(Analysis analysis) {
+  switch (analysis) {
+    case kAnalysisDefUse:
+      return "def-use";
+    case kAnalysisInstrToBlockMapping:
+      return "instr-to-block";
+    case kAnalysisDecorations:
+      return "decorations";
+    case kAnalysisCombinators:
+      return "combinators";
+    case kAnalysisCFG:
+      return "cfg";
+    case kAnalysisDominatorAnalysis:
+      return "dominators";
+    case kAnalysisLoopAnalysis:
+      return "loops";
+    case kAnalysisNameMap:
+      return "name-map";
+    case kAnalysisScalarEvolution:
+      return "scalar-evolution";
+    case kAnalysisRegisterPressure:
+      return "register-pressure";
+    case kAnalysisValueNumberTable:
+      return "value-numbers";
+    case kAnalysisStructuredCFG:
+      return "structured-cfg";
+    case kAnalysisBuiltinVarId:
+      return "builtin-var-ids";
+    case kAnalysisIdToFuncMapping:
+      return "id-to-function";
+    case kAnalysisConstants:
+      return "constants";
+    case kAnalysisTypes:
+      return "types";
+    case kAnalysisDebugInfo:
+      return "debug-info";
+    default:
+      return "unknown";
+  }
 }
 
 void IRContext::InvalidateAnalysesExceptFor(
@@ -183,6 +228,9 @@ Instruction* IRContext::KillInst(Instruction* inst) {
   if (AreAnalysesValid(kAnalysisDebugInfo)) {
     get_debug_info_mgr()->ClearDebugInfo(inst);
   }
+  if (AreAnalysesValid(kAnalysisValueNumberTable) && inst->result_id() != 0) {
+    vn_table_->RemoveInstruction(inst);
+  }
   if (type_mgr_ && IsTypeInst(inst->opcode())) {
     type_mgr_->RemoveId(inst->result_id());
   }
@@ -199,6 +247,7 @@ Instruction* IRContext::KillInst(Instruction* inst) {
   }
 
   RemoveFromIdToName(inst);
+  journal_insts_.erase(inst);
 
   Instruction* next_instruction = nullptr;
   if (inst->IsInAList()) {
@@ -288,6 +337,90 @@ bool IRContext::ReplaceAllUsesWithPredicate(
   return true;
 }
 
+IRContext::Analysis IRContext::StopChangeJournal() {
+  if (!journal_.empty()) CatchUpWithChangeJournal();
+  journal_enabled_ = false;
+  const Analysis journaled = kAnalysisDefUse | kAnalysisDecorations |
+                             kAnalysisInstrToBlockMapping;
+  return Analysis(valid_analyses_ & journaled & ~journal_dropped_);
+}
+
+void IRContext::CatchUpWithChangeJournal() {
+  // The instructions that were killed after they were recorded are no longer
+  // in |journal_insts_|.
+  std::vector<Instruction*> insts;
+  insts.reserve(journal_.size());
+  for (Instruction* inst : journal_) {
+    if (journal_insts_.erase(inst)) insts.push_back(inst);
+  }
+  journal_.clear();
+
+  if (AreAnalysesValid(kAnalysisDefUse)) {
+    // The definitions are added first, since an instruction can use an id
+    // defined by an instruction recorded after it.  Analyzing the definition
+    // of an instruction that is already registered would forget its users.
+    for (Instruction* inst : insts) {
+      const uint32_t id = inst->result_id();
+      if (id != 0 && def_use_mgr_->GetDef(id) != inst) {
+        def_use_mgr_->AnalyzeInstDef(inst);
+      }
+    }
+    for (Instruction* inst : insts) {
+      def_use_mgr_->AnalyzeInstUse(inst);
+    }
+  }
+  if (AreAnalysesValid(kAnalysisDecorations)) {
+    for (Instruction* inst : insts) {
+      if (inst->IsDecoration()) {
+        decoration_mgr_->RemoveDecoration(inst);
+        decoration_mgr_->AddDecoration(inst);
+      }
+    }
+  }
+  if (AreAnalysesValid(kAnalysisInstrToBlockMapping)) {
+    CatchUpInstrToBlockMapping(insts);
+  }
+}
+
+void IRContext::CatchUpInstrToBlockMapping(
+    const std::vector<Instruction*>& insts) {
+  std::unordered_set<Instruction*> unmapped(insts.begin(), insts.end());
+  for (Instruction* inst : insts) {
+    unmapped.erase(inst);
+    if (!inst->IsInAList()) continue;
+
+    // An instruction in a block is in the same block as its neighbours.
+    Instruction* neighbour = inst->NextNode();
+    while (neighbour != nullptr && unmapped.count(neighbour)) {
+      neighbour = neighbour->NextNode();
+    }
+    if (neighbour == nullptr) {
+      neighbour = inst->PreviousNode();
+      while (neighbour != nullptr && unmapped.count(neighbour)) {
+        neighbour = neighbour->PreviousNode();
+      }
+    }
+    auto entry = neighbour ? instr_to_block_.find(neighbour)
+                           : instr_to_block_.end();
+    if (entry != instr_to_block_.end()) {
+      instr_to_block_[inst] = entry->second;
+      continue;
+    }
+
+    // The pass may have given the block with set_instr_block.  Otherwise,
+    // the instruction is either outside of a function, or in a new block.
+    // Only the lists of instructions in a block end with a terminator.
+    if (instr_to_block_.count(inst)) continue;
+    Instruction* last = inst;
+    while (last->NextNode() != nullptr) last = last->NextNode();
+    if (last->IsBlockTerminator()) {
+      InvalidateAnalyses(kAnalysisInstrToBlockMapping);
+      journal_dropped_ |= kAnalysisInstrToBlockMapping;
+      return;
+    }
+  }
+}
+
 bool IRContext::IsConsistent() {
 #ifndef SPIRV_CHECK_CONTEXT
   return true;
@@ -325,6 +458,10 @@ bool IRContext::IsConsistent() {
     return false;
   }
 
+  if (!CheckDominators()) {
+    return false;
+  }
+
   if (AreAnalysesValid(kAnalysisDecorations)) {
     analysis::DecorationManager* dec_mgr = get_decoration_mgr();
     analysis::DecorationManager current(module());
@@ -362,6 +499,7 @@ void IRContext::ForgetUses(Instruction* inst) {
 }
 
 void IRContext::AnalyzeUses(Instruction* inst) {
+  RecordChangedInstruction(inst);
   if (AreAnalysesValid(kAnalysisDefUse)) {
     get_def_use_mgr()->AnalyzeInstUse(inst);
   }
@@ -690,6 +828,7 @@ void IRContext::AddCombinatorsForExtension(Instruction* extension) {
 }
 
 void IRContext::InitializeCombinators() {
+  ScopedAnalysisBuild scoped_build(this, kAnalysisCombinators);
   get_feature_mgr()->GetCapabilities()->ForEach(
       [this](SpvCapability cap) { AddCombinatorsForCapability(cap); });
 
@@ -721,6 +860,7 @@ LoopDescriptor* IRContext::GetLoopDescriptor(const Function* f) {
   std::unordered_map<const Function*, LoopDescriptor>::iterator it =
       loop_descriptors_.find(f);
   if (it == loop_descriptors_.end()) {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisLoopAnalysis);
     return &loop_descriptors_
                 .emplace(std::make_pair(f, LoopDescriptor(this, f)))
                 .first->second;
@@ -896,7 +1036,9 @@ bool IRContext::ProcessCallTreeFromRoots(ProcessFunction& pfn,
     if (done.insert(fi).second) {
       Function* fn = GetFunction(fi);
       assert(fn && "Trying to process a function that does not exist.");
-      modified = pfn(fn) || modified;
+      if (ShouldProcessFunction(*fn)) {
+        modified = pfn(fn) || modified;
+      }
       AddCalls(fn, roots);
     }
   }
@@ -946,7 +1088,10 @@ DominatorAnalysis* IRContext::GetDominatorAnalysis(const Function* f) {
   }
 
   if (dominator_trees_.find(f) == dominator_trees_.end()) {
-    dominator_trees_[f].InitializeTree(*cfg(), f);
+    // Build the CFG first so that it is recorded separately.
+    const CFG& function_cfg = *cfg();
+    ScopedAnalysisBuild scoped_build(this, kAnalysisDominatorAnalysis);
+    dominator_trees_[f].InitializeTree(function_cfg, f);
   }
 
   return &dominator_trees_[f];
@@ -959,7 +1104,9 @@ PostDominatorAnalysis* IRContext::GetPostDominatorAnalysis(const Function* f) {
   }
 
   if (post_dominator_trees_.find(f) == post_dominator_trees_.end()) {
-    post_dominator_trees_[f].InitializeTree(*cfg(), f);
+    const CFG& function_cfg = *cfg();
+    ScopedAnalysisBuild scoped_build(this, kAnalysisDominatorAnalysis);
+    post_dominator_trees_[f].InitializeTree(function_cfg, f);
   }
 
   return &post_dominator_trees_[f];
@@ -1012,9 +1159,115 @@ bool IRContext::CheckCFG() {
       }
       if (!same) return false;
     }
+
+    // A flat graph that is no longer current is rebuilt the next time it is
+    // used, so only a graph that still looks current must match the function.
+    // Otherwise its edges, and the block orders memoized in it, were kept
+    // across a change that IsCurrent() does not see.
+    const FunctionGraph* graph = cfg()->FindFunctionGraph(&function);
+    if (graph != nullptr && graph->IsCurrent()) {
+      FunctionGraph current(&function);
+      if (!(*graph == current)) {
+        std::cerr << "The flat CFG of function " << function.result_id()
+                  << " is out of date.\n";
+        return false;
+      }
+    }
   }
 
   return true;
 }
+
+void IRContext::UpdateCFGForNewTerminator(
+    BasicBlock* bb, const std::vector<uint32_t>& old_successors) {
+  // The dominator trees are only valid if the CFG is.
+  if (!AreAnalysesValid(kAnalysisCFG)) return;
+
+  // The edges that were removed and added, counting repeated edges.
+  std::vector<uint32_t> removed = old_successors;
+  std::vector<uint32_t> added;
+  const BasicBlock* const_bb = bb;
+  const_bb->ForEachSuccessorLabel([&removed, &added](const uint32_t id) {
+    auto it = std::find(removed.begin(), removed.end(), id);
+    if (it != removed.end()) {
+      removed.erase(it);
+    } else {
+      added.push_back(id);
+    }
+  });
+  for (uint32_t id : removed) cfg()->RemoveEdge(bb->id(), id);
+  for (uint32_t id : added) cfg()->AddEdge(bb->id(), id);
+
+  // The trees are updated one edge at a time, so they are rebuilt when
+  // several edges changed at once.  The edges leaving a block that is not
+  // reachable from the entry do not change the dominator tree.
+  const Function* f = bb->GetParent();
+  for (DominatorAnalysisBase* analysis :
+       {static_cast<DominatorAnalysisBase*>(FindDominatorAnalysis(f)),
+        static_cast<DominatorAnalysisBase*>(FindPostDominatorAnalysis(f))}) {
+    if (analysis == nullptr) continue;
+    if (!analysis->IsPostDominator() && !analysis->IsReachable(bb)) continue;
+    if (removed.size() + added.size() > 1) {
+      analysis->InitializeTree(*cfg(), f);
+    } else if (!removed.empty()) {
+      analysis->DeleteEdge(*cfg(), bb, cfg()->block(removed[0]));
+    } else if (!added.empty()) {
+      analysis->InsertEdge(*cfg(), bb, cfg()->block(added[0]));
+    }
+  }
+}
+
+void IRContext::ForgetBlockInCFG(BasicBlock* bb) {
+  if (!AreAnalysesValid(kAnalysisCFG)) return;
+  cfg()->ForgetBlock(bb);
+  if (DominatorAnalysis* dominators = FindDominatorAnalysis(bb->GetParent())) {
+    dominators->ForgetBlock(bb);
+  }
+  if (PostDominatorAnalysis* postdominators =
+          FindPostDominatorAnalysis(bb->GetParent())) {
+    postdominators->ForgetBlock(bb);
+  }
+}
+
+bool IRContext::CheckDominators() {
+  if (!AreAnalysesValid(kAnalysisDominatorAnalysis)) {
+    return true;
+  }
+
+  // Returns true if |cached| has the same immediate dominators as |current|,
+  // built from the CFG of |function|.
+  auto same_tree = [this](const Function& function,
+                          const DominatorAnalysisBase& cached,
+                          DominatorAnalysisBase* current) {
+    current->InitializeTree(*cfg(), &function);
+    for (const auto& bb : function) {
+      BasicBlock* idom = cached.ImmediateDominator(&bb);
+      if (cached.IsReachable(&bb) != current->IsReachable(&bb) ||
+          idom != current->ImmediateDominator(&bb) ||
+          (idom && !cached.StrictlyDominates(idom, &bb))) {
+        std::cerr << (current->IsPostDominator() ? "Postdominator"
+                                                 : "Dominator")
+                  << " tree of function " << function.result_id()
+                  << " is different at block " << bb.id() << std::endl;
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (const Function& function : *module()) {
+    auto dom_iter = dominator_trees_.find(&function);
+    if (dom_iter != dominator_trees_.end()) {
+      DominatorAnalysis current;
+      if (!same_tree(function, dom_iter->second, &current)) return false;
+    }
+    auto post_dom_iter = post_dominator_trees_.find(&function);
+    if (post_dom_iter != post_dominator_trees_.end()) {
+      PostDominatorAnalysis current;
+      if (!same_tree(function, post_dom_iter->second, &current)) return false;
+    }
+  }
+  return true;
+}
 }  // namespace opt
 }  // namespace spvtools
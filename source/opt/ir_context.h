@@ -16,10 +16,13 @@
 #define SOURCE_OPT_IR_CONTEXT_H_
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
@@ -42,6 +45,7 @@
 #include "source/opt/struct_cfg_analysis.h"
 #include "source/opt/type_manager.h"
 #include "source/opt/value_number_table.h"
+#include "source/util/arena.h"
 #include "source/util/make_unique.h"
 
 namespace spvtools {
@@ -104,7 +108,12 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1),
+        analysis_build_log_(nullptr),
+        functions_to_process_(nullptr),
+        journal_enabled_(false),
+        journal_dropped_(kAnalysisNone) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
   }
@@ -121,7 +130,12 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1),
+        analysis_build_log_(nullptr),
+        functions_to_process_(nullptr),
+        journal_enabled_(false),
+        journal_dropped_(kAnalysisNone) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
     InitializeCombinators();
@@ -131,6 +145,18 @@ class IRContext {
 
   Module* module() const { return module_.get(); }
 
+  // Makes the IR loader allocate instructions and basic blocks from an arena
+  // owned by this context, instead of allocating each one on the heap.  Must be
+  // called before the module is loaded.  Objects allocated from the arena must
+  // not outlive this context.
+  void EnableArena() {
+    if (!arena_) arena_ = MakeUnique<utils::Arena>();
+  }
+
+  // Returns the arena for this context, or nullptr if it is not enabled.  Its
+  // counters can be used to measure the memory used by the module.
+  utils::Arena* arena() const { return arena_.get(); }
+
   // Returns a vector of pointers to constant-creation instructions in this
   // context.
   inline std::vector<Instruction*> GetConstants();
@@ -242,6 +268,7 @@ class IRContext {
     if (!AreAnalysesValid(kAnalysisDefUse)) {
       BuildDefUseManager();
     }
+    if (!journal_.empty()) CatchUpWithChangeJournal();
     return def_use_mgr_.get();
   }
 
@@ -278,6 +305,7 @@ class IRContext {
     if (!AreAnalysesValid(kAnalysisInstrToBlockMapping)) {
       BuildInstrToBlockMapping();
     }
+    if (!journal_.empty()) CatchUpWithChangeJournal();
     auto entry = instr_to_block_.find(instr);
     return (entry != instr_to_block_.end()) ? entry->second : nullptr;
   }
@@ -305,6 +333,7 @@ class IRContext {
     if (!AreAnalysesValid(kAnalysisDecorations)) {
       BuildDecorationManager();
     }
+    if (!journal_.empty()) CatchUpWithChangeJournal();
     return decoration_mgr_.get();
   }
 
@@ -452,7 +481,8 @@ class IRContext {
   // Change operands of debug instruction to DebugInfoNone.
   void KillOperandFromDebugInstructions(Instruction* inst);
 
-  // Returns the next unique id for use by an instruction.
+  // Returns the next unique id for use by an instruction.  This may be called
+  // concurrently from the worker threads of a parallel pass.
   inline uint32_t TakeNextUniqueId() {
     assert(unique_id_ != std::numeric_limits<uint32_t>::max());
 
@@ -474,7 +504,10 @@ class IRContext {
     } else {
       uint32_t set = inst->GetSingleWordInOperand(kExtInstSetIdInIndx);
       uint32_t op = inst->GetSingleWordInOperand(kExtInstInstructionInIndx);
-      return combinator_ops_[set].count(op) != 0;
+      // Use find rather than operator[] so that the query does not modify the
+      // table; it may be made concurrently by a parallel pass.
+      auto set_ops = combinator_ops_.find(set);
+      return set_ops != combinator_ops_.end() && set_ops->second.count(op) != 0;
     }
   }
 
@@ -495,6 +528,35 @@ class IRContext {
   // Gets the postdominator analysis for function |f|.
   PostDominatorAnalysis* GetPostDominatorAnalysis(const Function* f);
 
+  // Returns the dominator analysis of |f| if it has already been built, and
+  // nullptr otherwise.  A pass that changes the CFG of |f| can use it to update
+  // the analysis, instead of invalidating it.
+  DominatorAnalysis* FindDominatorAnalysis(const Function* f) {
+    if (!AreAnalysesValid(kAnalysisDominatorAnalysis)) return nullptr;
+    auto it = dominator_trees_.find(f);
+    return it == dominator_trees_.end() ? nullptr : &it->second;
+  }
+
+  // Returns the postdominator analysis of |f| if it has already been built,
+  // and nullptr otherwise.
+  PostDominatorAnalysis* FindPostDominatorAnalysis(const Function* f) {
+    if (!AreAnalysesValid(kAnalysisDominatorAnalysis)) return nullptr;
+    auto it = post_dominator_trees_.find(f);
+    return it == post_dominator_trees_.end() ? nullptr : &it->second;
+  }
+
+  // Updates the CFG and the dominator and postdominator trees of the function
+  // of |bb|, if they have been built, after the terminator of |bb| has been
+  // replaced.  |old_successors| are the labels the old terminator branched to.
+  void UpdateCFGForNewTerminator(BasicBlock* bb,
+                                 const std::vector<uint32_t>& old_successors);
+
+  // Removes |bb| from the CFG and from the dominator and postdominator trees
+  // of its function, if they have been built.  |bb| must be unreachable from
+  // the entry of the function, and each block that branches to it must be
+  // removed as well.  Must be called while |bb| still has its terminator.
+  void ForgetBlockInCFG(BasicBlock* bb);
+
   // Remove the dominator tree of |f| from the cache.
   inline void RemoveDominatorAnalysis(const Function* f) {
     dominator_trees_.erase(f);
@@ -506,9 +568,14 @@ class IRContext {
   }
 
   // Return the next available SSA id and increment it.  Returns 0 if the
-  // maximum SSA id has been reached.
+  // maximum SSA id has been reached.  This may be called concurrently from the
+  // worker threads of a parallel pass.
   inline uint32_t TakeNextId() {
-    uint32_t next_id = module()->TakeNextIdBound();
+    uint32_t next_id;
+    {
+      std::lock_guard<std::mutex> lock(id_mutex_);
+      next_id = module()->TakeNextIdBound();
+    }
     if (next_id == 0) {
       if (consumer()) {
         std::string message = "ID overflow. Try running compact-ids.";
@@ -554,6 +621,74 @@ class IRContext {
     preserve_spec_constants_ = should_preserve_spec_constants;
   }
 
+  // Returns the maximum number of threads that passes may use to process
+  // functions in parallel.  A value of 1 means everything runs on the calling
+  // thread.
+  uint32_t num_threads() const { return num_threads_; }
+  void set_num_threads(uint32_t num_threads) {
+    num_threads_ = std::max(num_threads, 1u);
+  }
+
+  // Restricts the functions processed by ProcessCallTreeFromRoots, by
+  // Pass::ProcessEachFunctionInParallel and by the passes that are function
+  // local to those whose ids are in |ids|.  The other functions are skipped.
+  // Every function is processed if |ids| is null, which is the default.
+  // See Pass::IsFunctionLocal.
+  void set_functions_to_process(const std::unordered_set<uint32_t>* ids) {
+    functions_to_process_ = ids;
+  }
+
+  // Returns true if |func| is to be processed.  See
+  // set_functions_to_process().
+  bool ShouldProcessFunction(const Function& func) const {
+    return functions_to_process_ == nullptr ||
+           functions_to_process_->count(func.result_id()) != 0;
+  }
+
+  // Starts recording a journal of the instructions that are inserted into an
+  // instruction list, or whose uses are analyzed again with AnalyzeUses,
+  // AnalyzeDefUse or UpdateDefUse.  The def-use manager, the decoration
+  // manager and the instruction to block mapping catch up with the journal
+  // the next time they are used, instead of the pass keeping them up to date
+  // itself or invalidating them.  See Pass::KeepsChangeJournal for what a
+  // pass has to do for the journal to be complete.
+  void StartChangeJournal() {
+    journal_enabled_ = true;
+    journal_dropped_ = kAnalysisNone;
+  }
+
+  // Brings the analyses up to date with the change journal, and stops
+  // recording it.  Returns those of the three analyses above that are valid
+  // and were kept up to date all along.  An analysis is left out if the
+  // journal was not enough to update it, and it had to be invalidated.
+  Analysis StopChangeJournal();
+
+  // Records |inst| in the change journal, if it is being recorded.
+  void RecordChangedInstruction(Instruction* inst) {
+    if (journal_enabled_ && journal_insts_.insert(inst).second) {
+      journal_.push_back(inst);
+    }
+  }
+
+  // A record of one build of an analysis.  Builds can nest; for example,
+  // building the decoration manager may build the def-use manager.  The
+  // duration of a build includes the builds nested in it.
+  struct AnalysisBuild {
+    Analysis analysis;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration duration;
+  };
+
+  // Appends a record of every analysis built from now on to |builds|.  Stops
+  // recording if |builds| is null.  The dominator, post-dominator and loop
+  // analyses are recorded once for each function they are built for.
+  void set_analysis_build_log(std::vector<AnalysisBuild>* builds) {
+    analysis_build_log_ = builds;
+  }
+
+  // Returns a short name for |analysis|, which must be a single analysis.
+  static const char* GetAnalysisName(Analysis analysis);
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Create variable and return its id otherwise. If builtin not currently
   // supported, return 0.
@@ -601,14 +736,37 @@ class IRContext {
   void EmitErrorMessage(std::string message, Instruction* inst);
 
  private:
+  // Records the build of an analysis in the analysis build log, if there is
+  // one, for as long as it is in scope.
+  class ScopedAnalysisBuild {
+   public:
+    ScopedAnalysisBuild(IRContext* context, Analysis analysis)
+        : log_(context->analysis_build_log_), analysis_(analysis) {
+      if (log_) start_ = std::chrono::steady_clock::now();
+    }
+    ~ScopedAnalysisBuild() {
+      if (log_) {
+        log_->push_back(
+            {analysis_, start_, std::chrono::steady_clock::now() - start_});
+      }
+    }
+
+   private:
+    std::vector<AnalysisBuild>* log_;
+    Analysis analysis_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
   // Builds the def-use manager from scratch, even if it was already valid.
   void BuildDefUseManager() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisDefUse);
     def_use_mgr_ = MakeUnique<analysis::DefUseManager>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisDefUse;
   }
 
   // Builds the instruction-block map for the whole module.
   void BuildInstrToBlockMapping() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisInstrToBlockMapping);
     instr_to_block_.clear();
     for (auto& fn : *module_) {
       for (auto& block : fn) {
@@ -620,8 +778,19 @@ class IRContext {
     valid_analyses_ = valid_analyses_ | kAnalysisInstrToBlockMapping;
   }
 
+  // Updates the def-use manager, the decoration manager and the instruction to
+  // block mapping, those that are valid, with the instructions in the change
+  // journal, and empties it.
+  void CatchUpWithChangeJournal();
+
+  // Maps each instruction in |insts| to the block of its closest neighbour in
+  // its list that is mapped and not in |insts|.  Invalidates the mapping if
+  // an instruction is in a block in which no such neighbour is found.
+  void CatchUpInstrToBlockMapping(const std::vector<Instruction*>& insts);
+
   // Builds the instruction-function map for the whole module.
   void BuildIdToFuncMapping() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisIdToFuncMapping);
     id_to_func_.clear();
     for (auto& fn : *module_) {
       id_to_func_[fn.result_id()] = &fn;
@@ -630,22 +799,26 @@ class IRContext {
   }
 
   void BuildDecorationManager() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisDecorations);
     decoration_mgr_ = MakeUnique<analysis::DecorationManager>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisDecorations;
   }
 
   void BuildCFG() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisCFG);
     cfg_ = MakeUnique<CFG>(module());
     valid_analyses_ = valid_analyses_ | kAnalysisCFG;
   }
 
   void BuildScalarEvolutionAnalysis() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisScalarEvolution);
     scalar_evolution_analysis_ = MakeUnique<ScalarEvolutionAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisScalarEvolution;
   }
 
   // Builds the liveness analysis from scratch, even if it was already valid.
   void BuildRegPressureAnalysis() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisRegisterPressure);
     reg_pressure_ = MakeUnique<LivenessAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisRegisterPressure;
   }
@@ -653,6 +826,7 @@ class IRContext {
   // Builds the value number table analysis from scratch, even if it was already
   // valid.
   void BuildValueNumberTable() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisValueNumberTable);
     vn_table_ = MakeUnique<ValueNumberTable>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisValueNumberTable;
   }
@@ -660,6 +834,7 @@ class IRContext {
   // Builds the structured CFG analysis from scratch, even if it was already
   // valid.
   void BuildStructuredCFGAnalysis() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisStructuredCFG);
     struct_cfg_analysis_ = MakeUnique<StructuredCFGAnalysis>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisStructuredCFG;
   }
@@ -667,6 +842,7 @@ class IRContext {
   // Builds the constant manager from scratch, even if it was already
   // valid.
   void BuildConstantManager() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisConstants);
     constant_mgr_ = MakeUnique<analysis::ConstantManager>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisConstants;
   }
@@ -674,6 +850,7 @@ class IRContext {
   // Builds the type manager from scratch, even if it was already
   // valid.
   void BuildTypeManager() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisTypes);
     type_mgr_ = MakeUnique<analysis::TypeManager>(consumer(), this);
     valid_analyses_ = valid_analyses_ | kAnalysisTypes;
   }
@@ -681,6 +858,7 @@ class IRContext {
   // Builds the debug information manager from scratch, even if it was
   // already valid.
   void BuildDebugInfoManager() {
+    ScopedAnalysisBuild scoped_build(this, kAnalysisDebugInfo);
     debug_info_mgr_ = MakeUnique<analysis::DebugInfoManager>(this);
     valid_analyses_ = valid_analyses_ | kAnalysisDebugInfo;
   }
@@ -731,6 +909,11 @@ class IRContext {
   // true if the cfg is invalidated.
   bool CheckCFG();
 
+  // Returns false if a dominator or postdominator tree that has been built
+  // does not match the CFG.  Returns true if the dominator analysis is
+  // invalid.
+  bool CheckDominators();
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Return 0 otherwise.
   uint32_t FindBuiltinInputVar(uint32_t builtin);
@@ -750,7 +933,14 @@ class IRContext {
   //
   // This member is initialized to 0, but always issues this value plus one.
   // Therefore, 0 is not a valid unique id for an instruction.
-  uint32_t unique_id_;
+  std::atomic<uint32_t> unique_id_;
+
+  // Serializes the allocation of result ids in |TakeNextId|.
+  std::mutex id_mutex_;
+
+  // The arena that the IR loader allocates from, if enabled.  It is declared
+  // before |module_| so that it is destroyed after the module.
+  std::unique_ptr<utils::Arena> arena_;
 
   // The module being processed within this IR context.
   std::unique_ptr<Module> module_;
@@ -834,6 +1024,27 @@ class IRContext {
   // Whether all specialization constants within |module_|
   // should be preserved.
   bool preserve_spec_constants_;
+
+  // The maximum number of threads passes may use to process functions.
+  uint32_t num_threads_;
+
+  // Where analysis builds are recorded, or nullptr if they are not.
+  std::vector<AnalysisBuild>* analysis_build_log_;
+
+  // The ids of the functions to process, or nullptr to process all of them.
+  const std::unordered_set<uint32_t>* functions_to_process_;
+
+  // Whether the change journal is being recorded.
+  bool journal_enabled_;
+
+  // The instructions changed since the analyses last caught up, in the order
+  // they were first recorded, and the set of them.  An instruction that is
+  // killed is removed from the set only.
+  std::vector<Instruction*> journal_;
+  std::unordered_set<Instruction*> journal_insts_;
+
+  // The analyses the journal could not update since it was started.
+  Analysis journal_dropped_;
 };
 
 inline IRContext::Analysis operator|(IRContext::Analysis lhs,
@@ -1116,18 +1327,21 @@ void IRContext::AddFunction(std::unique_ptr<Function>&& f) {
 }
 
 void IRContext::AnalyzeDefUse(Instruction* inst) {
+  RecordChangedInstruction(inst);
   if (AreAnalysesValid(kAnalysisDefUse)) {
     get_def_use_mgr()->AnalyzeInstDefUse(inst);
   }
 }
 
 void IRContext::UpdateDefUse(Instruction* inst) {
+  RecordChangedInstruction(inst);
   if (AreAnalysesValid(kAnalysisDefUse)) {
     get_def_use_mgr()->UpdateDefUse(inst);
   }
 }
 
 void IRContext::BuildIdToNameMap() {
+  ScopedAnalysisBuild scoped_build(this, kAnalysisNameMap);
   id_to_name_ = MakeUnique<std::multimap<uint32_t, Instruction*>>();
   for (Instruction& debug_inst : debugs2()) {
     if (debug_inst.opcode() == SpvOpMemberName ||
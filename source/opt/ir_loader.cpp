@@ -19,6 +19,7 @@
 #include "DebugInfo.h"
 #include "OpenCLDebugInfo100.h"
 #include "source/ext_inst.h"
+#include "source/opt/ir_context.h"
 #include "source/opt/log.h"
 #include "source/opt/reflect.h"
 #include "source/util/make_unique.h"
@@ -88,8 +89,10 @@ bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
     }
   }
 
-  std::unique_ptr<Instruction> spv_inst(
-      new Instruction(module()->context(), *inst, std::move(dbg_line_info_)));
+  // Instructions and blocks come from the context's arena when it has one.
+  utils::Arena* arena = module()->context()->arena();
+  std::unique_ptr<Instruction> spv_inst(new (arena) Instruction(
+      module()->context(), *inst, std::move(dbg_line_info_)));
   dbg_line_info_.clear();
 
   const char* src = source_.c_str();
@@ -125,7 +128,8 @@ bool IrLoader::AddInstruction(const spv_parsed_instruction_t* inst) {
       Error(consumer_, src, loc, "OpLabel inside basic block");
       return false;
     }
-    block_ = MakeUnique<BasicBlock>(std::move(spv_inst));
+    block_ =
+        std::unique_ptr<BasicBlock>(new (arena) BasicBlock(std::move(spv_inst)));
   } else if (IsTerminatorInst(opcode)) {
     if (function_ == nullptr) {
       Error(consumer_, src, loc, "terminator instruction outside function");
@@ -28,7 +28,7 @@ Pass::Status LocalRedundancyEliminationPass::Process() {
       // Keeps track of all ids that contain a given value number. We keep
       // track of multiple values because they could have the same value, but
       // different decorations.
-      std::map<uint32_t, uint32_t> value_to_ids;
+      std::unordered_map<uint32_t, uint32_t> value_to_ids;
       if (EliminateRedundanciesInBB(&bb, vnTable, &value_to_ids))
         modified = true;
     }
@@ -38,10 +38,12 @@ Pass::Status LocalRedundancyEliminationPass::Process() {
 
 bool LocalRedundancyEliminationPass::EliminateRedundanciesInBB(
     BasicBlock* block, const ValueNumberTable& vnTable,
-    std::map<uint32_t, uint32_t>* value_to_ids) {
+    std::unordered_map<uint32_t, uint32_t>* value_to_ids,
+    std::vector<uint32_t>* added_values) {
   bool modified = false;
 
-  auto func = [this, &vnTable, &modified, value_to_ids](Instruction* inst) {
+  auto func = [this, &vnTable, &modified, value_to_ids,
+               added_values](Instruction* inst) {
     if (inst->result_id() == 0) {
       return;
     }
@@ -58,6 +60,8 @@ bool LocalRedundancyEliminationPass::EliminateRedundanciesInBB(
       context()->ReplaceAllUsesWith(inst->result_id(), candidate.first->second);
       context()->KillInst(inst);
       modified = true;
+    } else if (added_values) {
+      added_values->push_back(value);
     }
   };
   block->ForEachInst(func);
@@ -15,7 +15,8 @@
 #ifndef SOURCE_OPT_LOCAL_REDUNDANCY_ELIMINATION_H_
 #define SOURCE_OPT_LOCAL_REDUNDANCY_ELIMINATION_H_
 
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "source/opt/ir_context.h"
 #include "source/opt/pass.h"
@@ -54,12 +55,15 @@ class LocalRedundancyEliminationPass : public Pass {
   //
   // |value_to_ids| is a map from value number to ids.  If {vn, id} is in
   // |value_to_ids| then vn is the value number of id, and the definition of id
-  // dominates |bb|.
+  // dominates |bb|.  The values computed in |block| are added to it.  If
+  // |added_values| is not null, the value numbers that are added are also
+  // appended to |added_values|.
   //
   // Returns true if the module is changed.
-  bool EliminateRedundanciesInBB(BasicBlock* block,
-                                 const ValueNumberTable& vnTable,
-                                 std::map<uint32_t, uint32_t>* value_to_ids);
+  bool EliminateRedundanciesInBB(
+      BasicBlock* block, const ValueNumberTable& vnTable,
+      std::unordered_map<uint32_t, uint32_t>* value_to_ids,
+      std::vector<uint32_t>* added_values = nullptr);
 };
 
 }  // namespace opt
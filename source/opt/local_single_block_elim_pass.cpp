@@ -16,6 +16,9 @@
 
 #include "source/opt/local_single_block_elim_pass.h"
 
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "source/opt/iterator.h"
@@ -53,26 +56,44 @@ bool LocalSingleBlockLoadStoreElimPass::HasOnlySupportedRefs(uint32_t ptrId) {
   return false;
 }
 
-bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
-    Function* func) {
+void LocalSingleBlockLoadStoreElimPass::FindSupportedVariables() {
+  for (auto& func : *get_module()) {
+    if (func.begin() == func.end()) continue;
+    for (auto& inst : *func.begin()) {
+      if (inst.opcode() != SpvOpVariable) continue;
+      const uint32_t varId = inst.result_id();
+      if (IsTargetVar(varId) && HasOnlySupportedRefs(varId)) {
+        supported_vars_.insert(varId);
+      }
+    }
+  }
+}
+
+void LocalSingleBlockLoadStoreElimPass::FindEliminations(
+    Function* func, Eliminations* eliminations) {
   // Perform local store/load, load/load and store/store elimination
-  // on each block
-  bool modified = false;
-  std::vector<Instruction*> instructions_to_kill;
+  // on each block.  The loads are only replaced once all of them are found,
+  // so the value of a store is looked up in |replacements| in case it is a
+  // load that is replaced.
+  std::unordered_map<uint32_t, Instruction*> var2store;
+  std::unordered_map<uint32_t, Instruction*> var2load;
+  std::unordered_map<uint32_t, uint32_t> replacements;
   std::unordered_set<Instruction*> instructions_to_save;
+  auto stored_value = [&replacements](const Instruction* store) {
+    const uint32_t valId = store->GetSingleWordInOperand(kStoreValIdInIdx);
+    auto ri = replacements.find(valId);
+    return ri != replacements.end() ? ri->second : valId;
+  };
   for (auto bi = func->begin(); bi != func->end(); ++bi) {
-    var2store_.clear();
-    var2load_.clear();
-    auto next = bi->begin();
-    for (auto ii = next; ii != bi->end(); ii = next) {
-      ++next;
+    var2store.clear();
+    var2load.clear();
+    for (auto ii = bi->begin(); ii != bi->end(); ++ii) {
       switch (ii->opcode()) {
         case SpvOpStore: {
           // Verify store variable is target type
           uint32_t varId;
           Instruction* ptrInst = GetPtr(&*ii, &varId);
-          if (!IsTargetVar(varId)) continue;
-          if (!HasOnlySupportedRefs(varId)) continue;
+          if (supported_vars_.count(varId) == 0) continue;
           // If a store to the whole variable, remember it for succeeding
           // loads and stores. Otherwise forget any previous store to that
           // variable.
@@ -80,19 +101,17 @@ bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
             // If a previous store to same variable, mark the store
             // for deletion if not still used. Don't delete store
             // if debugging; let ssa-rewrite and DCE handle it
-            auto prev_store = var2store_.find(varId);
-            if (prev_store != var2store_.end() &&
+            auto prev_store = var2store.find(varId);
+            if (prev_store != var2store.end() &&
                 instructions_to_save.count(prev_store->second) == 0 &&
                 !context()->get_debug_info_mgr()->IsDebugDeclared(varId)) {
-              instructions_to_kill.push_back(prev_store->second);
-              modified = true;
+              eliminations->instructions_to_kill.push_back(prev_store->second);
             }
 
             bool kill_store = false;
-            auto li = var2load_.find(varId);
-            if (li != var2load_.end()) {
-              if (ii->GetSingleWordInOperand(kStoreValIdInIdx) ==
-                  li->second->result_id()) {
+            auto li = var2load.find(varId);
+            if (li != var2load.end()) {
+              if (stored_value(&*ii) == li->second->result_id()) {
                 // We are storing the same value that already exists in the
                 // memory location.  The store does nothing.
                 kill_store = true;
@@ -100,71 +119,77 @@ bool LocalSingleBlockLoadStoreElimPass::LocalSingleBlockLoadStoreElim(
             }
 
             if (!kill_store) {
-              var2store_[varId] = &*ii;
-              var2load_.erase(varId);
+              var2store[varId] = &*ii;
+              var2load.erase(varId);
             } else {
-              instructions_to_kill.push_back(&*ii);
-              modified = true;
+              eliminations->instructions_to_kill.push_back(&*ii);
             }
           } else {
             assert(IsNonPtrAccessChain(ptrInst->opcode()));
-            var2store_.erase(varId);
-            var2load_.erase(varId);
+            var2store.erase(varId);
+            var2load.erase(varId);
           }
         } break;
         case SpvOpLoad: {
           // Verify store variable is target type
           uint32_t varId;
           Instruction* ptrInst = GetPtr(&*ii, &varId);
-          if (!IsTargetVar(varId)) continue;
-          if (!HasOnlySupportedRefs(varId)) continue;
+          if (supported_vars_.count(varId) == 0) continue;
           uint32_t replId = 0;
           if (ptrInst->opcode() == SpvOpVariable) {
             // If a load from a variable, look for a previous store or
             // load from that variable and use its value.
-            auto si = var2store_.find(varId);
-            if (si != var2store_.end()) {
-              replId = si->second->GetSingleWordInOperand(kStoreValIdInIdx);
+            auto si = var2store.find(varId);
+            if (si != var2store.end()) {
+              replId = stored_value(si->second);
             } else {
-              auto li = var2load_.find(varId);
-              if (li != var2load_.end()) {
+              auto li = var2load.find(varId);
+              if (li != var2load.end()) {
                 replId = li->second->result_id();
               }
             }
           } else {
             // If a partial load of a previously seen store, remember
             // not to delete the store.
-            auto si = var2store_.find(varId);
-            if (si != var2store_.end()) instructions_to_save.insert(si->second);
+            auto si = var2store.find(varId);
+            if (si != var2store.end()) instructions_to_save.insert(si->second);
           }
           if (replId != 0) {
             // replace load's result id and delete load
-            context()->KillNamesAndDecorates(&*ii);
-            context()->ReplaceAllUsesWith(ii->result_id(), replId);
-            instructions_to_kill.push_back(&*ii);
-            modified = true;
+            replacements[ii->result_id()] = replId;
+            eliminations->replaced_loads.emplace_back(&*ii, replId);
+            eliminations->instructions_to_kill.push_back(&*ii);
           } else {
             if (ptrInst->opcode() == SpvOpVariable)
-              var2load_[varId] = &*ii;  // register load
+              var2load[varId] = &*ii;  // register load
           }
         } break;
         case SpvOpFunctionCall: {
           // Conservatively assume all locals are redefined for now.
           // TODO(): Handle more optimally
-          var2store_.clear();
-          var2load_.clear();
+          var2store.clear();
+          var2load.clear();
         } break;
         default:
           break;
       }
     }
   }
+}
+
+bool LocalSingleBlockLoadStoreElimPass::ApplyEliminations(
+    const Eliminations& eliminations) {
+  for (const auto& replaced_load : eliminations.replaced_loads) {
+    context()->KillNamesAndDecorates(replaced_load.first);
+    context()->ReplaceAllUsesWith(replaced_load.first->result_id(),
+                                  replaced_load.second);
+  }
 
-  for (Instruction* inst : instructions_to_kill) {
+  for (Instruction* inst : eliminations.instructions_to_kill) {
     context()->KillInst(inst);
   }
 
-  return modified;
+  return !eliminations.instructions_to_kill.empty();
 }
 
 void LocalSingleBlockLoadStoreElimPass::Initialize() {
@@ -174,6 +199,7 @@ void LocalSingleBlockLoadStoreElimPass::Initialize() {
 
   // Clear collections
   supported_ref_ptrs_.clear();
+  supported_vars_.clear();
 
   // Initialize extensions allowlist
   InitExtensions();
@@ -203,9 +229,24 @@ Pass::Status LocalSingleBlockLoadStoreElimPass::ProcessImpl() {
   // If any extensions in the module are not explicitly supported,
   // return unmodified.
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
+  // Finding the loads and stores to eliminate only reads the module, so it is
+  // done for all functions in parallel.  Eliminating them updates the def-use
+  // manager, so it is done one function at a time afterwards.
+  FindSupportedVariables();
+  std::unordered_map<const Function*, Eliminations> eliminations;
+  for (auto& func : *get_module()) {
+    eliminations[&func];
+  }
+  ProcessEachFunctionInParallel(
+      [this, &eliminations](Function* function, uint32_t) {
+        FindEliminations(function, &eliminations.at(function));
+        return false;
+      },
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisDebugInfo);
+
   // Process all entry point functions
-  ProcessFunction pfn = [this](Function* fp) {
-    return LocalSingleBlockLoadStoreElim(fp);
+  ProcessFunction pfn = [this, &eliminations](Function* fp) {
+    return ApplyEliminations(eliminations.at(fp));
   };
 
   bool modified = context()->ProcessEntryPointCallTree(pfn);
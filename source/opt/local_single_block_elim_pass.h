@@ -24,6 +24,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "source/opt/basic_block.h"
 #include "source/opt/def_use_manager.h"
@@ -40,6 +41,7 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
 
   const char* name() const override { return "eliminate-local-single-block"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
@@ -55,13 +57,30 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   // implementation?
   bool HasOnlySupportedRefs(uint32_t varId);
 
-  // On all entry point functions, within each basic block, eliminate
-  // loads and stores to function variables where possible. For
-  // loads, if previous load or store to same variable, replace
-  // load id with previous id and delete load. Finally, check if
-  // remaining stores are useless, and delete store and variable
-  // where possible. Assumes logical addressing.
-  bool LocalSingleBlockLoadStoreElim(Function* func);
+  // The loads and stores of a function that can be eliminated.
+  struct Eliminations {
+    // The loads to replace, each with the id that replaces it.
+    std::vector<std::pair<Instruction*, uint32_t>> replaced_loads;
+
+    // The loads and stores to delete.
+    std::vector<Instruction*> instructions_to_kill;
+  };
+
+  // Records in |supported_vars_| the function scope variables of target type
+  // that are only referenced by supported operations.
+  void FindSupportedVariables();
+
+  // Within each basic block of |func|, finds the loads and stores to function
+  // variables that can be eliminated, and records them in |eliminations|. For
+  // loads, if previous load or store to same variable, the load is replaced by
+  // the previous id. Stores that are overwritten in the same block, or that
+  // store the value just loaded, are deleted. Only reads the module, so it can
+  // be called for several functions at once. Assumes logical addressing.
+  void FindEliminations(Function* func, Eliminations* eliminations);
+
+  // Replaces and deletes the loads and stores in |eliminations|. Returns true
+  // if anything was eliminated.
+  bool ApplyEliminations(const Eliminations& eliminations);
 
   // Initialize extensions allowlist
   void InitExtensions();
@@ -72,20 +91,6 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   void Initialize();
   Pass::Status ProcessImpl();
 
-  // Map from function scope variable to a store of that variable in the
-  // current block whose value is currently valid. This map is cleared
-  // at the start of each block and incrementally updated as the block
-  // is scanned. The stores are candidates for elimination. The map is
-  // conservatively cleared when a function call is encountered.
-  std::unordered_map<uint32_t, Instruction*> var2store_;
-
-  // Map from function scope variable to a load of that variable in the
-  // current block whose value is currently valid. This map is cleared
-  // at the start of each block and incrementally updated as the block
-  // is scanned. The stores are candidates for elimination. The map is
-  // conservatively cleared when a function call is encountered.
-  std::unordered_map<uint32_t, Instruction*> var2load_;
-
   // Set of variables whose most recent store in the current block cannot be
   // deleted, for example, if there is a load of the variable which is
   // dependent on the store and is not replaced and deleted by this pass,
@@ -99,6 +104,11 @@ class LocalSingleBlockLoadStoreElimPass : public MemPass {
   // Variables that are only referenced by supported operations for this
   // pass ie. loads and stores.
   std::unordered_set<uint32_t> supported_ref_ptrs_;
+
+  // Function scope variables of target type that are only referenced by
+  // supported operations.  Built before the functions are processed, so that
+  // they can be processed in parallel.
+  std::unordered_set<uint32_t> supported_vars_;
 };
 
 }  // namespace opt
@@ -43,6 +43,7 @@ class LocalSingleStoreElimPass : public Pass {
 
   const char* name() const override { return "eliminate-local-single-store"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
@@ -461,9 +461,17 @@ bool MemPass::RemoveUnreachableBlocks(Function* func) {
     });
   }
 
-  // Erase unreachable blocks.
+  // Erase unreachable blocks.  Everything that branches to them is erased as
+  // well, so the CFG and the dominator trees, if they have been built, only
+  // need to forget them.
+  DominatorAnalysis* dominators = context()->FindDominatorAnalysis(func);
+  PostDominatorAnalysis* postdominators =
+      context()->FindPostDominatorAnalysis(func);
   for (auto ebi = func->begin(); ebi != func->end();) {
     if (reachable_blocks.count(&*ebi) == 0) {
+      cfg()->ForgetBlock(&*ebi);
+      if (dominators) dominators->ForgetBlock(&*ebi);
+      if (postdominators) postdominators->ForgetBlock(&*ebi);
       RemoveBlock(&ebi);
       modified = true;
     } else {
@@ -0,0 +1,352 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/optimization_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <utility>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// The two halves of the key are 64-bit FNV-1a hashes of the same bytes,
+// started from different offset bases.
+const uint64_t kFnvPrime = 0x100000001b3ull;
+const uint64_t kLowOffsetBasis = 0xcbf29ce484222325ull;
+const uint64_t kHighOffsetBasis = 0x84222325cbf29ce4ull;
+
+// Mixes the bits of |h| so that every bit of the digest depends on every
+// byte of the input.
+uint64_t Finalize(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+// The first word of a cached module file.
+const uint32_t kEntryMagic = 0x4f505343;  // "CSPO"
+
+// The words of a cached module file are in little-endian byte order, like the
+// words added to the keys, so that a cache directory can be shared between
+// machines of either byte order.
+
+// Writes the |num_words| words at |words| to |out|.
+void WriteWords(const uint32_t* words, size_t num_words, std::ostream* out) {
+  std::vector<unsigned char> bytes(num_words * sizeof(uint32_t));
+  for (size_t i = 0; i < num_words; ++i) {
+    bytes[4 * i] = static_cast<unsigned char>(words[i]);
+    bytes[4 * i + 1] = static_cast<unsigned char>(words[i] >> 8);
+    bytes[4 * i + 2] = static_cast<unsigned char>(words[i] >> 16);
+    bytes[4 * i + 3] = static_cast<unsigned char>(words[i] >> 24);
+  }
+  out->write(reinterpret_cast<const char*>(bytes.data()),
+             static_cast<std::streamsize>(bytes.size()));
+}
+
+// Reads |words->size()| words from |in| into |words|.  Returns false if |in|
+// ends first.
+bool ReadWords(std::istream* in, std::vector<uint32_t>* words) {
+  std::vector<unsigned char> bytes(words->size() * sizeof(uint32_t));
+  if (!in->read(reinterpret_cast<char*>(bytes.data()),
+                static_cast<std::streamsize>(bytes.size()))) {
+    return false;
+  }
+  for (size_t i = 0; i < words->size(); ++i) {
+    (*words)[i] = static_cast<uint32_t>(bytes[4 * i]) |
+                  static_cast<uint32_t>(bytes[4 * i + 1]) << 8 |
+                  static_cast<uint32_t>(bytes[4 * i + 2]) << 16 |
+                  static_cast<uint32_t>(bytes[4 * i + 3]) << 24;
+  }
+  return true;
+}
+
+const char kIndexFileName[] = "index";
+
+// The number of hits recorded in memory before they are written to the index.
+const size_t kMaxPendingUses = 64;
+
+}  // namespace
+
+OptimizationCacheKey::OptimizationCacheKey()
+    : low_(kLowOffsetBasis), high_(kHighOffsetBasis) {}
+
+void OptimizationCacheKey::Add(const void* data, size_t size) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    low_ = (low_ ^ bytes[i]) * kFnvPrime;
+    high_ = (high_ ^ bytes[i]) * kFnvPrime;
+  }
+}
+
+void OptimizationCacheKey::Add(uint32_t value) {
+  const unsigned char bytes[4] = {static_cast<unsigned char>(value),
+                                  static_cast<unsigned char>(value >> 8),
+                                  static_cast<unsigned char>(value >> 16),
+                                  static_cast<unsigned char>(value >> 24)};
+  Add(bytes, sizeof(bytes));
+}
+
+void OptimizationCacheKey::Add(uint64_t value) {
+  Add(static_cast<uint32_t>(value));
+  Add(static_cast<uint32_t>(value >> 32));
+}
+
+void OptimizationCacheKey::Add(const std::string& str) {
+  Add(static_cast<uint64_t>(str.size()));
+  Add(str.data(), str.size());
+}
+
+void OptimizationCacheKey::AddWords(const uint32_t* binary,
+                                    size_t num_words) {
+  Add(static_cast<uint64_t>(num_words));
+  for (size_t i = 0; i < num_words; ++i) {
+    Add(binary[i]);
+  }
+}
+
+std::string OptimizationCacheKey::Digest() const {
+  char digest[33];
+  snprintf(digest, sizeof(digest), "%016llx%016llx",
+           static_cast<unsigned long long>(Finalize(high_)),
+           static_cast<unsigned long long>(Finalize(low_)));
+  return digest;
+}
+
+std::shared_ptr<DirectoryOptimizationCache> DirectoryOptimizationCache::Get(
+    const std::string& directory, uint64_t max_size) {
+  static std::mutex caches_mutex;
+  static std::unordered_map<std::string,
+                            std::weak_ptr<DirectoryOptimizationCache>>
+      caches;
+
+  std::lock_guard<std::mutex> lock(caches_mutex);
+  std::shared_ptr<DirectoryOptimizationCache> cache = caches[directory].lock();
+  if (cache) {
+    cache->set_max_size(max_size);
+  } else {
+    cache = std::make_shared<DirectoryOptimizationCache>(directory, max_size);
+    caches[directory] = cache;
+  }
+  return cache;
+}
+
+DirectoryOptimizationCache::DirectoryOptimizationCache(
+    const std::string& directory, uint64_t max_size)
+    : directory_(directory), mutex_(), max_size_(max_size) {}
+
+DirectoryOptimizationCache::~DirectoryOptimizationCache() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!pending_uses_.empty()) {
+    ReadIndex();
+    Evict();
+    WriteIndex();
+  }
+}
+
+std::string DirectoryOptimizationCache::EntryPath(
+    const std::string& key) const {
+  return directory_ + "/" + key + ".spv";
+}
+
+bool DirectoryOptimizationCache::Lookup(const std::string& key,
+                                        std::vector<uint32_t>* binary) {
+  std::ifstream file(EntryPath(key), std::ios::binary | std::ios::ate);
+  if (!file) {
+    // A module whose file is gone stays in the index until it is evicted.
+    return false;
+  }
+
+  // The size in the header is only trusted if it matches the file.
+  const std::streamoff file_size = file.tellg();
+  file.seekg(0);
+  std::vector<uint32_t> header(2);
+  std::vector<uint32_t> words;
+  bool found = ReadWords(&file, &header) && header[0] == kEntryMagic &&
+               static_cast<uint64_t>(file_size) ==
+                   (header.size() + uint64_t{header[1]}) * sizeof(uint32_t);
+  if (found) {
+    words.resize(header[1]);
+    found = ReadWords(&file, &words);
+  }
+  file.close();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!found) {
+    // Drop the entry if its file is damaged, so that its size no longer
+    // counts against the bound.
+    pending_uses_.erase(
+        std::remove_if(pending_uses_.begin(), pending_uses_.end(),
+                       [&key](const Entry& use) { return use.key == key; }),
+        pending_uses_.end());
+    ReadIndex();
+    Forget(key);
+    std::remove(EntryPath(key).c_str());
+    WriteIndex();
+    return false;
+  }
+
+  // A module that is missing from the index, because of a concurrent update
+  // from another process, is added back to it when the use is written.
+  pending_uses_.push_back(
+      {key, (header.size() + words.size()) * sizeof(uint32_t)});
+  if (pending_uses_.size() >= kMaxPendingUses) {
+    ReadIndex();
+    Evict();
+    WriteIndex();
+  }
+  *binary = std::move(words);
+  return true;
+}
+
+void DirectoryOptimizationCache::Store(const std::string& key,
+                                       const std::vector<uint32_t>& binary) {
+  // Write the module to a file of its own first, so that a reader never sees
+  // a partially written module.
+  std::random_device random;
+  const std::string path = EntryPath(key);
+  const std::string temp_path = path + ".tmp" + std::to_string(random());
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    const uint32_t header[2] = {kEntryMagic,
+                                static_cast<uint32_t>(binary.size())};
+    WriteWords(header, 2, &file);
+    WriteWords(binary.data(), binary.size(), &file);
+    if (!file) {
+      file.close();
+      std::remove(temp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    // Renaming over an existing file fails on some systems.
+    std::remove(path.c_str());
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      std::remove(temp_path.c_str());
+      return;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReadIndex();
+  Touch(key, 2 * sizeof(uint32_t) + binary.size() * sizeof(uint32_t));
+  Evict();
+  WriteIndex();
+}
+
+void DirectoryOptimizationCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReadIndex();
+  for (const Entry& entry : entries_) {
+    std::remove(EntryPath(entry.key).c_str());
+  }
+  entries_.clear();
+  entry_map_.clear();
+  total_size_ = 0;
+  WriteIndex();
+}
+
+size_t DirectoryOptimizationCache::num_entries() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReadIndex();
+  return entries_.size();
+}
+
+uint64_t DirectoryOptimizationCache::size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ReadIndex();
+  return total_size_;
+}
+
+void DirectoryOptimizationCache::set_max_size(uint64_t max_size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  max_size_ = max_size;
+}
+
+void DirectoryOptimizationCache::ReadIndex() {
+  entries_.clear();
+  entry_map_.clear();
+  total_size_ = 0;
+
+  // Each line of the index holds the key and the size of a module, from the
+  // least to the most recently used.
+  std::ifstream index(directory_ + "/" + kIndexFileName);
+  std::string key;
+  uint64_t size = 0;
+  while (index >> key >> size) {
+    Touch(key, size);
+  }
+
+  for (const Entry& use : pending_uses_) {
+    Touch(use.key, use.size);
+  }
+}
+
+void DirectoryOptimizationCache::WriteIndex() {
+  pending_uses_.clear();
+
+  std::random_device random;
+  const std::string path = directory_ + "/" + kIndexFileName;
+  const std::string temp_path = path + ".tmp" + std::to_string(random());
+  {
+    std::ofstream index(temp_path, std::ios::trunc);
+    for (const Entry& entry : entries_) {
+      index << entry.key << " " << entry.size << "\n";
+    }
+    if (!index) {
+      index.close();
+      std::remove(temp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    std::remove(path.c_str());
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      std::remove(temp_path.c_str());
+    }
+  }
+}
+
+void DirectoryOptimizationCache::Touch(const std::string& key, uint64_t size) {
+  Forget(key);
+  entries_.push_back({key, size});
+  entry_map_[key] = std::prev(entries_.end());
+  total_size_ += size;
+}
+
+void DirectoryOptimizationCache::Forget(const std::string& key) {
+  auto it = entry_map_.find(key);
+  if (it == entry_map_.end()) return;
+  total_size_ -= it->second->size;
+  entries_.erase(it->second);
+  entry_map_.erase(it);
+}
+
+void DirectoryOptimizationCache::Evict() {
+  while (total_size_ > max_size_ && !entries_.empty()) {
+    const std::string key = entries_.front().key;
+    Forget(key);
+    std::remove(EntryPath(key).c_str());
+  }
+}
+
+}  // namespace opt
+}  // namespace spvtools
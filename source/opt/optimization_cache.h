@@ -0,0 +1,166 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_OPTIMIZATION_CACHE_H_
+#define SOURCE_OPT_OPTIMIZATION_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spvtools {
+namespace opt {
+
+// Computes the key under which the result of an optimization run is cached.
+// Everything that determines the result is added to the key: the input
+// module, the target environment, the options and the passes to run.  The
+// key is a 128-bit digest of those, written as 32 hexadecimal digits.  The
+// digest does not depend on the byte order of the host, so keys can be shared
+// between machines.
+class OptimizationCacheKey {
+ public:
+  OptimizationCacheKey();
+
+  // Adds |size| bytes from |data| to the key.
+  void Add(const void* data, size_t size);
+
+  // Adds |value| to the key, in little-endian byte order.
+  void Add(uint32_t value);
+  void Add(uint64_t value);
+
+  // Adds |str| to the key, preceded by its length so that the concatenation
+  // of several strings is not ambiguous.
+  void Add(const std::string& str);
+
+  // Adds the words of |binary|, preceded by their number.
+  void AddWords(const uint32_t* binary, size_t num_words);
+
+  // Returns the key for everything added so far.
+  std::string Digest() const;
+
+ private:
+  uint64_t low_;
+  uint64_t high_;
+};
+
+// A store of optimized modules, indexed by the keys computed by
+// OptimizationCacheKey.  Implementations must be safe to use from several
+// threads at once.
+class OptimizationCache {
+ public:
+  virtual ~OptimizationCache() = default;
+
+  // Looks up |key|.  On a hit, stores the cached module in |binary| and
+  // returns true.  Otherwise returns false and leaves |binary| unchanged.
+  virtual bool Lookup(const std::string& key,
+                      std::vector<uint32_t>* binary) = 0;
+
+  // Stores |binary| as the module for |key|.  Storing is best effort: a
+  // failure to store only makes a later lookup of |key| miss.
+  virtual void Store(const std::string& key,
+                     const std::vector<uint32_t>& binary) = 0;
+};
+
+// An OptimizationCache that keeps each module in its own file in a local
+// directory, which must already exist.  The modules are stored as
+// little-endian words whatever the byte order of the host, so that, like the
+// keys, the directory can be shared between machines.  The total size of the
+// modules is kept under a bound by evicting the least recently used ones.  The
+// order of use and the size of each module are recorded in an index file in
+// the same directory, which is re-read before every update so that several
+// processes can share the directory.  Hits only update the index in memory;
+// they are written to the file in batches, and when the cache is destroyed.
+// Concurrent updates from different processes can still lose each other's
+// changes to the index; the modules themselves are written to a temporary
+// file and renamed into place, so a lookup never sees a partially written
+// module.
+class DirectoryOptimizationCache : public OptimizationCache {
+ public:
+  // Returns the cache for |directory|, with a bound of |max_size| bytes.  All
+  // the callers in a process share one cache for each directory; the bound
+  // is updated to |max_size| on each call.
+  static std::shared_ptr<DirectoryOptimizationCache> Get(
+      const std::string& directory, uint64_t max_size);
+
+  DirectoryOptimizationCache(const std::string& directory, uint64_t max_size);
+  ~DirectoryOptimizationCache() override;
+
+  bool Lookup(const std::string& key, std::vector<uint32_t>* binary) override;
+  void Store(const std::string& key,
+             const std::vector<uint32_t>& binary) override;
+
+  // Removes every module in the cache.
+  void Clear();
+
+  // Returns the number of modules in the cache and their total size in
+  // bytes, as recorded in the index.
+  size_t num_entries();
+  uint64_t size();
+
+  void set_max_size(uint64_t max_size);
+
+ private:
+  struct Entry {
+    std::string key;
+    uint64_t size;
+  };
+
+  // Returns the path of the file holding the module for |key|.
+  std::string EntryPath(const std::string& key) const;
+
+  // Replaces the in-memory index with the one in the directory, then records
+  // the uses in |pending_uses_| again.
+  void ReadIndex();
+
+  // Writes the in-memory index to the directory, which then records the uses
+  // in |pending_uses_|.
+  void WriteIndex();
+
+  // Records |key|, of |size| bytes, as the most recently used module.
+  void Touch(const std::string& key, uint64_t size);
+
+  // Removes |key| from the index.  Does not remove its file.
+  void Forget(const std::string& key);
+
+  // Removes the least recently used modules until the total size is within
+  // |max_size_|.
+  void Evict();
+
+  const std::string directory_;
+
+  // Guards the members below, and the index file against the other threads
+  // of this process.
+  std::mutex mutex_;
+
+  uint64_t max_size_;
+
+  // The modules, from the least to the most recently used.
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> entry_map_;
+  uint64_t total_size_ = 0;
+
+  // The modules found by Lookup() since the index was last written, in the
+  // order they were found.
+  std::vector<Entry> pending_uses_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_OPTIMIZATION_CACHE_H_
@@ -24,6 +24,7 @@
 #include "source/opt/build_module.h"
 #include "source/opt/graphics_robust_access_pass.h"
 #include "source/opt/log.h"
+#include "source/opt/optimization_cache.h"
 #include "source/opt/pass_manager.h"
 #include "source/opt/passes.h"
 #include "source/spirv_optimizer_options.h"
@@ -31,6 +32,181 @@
 #include "source/util/string_utils.h"
 
 namespace spvtools {
+namespace {
+
+// The passes of RegisterLegalizationPasses().
+const char* const kLegalizationPassFlags[] = {
+    // Wrap OpKill instructions so all other code can be inlined.
+    "--wrap-opkill",
+    // Remove unreachable block so that merge return works.
+    "--eliminate-dead-branches",
+    // Merge the returns so we can inline.
+    "--merge-return",
+    // Make sure uses and definitions are in the same function.
+    "--inline-entry-points-exhaustive",
+    // Make private variable function scope
+    "--eliminate-dead-functions",
+    "--private-to-local",
+    // Fix up the storage classes that DXC may have purposely generated
+    // incorrectly.  All functions are inlined, and a lot of dead code has
+    // been removed.
+    "--fix-storage-class",
+    // Propagate the value stored to the loads in very simple cases.
+    "--eliminate-local-single-block",
+    "--eliminate-local-single-store",
+    "--eliminate-dead-code-aggressive",
+    // Split up aggregates so they are easier to deal with.
+    "--scalar-replacement=0",
+    // Remove loads and stores so everything is in intermediate values.
+    // Takes care of copy propagation of non-members.
+    "--eliminate-local-single-block",
+    "--eliminate-local-single-store",
+    "--eliminate-dead-code-aggressive",
+    "--eliminate-local-multi-store",
+    "--eliminate-dead-code-aggressive",
+    // Propagate constants to get as many constant conditions on branches
+    // as possible.
+    "--ccp",
+    "--loop-unroll",
+    "--eliminate-dead-branches",
+    // Copy propagate members.  Cleans up code sequences generated by
+    // scalar replacement.  Also important for removing OpPhi nodes.
+    "--simplify-instructions",
+    "--eliminate-dead-code-aggressive",
+    "--copy-propagate-arrays",
+    // May need loop unrolling here see
+    // https://github.com/Microsoft/DirectXShaderCompiler/pull/930
+    // Get rid of unused code that contain traces of illegal code
+    // or unused references to unbound external objects
+    "--vector-dce",
+    "--eliminate-dead-inserts",
+    "--reduce-load-size",
+    "--eliminate-dead-code-aggressive",
+};
+
+// The passes of RegisterPerformancePasses().
+const char* const kPerformancePassFlags[] = {
+    "--wrap-opkill",
+    "--eliminate-dead-branches",
+    "--merge-return",
+    "--inline-entry-points-exhaustive",
+    "--eliminate-dead-code-aggressive",
+    "--private-to-local",
+    "--eliminate-local-single-block",
+    "--eliminate-local-single-store",
+    "--eliminate-dead-code-aggressive",
+    "--scalar-replacement",
+    "--convert-local-access-chains",
+    "--eliminate-local-single-block",
+    "--eliminate-local-single-store",
+    "--eliminate-dead-code-aggressive",
+    "--eliminate-local-multi-store",
+    "--eliminate-dead-code-aggressive",
+    "--ccp",
+    "--eliminate-dead-code-aggressive",
+    "--loop-unroll",
+    "--eliminate-dead-branches",
+    "--redundancy-elimination",
+    "--combine-access-chains",
+    "--simplify-instructions",
+    "--scalar-replacement",
+    "--convert-local-access-chains",
+    "--eliminate-local-single-block",
+    "--eliminate-local-single-store",
+    "--eliminate-dead-code-aggressive",
+    "--ssa-rewrite",
+    "--eliminate-dead-code-aggressive",
+    "--vector-dce",
+    "--eliminate-dead-inserts",
+    "--eliminate-dead-branches",
+    "--simplify-instructions",
+    "--if-conversion",
+    "--copy-propagate-arrays",
+    "--reduce-load-size",
+    "--eliminate-dead-code-aggressive",
+    "--merge-blocks",
+    "--redundancy-elimination",
+    "--eliminate-dead-branches",
+    "--merge-blocks",
+    "--simplify-instructions",
+};
+
+// The passes of RegisterSizePasses().
+const char* const kSizePassFlags[] = {
+    "--wrap-opkill",
+    "--eliminate-dead-branches",
+    "--merge-return",
+    "--inline-entry-points-exhaustive",
+    "--eliminate-dead-functions",
+    "--private-to-local",
+    "--scalar-replacement=0",
+    "--eliminate-local-multi-store",
+    "--ccp",
+    "--loop-unroll",
+    "--eliminate-dead-branches",
+    "--simplify-instructions",
+    "--scalar-replacement=0",
+    "--eliminate-local-single-store",
+    "--if-conversion",
+    "--simplify-instructions",
+    "--eliminate-dead-code-aggressive",
+    "--eliminate-dead-branches",
+    "--merge-blocks",
+    "--convert-local-access-chains",
+    "--eliminate-local-single-block",
+    "--eliminate-dead-code-aggressive",
+    "--copy-propagate-arrays",
+    "--vector-dce",
+    "--eliminate-dead-inserts",
+    "--eliminate-dead-members",
+    "--eliminate-local-single-store",
+    "--merge-blocks",
+    "--eliminate-local-multi-store",
+    "--redundancy-elimination",
+    "--simplify-instructions",
+    "--eliminate-dead-code-aggressive",
+    "--cfg-cleanup",
+};
+
+// The passes of RegisterVulkanToWebGPUPasses().
+const char* const kVulkanToWebGPUPassFlags[] = {
+    "--strip-atomic-counter-memory",
+    "--generate-webgpu-initializers",
+    "--legalize-vector-shuffle",
+    "--split-invalid-unreachable",
+    "--eliminate-dead-const",
+    "--flatten-decorations",
+    "--eliminate-dead-code-aggressive",
+    "--eliminate-dead-branches",
+    "--compact-ids",
+};
+
+// The passes of RegisterWebGPUToVulkanPasses().
+const char* const kWebGPUToVulkanPassFlags[] = {
+    "--decompose-initialized-variables",
+    "--compact-ids",
+};
+
+// Returns the flags of |flags| as strings.
+template <size_t N>
+std::vector<std::string> FlagList(const char* const (&flags)[N]) {
+  return std::vector<std::string>(flags, flags + N);
+}
+
+// Pushes |flag| on |flags| for the lifetime of the scope.
+class FlagScope {
+ public:
+  FlagScope(std::vector<std::string>* flags, const std::string& flag)
+      : flags_(flags) {
+    flags_->push_back(flag);
+  }
+  ~FlagScope() { flags_->pop_back(); }
+
+ private:
+  std::vector<std::string>* flags_;
+};
+
+}  // namespace
 
 struct Optimizer::PassToken::Impl {
   Impl(std::unique_ptr<opt::Pass> p) : pass(std::move(p)) {}
@@ -56,12 +232,121 @@ Optimizer::PassToken& Optimizer::PassToken::operator=(PassToken&& that) {
 Optimizer::PassToken::~PassToken() {}
 
 struct Optimizer::Impl {
-  explicit Impl(spv_target_env env) : target_env(env), pass_manager() {}
+  explicit Impl(spv_target_env env)
+      : target_env(env),
+        pass_manager(),
+        profile_stream(nullptr),
+        profile_format(ProfileFormat::kJson),
+        fixed_point_rounds(0),
+        has_pass_without_flag(false),
+        passes_ran(false) {}
+
+  // Returns the passes registered from |recipe| for |env|, or no passes if a
+  // flag of |recipe| is not valid.
+  static std::vector<std::unique_ptr<opt::Pass>> MakePasses(
+      spv_target_env env, const std::vector<std::string>& recipe);
+
+  // Returns the key under which the result of optimizing |binary|, of
+  // |binary_size| words, with |opt_options| is cached.
+  std::string CacheKey(const uint32_t* binary, size_t binary_size,
+                       const spv_optimizer_options opt_options) const;
 
   spv_target_env target_env;      // Target environment.
   opt::PassManager pass_manager;  // Internal implementation pass manager.
+  std::ostream* profile_stream;   // Where to write the pass profile, if set.
+  ProfileFormat profile_format;   // The format of the pass profile.
+  uint32_t fixed_point_rounds;    // Rounds of the fixed-point schedule.
+
+  // The cache of optimized modules, if set.
+  std::shared_ptr<opt::OptimizationCache> cache;
+
+  // Identifies the passes registered outside of any flag in the cache key.
+  // The cache is not used for them if it is empty.
+  std::string cache_key_salt;
+
+  // The flags the passes were registered from, in order, not counting the
+  // flags registered by other flags.  Registering them again gives the same
+  // passes, with the same arguments.
+  std::vector<std::string> pass_recipe;
+
+  // The flag that registered each pass, in the order of the passes.  For the
+  // passes of a flag that registers the passes of other flags, such as -O,
+  // this is the innermost flag.  Empty for the passes registered outside of
+  // any flag.
+  std::vector<std::string> pass_flags;
+
+  // The flags being registered, innermost last.
+  std::vector<std::string> flag_stack;
+
+  // True if a pass was registered outside of any flag, so that the passes
+  // cannot be created again from |pass_recipe|.
+  bool has_pass_without_flag;
+
+  // True once Run() has run the passes, which are then used up.
+  bool passes_ran;
 };
 
+std::vector<std::unique_ptr<opt::Pass>> Optimizer::Impl::MakePasses(
+    spv_target_env env, const std::vector<std::string>& recipe) {
+  Optimizer optimizer(env);
+  std::vector<std::unique_ptr<opt::Pass>> passes;
+  if (optimizer.RegisterPassesFromFlags(recipe)) {
+    passes = optimizer.impl_->pass_manager.TakePasses();
+  }
+  return passes;
+}
+
+std::string Optimizer::Impl::CacheKey(
+    const uint32_t* binary, size_t binary_size,
+    const spv_optimizer_options opt_options) const {
+  opt::OptimizationCacheKey key;
+  // Different versions of the optimizer can give different results.
+  key.Add(std::string(spvSoftwareVersionDetailsString()));
+  key.AddWords(binary, binary_size);
+  key.Add(static_cast<uint32_t>(target_env));
+
+  // The number of threads is left out, since it does not change the result.
+  key.Add(static_cast<uint32_t>(opt_options->run_validator_));
+  key.Add(opt_options->max_id_bound_);
+  key.Add(static_cast<uint32_t>(opt_options->preserve_bindings_));
+  key.Add(static_cast<uint32_t>(opt_options->preserve_spec_constants_));
+
+  // The validator options decide whether the input is accepted at all.
+  const spv_validator_options_t& val = opt_options->val_options_;
+  const validator_universal_limits_t& limits = val.universal_limits_;
+  for (uint32_t limit :
+       {limits.max_struct_members, limits.max_struct_depth,
+        limits.max_local_variables, limits.max_global_variables,
+        limits.max_switch_branches, limits.max_function_args,
+        limits.max_control_flow_nesting_depth,
+        limits.max_access_chain_indexes, limits.max_id_bound}) {
+    key.Add(limit);
+  }
+  for (bool option :
+       {val.relax_struct_store, val.relax_logical_pointer,
+        val.relax_block_layout, val.uniform_buffer_standard_layout,
+        val.scalar_block_layout, val.skip_block_layout,
+        val.before_hlsl_legalization}) {
+    key.Add(static_cast<uint32_t>(option));
+  }
+
+  // More rounds of the passes can give a better result.
+  key.Add(fixed_point_rounds);
+  key.Add(static_cast<uint64_t>(pass_recipe.size()));
+  for (const std::string& step : pass_recipe) {
+    key.Add(step);
+  }
+
+  // The order of the passes registered outside of any flag among the others
+  // is part of the key; what they do is described by the salt.
+  key.Add(static_cast<uint64_t>(pass_flags.size()));
+  for (const std::string& flag : pass_flags) {
+    key.Add(flag);
+  }
+  key.Add(cache_key_salt);
+  return key.Digest();
+}
+
 Optimizer::Optimizer(spv_target_env env) : impl_(new Impl(env)) {}
 
 Optimizer::~Optimizer() {}
@@ -69,7 +354,9 @@ Optimizer::~Optimizer() {}
 void Optimizer::SetMessageConsumer(MessageConsumer c) {
   // All passes' message consumer needs to be updated.
   for (uint32_t i = 0; i < impl_->pass_manager.NumPasses(); ++i) {
-    impl_->pass_manager.GetPass(i)->SetMessageConsumer(c);
+    if (opt::Pass* pass = impl_->pass_manager.GetPass(i)) {
+      pass->SetMessageConsumer(c);
+    }
   }
   impl_->pass_manager.SetMessageConsumer(std::move(c));
 }
@@ -81,6 +368,12 @@ const MessageConsumer& Optimizer::consumer() const {
 Optimizer& Optimizer::RegisterPass(PassToken&& p) {
   // Change to use the pass manager's consumer.
   p.impl_->pass->SetMessageConsumer(consumer());
+  if (impl_->flag_stack.empty()) {
+    impl_->has_pass_without_flag = true;
+    impl_->pass_flags.emplace_back();
+  } else {
+    impl_->pass_flags.push_back(impl_->flag_stack.back());
+  }
   impl_->pass_manager.AddPass(std::move(p.impl_->pass));
   return *this;
 }
@@ -107,152 +400,28 @@ Optimizer& Optimizer::RegisterPass(PassToken&& p) {
 // problem.  The optimization we use are all used to either do copy propagation
 // or enable more copy propagation.
 Optimizer& Optimizer::RegisterLegalizationPasses() {
-  return
-      // Wrap OpKill instructions so all other code can be inlined.
-      RegisterPass(CreateWrapOpKillPass())
-          // Remove unreachable block so that merge return works.
-          .RegisterPass(CreateDeadBranchElimPass())
-          // Merge the returns so we can inline.
-          .RegisterPass(CreateMergeReturnPass())
-          // Make sure uses and definitions are in the same function.
-          .RegisterPass(CreateInlineExhaustivePass())
-          // Make private variable function scope
-          .RegisterPass(CreateEliminateDeadFunctionsPass())
-          .RegisterPass(CreatePrivateToLocalPass())
-          // Fix up the storage classes that DXC may have purposely generated
-          // incorrectly.  All functions are inlined, and a lot of dead code has
-          // been removed.
-          .RegisterPass(CreateFixStorageClassPass())
-          // Propagate the value stored to the loads in very simple cases.
-          .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-          .RegisterPass(CreateLocalSingleStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          // Split up aggregates so they are easier to deal with.
-          .RegisterPass(CreateScalarReplacementPass(0))
-          // Remove loads and stores so everything is in intermediate values.
-          // Takes care of copy propagation of non-members.
-          .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-          .RegisterPass(CreateLocalSingleStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          .RegisterPass(CreateLocalMultiStoreElimPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          // Propagate constants to get as many constant conditions on branches
-          // as possible.
-          .RegisterPass(CreateCCPPass())
-          .RegisterPass(CreateLoopUnrollPass(true))
-          .RegisterPass(CreateDeadBranchElimPass())
-          // Copy propagate members.  Cleans up code sequences generated by
-          // scalar replacement.  Also important for removing OpPhi nodes.
-          .RegisterPass(CreateSimplificationPass())
-          .RegisterPass(CreateAggressiveDCEPass())
-          .RegisterPass(CreateCopyPropagateArraysPass())
-          // May need loop unrolling here see
-          // https://github.com/Microsoft/DirectXShaderCompiler/pull/930
-          // Get rid of unused code that contain traces of illegal code
-          // or unused references to unbound external objects
-          .RegisterPass(CreateVectorDCEPass())
-          .RegisterPass(CreateDeadInsertElimPass())
-          .RegisterPass(CreateReduceLoadSizePass())
-          .RegisterPass(CreateAggressiveDCEPass());
+  RegisterPassFromFlag("--legalize-hlsl");
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterPerformancePasses() {
-  return RegisterPass(CreateWrapOpKillPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateMergeReturnPass())
-      .RegisterPass(CreateInlineExhaustivePass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreatePrivateToLocalPass())
-      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-      .RegisterPass(CreateLocalSingleStoreElimPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateScalarReplacementPass())
-      .RegisterPass(CreateLocalAccessChainConvertPass())
-      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-      .RegisterPass(CreateLocalSingleStoreElimPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateLocalMultiStoreElimPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateCCPPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateLoopUnrollPass(true))
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateRedundancyEliminationPass())
-      .RegisterPass(CreateCombineAccessChainsPass())
-      .RegisterPass(CreateSimplificationPass())
-      .RegisterPass(CreateScalarReplacementPass())
-      .RegisterPass(CreateLocalAccessChainConvertPass())
-      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-      .RegisterPass(CreateLocalSingleStoreElimPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateSSARewritePass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateVectorDCEPass())
-      .RegisterPass(CreateDeadInsertElimPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateSimplificationPass())
-      .RegisterPass(CreateIfConversionPass())
-      .RegisterPass(CreateCopyPropagateArraysPass())
-      .RegisterPass(CreateReduceLoadSizePass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateRedundancyEliminationPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateSimplificationPass());
+  RegisterPassFromFlag("-O");
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterSizePasses() {
-  return RegisterPass(CreateWrapOpKillPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateMergeReturnPass())
-      .RegisterPass(CreateInlineExhaustivePass())
-      .RegisterPass(CreateEliminateDeadFunctionsPass())
-      .RegisterPass(CreatePrivateToLocalPass())
-      .RegisterPass(CreateScalarReplacementPass(0))
-      .RegisterPass(CreateLocalMultiStoreElimPass())
-      .RegisterPass(CreateCCPPass())
-      .RegisterPass(CreateLoopUnrollPass(true))
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateSimplificationPass())
-      .RegisterPass(CreateScalarReplacementPass(0))
-      .RegisterPass(CreateLocalSingleStoreElimPass())
-      .RegisterPass(CreateIfConversionPass())
-      .RegisterPass(CreateSimplificationPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateLocalAccessChainConvertPass())
-      .RegisterPass(CreateLocalSingleBlockLoadStoreElimPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateCopyPropagateArraysPass())
-      .RegisterPass(CreateVectorDCEPass())
-      .RegisterPass(CreateDeadInsertElimPass())
-      .RegisterPass(CreateEliminateDeadMembersPass())
-      .RegisterPass(CreateLocalSingleStoreElimPass())
-      .RegisterPass(CreateBlockMergePass())
-      .RegisterPass(CreateLocalMultiStoreElimPass())
-      .RegisterPass(CreateRedundancyEliminationPass())
-      .RegisterPass(CreateSimplificationPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateCFGCleanupPass());
+  RegisterPassFromFlag("-Os");
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterVulkanToWebGPUPasses() {
-  return RegisterPass(CreateStripAtomicCounterMemoryPass())
-      .RegisterPass(CreateGenerateWebGPUInitializersPass())
-      .RegisterPass(CreateLegalizeVectorShufflePass())
-      .RegisterPass(CreateSplitInvalidUnreachablePass())
-      .RegisterPass(CreateEliminateDeadConstantPass())
-      .RegisterPass(CreateFlattenDecorationPass())
-      .RegisterPass(CreateAggressiveDCEPass())
-      .RegisterPass(CreateDeadBranchElimPass())
-      .RegisterPass(CreateCompactIdsPass());
+  RegisterPassesFromFlags(FlagList(kVulkanToWebGPUPassFlags));
+  return *this;
 }
 
 Optimizer& Optimizer::RegisterWebGPUToVulkanPasses() {
-  return RegisterPass(CreateDecomposeInitializedVariablesPass())
-      .RegisterPass(CreateCompactIdsPass());
+  RegisterPassesFromFlags(FlagList(kWebGPUToVulkanPassFlags));
+  return *this;
 }
 
 bool Optimizer::RegisterPassesFromFlags(const std::vector<std::string>& flags) {
@@ -285,6 +454,10 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     return false;
   }
 
+  // The passes registered below are identified by |flag|.
+  const bool is_top_level = impl_->flag_stack.empty();
+  FlagScope flag_scope(&impl_->flag_stack, flag);
+
   // Split flags of the form --pass_name=pass_args.
   auto p = utils::SplitFlagArgs(flag);
   std::string pass_name = p.first;
@@ -329,6 +502,18 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateFreezeSpecConstantValuePass());
   } else if (pass_name == "inline-entry-points-exhaustive") {
     RegisterPass(CreateInlineExhaustivePass());
+  } else if (pass_name == "inline-bottom-up") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateInlineBottomUpPass());
+    } else if (pass_args.find_first_not_of("0123456789") == std::string::npos) {
+      RegisterPass(CreateInlineBottomUpPass(
+          static_cast<uint32_t>(atoi(pass_args.c_str()))));
+    } else {
+      Error(consumer(), nullptr, {},
+            "--inline-bottom-up must have no arguments or a non-negative "
+            "integer argument");
+      return false;
+    }
   } else if (pass_name == "inline-entry-points-opaque") {
     RegisterPass(CreateInlineOpaquePass());
   } else if (pass_name == "combine-access-chains") {
@@ -407,6 +592,8 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateReduceLoadSizePass());
   } else if (pass_name == "redundancy-elimination") {
     RegisterPass(CreateRedundancyEliminationPass());
+  } else if (pass_name == "partial-redundancy-elimination") {
+    RegisterPass(CreatePartialRedundancyEliminationPass());
   } else if (pass_name == "private-to-local") {
     RegisterPass(CreatePrivateToLocalPass());
   } else if (pass_name == "remove-duplicates") {
@@ -417,19 +604,17 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateReplaceInvalidOpcodePass());
   } else if (pass_name == "inst-bindless-check") {
     RegisterPass(CreateInstBindlessCheckPass(7, 23, false, false));
-    RegisterPass(CreateSimplificationPass());
-    RegisterPass(CreateDeadBranchElimPass());
-    RegisterPass(CreateBlockMergePass());
-    RegisterPass(CreateAggressiveDCEPass());
+    RegisterPassesFromFlags(
+        {"--simplify-instructions", "--eliminate-dead-branches",
+         "--merge-blocks", "--eliminate-dead-code-aggressive"});
   } else if (pass_name == "inst-desc-idx-check") {
     RegisterPass(CreateInstBindlessCheckPass(7, 23, true, true));
-    RegisterPass(CreateSimplificationPass());
-    RegisterPass(CreateDeadBranchElimPass());
-    RegisterPass(CreateBlockMergePass());
-    RegisterPass(CreateAggressiveDCEPass());
+    RegisterPassesFromFlags(
+        {"--simplify-instructions", "--eliminate-dead-branches",
+         "--merge-blocks", "--eliminate-dead-code-aggressive"});
   } else if (pass_name == "inst-buff-addr-check") {
     RegisterPass(CreateInstBuffAddrCheckPass(7, 23));
-    RegisterPass(CreateAggressiveDCEPass());
+    RegisterPassFromFlag("--eliminate-dead-code-aggressive");
   } else if (pass_name == "convert-relaxed-to-half") {
     RegisterPass(CreateConvertRelaxedToHalfPass());
   } else if (pass_name == "relax-float-ops") {
@@ -497,11 +682,11 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
   } else if (pass_name == "fix-storage-class") {
     RegisterPass(CreateFixStorageClassPass());
   } else if (pass_name == "O") {
-    RegisterPerformancePasses();
+    RegisterPassesFromFlags(FlagList(kPerformancePassFlags));
   } else if (pass_name == "Os") {
-    RegisterSizePasses();
+    RegisterPassesFromFlags(FlagList(kSizePassFlags));
   } else if (pass_name == "legalize-hlsl") {
-    RegisterLegalizationPasses();
+    RegisterPassesFromFlags(FlagList(kLegalizationPassFlags));
   } else if (pass_name == "generate-webgpu-initializers") {
     RegisterPass(CreateGenerateWebGPUInitializersPass());
   } else if (pass_name == "legalize-vector-shuffle") {
@@ -523,6 +708,7 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     return false;
   }
 
+  if (is_top_level) impl_->pass_recipe.push_back(flag);
   return true;
 }
 
@@ -553,6 +739,22 @@ bool Optimizer::Run(const uint32_t* original_binary,
                     const size_t original_binary_size,
                     std::vector<uint32_t>* optimized_binary,
                     const spv_optimizer_options opt_options) const {
+  // A cached result was produced from the same input, options and passes, and
+  // was validated the same way, so it can be returned as it is.
+  // The arguments of the passes registered outside of any flag are unknown,
+  // so they are only cached if the caller identified them.
+  const bool use_cache =
+      impl_->cache &&
+      (!impl_->has_pass_without_flag || !impl_->cache_key_salt.empty());
+  std::string cache_key;
+  if (use_cache) {
+    cache_key =
+        impl_->CacheKey(original_binary, original_binary_size, opt_options);
+    if (impl_->cache->Lookup(cache_key, optimized_binary)) {
+      return true;
+    }
+  }
+
   spvtools::SpirvTools tools(impl_->target_env);
   tools.SetMessageConsumer(impl_->pass_manager.consumer());
   if (opt_options->run_validator_ &&
@@ -561,17 +763,61 @@ bool Optimizer::Run(const uint32_t* original_binary,
     return false;
   }
 
-  std::unique_ptr<opt::IRContext> context = BuildModule(
-      impl_->target_env, consumer(), original_binary, original_binary_size);
+  // The context does not outlive this call, so the module can be allocated
+  // from its arena.
+  std::unique_ptr<opt::IRContext> context =
+      BuildModule(impl_->target_env, consumer(), original_binary,
+                  original_binary_size, /* use_arena = */ true);
   if (context == nullptr) return false;
 
   context->set_max_id_bound(opt_options->max_id_bound_);
   context->set_preserve_bindings(opt_options->preserve_bindings_);
   context->set_preserve_spec_constants(opt_options->preserve_spec_constants_);
+  context->set_num_threads(opt_options->num_threads_);
+
+  // The passes of an earlier call are used up, so they are registered again
+  // from their flags.
+  if (impl_->passes_ran) {
+    if (impl_->has_pass_without_flag) {
+      Error(consumer(), nullptr, {},
+            "The passes registered without a flag can only be run once");
+      return false;
+    }
+    impl_->pass_manager.TakePasses();
+    for (auto& pass :
+         Impl::MakePasses(impl_->target_env, impl_->pass_recipe)) {
+      pass->SetMessageConsumer(consumer());
+      impl_->pass_manager.AddPass(std::move(pass));
+    }
+  }
 
   impl_->pass_manager.SetValidatorOptions(&opt_options->val_options_);
   impl_->pass_manager.SetTargetEnv(impl_->target_env);
+
+  // The passes of the later rounds of the fixed-point schedule are registered
+  // again from the flags of the first round, so the schedule is off if a pass
+  // was registered without a flag.
+  if (impl_->fixed_point_rounds > 0 && !impl_->has_pass_without_flag) {
+    const spv_target_env env = impl_->target_env;
+    const std::vector<std::string> recipe = impl_->pass_recipe;
+    impl_->pass_manager.SetFixedPoint(
+        impl_->fixed_point_rounds, impl_->pass_flags,
+        [env, recipe]() { return Impl::MakePasses(env, recipe); });
+  } else {
+    impl_->pass_manager.SetFixedPoint(0, {}, nullptr);
+  }
+  opt::PassProfile profile;
+  if (impl_->profile_stream) impl_->pass_manager.SetPassProfile(&profile);
+  impl_->passes_ran = true;
   auto status = impl_->pass_manager.Run(context.get());
+  if (impl_->profile_stream) {
+    impl_->pass_manager.SetPassProfile(nullptr);
+    if (impl_->profile_format == ProfileFormat::kChromeTrace) {
+      profile.WriteChromeTrace(impl_->profile_stream);
+    } else {
+      profile.WriteJson(impl_->profile_stream);
+    }
+  }
 
   if (status == opt::Pass::Status::Failure) {
     return false;
@@ -602,6 +848,10 @@ bool Optimizer::Run(const uint32_t* original_binary,
   optimized_binary->clear();
   context->module()->ToBinary(optimized_binary, /* skip_nop = */ true);
 
+  if (use_cache) {
+    impl_->cache->Store(cache_key, *optimized_binary);
+  }
+
   return true;
 }
 
@@ -615,11 +865,37 @@ Optimizer& Optimizer::SetTimeReport(std::ostream* out) {
   return *this;
 }
 
+Optimizer& Optimizer::SetPassProfile(std::ostream* out, ProfileFormat format) {
+  impl_->profile_stream = out;
+  impl_->profile_format = format;
+  return *this;
+}
+
 Optimizer& Optimizer::SetValidateAfterAll(bool validate) {
   impl_->pass_manager.SetValidateAfterAll(validate);
   return *this;
 }
 
+Optimizer& Optimizer::SetFixedPointRounds(uint32_t max_rounds) {
+  impl_->fixed_point_rounds = max_rounds;
+  return *this;
+}
+
+Optimizer& Optimizer::SetCacheDirectory(const std::string& directory,
+                                        uint64_t max_size) {
+  if (directory.empty()) {
+    impl_->cache.reset();
+  } else {
+    impl_->cache = opt::DirectoryOptimizationCache::Get(directory, max_size);
+  }
+  return *this;
+}
+
+Optimizer& Optimizer::SetCacheKeySalt(const std::string& salt) {
+  impl_->cache_key_salt = salt;
+  return *this;
+}
+
 Optimizer::PassToken CreateNullPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(MakeUnique<opt::NullPass>());
 }
@@ -706,6 +982,13 @@ Optimizer::PassToken CreateInlineExhaustivePass() {
       MakeUnique<opt::InlineExhaustivePass>());
 }
 
+Optimizer::PassToken CreateInlineBottomUpPass(uint32_t max_growth_percent,
+                                              uint32_t max_callee_size) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::InlineBottomUpPass>(max_growth_percent,
+                                          max_callee_size));
+}
+
 Optimizer::PassToken CreateInlineOpaquePass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::InlineOpaquePass>());
@@ -818,6 +1101,11 @@ Optimizer::PassToken CreateRedundancyEliminationPass() {
       MakeUnique<opt::RedundancyEliminationPass>());
 }
 
+Optimizer::PassToken CreatePartialRedundancyEliminationPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::RedundancyEliminationPass>(true));
+}
+
 Optimizer::PassToken CreateRemoveDuplicatesPass() {
   return MakeUnique<Optimizer::PassToken::Impl>(
       MakeUnique<opt::RemoveDuplicatesPass>());
@@ -16,6 +16,10 @@
 
 #include "source/opt/pass.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "source/opt/ir_builder.h"
 #include "source/opt/iterator.h"
 
@@ -37,17 +41,75 @@ Pass::Status Pass::Run(IRContext* ctx) {
   already_run_ = true;
 
   context_ = ctx;
+  if (KeepsChangeJournal()) ctx->StartChangeJournal();
   Pass::Status status = Process();
   context_ = nullptr;
 
+  // The analyses that caught up with the journal are up to date.
+  const IRContext::Analysis journaled = KeepsChangeJournal()
+                                            ? ctx->StopChangeJournal()
+                                            : IRContext::kAnalysisNone;
   if (status == Status::SuccessWithChange) {
-    ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses());
+    ctx->InvalidateAnalysesExceptFor(GetPreservedAnalyses() | journaled);
   }
   assert((status == Status::Failure || ctx->IsConsistent()) &&
          "An analysis in the context is out of date.");
   return status;
 }
 
+bool Pass::ProcessEachFunctionInParallel(const ProcessFunctionAt& pfn,
+                                         IRContext::Analysis required) {
+  std::vector<Function*> functions;
+  for (Function& function : *get_module()) {
+    functions.push_back(&function);
+  }
+  const uint32_t num_functions = static_cast<uint32_t>(functions.size());
+  const uint32_t num_threads =
+      std::min(context()->num_threads(), num_functions);
+
+  if (num_threads <= 1) {
+    bool modified = false;
+    for (uint32_t i = 0; i < num_functions; ++i) {
+      if (context()->ShouldProcessFunction(*functions[i])) {
+        modified |= pfn(functions[i], i);
+      }
+    }
+    return modified;
+  }
+
+  // Everything the workers read must exist before they start, since the
+  // lazily built analyses are not safe to build concurrently.  The feature
+  // manager is not covered by |required|, but many instruction queries use it.
+  if (!context()->AreAnalysesValid(required)) {
+    context()->BuildInvalidAnalyses(required);
+  }
+  context()->get_feature_mgr();
+
+  std::atomic<uint32_t> next_function(0);
+  std::atomic<bool> modified(false);
+  IRContext* ctx = context();
+  auto worker = [ctx, &functions, &pfn, &next_function, &modified,
+                 num_functions]() {
+    for (uint32_t i = next_function++; i < num_functions;
+         i = next_function++) {
+      if (ctx->ShouldProcessFunction(*functions[i]) && pfn(functions[i], i)) {
+        modified = true;
+      }
+    }
+  };
+
+  // The calling thread is one of the workers.
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < num_threads; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : workers) {
+    t.join();
+  }
+  return modified;
+}
+
 uint32_t Pass::GetPointeeTypeId(const Instruction* ptrInst) const {
   const uint32_t ptrTypeId = ptrInst->type_id();
   const Instruction* ptrTypeInst = get_def_use_mgr()->GetDef(ptrTypeId);
@@ -17,6 +17,7 @@
 
 #include <algorithm>
 #include <map>
+#include <ostream>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -47,6 +48,10 @@ class Pass {
 
   using ProcessFunction = std::function<bool(Function*)>;
 
+  // Like |ProcessFunction|, but also given the position of the function in the
+  // module.
+  using ProcessFunctionAt = std::function<bool(Function*, uint32_t)>;
+
   // Destructs the pass.
   virtual ~Pass() = default;
 
@@ -106,6 +111,31 @@ class Pass {
     return IRContext::kAnalysisNone;
   }
 
+  // Returns true if the pass can be restricted to some of the functions in
+  // the module with IRContext::set_functions_to_process().  The changes the
+  // pass makes to a function must depend only on that function and on the
+  // instructions outside of functions, and the pass must only process the
+  // functions for which IRContext::ShouldProcessFunction() is true.
+  virtual bool IsFunctionLocal() const { return false; }
+
+  // Returns true if the context is to record a change journal while the pass
+  // runs, and keep the def-use manager, the decoration manager and the
+  // instruction to block mapping valid by catching up with it.  See
+  // IRContext::StartChangeJournal().  The pass must remove instructions only
+  // with IRContext::KillInst, report the instructions whose operands it
+  // changes with IRContext::AnalyzeUses or IRContext::UpdateDefUse, and give
+  // the block of an instruction it moves to another block, or appends to a
+  // block with no other instruction, with IRContext::set_instr_block.  New
+  // instructions need no reporting once they are inserted into a list, as
+  // long as the ids they use are defined by the time one of the analyses is
+  // used.  Those that are not in a list, such as labels, must be given to
+  // IRContext::AnalyzeDefUse.
+  virtual bool KeepsChangeJournal() const { return false; }
+
+  // Prints what the last run of the pass did to |out|, for the time report.
+  // Passes that keep no statistics print nothing.
+  virtual void PrintStatistics(std::ostream& out) const { (void)out; }
+
   // Return type id for |ptrInst|'s pointee
   uint32_t GetPointeeTypeId(const Instruction* ptrInst) const;
 
@@ -136,6 +166,19 @@ class Pass {
   // TODO(1841): Handle id overflow.
   uint32_t TakeNextId() { return context_->TakeNextId(); }
 
+  // Calls |pfn| on every function in the module, passing the function and its
+  // position in the module, and returns true if any call returned true.
+  //
+  // When the context allows more than one thread, the calls are spread over a
+  // pool of worker threads.  The analyses in |required| are built before the
+  // workers start.  |pfn| may read the module and those analyses and may take
+  // new ids, but it must only modify the function it is given and must not
+  // build, update or invalidate any analysis.  Results that need to be applied
+  // to shared state should be recorded per function, for example in a vector
+  // indexed by position, and applied after this returns.
+  bool ProcessEachFunctionInParallel(const ProcessFunctionAt& pfn,
+                                     IRContext::Analysis required);
+
   // Returns the id whose value is the same as |object_to_copy| except its type
   // is |new_type_id|.  Any instructions needed to generate this value will be
   // inserted before |insertion_position|.
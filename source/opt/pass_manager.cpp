@@ -16,16 +16,109 @@
 
 #include <iostream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "source/opt/ir_context.h"
 #include "source/util/timer.h"
+#include "source/val/validate.h"
+#include "source/val/validation_state.h"
 #include "spirv-tools/libspirv.hpp"
 
 namespace spvtools {
 
 namespace opt {
 
+namespace {
+
+const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+const uint64_t kFnvPrime = 0x100000001b3ull;
+
+// Tracks which parts of a module change: each function, and everything
+// outside of functions, debug line instructions included.  Each part records
+// the version of the module at which it last changed.
+class ChangeTracker {
+ public:
+  explicit ChangeTracker(IRContext* context) : version_(0), globals_{0, 0} {
+    Update(context);
+  }
+
+  // Hashes the module again, and gives a new version to the parts whose hash
+  // changed.
+  void Update(IRContext* context);
+
+  // Returns the current version of the module.
+  uint32_t version() const { return version_; }
+
+  // Returns true if anything outside of functions changed after |version|.
+  bool GlobalsChangedAfter(uint32_t version) const {
+    return globals_.version > version;
+  }
+
+  // Adds to |ids| the functions that changed after |version|.
+  void GetFunctionsChangedAfter(uint32_t version,
+                                std::unordered_set<uint32_t>* ids) const {
+    for (const auto& function : functions_) {
+      if (function.second.version > version) ids->insert(function.first);
+    }
+  }
+
+ private:
+  struct Part {
+    uint64_t hash;
+    uint32_t version;
+  };
+
+  // Adds the words of |inst| to |hash|.
+  static void AddInstruction(const Instruction& inst, uint64_t* hash) {
+    auto add = [hash](uint32_t word) { *hash = (*hash ^ word) * kFnvPrime; };
+    add(inst.opcode());
+    add(inst.type_id());
+    add(inst.result_id());
+    add(inst.NumOperands());
+    for (uint32_t i = 0; i < inst.NumOperands(); ++i) {
+      const Operand& operand = inst.GetOperand(i);
+      add(static_cast<uint32_t>(operand.words.size()));
+      for (uint32_t word : operand.words) add(word);
+    }
+  }
+
+  uint32_t version_;
+  Part globals_;
+  std::unordered_map<uint32_t, Part> functions_;
+};
+
+void ChangeTracker::Update(IRContext* context) {
+  ++version_;
+  uint64_t globals_hash = kFnvOffsetBasis;
+  std::unordered_map<uint32_t, Part> functions;
+  uint32_t function_id = 0;
+  uint64_t function_hash = kFnvOffsetBasis;
+  context->module()->ForEachInst(
+      [&](const Instruction* inst) {
+        if (inst->opcode() == SpvOpFunction) {
+          function_id = inst->result_id();
+          function_hash = kFnvOffsetBasis;
+        }
+        AddInstruction(*inst,
+                       function_id != 0 ? &function_hash : &globals_hash);
+        if (inst->opcode() == SpvOpFunctionEnd) {
+          auto previous = functions_.find(function_id);
+          const bool changed = previous == functions_.end() ||
+                               previous->second.hash != function_hash;
+          functions[function_id] = {
+              function_hash, changed ? version_ : previous->second.version};
+          function_id = 0;
+        }
+      },
+      true);
+  if (globals_hash != globals_.hash) globals_ = {globals_hash, version_};
+  functions_ = std::move(functions);
+}
+
+}  // namespace
+
 Pass::Status PassManager::Run(IRContext* context) {
   auto status = Pass::Status::SuccessWithoutChange;
 
@@ -43,30 +136,111 @@ Pass::Status PassManager::Run(IRContext* context) {
     }
   };
 
+  // What changed in the module, for the fixed-point schedule and for
+  // validating after each pass.
+  const bool fixed_point =
+      max_rounds_ > 0 && pass_keys_.size() == passes_.size();
+  std::unique_ptr<ChangeTracker> tracker;
+  if (fixed_point || validate_after_all_) {
+    tracker.reset(new ChangeTracker(context));
+  }
+
+  // For the fixed-point schedule: the version of the module after each pass
+  // last ran, by the key of the pass.
+  std::unordered_map<std::string, uint32_t> last_run;
+
+  // The module and validation state after the last pass, and the version of
+  // the module they are for, kept so that validating after the next pass only
+  // checks the functions it changed.
+  std::vector<uint32_t> validated_binary;
+  std::unique_ptr<val::ValidationState_t> validation_state;
+  uint32_t validated_version = 0;
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
-  for (auto& pass : passes_) {
-    print_disassembly("; IR before pass ", pass.get());
-    SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
-    const auto one_status = pass->Run(context);
-    if (one_status == Pass::Status::Failure) return one_status;
-    if (one_status == Pass::Status::SuccessWithChange) status = one_status;
-
-    if (validate_after_all_) {
-      spvtools::SpirvTools tools(target_env_);
-      tools.SetMessageConsumer(consumer());
-      std::vector<uint32_t> binary;
-      context->module()->ToBinary(&binary, true);
-      if (!tools.Validate(binary.data(), binary.size(), val_options_)) {
-        std::string msg = "Validation failed after pass ";
-        msg += pass->name();
-        spv_position_t null_pos{0, 0, 0};
-        consumer()(SPV_MSG_INTERNAL_ERROR, "", null_pos, msg.c_str());
-        return Pass::Status::Failure;
+  for (uint32_t round = 1;; ++round) {
+    bool round_modified = false;
+    for (size_t position = 0; position < passes_.size(); ++position) {
+      std::unique_ptr<Pass>& pass = passes_[position];
+
+      // The functions the pass is restricted to, if it is.
+      std::unordered_set<uint32_t> changed_functions;
+      bool restrict_to_changed = false;
+      auto previous_run =
+          fixed_point ? last_run.find(pass_keys_[position]) : last_run.end();
+      if (previous_run != last_run.end() &&
+          !tracker->GlobalsChangedAfter(previous_run->second)) {
+        tracker->GetFunctionsChangedAfter(previous_run->second,
+                                          &changed_functions);
+        if (changed_functions.empty()) {
+          pass.reset(nullptr);
+          continue;
+        }
+        restrict_to_changed = pass->IsFunctionLocal();
+      }
+
+      print_disassembly("; IR before pass ", pass.get());
+      SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
+      if (profile_) profile_->BeginPass(*pass, context);
+      if (restrict_to_changed) {
+        context->set_functions_to_process(&changed_functions);
       }
+      const auto one_status = pass->Run(context);
+      context->set_functions_to_process(nullptr);
+      if (profile_) profile_->EndPass(one_status, context);
+      if (one_status == Pass::Status::Failure) return one_status;
+      if (time_report_stream_) pass->PrintStatistics(*time_report_stream_);
+      if (one_status == Pass::Status::SuccessWithChange) {
+        status = one_status;
+        round_modified = true;
+        if (tracker) tracker->Update(context);
+      }
+      if (fixed_point) last_run[pass_keys_[position]] = tracker->version();
+
+      if (validate_after_all_) {
+        spvtools::Context val_context(target_env_);
+        val_context.SetMessageConsumer(consumer());
+        std::vector<uint32_t> binary;
+        context->module()->ToBinary(&binary, true);
+        std::unordered_set<uint32_t> functions_to_validate;
+        tracker->GetFunctionsChangedAfter(validated_version,
+                                          &functions_to_validate);
+        std::unique_ptr<val::ValidationState_t> state;
+        const spv_result_t result = val::ValidateBinaryAndKeepValidationState(
+            val_context.CContext(), val_options_, binary.data(), binary.size(),
+            nullptr, &state, validation_state.get(), &functions_to_validate);
+        if (result != SPV_SUCCESS) {
+          std::string msg = "Validation failed after pass ";
+          msg += pass->name();
+          spv_position_t null_pos{0, 0, 0};
+          consumer()(SPV_MSG_INTERNAL_ERROR, "", null_pos, msg.c_str());
+          return Pass::Status::Failure;
+        }
+        if (time_report_stream_) {
+          *time_report_stream_ << "Validation after " << pass->name()
+                               << ": " << state->num_unchanged_functions()
+                               << " of " << state->functions().size()
+                               << " functions unchanged" << std::endl;
+        }
+        validation_state = std::move(state);
+        validated_binary = std::move(binary);
+        validated_version = tracker->version();
+      }
+
+      // Reset the pass to free any memory used by the pass.
+      pass.reset(nullptr);
     }
 
-    // Reset the pass to free any memory used by the pass.
-    pass.reset(nullptr);
+    if (!fixed_point || !round_modified || round >= max_rounds_ ||
+        !make_passes_) {
+      break;
+    }
+
+    // Create the passes for the next round.
+    passes_ = make_passes_();
+    if (passes_.size() != pass_keys_.size()) break;
+    for (auto& pass : passes_) {
+      pass->SetMessageConsumer(consumer_);
+    }
   }
   print_disassembly("; IR after last pass", nullptr);
 
@@ -77,6 +251,15 @@ Pass::Status PassManager::Run(IRContext* context) {
   if (status == Pass::Status::SuccessWithChange) {
     context->module()->SetIdBound(context->module()->ComputeIdBound());
   }
+
+  if (time_report_stream_ && context->arena()) {
+    const utils::Arena* arena = context->arena();
+    *time_report_stream_ << "IR arena: " << arena->num_allocations()
+                         << " allocations, " << arena->bytes_reserved()
+                         << " bytes reserved, " << arena->peak_bytes_in_use()
+                         << " bytes peak use, " << arena->bytes_in_use()
+                         << " bytes in use" << std::endl;
+  }
   passes_.clear();
   return status;
 }
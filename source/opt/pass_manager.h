@@ -15,14 +15,17 @@
 #ifndef SOURCE_OPT_PASS_MANAGER_H_
 #define SOURCE_OPT_PASS_MANAGER_H_
 
+#include <functional>
 #include <memory>
 #include <ostream>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "source/opt/log.h"
 #include "source/opt/module.h"
 #include "source/opt/pass.h"
+#include "source/opt/pass_profile.h"
 
 #include "source/opt/ir_context.h"
 #include "spirv-tools/libspirv.hpp"
@@ -35,6 +38,10 @@ namespace opt {
 // to run on a module. Passes are executed in the exact order of addition.
 class PassManager {
  public:
+  // Creates the passes for another round of the fixed-point schedule: the
+  // same passes as the ones added, with the same arguments, in the same order.
+  using PassFactory = std::function<std::vector<std::unique_ptr<Pass>>()>;
+
   // Constructs a pass manager.
   //
   // The constructed instance will have an empty message consumer, which just
@@ -46,7 +53,9 @@ class PassManager {
         time_report_stream_(nullptr),
         target_env_(SPV_ENV_UNIVERSAL_1_2),
         val_options_(nullptr),
-        validate_after_all_(false) {}
+        validate_after_all_(false),
+        profile_(nullptr),
+        max_rounds_(0) {}
 
   // Sets the message consumer to the given |consumer|.
   void SetMessageConsumer(MessageConsumer c) { consumer_ = std::move(c); }
@@ -63,6 +72,13 @@ class PassManager {
   uint32_t NumPasses() const;
   // Returns a pointer to the |index|th pass added.
   inline Pass* GetPass(uint32_t index) const;
+  // Removes all the passes added and returns them.  The passes keep their
+  // message consumer.
+  std::vector<std::unique_ptr<Pass>> TakePasses() {
+    std::vector<std::unique_ptr<Pass>> passes;
+    passes.swap(passes_);
+    return passes;
+  }
 
   // Returns the message consumer.
   inline const MessageConsumer& consumer() const;
@@ -92,6 +108,13 @@ class PassManager {
     return *this;
   }
 
+  // Sets the option to record a profile of each pass into |profile|.  No
+  // profile is recorded if |profile| is null.
+  PassManager& SetPassProfile(PassProfile* profile) {
+    profile_ = profile;
+    return *this;
+  }
+
   // Sets the target environment for validation.
   PassManager& SetTargetEnv(spv_target_env env) {
     target_env_ = env;
@@ -110,6 +133,36 @@ class PassManager {
     return *this;
   }
 
+  // Sets the option to run the passes as a fixed-point schedule, for at most
+  // |max_rounds| rounds.  The schedule is off if |max_rounds| is 0, which is
+  // the default.  In this schedule:
+  //
+  // - After each pass that reports a change, every function and everything
+  //   outside of functions are hashed, to find what the pass changed.
+  // - Passes are told apart by |pass_keys|, which has a key for each pass
+  //   added, in order.  Passes with the same key must do the same thing, so
+  //   a key should hold the arguments of the pass as well as its name, as the
+  //   flag the pass was registered from does.
+  // - A pass is skipped if a pass with the same key has already run, in this
+  //   round or an earlier one, and nothing changed since.  If only some
+  //   functions changed, and nothing outside of them, a function local pass
+  //   is restricted to those.  See Pass::IsFunctionLocal.
+  // - If a round changed the module, and fewer than |max_rounds| rounds have
+  //   run, the passes are created again by |make_passes|, and run again.  The
+  //   schedule stops if it does not create as many passes as there are keys.
+  //
+  // Passes are assumed to reach their own fixed point: running a pass again
+  // on functions it has processed, with nothing changed since, must not
+  // change them.
+  PassManager& SetFixedPoint(uint32_t max_rounds,
+                             std::vector<std::string> pass_keys,
+                             PassFactory make_passes) {
+    max_rounds_ = max_rounds;
+    pass_keys_ = std::move(pass_keys);
+    make_passes_ = std::move(make_passes);
+    return *this;
+  }
+
  private:
   // Consumer for messages.
   MessageConsumer consumer_;
@@ -127,6 +180,15 @@ class PassManager {
   spv_validator_options val_options_;
   // Controls whether validation occurs after every pass.
   bool validate_after_all_;
+  // Where the profile of each pass is recorded, if not null.
+  PassProfile* profile_;
+  // The maximum number of rounds of the fixed-point schedule, or 0 to run the
+  // passes once, in order.
+  uint32_t max_rounds_;
+  // The key of each pass in the fixed-point schedule.
+  std::vector<std::string> pass_keys_;
+  // Creates the passes for the later rounds of the fixed-point schedule.
+  PassFactory make_passes_;
 };
 
 inline void PassManager::AddPass(std::unique_ptr<Pass> pass) {
@@ -0,0 +1,162 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/pass_profile.h"
+
+#include <iomanip>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t CountInstructions(const Module& module) {
+  size_t count = 0;
+  module.ForEachInst([&count](const Instruction*) { ++count; });
+  return count;
+}
+
+double Microseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+const char* StatusName(Pass::Status status) {
+  switch (status) {
+    case Pass::Status::Failure:
+      return "failure";
+    case Pass::Status::SuccessWithChange:
+      return "changed";
+    case Pass::Status::SuccessWithoutChange:
+      return "unchanged";
+  }
+  return "unknown";
+}
+
+// Writes |str| to |out| as a JSON string.
+void WriteJsonString(std::ostream* out, const std::string& str) {
+  *out << '"';
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      *out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      *out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+           << static_cast<int>(c) << std::dec << std::setfill(' ');
+    } else {
+      *out << c;
+    }
+  }
+  *out << '"';
+}
+
+}  // namespace
+
+void PassProfile::BeginPass(const Pass& pass, IRContext* context) {
+  entries_.emplace_back();
+  Entry& entry = entries_.back();
+  entry.pass_name = pass.name();
+  entry.instructions_before = CountInstructions(*context->module());
+  entry.id_bound_before = context->module()->IdBound();
+  context->set_analysis_build_log(&entry.analysis_builds);
+  entry.start = Clock::now();
+}
+
+void PassProfile::EndPass(Pass::Status status, IRContext* context) {
+  Entry& entry = entries_.back();
+  entry.duration = Clock::now() - entry.start;
+  context->set_analysis_build_log(nullptr);
+  entry.status = status;
+  entry.instructions_after = CountInstructions(*context->module());
+  entry.id_bound_after = context->module()->IdBound();
+}
+
+void PassProfile::WriteJson(std::ostream* out) const {
+  const auto saved_flags = out->flags();
+  const auto saved_precision = out->precision();
+  *out << std::fixed << std::setprecision(3) << "{\n  \"passes\": [";
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    const Entry& entry = entries_[i];
+    *out << (i ? ",\n" : "\n") << "    {\"name\": ";
+    WriteJsonString(out, entry.pass_name);
+    *out << ", \"status\": \"" << StatusName(entry.status) << "\""
+         << ", \"wall_us\": " << Microseconds(entry.duration)
+         << ", \"instructions_before\": " << entry.instructions_before
+         << ", \"instructions_after\": " << entry.instructions_after
+         << ", \"id_bound_before\": " << entry.id_bound_before
+         << ", \"id_bound_after\": " << entry.id_bound_after
+         << ", \"analyses\": [";
+
+    // Summarize the builds of each analysis, in the order of the Analysis
+    // enumerants.
+    bool first = true;
+    for (uint32_t bit = IRContext::kAnalysisBegin;
+         bit < IRContext::kAnalysisEnd; bit <<= 1) {
+      uint32_t builds = 0;
+      Clock::duration duration{};
+      for (const auto& build : entry.analysis_builds) {
+        if (build.analysis != bit) continue;
+        ++builds;
+        duration += build.duration;
+      }
+      if (builds == 0) continue;
+      *out << (first ? "" : ", ") << "{\"name\": \""
+           << IRContext::GetAnalysisName(
+                  static_cast<IRContext::Analysis>(bit))
+           << "\", \"builds\": " << builds
+           << ", \"wall_us\": " << Microseconds(duration) << "}";
+      first = false;
+    }
+    *out << "]}";
+  }
+  *out << "\n  ]\n}\n";
+  out->flags(saved_flags);
+  out->precision(saved_precision);
+}
+
+void PassProfile::WriteChromeTrace(std::ostream* out) const {
+  const auto saved_flags = out->flags();
+  const auto saved_precision = out->precision();
+  *out << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+  if (!entries_.empty()) {
+    // Timestamps are relative to the start of the first pass.
+    const Clock::time_point origin = entries_.front().start;
+    bool first = true;
+    for (const Entry& entry : entries_) {
+      *out << (first ? "\n" : ",\n") << "  {\"name\": ";
+      WriteJsonString(out, entry.pass_name);
+      *out << ", \"cat\": \"pass\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1"
+           << ", \"ts\": " << Microseconds(entry.start - origin)
+           << ", \"dur\": " << Microseconds(entry.duration)
+           << ", \"args\": {\"status\": \"" << StatusName(entry.status)
+           << "\", \"instructions_before\": " << entry.instructions_before
+           << ", \"instructions_after\": " << entry.instructions_after
+           << ", \"id_bound_before\": " << entry.id_bound_before
+           << ", \"id_bound_after\": " << entry.id_bound_after << "}}";
+      first = false;
+      for (const auto& build : entry.analysis_builds) {
+        *out << ",\n  {\"name\": \""
+             << IRContext::GetAnalysisName(build.analysis)
+             << "\", \"cat\": \"analysis\", \"ph\": \"X\", \"pid\": 1"
+             << ", \"tid\": 1, \"ts\": " << Microseconds(build.start - origin)
+             << ", \"dur\": " << Microseconds(build.duration) << "}";
+      }
+    }
+  }
+  *out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+  out->flags(saved_flags);
+  out->precision(saved_precision);
+}
+
+}  // namespace opt
+}  // namespace spvtools
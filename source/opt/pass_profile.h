@@ -0,0 +1,79 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_PASS_PROFILE_H_
+#define SOURCE_OPT_PASS_PROFILE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// Collects a profile of the passes run by a PassManager: how long each pass
+// took, how it changed the size of the module, and which analyses were built
+// while it ran.  The profile can be written as JSON, or as Chrome trace events
+// to be viewed in chrome://tracing or Perfetto.
+class PassProfile {
+ public:
+  // The profile of one pass.
+  struct Entry {
+    std::string pass_name;
+    Pass::Status status = Pass::Status::SuccessWithoutChange;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::duration duration{};
+    // The number of instructions in the module before and after the pass.
+    size_t instructions_before = 0;
+    size_t instructions_after = 0;
+    // The id bound of the module before and after the pass.
+    uint32_t id_bound_before = 0;
+    uint32_t id_bound_after = 0;
+    // Every analysis built while the pass ran, in the order they finished.
+    std::vector<IRContext::AnalysisBuild> analysis_builds;
+  };
+
+  // Starts the entry for |pass|, which is about to run on |context|, and
+  // starts recording the analyses built by |context|.
+  void BeginPass(const Pass& pass, IRContext* context);
+
+  // Completes the entry started by the last call to BeginPass.  |status| is
+  // the result of running the pass.
+  void EndPass(Pass::Status status, IRContext* context);
+
+  const std::vector<Entry>& entries() const { return entries_; }
+
+  // Writes the profile to |out| as a JSON document.  It holds one object for
+  // each pass, with the number of builds and the total time of each analysis
+  // built during that pass.
+  void WriteJson(std::ostream* out) const;
+
+  // Writes the profile to |out| in the Chrome trace-event format.  Each pass
+  // and each analysis build is a complete event, with the analysis builds
+  // nested in the pass that caused them.
+  void WriteChromeTrace(std::ostream* out) const;
+
+ private:
+  std::vector<Entry> entries_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_PASS_PROFILE_H_
@@ -17,23 +17,25 @@
 namespace spvtools {
 namespace opt {
 
-void SSAPropagator::AddControlEdge(const Edge& edge) {
-  BasicBlock* dest_bb = edge.dest;
-
-  // Refuse to add the exit block to the work list.
-  if (dest_bb == ctx_->cfg()->pseudo_exit_block()) {
-    return;
+uint32_t SSAPropagator::FindEdge(uint32_t source, uint32_t dest) const {
+  if (source + 1 >= successor_offsets_.size()) return kNoEdge;
+  for (uint32_t edge = successor_offsets_[source];
+       edge < successor_offsets_[source + 1]; ++edge) {
+    if (successors_[edge] == dest) return edge;
   }
+  return kNoEdge;
+}
 
+void SSAPropagator::AddControlEdge(uint32_t source, uint32_t dest) {
   // Try to mark the edge executable.  If it was already in the set of
   // executable edges, do nothing.
-  if (!MarkEdgeExecutable(edge)) {
+  if (!MarkEdgeExecutable(source, dest)) {
     return;
   }
 
   // If the edge had not already been marked executable, add the destination
   // basic block to the work list.
-  blocks_.push(dest_bb);
+  blocks_.push(numbering_->block(dest));
 }
 
 void SSAPropagator::AddSSAEdges(Instruction* instr) {
@@ -64,7 +66,7 @@ bool SSAPropagator::IsPhiArgExecutable(Instruction* phi, uint32_t i) const {
   Instruction* in_label_instr = get_def_use_mgr()->GetDef(in_label_id);
   BasicBlock* in_bb = ctx_->get_instr_block(in_label_instr);
 
-  return IsEdgeExecutable(Edge(in_bb, phi_bb));
+  return IsEdgeExecutable(Number(in_bb), Number(phi_bb));
 }
 
 bool SSAPropagator::SetStatus(Instruction* inst, PropStatus status) {
@@ -79,7 +81,13 @@ bool SSAPropagator::SetStatus(Instruction* inst, PropStatus status) {
          "Invalid lattice transition");
 
   bool status_changed = !has_old_status || (old_status != status);
-  if (status_changed) statuses_[inst] = status;
+  if (status_changed) {
+    const uint32_t number = Number(inst);
+    assert(number != InstructionNumbering::kNoNumber &&
+           "Only instructions in the function have a status.");
+    statuses_[number] = status;
+    has_status_.Set(number);
+  }
 
   return status_changed;
 }
@@ -107,9 +115,10 @@ bool SSAPropagator::Simulate(Instruction* instr) {
     // If |instr| is a block terminator, add all the control edges out of its
     // block.
     if (instr->IsBlockTerminator()) {
-      BasicBlock* block = ctx_->get_instr_block(instr);
-      for (const auto& e : bb_succs_.at(block)) {
-        AddControlEdge(e);
+      const uint32_t block = Number(ctx_->get_instr_block(instr));
+      for (uint32_t edge = successor_offsets_[block];
+           edge < successor_offsets_[block + 1]; ++edge) {
+        AddControlEdge(block, successors_[edge]);
       }
     }
     return false;
@@ -123,7 +132,7 @@ bool SSAPropagator::Simulate(Instruction* instr) {
     // If there are multiple outgoing control flow edges and we know which one
     // will be taken, add the destination block to the CFG work list.
     if (dest_bb) {
-      AddControlEdge(Edge(ctx_->get_instr_block(instr), dest_bb));
+      AddControlEdge(Number(ctx_->get_instr_block(instr)), Number(dest_bb));
     }
     changed = true;
   }
@@ -173,10 +182,6 @@ bool SSAPropagator::Simulate(Instruction* instr) {
 }
 
 bool SSAPropagator::Simulate(BasicBlock* block) {
-  if (block == ctx_->cfg()->pseudo_exit_block()) {
-    return false;
-  }
-
   // Always simulate Phi instructions, even if we have simulated this block
   // before. We do this because Phi instructions receive their inputs from
   // incoming edges. When those edges are marked executable, the corresponding
@@ -198,8 +203,9 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 
     // If this block has exactly one successor, mark the edge to its successor
     // as executable.
-    if (bb_succs_.at(block).size() == 1) {
-      AddControlEdge(bb_succs_.at(block).at(0));
+    const uint32_t number = Number(block);
+    if (successor_offsets_[number + 1] - successor_offsets_[number] == 1) {
+      AddControlEdge(number, successors_[successor_offsets_[number]]);
     }
   }
 
@@ -207,33 +213,34 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 }
 
 void SSAPropagator::Initialize(Function* fn) {
-  // Compute predecessor and successor blocks for every block in |fn|'s CFG.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  bb_succs_[ctx_->cfg()->pseudo_entry_block()].push_back(
-      Edge(ctx_->cfg()->pseudo_entry_block(), fn->entry().get()));
-
-  for (auto& block : *fn) {
-    const auto& const_block = block;
-    const_block.ForEachSuccessorLabel([this, &block](const uint32_t label_id) {
-      BasicBlock* succ_bb =
-          ctx_->get_instr_block(get_def_use_mgr()->GetDef(label_id));
-      bb_succs_[&block].push_back(Edge(&block, succ_bb));
-      bb_preds_[succ_bb].push_back(Edge(succ_bb, &block));
+  numbering_.reset(new InstructionNumbering(fn));
+  const uint32_t num_blocks = numbering_->num_blocks();
+
+  // Lay out the successors of every block of |fn|, by block number.  The
+  // pseudo entry block is block |num_blocks|.
+  successor_offsets_.clear();
+  successors_.clear();
+  for (uint32_t i = 0; i < num_blocks; ++i) {
+    successor_offsets_.push_back(static_cast<uint32_t>(successors_.size()));
+    const BasicBlock* block = numbering_->block(i);
+    block->ForEachSuccessorLabel([this](const uint32_t label_id) {
+      successors_.push_back(
+          numbering_->Get(get_def_use_mgr()->GetDef(label_id)));
     });
-    if (block.IsReturnOrAbort()) {
-      bb_succs_[&block].push_back(
-          Edge(&block, ctx_->cfg()->pseudo_exit_block()));
-      bb_preds_[ctx_->cfg()->pseudo_exit_block()].push_back(
-          Edge(ctx_->cfg()->pseudo_exit_block(), &block));
-    }
-  }
-
-  // Add the edges out of the entry block to seed the propagator.
-  const auto& entry_succs = bb_succs_[ctx_->cfg()->pseudo_entry_block()];
-  for (const auto& e : entry_succs) {
-    AddControlEdge(e);
   }
+  successor_offsets_.push_back(static_cast<uint32_t>(successors_.size()));
+  successors_.push_back(0);
+  successor_offsets_.push_back(static_cast<uint32_t>(successors_.size()));
+
+  simulated_blocks_ = utils::BitVector(num_blocks);
+  do_not_simulate_ = utils::BitVector(numbering_->size());
+  executable_edges_ = utils::BitVector(
+      static_cast<uint32_t>(successors_.size()));
+  statuses_.assign(numbering_->size(), kVarying);
+  has_status_ = utils::BitVector(numbering_->size());
+
+  // Add the edge out of the pseudo entry block to seed the propagator.
+  AddControlEdge(num_blocks, 0);
 }
 
 bool SSAPropagator::Run(Function* fn) {
@@ -16,33 +16,18 @@
 #define SOURCE_OPT_PROPAGATOR_H_
 
 #include <functional>
+#include <memory>
 #include <queue>
-#include <set>
-#include <unordered_map>
-#include <unordered_set>
-#include <utility>
 #include <vector>
 
+#include "source/opt/instruction_numbering.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/module.h"
+#include "source/util/bit_vector.h"
 
 namespace spvtools {
 namespace opt {
 
-// Represents a CFG control edge.
-struct Edge {
-  Edge(BasicBlock* b1, BasicBlock* b2) : source(b1), dest(b2) {
-    assert(source && "CFG edges cannot have a null source block.");
-    assert(dest && "CFG edges cannot have a null destination block.");
-  }
-  BasicBlock* source;
-  BasicBlock* dest;
-  bool operator<(const Edge& o) const {
-    return std::make_pair(source->id(), dest->id()) <
-           std::make_pair(o.source->id(), o.dest->id());
-  }
-};
-
 // This class implements a generic value propagation algorithm based on the
 // conditional constant propagation algorithm proposed in
 //
@@ -200,12 +185,16 @@ class SSAPropagator {
 
   // Returns true if |inst| has a recorded status. This will be true once |inst|
   // has been simulated once.
-  bool HasStatus(Instruction* inst) const { return statuses_.count(inst); }
+  bool HasStatus(Instruction* inst) const {
+    const uint32_t number = Number(inst);
+    return number != InstructionNumbering::kNoNumber &&
+           has_status_.Get(number);
+  }
 
   // Returns the current propagation status of |inst|. Assumes
   // |HasStatus(inst)| returns true.
   PropStatus Status(Instruction* inst) const {
-    return statuses_.find(inst)->second;
+    return statuses_[Number(inst)];
   }
 
   // Records the propagation status |status| for |inst|. Returns true if the
@@ -226,33 +215,60 @@ class SSAPropagator {
   // the value computed by |instr|.
   bool Simulate(Instruction* instr);
 
-  // Returns true if |instr| should be simulated again.
+  // Returns the number of |inst| in |numbering_|, or kNoNumber if |inst| is
+  // not an instruction of the function being propagated.
+  uint32_t Number(const Instruction* inst) const {
+    return numbering_ ? numbering_->Get(inst)
+                      : InstructionNumbering::kNoNumber;
+  }
+
+  // Returns true if |instr| should be simulated again.  Instructions outside
+  // the function, like constants, are never marked.
   bool ShouldSimulateAgain(Instruction* instr) const {
-    return do_not_simulate_.find(instr) == do_not_simulate_.end();
+    const uint32_t number = Number(instr);
+    return number == InstructionNumbering::kNoNumber ||
+           !do_not_simulate_.Get(number);
   }
 
   // Add |instr| to the set of instructions not to simulate again.
-  void DontSimulateAgain(Instruction* instr) { do_not_simulate_.insert(instr); }
+  void DontSimulateAgain(Instruction* instr) {
+    do_not_simulate_.Set(Number(instr));
+  }
 
   // Returns true if |block| has been simulated already.
   bool BlockHasBeenSimulated(BasicBlock* block) const {
-    return simulated_blocks_.find(block) != simulated_blocks_.end();
+    return block != nullptr && simulated_blocks_.Get(Number(block));
   }
 
   // Marks block |block| as simulated.
   void MarkBlockSimulated(BasicBlock* block) {
-    simulated_blocks_.insert(block);
+    simulated_blocks_.Set(Number(block));
   }
 
-  // Marks |edge| as executable.  Returns false if the edge was already marked
-  // as executable.
-  bool MarkEdgeExecutable(const Edge& edge) {
-    return executable_edges_.insert(edge).second;
+  // Returns the number of |block| in |numbering_|.
+  uint32_t Number(const BasicBlock* block) const {
+    return Number(block->GetLabelInst());
   }
 
-  // Returns true if |edge| has been marked as executable.
-  bool IsEdgeExecutable(const Edge& edge) const {
-    return executable_edges_.find(edge) != executable_edges_.end();
+  // Returns the position in |successors_| of the edge from block |source| to
+  // block |dest|, or kNoEdge if there is no such edge.  When |source| branches
+  // to |dest| more than once, the first of these edges stands for all of
+  // them.
+  uint32_t FindEdge(uint32_t source, uint32_t dest) const;
+
+  // Marks the edge from block |source| to block |dest| as executable.  Returns
+  // false if the edge was already marked as executable.
+  bool MarkEdgeExecutable(uint32_t source, uint32_t dest) {
+    const uint32_t edge = FindEdge(source, dest);
+    assert(edge != kNoEdge && "Not an edge of the CFG.");
+    return !executable_edges_.Set(edge);
+  }
+
+  // Returns true if the edge from block |source| to block |dest| has been
+  // marked as executable.
+  bool IsEdgeExecutable(uint32_t source, uint32_t dest) const {
+    const uint32_t edge = FindEdge(source, dest);
+    return edge != kNoEdge && executable_edges_.Get(edge);
   }
 
   // Returns a pointer to the def-use manager for |ctx_|.
@@ -260,9 +276,9 @@ class SSAPropagator {
     return ctx_->get_def_use_mgr();
   }
 
-  // If the CFG edge |e| has not been executed, this function adds |e|'s
-  // destination block to the work list.
-  void AddControlEdge(const Edge& e);
+  // If the CFG edge from block |source| to block |dest| has not been
+  // executed, this function adds |dest| to the work list.
+  void AddControlEdge(uint32_t source, uint32_t dest);
 
   // Adds all the instructions that use the result of |instr| to the SSA edges
   // work list. If |instr| produces no result id, this does nothing.
@@ -284,28 +300,33 @@ class SSAPropagator {
   // Blocks to simulate.
   std::queue<BasicBlock*> blocks_;
 
+  // Numbers the blocks and instructions of the function being propagated.
+  // The sets and maps below are indexed by these numbers.
+  std::unique_ptr<InstructionNumbering> numbering_;
+
   // Blocks simulated during propagation.
-  std::unordered_set<BasicBlock*> simulated_blocks_;
+  utils::BitVector simulated_blocks_;
 
   // Set of instructions that should not be simulated again because they have
   // been found to be in the kVarying state.
-  std::unordered_set<Instruction*> do_not_simulate_;
-
-  // Map between a basic block and its predecessor edges.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_preds_;
-
-  // Map between a basic block and its successor edges.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_succs_;
-
-  // Set of executable CFG edges.
-  std::set<Edge> executable_edges_;
-
-  // Tracks instruction propagation status.
-  std::unordered_map<Instruction*, SSAPropagator::PropStatus> statuses_;
+  utils::BitVector do_not_simulate_;
+
+  // The edges of the CFG.  The successors of block |b| are at positions
+  // [successor_offsets_[b], successor_offsets_[b + 1]) of |successors_|.  The
+  // pseudo entry block is numbered after the blocks of the function, and
+  // branches to the entry block.  Edges to the pseudo exit block are left
+  // out, since they are never followed.
+  static const uint32_t kNoEdge = 0xFFFFFFFF;
+  std::vector<uint32_t> successor_offsets_;
+  std::vector<uint32_t> successors_;
+
+  // Set of executable CFG edges, by position in |successors_|.
+  utils::BitVector executable_edges_;
+
+  // Tracks instruction propagation status.  The status of an instruction is
+  // only meaningful if its bit in |has_status_| is set.
+  std::vector<PropStatus> statuses_;
+  utils::BitVector has_status_;
 };
 
 std::ostream& operator<<(std::ostream& str,
@@ -14,6 +14,11 @@
 
 #include "source/opt/redundancy_elimination.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/ir_builder.h"
 #include "source/opt/value_number_table.h"
 
 namespace spvtools {
@@ -23,18 +28,23 @@ Pass::Status RedundancyEliminationPass::Process() {
   bool modified = false;
   ValueNumberTable vnTable(context());
 
+  // The table is kept up to date by the partial redundancy elimination, so it
+  // can be used for the total redundancy elimination that follows.
+  if (remove_partial_redundancies_) {
+    for (auto& func : *get_module()) {
+      if (EliminatePartialRedundancies(&func, &vnTable)) {
+        modified = true;
+      }
+    }
+  }
+
   for (auto& func : *get_module()) {
     // Build the dominator tree for this function. It is how the code is
     // traversed.
     DominatorTree& dom_tree =
         context()->GetDominatorAnalysis(&func)->GetDomTree();
 
-    // Keeps track of all ids that contain a given value number. We keep
-    // track of multiple values because they could have the same value, but
-    // different decorations.
-    std::map<uint32_t, uint32_t> value_to_ids;
-
-    if (EliminateRedundanciesFrom(dom_tree.GetRoot(), vnTable, value_to_ids)) {
+    if (EliminateRedundanciesFrom(dom_tree.GetRoot(), vnTable)) {
       modified = true;
     }
   }
@@ -42,15 +52,248 @@ Pass::Status RedundancyEliminationPass::Process() {
 }
 
 bool RedundancyEliminationPass::EliminateRedundanciesFrom(
-    DominatorTreeNode* bb, const ValueNumberTable& vnTable,
-    std::map<uint32_t, uint32_t> value_to_ids) {
-  bool modified = EliminateRedundanciesInBB(bb->bb_, vnTable, &value_to_ids);
+    DominatorTreeNode* bb, const ValueNumberTable& vnTable) {
+  bool modified = false;
 
-  for (auto dominated_bb : bb->children_) {
-    modified |= EliminateRedundanciesFrom(dominated_bb, vnTable, value_to_ids);
+  // Keeps track of the id that holds each value number in the blocks that
+  // dominate the current one.  The values added by each block are recorded in
+  // |added_values|, so that they can be removed when the block is left.
+  std::unordered_map<uint32_t, uint32_t> value_to_ids;
+  std::vector<uint32_t> added_values;
+
+  // The path from |bb| to the current block in the dominator tree.  For each
+  // block, holds the index of the next child to visit, and the size of
+  // |added_values| before the block was entered.
+  struct Scope {
+    DominatorTreeNode* node;
+    size_t next_child;
+    size_t first_added_value;
+  };
+  std::vector<Scope> scopes;
+
+  auto enter = [&](DominatorTreeNode* node) {
+    scopes.push_back({node, 0, added_values.size()});
+    modified |= EliminateRedundanciesInBB(node->bb_, vnTable, &value_to_ids,
+                                          &added_values);
+  };
+
+  enter(bb);
+  while (!scopes.empty()) {
+    Scope& scope = scopes.back();
+    if (scope.next_child < scope.node->children_.size()) {
+      DominatorTreeNode* child = scope.node->children_[scope.next_child++];
+      enter(child);
+      continue;
+    }
+
+    for (size_t i = scope.first_added_value; i < added_values.size(); ++i) {
+      value_to_ids.erase(added_values[i]);
+    }
+    added_values.resize(scope.first_added_value);
+    scopes.pop_back();
   }
 
   return modified;
 }
+
+bool RedundancyEliminationPass::EliminatePartialRedundancies(
+    Function* func, ValueNumberTable* vn_table) {
+  DominatorAnalysis* dom = context()->GetDominatorAnalysis(func);
+  analysis::DefUseManager* def_use_mgr = context()->get_def_use_mgr();
+
+  // The instructions in |func| that compute each value number.
+  std::unordered_map<uint32_t, std::vector<Instruction*>> value_to_defs;
+  for (auto& block : *func) {
+    for (auto& inst : block) {
+      if (inst.result_id() == 0) continue;
+      uint32_t value = vn_table->GetValueNumber(&inst);
+      if (value != 0) value_to_defs[value].push_back(&inst);
+    }
+  }
+
+  bool modified = false;
+  std::vector<Instruction*> insts;
+  for (auto& block : *func) {
+    std::vector<uint32_t> preds = cfg()->preds(block.id());
+    std::sort(preds.begin(), preds.end());
+    preds.erase(std::unique(preds.begin(), preds.end()), preds.end());
+    if (preds.size() < 2) continue;
+
+    // Values are not moved around a back edge, and all of the predecessors
+    // must be reachable for the value to be computed in them.
+    bool is_candidate = dom->IsReachable(&block);
+    for (uint32_t pred_id : preds) {
+      if (!dom->IsReachable(pred_id) || dom->Dominates(block.id(), pred_id)) {
+        is_candidate = false;
+      }
+    }
+    if (!is_candidate) continue;
+
+    // Replacing an instruction changes the operands of the instructions that
+    // follow it, so they are checked one at a time.
+    insts.clear();
+    for (auto& inst : block) {
+      insts.push_back(&inst);
+    }
+
+    for (Instruction* inst : insts) {
+      if (!IsPartialRedundancyCandidate(inst, &block)) continue;
+      const uint32_t value = vn_table->GetValueNumber(inst);
+      if (value == 0) continue;
+
+      // A value that is already computed on every path to |inst| is fully
+      // redundant, so |inst| is replaced by that computation and no phi is
+      // needed.
+      Instruction* dominating_def = nullptr;
+      for (Instruction* def : value_to_defs[value]) {
+        if (def != inst && dom->Dominates(def, inst)) {
+          dominating_def = def;
+          break;
+        }
+      }
+      if (dominating_def != nullptr) {
+        std::vector<Instruction*>& defs = value_to_defs[value];
+        defs.erase(std::find(defs.begin(), defs.end(), inst));
+        vn_table->RemoveInstruction(inst);
+        context()->ReplaceAllUsesWith(inst->result_id(),
+                                      dominating_def->result_id());
+        context()->KillInst(inst);
+        modified = true;
+        continue;
+      }
+
+      // Find the id holding the value at the end of each predecessor.
+      std::vector<uint32_t> available(preds.size(), 0);
+      bool is_partially_available = false;
+      bool can_insert = true;
+      for (size_t i = 0; i < preds.size(); ++i) {
+        BasicBlock* pred = cfg()->block(preds[i]);
+        for (Instruction* def : value_to_defs[value]) {
+          BasicBlock* def_block = context()->get_instr_block(def);
+          if (def != inst && dom->Dominates(def_block, pred)) {
+            available[i] = def->result_id();
+            break;
+          }
+        }
+
+        // A predecessor with several successors would need its edge to the
+        // block to be split.
+        if (available[i] != 0) {
+          is_partially_available = true;
+        } else if (pred->tail()->opcode() != SpvOpBranch) {
+          can_insert = false;
+        }
+      }
+      if (!is_partially_available || !can_insert) continue;
+
+      // Compute the value in the predecessors where it is not available.
+      for (size_t i = 0; i < preds.size(); ++i) {
+        if (available[i] != 0) continue;
+        BasicBlock* pred = cfg()->block(preds[i]);
+        uint32_t new_id = TakeNextId();
+        if (new_id == 0) {
+          return modified;
+        }
+
+        std::unique_ptr<Instruction> copy(inst->Clone(context()));
+        copy->SetResultId(new_id);
+        Instruction* insert_before = pred->GetMergeInst();
+        if (insert_before == nullptr) insert_before = pred->terminator();
+        Instruction* new_inst = insert_before->InsertBefore(std::move(copy));
+        def_use_mgr->AnalyzeInstDefUse(new_inst);
+        context()->set_instr_block(new_inst, pred);
+        vn_table->AssignValueNumber(new_inst);
+        value_to_defs[value].push_back(new_inst);
+        available[i] = new_id;
+        modified = true;
+      }
+
+      // Replace |inst| by a phi of the values from the predecessors.
+      std::vector<uint32_t> incomings;
+      for (size_t i = 0; i < preds.size(); ++i) {
+        incomings.push_back(available[i]);
+        incomings.push_back(preds[i]);
+      }
+      InstructionBuilder builder(
+          context(), &*block.begin(),
+          IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+      Instruction* phi = builder.AddPhi(inst->type_id(), incomings);
+      if (phi == nullptr) {
+        return modified;
+      }
+      vn_table->AssignValueNumber(phi);
+
+      std::vector<Instruction*>& defs = value_to_defs[value];
+      defs.erase(std::find(defs.begin(), defs.end(), inst));
+      defs.push_back(phi);
+      vn_table->RemoveInstruction(inst);
+      context()->ReplaceAllUsesWith(inst->result_id(), phi->result_id());
+      context()->KillInst(inst);
+    }
+  }
+  return modified;
+}
+
+bool RedundancyEliminationPass::IsPartialRedundancyCandidate(
+    Instruction* inst, BasicBlock* block) {
+  if (inst->result_id() == 0 || inst->type_id() == 0) {
+    return false;
+  }
+
+  switch (inst->opcode()) {
+    case SpvOpPhi:
+    case SpvOpVariable:
+    case SpvOpSampledImage:
+    case SpvOpImage:
+      return false;
+    // Implicit derivatives are computed from the neighbouring invocations,
+    // which may not all take the same predecessor, so moving them into a
+    // predecessor changes their result.
+    case SpvOpImageSampleImplicitLod:
+    case SpvOpImageSampleDrefImplicitLod:
+    case SpvOpImageSampleProjImplicitLod:
+    case SpvOpImageSampleProjDrefImplicitLod:
+    case SpvOpImageSparseSampleImplicitLod:
+    case SpvOpImageSparseSampleDrefImplicitLod:
+    case SpvOpImageSparseSampleProjImplicitLod:
+    case SpvOpImageSparseSampleProjDrefImplicitLod:
+    case SpvOpImageQueryLod:
+    case SpvOpDPdx:
+    case SpvOpDPdy:
+    case SpvOpFwidth:
+    case SpvOpDPdxFine:
+    case SpvOpDPdyFine:
+    case SpvOpFwidthFine:
+    case SpvOpDPdxCoarse:
+    case SpvOpDPdyCoarse:
+    case SpvOpFwidthCoarse:
+      return false;
+    default:
+      break;
+  }
+
+  // The logical addressing model does not allow phis of pointers, which
+  // access chains and copies of pointers would be replaced by.
+  if (get_def_use_mgr()->GetDef(inst->type_id())->opcode() ==
+      SpvOpTypePointer) {
+    return false;
+  }
+
+  if (!context()->IsCombinatorInstruction(inst) || inst->IsLoad()) {
+    return false;
+  }
+
+  // The copies would need the same decorations.
+  if (!get_decoration_mgr()
+           ->GetDecorationsFor(inst->result_id(), false)
+           .empty()) {
+    return false;
+  }
+
+  return inst->WhileEachInId([this, block](const uint32_t* id) {
+    return context()->get_instr_block(*id) != block;
+  });
+}
+
 }  // namespace opt
 }  // namespace spvtools
@@ -15,8 +15,6 @@
 #ifndef SOURCE_OPT_REDUNDANCY_ELIMINATION_H_
 #define SOURCE_OPT_REDUNDANCY_ELIMINATION_H_
 
-#include <map>
-
 #include "source/opt/ir_context.h"
 #include "source/opt/local_redundancy_elimination.h"
 #include "source/opt/pass.h"
@@ -29,9 +27,21 @@ namespace opt {
 // local redundancy elimination except it looks across basic block boundaries.
 // An instruction, inst, is totally redundant if there is another instruction
 // that dominates inst, and also computes the same value.
+//
+// If |remove_partial_redundancies| is true, the pass first removes partial
+// redundancies, in the manner of GVN-PRE.  An instruction in a block with
+// several predecessors is partially redundant if its value is available at the
+// end of some of the predecessors.  The instruction is computed at the end of
+// the other predecessors, and replaced by an OpPhi of the values.
 class RedundancyEliminationPass : public LocalRedundancyEliminationPass {
  public:
-  const char* name() const override { return "redundancy-elimination"; }
+  explicit RedundancyEliminationPass(bool remove_partial_redundancies = false)
+      : remove_partial_redundancies_(remove_partial_redundancies) {}
+
+  const char* name() const override {
+    return remove_partial_redundancies_ ? "partial-redundancy-elimination"
+                                        : "redundancy-elimination";
+  }
   Status Process() override;
 
  protected:
@@ -40,14 +50,28 @@ class RedundancyEliminationPass : public LocalRedundancyEliminationPass {
   // |vnTable| must have computed a value number for every result id defined
   // in the function containing |bb|.
   //
-  // |value_to_ids| is a map from value number to ids.  If {vn, id} is in
-  // |value_to_ids| then vn is the value number of id, and the defintion of id
-  // dominates |bb|.
+  // The ids holding the value numbers are kept in a single table, scoped by
+  // the dominator tree: the values computed in a block are removed from it
+  // once the blocks it dominates are done.
   //
   // Returns true if at least one instruction is deleted.
   bool EliminateRedundanciesFrom(DominatorTreeNode* bb,
-                                 const ValueNumberTable& vnTable,
-                                 std::map<uint32_t, uint32_t> value_to_ids);
+                                 const ValueNumberTable& vnTable);
+
+ private:
+  // Removes the partial redundancies in |func|.  |vn_table| is updated for the
+  // instructions that are added.  Returns true if |func| is changed.
+  bool EliminatePartialRedundancies(Function* func,
+                                    ValueNumberTable* vn_table);
+
+  // Returns true if |inst| is a candidate for partial redundancy elimination
+  // in |block|: it can be computed again anywhere its operands are available
+  // with the same result, it can be replaced by a phi, and its operands are
+  // all defined outside of |block|.
+  bool IsPartialRedundancyCandidate(Instruction* inst, BasicBlock* block);
+
+  // Whether partial redundancies are removed.
+  const bool remove_partial_redundancies_;
 };
 
 }  // namespace opt
@@ -21,30 +21,16 @@
 #include "source/opt/def_use_manager.h"
 #include "source/opt/dominator_tree.h"
 #include "source/opt/function.h"
+#include "source/opt/instruction_numbering.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/iterator.h"
+#include "source/util/bit_vector.h"
+#include "source/util/sparse_bit_vector.h"
 
 namespace spvtools {
 namespace opt {
 
 namespace {
-// Predicate for the FilterIterator to only consider instructions that are not
-// phi instructions defined in the basic block |bb|.
-class ExcludePhiDefinedInBlock {
- public:
-  ExcludePhiDefinedInBlock(IRContext* context, const BasicBlock* bb)
-      : context_(context), bb_(bb) {}
-
-  bool operator()(Instruction* insn) const {
-    return !(insn->opcode() == SpvOpPhi &&
-             context_->get_instr_block(insn) == bb_);
-  }
-
- private:
-  IRContext* context_;
-  const BasicBlock* bb_;
-};
-
 // Returns true if |insn| generates a SSA register that is likely to require a
 // physical register.
 bool CreatesRegisterUsage(Instruction* insn) {
@@ -59,17 +45,24 @@ bool CreatesRegisterUsage(Instruction* insn) {
 // fill-up some information about the pick register usage and a break down of
 // register usage. This implements: "A non-iterative data-flow algorithm for
 // computing liveness sets in strict ssa programs" from Boissinot et al.
+//
+// The live sets are computed as sparse bit vectors over a numbering of the
+// instructions of the function, and are only turned into the sets of
+// instructions held by |reg_pressure| once they are final.
 class ComputeRegisterLiveness {
  public:
   ComputeRegisterLiveness(RegisterLiveness* reg_pressure, Function* f)
       : reg_pressure_(reg_pressure),
-        context_(reg_pressure->GetContext()),
         function_(f),
         cfg_(*reg_pressure->GetContext()->cfg()),
         def_use_manager_(*reg_pressure->GetContext()->get_def_use_mgr()),
         dom_tree_(
             reg_pressure->GetContext()->GetDominatorAnalysis(f)->GetDomTree()),
-        loop_desc_(*reg_pressure->GetContext()->GetLoopDescriptor(f)) {}
+        loop_desc_(*reg_pressure->GetContext()->GetLoopDescriptor(f)),
+        numbering_(f),
+        processed_(numbering_.num_blocks()),
+        live_in_(numbering_.num_blocks()),
+        live_out_(numbering_.num_blocks()) {}
 
   // Computes the register liveness for |function_| and then estimate the
   // register usage. The liveness algorithm works in 2 steps:
@@ -79,11 +72,11 @@ class ComputeRegisterLiveness {
   //   (add iterative values into the liveness set).
   void Compute() {
     for (BasicBlock& start_bb : *function_) {
-      if (reg_pressure_->Get(start_bb.id()) != nullptr) {
+      if (processed_.Get(numbering_.Get(&start_bb))) {
         continue;
       }
       cfg_.ForEachBlockInPostOrder(&start_bb, [this](BasicBlock* bb) {
-        if (reg_pressure_->Get(bb->id()) == nullptr) {
+        if (!processed_.Get(numbering_.Get(bb))) {
           ComputePartialLiveness(bb);
         }
       });
@@ -95,8 +88,7 @@ class ComputeRegisterLiveness {
  private:
   // Registers all SSA register used by successors of |bb| in their phi
   // instructions.
-  void ComputePhiUses(const BasicBlock& bb,
-                      RegisterLiveness::RegionRegisterLiveness::LiveSet* live) {
+  void ComputePhiUses(const BasicBlock& bb, utils::SparseBitVector* live) {
     uint32_t bb_id = bb.id();
     bb.ForEachSuccessorLabel([live, bb_id, this](uint32_t sid) {
       BasicBlock* succ_bb = cfg_.block(sid);
@@ -106,7 +98,7 @@ class ComputeRegisterLiveness {
             Instruction* insn_op =
                 def_use_manager_.GetDef(phi->GetSingleWordInOperand(i));
             if (CreatesRegisterUsage(insn_op)) {
-              live->insert(insn_op);
+              live->Set(numbering_.GetOrAssign(insn_op));
               break;
             }
           }
@@ -118,44 +110,47 @@ class ComputeRegisterLiveness {
   // Computes register liveness for each basic blocks but ignores all
   // back-edges.
   void ComputePartialLiveness(BasicBlock* bb) {
-    assert(reg_pressure_->Get(bb) == nullptr &&
-           "Basic block already processed");
+    const uint32_t bb_number = numbering_.Get(bb);
+    assert(!processed_.Get(bb_number) && "Basic block already processed");
+    processed_.Set(bb_number);
 
-    RegisterLiveness::RegionRegisterLiveness* live_inout =
-        reg_pressure_->GetOrInsert(bb->id());
-    ComputePhiUses(*bb, &live_inout->live_out_);
+    utils::SparseBitVector& live_out = live_out_[bb_number];
+    ComputePhiUses(*bb, &live_out);
 
     const BasicBlock* cbb = bb;
-    cbb->ForEachSuccessorLabel([&live_inout, bb, this](uint32_t sid) {
+    cbb->ForEachSuccessorLabel([&live_out, bb, this](uint32_t sid) {
       // Skip back edges.
       if (dom_tree_.Dominates(sid, bb->id())) {
         return;
       }
 
       BasicBlock* succ_bb = cfg_.block(sid);
-      RegisterLiveness::RegionRegisterLiveness* succ_live_inout =
-          reg_pressure_->Get(succ_bb);
-      assert(succ_live_inout &&
+      const uint32_t succ_number = numbering_.Get(succ_bb);
+      assert(processed_.Get(succ_number) &&
              "Successor liveness analysis was not performed");
 
-      ExcludePhiDefinedInBlock predicate(context_, succ_bb);
-      auto filter =
-          MakeFilterIteratorRange(succ_live_inout->live_in_.begin(),
-                                  succ_live_inout->live_in_.end(), predicate);
-      live_inout->live_out_.insert(filter.begin(), filter.end());
+      // Add the values live into the successor, except for the phis it
+      // defines.
+      utils::SparseBitVector before = live_out;
+      live_out.Or(live_in_[succ_number]);
+      succ_bb->ForEachPhiInst([&live_out, &before, this](Instruction* phi) {
+        const uint32_t phi_number = numbering_.Get(phi);
+        if (!before.Get(phi_number)) live_out.Clear(phi_number);
+      });
     });
 
-    live_inout->live_in_ = live_inout->live_out_;
+    utils::SparseBitVector& live_in = live_in_[bb_number];
+    live_in = live_out;
     for (Instruction& insn : make_range(bb->rbegin(), bb->rend())) {
       if (insn.opcode() == SpvOpPhi) {
-        live_inout->live_in_.insert(&insn);
+        live_in.Set(numbering_.Get(&insn));
         break;
       }
-      live_inout->live_in_.erase(&insn);
-      insn.ForEachInId([live_inout, this](uint32_t* id) {
+      live_in.Clear(numbering_.Get(&insn));
+      insn.ForEachInId([&live_in, this](uint32_t* id) {
         Instruction* insn_op = def_use_manager_.GetDef(*id);
         if (CreatesRegisterUsage(insn_op)) {
-          live_inout->live_in_.insert(insn_op);
+          live_in.Set(numbering_.GetOrAssign(insn_op));
         }
       });
     }
@@ -178,30 +173,28 @@ class ComputeRegisterLiveness {
                  loop_desc_[bb_id] == &loop;
         });
 
-    RegisterLiveness::RegionRegisterLiveness* header_live_inout =
-        reg_pressure_->Get(loop.GetHeaderBlock());
-    assert(header_live_inout &&
+    const uint32_t header_number = numbering_.Get(loop.GetHeaderBlock());
+    assert(processed_.Get(header_number) &&
            "Liveness analysis was not performed for the current block");
 
-    ExcludePhiDefinedInBlock predicate(context_, loop.GetHeaderBlock());
-    auto live_loop =
-        MakeFilterIteratorRange(header_live_inout->live_in_.begin(),
-                                header_live_inout->live_in_.end(), predicate);
+    // The values live into the header, except for the phis it defines.
+    utils::SparseBitVector live_loop = live_in_[header_number];
+    cfg_.block(loop.GetHeaderBlock()->id())
+        ->ForEachPhiInst([&live_loop, this](Instruction* phi) {
+          live_loop.Clear(numbering_.Get(phi));
+        });
 
     for (uint32_t bb_id : blocks_in_loop) {
-      BasicBlock* bb = cfg_.block(bb_id);
-
-      RegisterLiveness::RegionRegisterLiveness* live_inout =
-          reg_pressure_->Get(bb);
-      live_inout->live_in_.insert(live_loop.begin(), live_loop.end());
-      live_inout->live_out_.insert(live_loop.begin(), live_loop.end());
+      const uint32_t bb_number = numbering_.Get(cfg_.block(bb_id));
+      live_in_[bb_number].Or(live_loop);
+      live_out_[bb_number].Or(live_loop);
     }
 
     for (const Loop* inner_loop : loop) {
-      RegisterLiveness::RegionRegisterLiveness* live_inout =
-          reg_pressure_->Get(inner_loop->GetHeaderBlock());
-      live_inout->live_in_.insert(live_loop.begin(), live_loop.end());
-      live_inout->live_out_.insert(live_loop.begin(), live_loop.end());
+      const uint32_t inner_number =
+          numbering_.Get(inner_loop->GetHeaderBlock());
+      live_in_[inner_number].Or(live_loop);
+      live_out_[inner_number].Or(live_loop);
 
       DoLoopLivenessUnification(*inner_loop);
     }
@@ -210,9 +203,18 @@ class ComputeRegisterLiveness {
   // Get the number of required registers for this each basic block.
   void EvaluateRegisterRequirements() {
     for (BasicBlock& bb : *function_) {
+      const uint32_t bb_number = numbering_.Get(&bb);
+      assert(processed_.Get(bb_number) && "Basic block not processed");
+      const utils::SparseBitVector& live_out = live_out_[bb_number];
+
       RegisterLiveness::RegionRegisterLiveness* live_inout =
-          reg_pressure_->Get(bb.id());
-      assert(live_inout != nullptr && "Basic block not processed");
+          reg_pressure_->GetOrInsert(bb.id());
+      live_in_[bb_number].ForEach([live_inout, this](uint32_t n) {
+        live_inout->live_in_.insert(numbering_.instruction(n));
+      });
+      live_out.ForEach([live_inout, this](uint32_t n) {
+        live_inout->live_out_.insert(numbering_.instruction(n));
+      });
 
       size_t reg_count = live_inout->live_out_.size();
       for (Instruction* insn : live_inout->live_out_) {
@@ -228,20 +230,20 @@ class ComputeRegisterLiveness {
           break;
         }
 
-        insn.ForEachInId(
-            [live_inout, &die_in_block, &reg_count, this](uint32_t* id) {
-              Instruction* op_insn = def_use_manager_.GetDef(*id);
-              if (!CreatesRegisterUsage(op_insn) ||
-                  live_inout->live_out_.count(op_insn)) {
-                // already taken into account.
-                return;
-              }
-              if (!die_in_block.count(*id)) {
-                live_inout->AddRegisterClass(def_use_manager_.GetDef(*id));
-                reg_count++;
-                die_in_block.insert(*id);
-              }
-            });
+        insn.ForEachInId([live_inout, &live_out, &die_in_block, &reg_count,
+                          this](uint32_t* id) {
+          Instruction* op_insn = def_use_manager_.GetDef(*id);
+          if (!CreatesRegisterUsage(op_insn) ||
+              live_out.Get(numbering_.Get(op_insn))) {
+            // already taken into account.
+            return;
+          }
+          if (!die_in_block.count(*id)) {
+            live_inout->AddRegisterClass(def_use_manager_.GetDef(*id));
+            reg_count++;
+            die_in_block.insert(*id);
+          }
+        });
         live_inout->used_registers_ =
             std::max(live_inout->used_registers_, reg_count);
         if (CreatesRegisterUsage(&insn)) {
@@ -252,12 +254,22 @@ class ComputeRegisterLiveness {
   }
 
   RegisterLiveness* reg_pressure_;
-  IRContext* context_;
   Function* function_;
   CFG& cfg_;
   analysis::DefUseManager& def_use_manager_;
   DominatorTree& dom_tree_;
   LoopDescriptor& loop_desc_;
+
+  // Numbers the blocks and the instructions of |function_|.  Values defined
+  // outside of |function_| are numbered when they are first found live.
+  InstructionNumbering numbering_;
+
+  // The blocks whose partial liveness has been computed, by block number.
+  utils::BitVector processed_;
+
+  // The values live into and out of each block, by block number.
+  std::vector<utils::SparseBitVector> live_in_;
+  std::vector<utils::SparseBitVector> live_out_;
 };
 }  // namespace
 
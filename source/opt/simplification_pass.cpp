@@ -27,7 +27,9 @@ Pass::Status SimplificationPass::Process() {
   bool modified = false;
 
   for (Function& function : *get_module()) {
-    modified |= SimplifyFunction(&function);
+    if (context()->ShouldProcessFunction(function)) {
+      modified |= SimplifyFunction(&function);
+    }
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
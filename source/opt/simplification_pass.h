@@ -27,6 +27,7 @@ class SimplificationPass : public Pass {
  public:
   const char* name() const override { return "simplify-instructions"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse |
@@ -294,6 +294,7 @@ class SSARewritePass : public MemPass {
 
   const char* name() const override { return "ssa-rewrite"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 };
 
 }  // namespace opt
@@ -145,9 +145,9 @@ void TypeManager::AnalyzeTypes(const Module& module) {
       for (auto dec : decorations) {
         AttachDecoration(*dec, type.type());
       }
-      auto pair = type_pool_.insert(type.ReleaseType());
-      id_to_type_[type.id()] = pair.first->get();
-      type_to_id_[pair.first->get()] = type.id();
+      Type* pooled = AddToPool(type.ReleaseType());
+      id_to_type_[type.id()] = pooled;
+      type_to_id_[pooled] = type.id();
       id_to_incomplete_type_.erase(type.id());
     }
   }
@@ -162,12 +162,14 @@ void TypeManager::AnalyzeTypes(const Module& module) {
   // Check if the type pool contains two types that are the same.  This
   // is an indication that the hashing and comparison are wrong.  It
   // will cause a problem if the type pool gets resized and everything
-  // is rehashed.
+  // is rehashed.  The structures are compared, since |IsSame| assumes that
+  // the pooled types are unique.
   for (auto& i : type_pool_) {
     for (auto& j : type_pool_) {
       Type* ti = i.get();
       Type* tj = j.get();
-      assert((ti == tj || !ti->IsSame(tj)) &&
+      Type::IsSameCache seen;
+      assert((ti == tj || !ti->IsSameImpl(tj, &seen)) &&
              "Type pool contains two types that are the same.");
     }
   }
@@ -508,12 +510,16 @@ Type* TypeManager::RebuildType(const Type& type) {
   // when it goes out of scope at the end of the function in that case. Repeated
   // insertions of the same Type will, at most, keep one corresponding object in
   // the type pool.
+  if (type.owner_ == this) {
+    // Already in the type pool, along with all its subtypes.
+    return const_cast<Type*>(&type);
+  }
   std::unique_ptr<Type> rebuilt_ty;
   switch (type.kind()) {
 #define DefineNoSubtypeCase(kind)             \
   case Type::k##kind:                         \
     rebuilt_ty.reset(type.Clone().release()); \
-    return type_pool_.insert(std::move(rebuilt_ty)).first->get();
+    return AddToPool(std::move(rebuilt_ty));
 
     DefineNoSubtypeCase(Void);
     DefineNoSubtypeCase(Bool);
@@ -562,8 +568,9 @@ Type* TypeManager::RebuildType(const Type& type) {
     }
     case Type::kArray: {
       const Array* array_ty = type.AsArray();
+      const Type* ele_ty = array_ty->element_type();
       rebuilt_ty =
-          MakeUnique<Array>(array_ty->element_type(), array_ty->length_info());
+          MakeUnique<Array>(RebuildType(*ele_ty), array_ty->length_info());
       break;
     }
     case Type::kRuntimeArray: {
@@ -638,7 +645,20 @@ Type* TypeManager::RebuildType(const Type& type) {
     rebuilt_ty->AddDecoration(std::move(copy));
   }
 
-  return type_pool_.insert(std::move(rebuilt_ty)).first->get();
+  return AddToPool(std::move(rebuilt_ty));
+}
+
+Type* TypeManager::AddToPool(std::unique_ptr<Type> type) {
+  auto pair = type_pool_.insert(std::move(type));
+  Type* pooled = pair.first->get();
+  if (pair.second) {
+    // The pooled type is not modified anymore, so its hash value is cached.
+    // It is also the only pooled type that is the same as itself, which lets
+    // comparisons with other pooled types stop at the pointers.
+    pooled->owner_ = this;
+    pooled->HashValue();
+  }
+  return pooled;
 }
 
 void TypeManager::RegisterType(uint32_t id, const Type& type) {
@@ -879,11 +899,10 @@ Type* TypeManager::RecordIfTypeDefinition(const Instruction& inst) {
   for (auto dec : decorations) {
     AttachDecoration(*dec, type);
   }
-  std::unique_ptr<Type> unique(type);
-  auto pair = type_pool_.insert(std::move(unique));
-  id_to_type_[id] = pair.first->get();
-  type_to_id_[pair.first->get()] = id;
-  return type;
+  Type* pooled = AddToPool(std::unique_ptr<Type>(type));
+  id_to_type_[id] = pooled;
+  type_to_id_[pooled] = id;
+  return pooled;
 }
 
 void TypeManager::AttachDecoration(const Instruction& inst, Type* type) {
@@ -255,6 +255,11 @@ class TypeManager {
   // replacing the bool subtype with one owned by |type_pool_|.
   Type* RebuildType(const Type& type);
 
+  // Adds |type| to |type_pool_|, unless the pool already holds the same type,
+  // and returns the pooled type.  The pooled type is owned by this manager,
+  // and must not be modified afterwards.
+  Type* AddToPool(std::unique_ptr<Type> type);
+
   // Completes the incomplete type |type|, by replaces all references to
   // ForwardPointer by the defining Pointer.
   void ReplaceForwardPointers(Type* type);
@@ -62,6 +62,25 @@ bool CompareTwoVectors(const U32VecVec a, const U32VecVec b) {
   return true;
 }
 
+// Adds the words of |decorations| to |words|.  The decorations are added in a
+// fixed order, since their order does not matter to CompareTwoVectors.
+void AddDecorationWords(const U32VecVec& decorations,
+                        std::vector<uint32_t>* words) {
+  std::vector<const std::vector<uint32_t>*> sorted;
+  sorted.reserve(decorations.size());
+  for (const auto& d : decorations) {
+    sorted.push_back(&d);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const std::vector<uint32_t>* m, const std::vector<uint32_t>* n) {
+              return *m < *n;
+            });
+  for (const auto* d : sorted) {
+    words->push_back(static_cast<uint32_t>(d->size()));
+    words->insert(words->end(), d->begin(), d->end());
+  }
+}
+
 }  // anonymous namespace
 
 std::string Type::GetDecorationStr() const {
@@ -182,23 +201,17 @@ bool Type::operator==(const Type& other) const {
   }
 }
 
-void Type::GetHashWords(std::vector<uint32_t>* words,
-                        std::unordered_set<const Type*>* seen) const {
-  if (!seen->insert(this).second) {
-    return;
-  }
+void Type::GetHashWords(std::vector<uint32_t>* words, HashState* state) const {
+  state->seen.insert(this);
 
   words->push_back(kind_);
-  for (const auto& d : decorations_) {
-    for (auto w : d) {
-      words->push_back(w);
-    }
-  }
+  words->push_back(static_cast<uint32_t>(decorations_.size()));
+  AddDecorationWords(decorations_, words);
 
   switch (kind_) {
-#define DeclareKindCase(type)                   \
-  case k##type:                                 \
-    As##type()->GetExtraHashWords(words, seen); \
+#define DeclareKindCase(type)                    \
+  case k##type:                                  \
+    As##type()->GetExtraHashWords(words, state); \
     break
     DeclareKindCase(Void);
     DeclareKindCase(Bool);
@@ -232,18 +245,48 @@ void Type::GetHashWords(std::vector<uint32_t>* words,
       break;
   }
 
-  seen->erase(this);
+  state->seen.erase(this);
 }
 
-size_t Type::HashValue() const {
-  std::u32string h;
+void Type::AddHashValue(std::vector<uint32_t>* words, HashState* state) const {
+  if (state->seen.count(this)) {
+    // A recursive type, through a forward pointer.  The reference back adds
+    // nothing, which keeps the hash value finite.
+    state->found_cycle = true;
+    return;
+  }
+
+  const uint64_t hash = ComputeHashValue(state);
+  words->push_back(static_cast<uint32_t>(hash));
+  words->push_back(static_cast<uint32_t>(hash >> 32));
+}
+
+size_t Type::ComputeHashValue(HashState* state) const {
+  if (has_hash_) return hash_;
+
+  // Whether this type refers back to a type that is being hashed is tracked
+  // separately from the same property of the caller.
+  const bool outer_found_cycle = state->found_cycle;
+  state->found_cycle = false;
+
   std::vector<uint32_t> words;
-  GetHashWords(&words);
-  for (auto w : words) {
-    h.push_back(w);
+  GetHashWords(&words, state);
+  const size_t hash =
+      std::hash<std::u32string>()(std::u32string(words.begin(), words.end()));
+
+  // The hash value of a type in a cycle depends on where the cycle was
+  // entered, so it is not cached.
+  if (owner_ && !state->found_cycle) {
+    hash_ = hash;
+    has_hash_ = true;
   }
+  state->found_cycle = state->found_cycle || outer_found_cycle;
+  return hash;
+}
 
-  return std::hash<std::u32string>()(h);
+size_t Type::HashValue() const {
+  HashState state;
+  return ComputeHashValue(&state);
 }
 
 bool Integer::IsSameImpl(const Type* that, IsSameCache*) const {
@@ -259,7 +302,7 @@ std::string Integer::str() const {
 }
 
 void Integer::GetExtraHashWords(std::vector<uint32_t>* words,
-                                std::unordered_set<const Type*>*) const {
+                                HashState*) const {
   words->push_back(width_);
   words->push_back(signed_);
 }
@@ -276,7 +319,7 @@ std::string Float::str() const {
 }
 
 void Float::GetExtraHashWords(std::vector<uint32_t>* words,
-                              std::unordered_set<const Type*>*) const {
+                              HashState*) const {
   words->push_back(width_);
 }
 
@@ -289,7 +332,7 @@ bool Vector::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const Vector* vt = that->AsVector();
   if (!vt) return false;
   return count_ == vt->count_ &&
-         element_type_->IsSameImpl(vt->element_type_, seen) &&
+         element_type_->IsSame(vt->element_type_, seen) &&
          HasSameDecorations(that);
 }
 
@@ -300,8 +343,8 @@ std::string Vector::str() const {
 }
 
 void Vector::GetExtraHashWords(std::vector<uint32_t>* words,
-                               std::unordered_set<const Type*>* seen) const {
-  element_type_->GetHashWords(words, seen);
+                               HashState* state) const {
+  element_type_->AddHashValue(words, state);
   words->push_back(count_);
 }
 
@@ -314,7 +357,7 @@ bool Matrix::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const Matrix* mt = that->AsMatrix();
   if (!mt) return false;
   return count_ == mt->count_ &&
-         element_type_->IsSameImpl(mt->element_type_, seen) &&
+         element_type_->IsSame(mt->element_type_, seen) &&
          HasSameDecorations(that);
 }
 
@@ -325,8 +368,8 @@ std::string Matrix::str() const {
 }
 
 void Matrix::GetExtraHashWords(std::vector<uint32_t>* words,
-                               std::unordered_set<const Type*>* seen) const {
-  element_type_->GetHashWords(words, seen);
+                               HashState* state) const {
+  element_type_->AddHashValue(words, state);
   words->push_back(count_);
 }
 
@@ -350,7 +393,7 @@ bool Image::IsSameImpl(const Type* that, IsSameCache* seen) const {
   return dim_ == it->dim_ && depth_ == it->depth_ && arrayed_ == it->arrayed_ &&
          ms_ == it->ms_ && sampled_ == it->sampled_ && format_ == it->format_ &&
          access_qualifier_ == it->access_qualifier_ &&
-         sampled_type_->IsSameImpl(it->sampled_type_, seen) &&
+         sampled_type_->IsSame(it->sampled_type_, seen) &&
          HasSameDecorations(that);
 }
 
@@ -363,8 +406,8 @@ std::string Image::str() const {
 }
 
 void Image::GetExtraHashWords(std::vector<uint32_t>* words,
-                              std::unordered_set<const Type*>* seen) const {
-  sampled_type_->GetHashWords(words, seen);
+                              HashState* state) const {
+  sampled_type_->AddHashValue(words, state);
   words->push_back(dim_);
   words->push_back(depth_);
   words->push_back(arrayed_);
@@ -377,7 +420,7 @@ void Image::GetExtraHashWords(std::vector<uint32_t>* words,
 bool SampledImage::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const SampledImage* sit = that->AsSampledImage();
   if (!sit) return false;
-  return image_type_->IsSameImpl(sit->image_type_, seen) &&
+  return image_type_->IsSame(sit->image_type_, seen) &&
          HasSameDecorations(that);
 }
 
@@ -387,9 +430,9 @@ std::string SampledImage::str() const {
   return oss.str();
 }
 
-void SampledImage::GetExtraHashWords(
-    std::vector<uint32_t>* words, std::unordered_set<const Type*>* seen) const {
-  image_type_->GetHashWords(words, seen);
+void SampledImage::GetExtraHashWords(std::vector<uint32_t>* words,
+                                     HashState* state) const {
+  image_type_->AddHashValue(words, state);
 }
 
 Array::Array(const Type* type, const Array::LengthInfo& length_info_arg)
@@ -404,7 +447,7 @@ Array::Array(const Type* type, const Array::LengthInfo& length_info_arg)
 bool Array::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const Array* at = that->AsArray();
   if (!at) return false;
-  bool is_same = element_type_->IsSameImpl(at->element_type_, seen);
+  bool is_same = element_type_->IsSame(at->element_type_, seen);
   is_same = is_same && HasSameDecorations(that);
   is_same = is_same && (length_info_.words == at->length_info_.words);
   return is_same;
@@ -423,8 +466,8 @@ std::string Array::str() const {
 }
 
 void Array::GetExtraHashWords(std::vector<uint32_t>* words,
-                              std::unordered_set<const Type*>* seen) const {
-  element_type_->GetHashWords(words, seen);
+                              HashState* state) const {
+  element_type_->AddHashValue(words, state);
   // This should mirror the logic in IsSameImpl
   words->insert(words->end(), length_info_.words.begin(),
                 length_info_.words.end());
@@ -440,7 +483,7 @@ RuntimeArray::RuntimeArray(const Type* type)
 bool RuntimeArray::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const RuntimeArray* rat = that->AsRuntimeArray();
   if (!rat) return false;
-  return element_type_->IsSameImpl(rat->element_type_, seen) &&
+  return element_type_->IsSame(rat->element_type_, seen) &&
          HasSameDecorations(that);
 }
 
@@ -450,9 +493,9 @@ std::string RuntimeArray::str() const {
   return oss.str();
 }
 
-void RuntimeArray::GetExtraHashWords(
-    std::vector<uint32_t>* words, std::unordered_set<const Type*>* seen) const {
-  element_type_->GetHashWords(words, seen);
+void RuntimeArray::GetExtraHashWords(std::vector<uint32_t>* words,
+                                     HashState* state) const {
+  element_type_->AddHashValue(words, state);
 }
 
 void RuntimeArray::ReplaceElementType(const Type* type) {
@@ -486,7 +529,7 @@ bool Struct::IsSameImpl(const Type* that, IsSameCache* seen) const {
   if (!HasSameDecorations(that)) return false;
 
   for (size_t i = 0; i < element_types_.size(); ++i) {
-    if (!element_types_[i]->IsSameImpl(st->element_types_[i], seen))
+    if (!element_types_[i]->IsSame(st->element_types_[i], seen))
       return false;
   }
   for (const auto& p : element_decorations_) {
@@ -510,17 +553,14 @@ std::string Struct::str() const {
 }
 
 void Struct::GetExtraHashWords(std::vector<uint32_t>* words,
-                               std::unordered_set<const Type*>* seen) const {
+                               HashState* state) const {
   for (auto* t : element_types_) {
-    t->GetHashWords(words, seen);
+    t->AddHashValue(words, state);
   }
   for (const auto& pair : element_decorations_) {
     words->push_back(pair.first);
-    for (const auto& d : pair.second) {
-      for (auto w : d) {
-        words->push_back(w);
-      }
-    }
+    words->push_back(static_cast<uint32_t>(pair.second.size()));
+    AddDecorationWords(pair.second, words);
   }
 }
 
@@ -537,7 +577,7 @@ std::string Opaque::str() const {
 }
 
 void Opaque::GetExtraHashWords(std::vector<uint32_t>* words,
-                               std::unordered_set<const Type*>*) const {
+                               HashState*) const {
   for (auto c : name_) {
     words->push_back(static_cast<char32_t>(c));
   }
@@ -554,7 +594,7 @@ bool Pointer::IsSameImpl(const Type* that, IsSameCache* seen) const {
   if (!p.second) {
     return true;
   }
-  bool same_pointee = pointee_type_->IsSameImpl(pt->pointee_type_, seen);
+  bool same_pointee = pointee_type_->IsSame(pt->pointee_type_, seen);
   seen->erase(p.first);
   if (!same_pointee) {
     return false;
@@ -570,8 +610,8 @@ std::string Pointer::str() const {
 }
 
 void Pointer::GetExtraHashWords(std::vector<uint32_t>* words,
-                                std::unordered_set<const Type*>* seen) const {
-  pointee_type_->GetHashWords(words, seen);
+                                HashState* state) const {
+  pointee_type_->AddHashValue(words, state);
   words->push_back(storage_class_);
 }
 
@@ -586,10 +626,10 @@ Function::Function(const Type* ret_type, std::vector<const Type*>& params)
 bool Function::IsSameImpl(const Type* that, IsSameCache* seen) const {
   const Function* ft = that->AsFunction();
   if (!ft) return false;
-  if (!return_type_->IsSameImpl(ft->return_type_, seen)) return false;
+  if (!return_type_->IsSame(ft->return_type_, seen)) return false;
   if (param_types_.size() != ft->param_types_.size()) return false;
   for (size_t i = 0; i < param_types_.size(); ++i) {
-    if (!param_types_[i]->IsSameImpl(ft->param_types_[i], seen)) return false;
+    if (!param_types_[i]->IsSame(ft->param_types_[i], seen)) return false;
   }
   return HasSameDecorations(that);
 }
@@ -607,10 +647,10 @@ std::string Function::str() const {
 }
 
 void Function::GetExtraHashWords(std::vector<uint32_t>* words,
-                                 std::unordered_set<const Type*>* seen) const {
-  return_type_->GetHashWords(words, seen);
+                                 HashState* state) const {
+  return_type_->AddHashValue(words, state);
   for (const auto* t : param_types_) {
-    t->GetHashWords(words, seen);
+    t->AddHashValue(words, state);
   }
 }
 
@@ -629,7 +669,7 @@ std::string Pipe::str() const {
 }
 
 void Pipe::GetExtraHashWords(std::vector<uint32_t>* words,
-                             std::unordered_set<const Type*>*) const {
+                             HashState*) const {
   words->push_back(access_qualifier_);
 }
 
@@ -653,11 +693,11 @@ std::string ForwardPointer::str() const {
   return oss.str();
 }
 
-void ForwardPointer::GetExtraHashWords(
-    std::vector<uint32_t>* words, std::unordered_set<const Type*>* seen) const {
-  words->push_back(target_id_);
+void ForwardPointer::GetExtraHashWords(std::vector<uint32_t>* words,
+                                       HashState*) const {
+  // Two forward pointers to the same pointer are the same even if their target
+  // ids differ, so only the storage class is used.
   words->push_back(storage_class_);
-  if (pointer_) pointer_->GetHashWords(words, seen);
 }
 
 CooperativeMatrixNV::CooperativeMatrixNV(const Type* type, const uint32_t scope,
@@ -681,9 +721,9 @@ std::string CooperativeMatrixNV::str() const {
   return oss.str();
 }
 
-void CooperativeMatrixNV::GetExtraHashWords(
-    std::vector<uint32_t>* words, std::unordered_set<const Type*>* pSet) const {
-  component_type_->GetHashWords(words, pSet);
+void CooperativeMatrixNV::GetExtraHashWords(std::vector<uint32_t>* words,
+                                            HashState* state) const {
+  component_type_->AddHashValue(words, state);
   words->push_back(scope_id_);
   words->push_back(rows_id_);
   words->push_back(columns_id_);
@@ -693,7 +733,7 @@ bool CooperativeMatrixNV::IsSameImpl(const Type* that,
                                      IsSameCache* seen) const {
   const CooperativeMatrixNV* mt = that->AsCooperativeMatrixNV();
   if (!mt) return false;
-  return component_type_->IsSameImpl(mt->component_type_, seen) &&
+  return component_type_->IsSame(mt->component_type_, seen) &&
          scope_id_ == mt->scope_id_ && rows_id_ == mt->rows_id_ &&
          columns_id_ == mt->columns_id_ && HasSameDecorations(that);
 }
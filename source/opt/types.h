@@ -60,6 +60,7 @@ class NamedBarrier;
 class AccelerationStructureNV;
 class CooperativeMatrixNV;
 class RayQueryProvisionalKHR;
+class TypeManager;
 
 // Abstract class for a SPIR-V type. It has a bunch of As<sublcass>() methods,
 // which is used as a way to probe the actual <subclass>.
@@ -67,6 +68,13 @@ class Type {
  public:
   typedef std::set<std::pair<const Pointer*, const Pointer*>> IsSameCache;
 
+  // The state of a hash value computation: the types whose hash value is
+  // being computed, and whether a reference back to one of them was found.
+  struct HashState {
+    std::unordered_set<const Type*> seen;
+    bool found_cycle = false;
+  };
+
   // Available subtypes.
   //
   // When adding a new derived class of Type, please add an entry to the enum.
@@ -101,6 +109,10 @@ class Type {
 
   Type(Kind k) : kind_(k) {}
 
+  // A copy is not owned by the type manager of |that|, and so does not share
+  // its cached hash value.
+  Type(const Type& that) : decorations_(that.decorations_), kind_(that.kind_) {}
+
   virtual ~Type() {}
 
   // Attaches a decoration directly on this type.
@@ -115,12 +127,26 @@ class Type {
   // decorations.
   bool IsSame(const Type* that) const {
     IsSameCache seen;
-    return IsSameImpl(that, &seen);
+    return IsSame(that, &seen);
   }
 
   // Returns true if this type is exactly the same as |that| type, including
   // decorations.  |seen| is the set of |Pointer*| pair that are currently being
   // compared in a parent call to |IsSameImpl|.
+  //
+  // Two types owned by the same type manager are the same only if they are the
+  // same object, so they are compared in constant time.
+  bool IsSame(const Type* that, IsSameCache* seen) const {
+    if (this == that) return true;
+    if (has_hash_ && that->has_hash_ &&
+        (hash_ != that->hash_ || owner_ == that->owner_)) {
+      return false;
+    }
+    return IsSameImpl(that, seen);
+  }
+
+  // Compares the structure of this type and |that| type.  Subtypes are
+  // compared with |IsSame|.
   virtual bool IsSameImpl(const Type* that, IsSameCache* seen) const = 0;
 
   // Returns a human-readable string to represent this type.
@@ -151,24 +177,28 @@ class Type {
 
   bool operator==(const Type& other) const;
 
-  // Returns the hash value of this type.
+  // Returns the hash value of this type.  Once the type is owned by a type
+  // manager, its hash value is computed only once.
   size_t HashValue() const;
 
   // Adds the necessary words to compute a hash value of this type to |words|.
   void GetHashWords(std::vector<uint32_t>* words) const {
-    std::unordered_set<const Type*> seen;
-    GetHashWords(words, &seen);
+    HashState state;
+    GetHashWords(words, &state);
   }
 
   // Adds the necessary words to compute a hash value of this type to |words|.
-  void GetHashWords(std::vector<uint32_t>* words,
-                    std::unordered_set<const Type*>* seen) const;
+  // Subtypes are represented by their hash value, added with |AddHashValue|.
+  void GetHashWords(std::vector<uint32_t>* words, HashState* state) const;
+
+  // Adds the hash value of this type, as a subtype of a type whose hash value
+  // is being computed, to |words|.
+  void AddHashValue(std::vector<uint32_t>* words, HashState* state) const;
 
   // Adds necessary extra words for a subtype to calculate a hash value into
   // |words|.
-  virtual void GetExtraHashWords(
-      std::vector<uint32_t>* words,
-      std::unordered_set<const Type*>* pSet) const = 0;
+  virtual void GetExtraHashWords(std::vector<uint32_t>* words,
+                                 HashState* state) const = 0;
 
 // A bunch of methods for casting this type to a given type. Returns this if the
 // cast can be done, nullptr otherwise.
@@ -211,11 +241,23 @@ class Type {
   std::vector<std::vector<uint32_t>> decorations_;
 
  private:
+  friend class TypeManager;
+
   // Removes decorations on this type. For struct types, also removes element
   // decorations.
   virtual void ClearDecorations() { decorations_.clear(); }
 
+  // Returns the hash value of this type, and caches it if the type is owned by
+  // a type manager and does not refer back to a type in |state|.
+  size_t ComputeHashValue(HashState* state) const;
+
   Kind kind_;
+
+  // The type manager that owns this type, if any.  A type is not modified
+  // once it is owned, so its hash value can be cached.
+  const TypeManager* owner_ = nullptr;
+  mutable size_t hash_ = 0;
+  mutable bool has_hash_ = false;
 };
 // clang-format on
 
@@ -233,7 +275,7 @@ class Integer : public Type {
   bool IsSigned() const { return signed_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -254,7 +296,7 @@ class Float : public Type {
   uint32_t width() const { return width_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -275,7 +317,7 @@ class Vector : public Type {
   const Vector* AsVector() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -297,7 +339,7 @@ class Matrix : public Type {
   const Matrix* AsMatrix() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -328,7 +370,7 @@ class Image : public Type {
   SpvAccessQualifier access_qualifier() const { return access_qualifier_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -356,7 +398,7 @@ class SampledImage : public Type {
   const Type* image_type() const { return image_type_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -400,7 +442,7 @@ class Array : public Type {
   const Array* AsArray() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
   void ReplaceElementType(const Type* element_type);
 
@@ -423,7 +465,7 @@ class RuntimeArray : public Type {
   const RuntimeArray* AsRuntimeArray() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
   void ReplaceElementType(const Type* element_type);
 
@@ -460,7 +502,7 @@ class Struct : public Type {
   const Struct* AsStruct() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -492,7 +534,7 @@ class Opaque : public Type {
   const std::string& name() const { return name_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -513,7 +555,7 @@ class Pointer : public Type {
   const Pointer* AsPointer() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
   void SetPointeeType(const Type* type);
 
@@ -540,7 +582,7 @@ class Function : public Type {
   std::vector<const Type*>& param_types() { return param_types_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>*) const override;
+                         HashState* state) const override;
 
   void SetReturnType(const Type* type);
 
@@ -565,7 +607,7 @@ class Pipe : public Type {
   SpvAccessQualifier access_qualifier() const { return access_qualifier_; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -593,7 +635,7 @@ class ForwardPointer : public Type {
   const ForwardPointer* AsForwardPointer() const override { return this; }
 
   void GetExtraHashWords(std::vector<uint32_t>* words,
-                         std::unordered_set<const Type*>* pSet) const override;
+                         HashState* state) const override;
 
  private:
   bool IsSameImpl(const Type* that, IsSameCache*) const override;
@@ -616,8 +658,8 @@ class CooperativeMatrixNV : public Type {
     return this;
   }
 
-  void GetExtraHashWords(std::vector<uint32_t>*,
-                         std::unordered_set<const Type*>*) const override;
+  void GetExtraHashWords(std::vector<uint32_t>* words,
+                         HashState* state) const override;
 
   const Type* component_type() const { return component_type_; }
   uint32_t scope_id() const { return scope_id_; }
@@ -645,7 +687,7 @@ class CooperativeMatrixNV : public Type {
     const type* As##type() const override { return this; }                     \
                                                                                \
     void GetExtraHashWords(std::vector<uint32_t>*,                             \
-                           std::unordered_set<const Type*>*) const override {} \
+                           HashState*) const override {}                       \
                                                                                \
    private:                                                                    \
     bool IsSameImpl(const Type* that, IsSameCache*) const override {           \
@@ -15,27 +15,51 @@
 #include "source/opt/value_number_table.h"
 
 #include <algorithm>
+#include <set>
+#include <string>
 
 #include "source/opt/cfg.h"
 #include "source/opt/ir_context.h"
 
 namespace spvtools {
 namespace opt {
+namespace {
+
+// Returns the hash value of the |size| words in |words|.
+size_t HashWords(const uint32_t* words, size_t size) {
+  // 64-bit FNV-1a over the words.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ words[i]) * 0x100000001b3ull;
+  }
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+}  // namespace
+
+const uint32_t ValueNumberTable::kNoKey;
 
 uint32_t ValueNumberTable::GetValueNumber(Instruction* inst) const {
   assert(inst->result_id() != 0 &&
          "inst must have a result id to get a value number.");
+  return GetValueNumber(inst->result_id());
+}
 
-  // Check if this instruction already has a value.
-  auto result_id_to_val = id_to_value_.find(inst->result_id());
-  if (result_id_to_val != id_to_value_.end()) {
-    return result_id_to_val->second;
+uint32_t ValueNumberTable::GetValueNumber(uint32_t id) const {
+  return id < id_to_value_.size() ? id_to_value_[id] : 0;
+}
+
+void ValueNumberTable::SetValueNumber(uint32_t id, uint32_t value) {
+  if (id >= id_to_value_.size()) {
+    id_to_value_.resize(std::max(id + 1, context()->module()->IdBound()), 0);
   }
-  return 0;
+  id_to_value_[id] = value;
 }
 
-uint32_t ValueNumberTable::GetValueNumber(uint32_t id) const {
-  return GetValueNumber(context()->get_def_use_mgr()->GetDef(id));
+void ValueNumberTable::RemoveInstruction(Instruction* inst) {
+  if (inst->result_id() < id_to_value_.size()) {
+    id_to_value_[inst->result_id()] = 0;
+  }
 }
 
 uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
@@ -51,7 +75,7 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
   // they are used, because of this we will assign each one it own value number.
   if (!context()->IsCombinatorInstruction(inst)) {
     value = TakeNextValueNumber();
-    id_to_value_[inst->result_id()] = value;
+    SetValueNumber(inst->result_id(), value);
     return value;
   }
 
@@ -60,7 +84,7 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
     case SpvOpImage:
     case SpvOpVariable:
       value = TakeNextValueNumber();
-      id_to_value_[inst->result_id()] = value;
+      SetValueNumber(inst->result_id(), value);
       return value;
     default:
       break;
@@ -74,7 +98,7 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
   // will have to add a new case for volatile loads.
   if (inst->IsLoad() && !inst->IsReadOnlyLoad()) {
     value = TakeNextValueNumber();
-    id_to_value_[inst->result_id()] = value;
+    SetValueNumber(inst->result_id(), value);
     return value;
   }
 
@@ -86,7 +110,7 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
                                       inst->GetSingleWordInOperand(0))) {
     value = GetValueNumber(inst->GetSingleWordInOperand(0));
     if (value != 0) {
-      id_to_value_[inst->result_id()] = value;
+      SetValueNumber(inst->result_id(), value);
       return value;
     }
   }
@@ -105,49 +129,108 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
         }
       }
       if (value != 0) {
-        id_to_value_[inst->result_id()] = value;
+        SetValueNumber(inst->result_id(), value);
         return value;
       }
     }
   }
 
+  // TODO: Implement a normal form for opcodes that commute like integer
+  // addition.  This will let us know that a+b is the same value as b+a.
+
+  // Otherwise, we check if this value has been computed before.  If not, it
+  // gets a new value number.
+  BuildValueKey(inst, &key_);
+  value = FindOrAddValue(key_);
+  SetValueNumber(inst->result_id(), value);
+  return value;
+}
+
+void ValueNumberTable::BuildValueKey(Instruction* inst,
+                                     std::vector<uint32_t>* key) const {
+  key->clear();
+  key->push_back(inst->opcode());
+  key->push_back(inst->type_id());
+  key->push_back(inst->NumInOperands());
+
   // Replace all of the operands by their value number.  The sign bit will be
   // set to distinguish between an id and a value number.
-  Instruction value_ins(context(), inst->opcode(), inst->type_id(),
-                        inst->result_id(), {});
   for (uint32_t o = 0; o < inst->NumInOperands(); ++o) {
     const Operand& op = inst->GetInOperand(o);
+    key->push_back(op.type);
+    key->push_back(static_cast<uint32_t>(op.words.size()));
     if (spvIsIdType(op.type)) {
       uint32_t id_value = op.words[0];
-      auto use_id_to_val = id_to_value_.find(id_value);
-      if (use_id_to_val != id_to_value_.end()) {
-        id_value = (1 << 31) | use_id_to_val->second;
+      uint32_t value = GetValueNumber(id_value);
+      if (value != 0) {
+        id_value = (1u << 31) | value;
       }
-      value_ins.AddOperand(Operand(op.type, {id_value}));
+      key->push_back(id_value);
     } else {
-      value_ins.AddOperand(Operand(op.type, op.words));
+      key->insert(key->end(), op.words.begin(), op.words.end());
     }
   }
 
-  // TODO: Implement a normal form for opcodes that commute like integer
-  // addition.  This will let us know that a+b is the same value as b+a.
+  // Two instructions compute the same value only if they have the same
+  // decorations.  They are added in a fixed order, and without duplicates, as
+  // in DecorationManager::HaveTheSameDecorations.
+  std::set<std::u32string> decorations;
+  for (const Instruction* dec :
+       context()->get_decoration_mgr()->GetDecorationsFor(inst->result_id(),
+                                                          false)) {
+    switch (dec->opcode()) {
+      case SpvOpDecorate:
+      case SpvOpMemberDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
+        break;
+      default:
+        continue;
+    }
+    // The target is not part of the decoration.
+    std::u32string payload(1, dec->opcode());
+    for (uint32_t i = 1; i < dec->NumInOperands(); ++i) {
+      for (uint32_t word : dec->GetInOperand(i).words) {
+        payload.push_back(word);
+      }
+    }
+    decorations.insert(std::move(payload));
+  }
+  key->push_back(static_cast<uint32_t>(decorations.size()));
+  for (const std::u32string& payload : decorations) {
+    key->push_back(static_cast<uint32_t>(payload.size()));
+    key->insert(key->end(), payload.begin(), payload.end());
+  }
+}
 
-  // Otherwise, we check if this value has been computed before.
-  auto value_iterator = instruction_to_value_.find(value_ins);
-  if (value_iterator != instruction_to_value_.end()) {
-    value = id_to_value_[value_iterator->first.result_id()];
-    id_to_value_[inst->result_id()] = value;
-    return value;
+uint32_t ValueNumberTable::FindOrAddValue(const std::vector<uint32_t>& key) {
+  const size_t hash = HashWords(key.data(), key.size());
+  auto head = key_index_.find(hash);
+  if (head != key_index_.end()) {
+    for (uint32_t k = head->second; k != kNoKey; k = keys_[k].next) {
+      const ValueKey& candidate = keys_[k];
+      if (candidate.size == key.size() &&
+          std::equal(key.begin(), key.end(),
+                     key_words_.begin() + candidate.offset)) {
+        return candidate.value;
+      }
+    }
   }
 
-  // If not, assign it a new value number.
-  value = TakeNextValueNumber();
-  id_to_value_[inst->result_id()] = value;
-  instruction_to_value_[value_ins] = value;
-  return value;
+  ValueKey new_key;
+  new_key.offset = static_cast<uint32_t>(key_words_.size());
+  new_key.size = static_cast<uint32_t>(key.size());
+  new_key.value = TakeNextValueNumber();
+  new_key.next = head != key_index_.end() ? head->second : kNoKey;
+  key_words_.insert(key_words_.end(), key.begin(), key.end());
+  key_index_[hash] = static_cast<uint32_t>(keys_.size());
+  keys_.push_back(new_key);
+  return new_key.value;
 }
 
 void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
+  id_to_value_.assign(context()->module()->IdBound(), 0);
+
   // First value number the headers.
   for (auto& inst : context()->annotations()) {
     if (inst.result_id() != 0) {
@@ -186,48 +269,5 @@ void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
   }
 }
 
-bool ComputeSameValue::operator()(const Instruction& lhs,
-                                  const Instruction& rhs) const {
-  if (lhs.result_id() == 0 || rhs.result_id() == 0) {
-    return false;
-  }
-
-  if (lhs.opcode() != rhs.opcode()) {
-    return false;
-  }
-
-  if (lhs.type_id() != rhs.type_id()) {
-    return false;
-  }
-
-  if (lhs.NumInOperands() != rhs.NumInOperands()) {
-    return false;
-  }
-
-  for (uint32_t i = 0; i < lhs.NumInOperands(); ++i) {
-    if (lhs.GetInOperand(i) != rhs.GetInOperand(i)) {
-      return false;
-    }
-  }
-
-  return lhs.context()->get_decoration_mgr()->HaveTheSameDecorations(
-      lhs.result_id(), rhs.result_id());
-}
-
-std::size_t ValueTableHash::operator()(const Instruction& inst) const {
-  // We hash the opcode and in-operands, not the result, because we want
-  // instructions that are the same except for the result to hash to the
-  // same value.
-  std::u32string h;
-  h.push_back(inst.opcode());
-  h.push_back(inst.type_id());
-  for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
-    const auto& opnd = inst.GetInOperand(i);
-    for (uint32_t word : opnd.words) {
-      h.push_back(word);
-    }
-  }
-  return std::hash<std::u32string>()(h);
-}
 }  // namespace opt
 }  // namespace spvtools
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include "source/opt/instruction.h"
 
@@ -25,19 +26,6 @@ namespace opt {
 
 class IRContext;
 
-// Returns true if the two instructions compute the same value.  Used by the
-// value number table to compare two instructions.
-class ComputeSameValue {
- public:
-  bool operator()(const Instruction& lhs, const Instruction& rhs) const;
-};
-
-// The hash function used in the value number table.
-class ValueTableHash {
- public:
-  std::size_t operator()(const Instruction& inst) const;
-};
-
 // This class implements the value number analysis.  It is using a hash-based
 // approach to value numbering.  It is essentially doing dominator-tree value
 // numbering described in
@@ -49,6 +37,11 @@ class ValueTableHash {
 // The main difference is that because we do not perform redundancy elimination
 // as we build the value number table, we do not have to deal with cleaning up
 // the scope.
+//
+// A computation is identified by a key made of its opcode, its result type,
+// the value numbers of its id operands, its literal operands and the
+// decorations on its result.  The keys are stored one after the other in a
+// single array, so the table does not keep a copy of the instructions.
 class ValueNumberTable {
  public:
   ValueNumberTable(IRContext* ctx) : context_(ctx), next_value_number_(1) {
@@ -64,23 +57,59 @@ class ValueNumberTable {
   // has not been assigned a value number.
   uint32_t GetValueNumber(uint32_t id) const;
 
+  // Assigns a new value number to the result of |inst| if it does not already
+  // have one.  Return the value number for |inst|.  |inst| must have a result
+  // id.  Instructions added to the module after the table was built must be
+  // given a value number this way, after their operands.
+  uint32_t AssignValueNumber(Instruction* inst);
+
+  // Forgets the value number of the result of |inst|, which is about to be
+  // killed.  The value numbers of the other instructions are unchanged.
+  void RemoveInstruction(Instruction* inst);
+
   IRContext* context() const { return context_; }
 
  private:
+  // The key of a computation that has a value number.
+  struct ValueKey {
+    // The position of the key in |key_words_|, and its number of words.
+    uint32_t offset;
+    uint32_t size;
+    uint32_t value;
+    // The index in |keys_| of the next key with the same hash value, or
+    // |kNoKey|.
+    uint32_t next;
+  };
+
+  static const uint32_t kNoKey = 0xFFFFFFFF;
+
   // Assigns a value number to every result id in the module.
   void BuildDominatorTreeValueNumberTable();
 
   // Returns the new value number.
   uint32_t TakeNextValueNumber() { return next_value_number_++; }
 
-  // Assigns a new value number to the result of |inst| if it does not already
-  // have one.  Return the value number for |inst|.  |inst| must have a result
-  // id.
-  uint32_t AssignValueNumber(Instruction* inst);
-
-  std::unordered_map<Instruction, uint32_t, ValueTableHash, ComputeSameValue>
-      instruction_to_value_;
-  std::unordered_map<uint32_t, uint32_t> id_to_value_;
+  // Records |value| as the value number of |id|.
+  void SetValueNumber(uint32_t id, uint32_t value);
+
+  // Replaces the contents of |key| with the key of the computation done by
+  // |inst|.
+  void BuildValueKey(Instruction* inst, std::vector<uint32_t>* key) const;
+
+  // Returns the value number of the computation identified by |key|.  A new
+  // value number is assigned to it if it has not been seen before.
+  uint32_t FindOrAddValue(const std::vector<uint32_t>& key);
+
+  // The words of all the keys in |keys_|.
+  std::vector<uint32_t> key_words_;
+  std::vector<ValueKey> keys_;
+  // Maps the hash value of a key to the first key in |keys_| with that hash
+  // value.
+  std::unordered_map<size_t, uint32_t> key_index_;
+  // The value number of each id, or 0.
+  std::vector<uint32_t> id_to_value_;
+  // The scratch space for the key of the instruction being numbered.
+  std::vector<uint32_t> key_;
   IRContext* context_;
   uint32_t next_value_number_;
 };
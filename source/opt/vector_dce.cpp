@@ -27,19 +27,30 @@ const uint32_t kInsertCompositeIdInIdx = 1;
 }  // namespace
 
 Pass::Status VectorDCE::Process() {
+  // Finding the live components only reads the module, so it can be done for
+  // all functions in parallel.  The rewrite updates the def-use manager, so it
+  // is done one function at a time afterwards.
+  std::vector<LiveComponentMap> live_components(get_module()->end() -
+                                                get_module()->begin());
+  ProcessEachFunctionInParallel(
+      [this, &live_components](Function* function, uint32_t index) {
+        FindLiveComponents(function, &live_components[index]);
+        return false;
+      },
+      IRContext::kAnalysisDefUse | IRContext::kAnalysisTypes |
+          IRContext::kAnalysisCombinators);
+
   bool modified = false;
+  uint32_t index = 0;
   for (Function& function : *get_module()) {
-    modified |= VectorDCEFunction(&function);
+    if (context()->ShouldProcessFunction(function)) {
+      modified |= RewriteInstructions(&function, live_components[index]);
+    }
+    ++index;
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
-bool VectorDCE::VectorDCEFunction(Function* function) {
-  LiveComponentMap live_components;
-  FindLiveComponents(function, &live_components);
-  return RewriteInstructions(function, live_components);
-}
-
 void VectorDCE::FindLiveComponents(Function* function,
                                    LiveComponentMap* live_components) {
   std::vector<WorkListItem> work_list;
@@ -48,6 +48,7 @@ class VectorDCE : public MemPass {
 
   const char* name() const override { return "vector-dce"; }
   Status Process() override;
+  bool IsFunctionLocal() const override { return true; }
 
   IRContext::Analysis GetPreservedAnalyses() override {
     return IRContext::kAnalysisDefUse | IRContext::kAnalysisCFG |
@@ -58,10 +59,6 @@ class VectorDCE : public MemPass {
   }
 
  private:
-  // Runs the vector dce pass on |function|.  Returns true if |function| was
-  // modified.
-  bool VectorDCEFunction(Function* function);
-
   // Identifies the live components of the vectors that are results of
   // instructions in |function|.  The results are stored in |live_components|.
   void FindLiveComponents(Function* function,
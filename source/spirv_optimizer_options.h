@@ -26,7 +26,8 @@ struct spv_optimizer_options_t {
         val_options_(),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {}
+        preserve_spec_constants_(false),
+        num_threads_(1) {}
 
   // When true the validator will be run before optimizations are run.
   bool run_validator_;
@@ -45,5 +46,9 @@ struct spv_optimizer_options_t {
   // When true, all specialization constants within the module should be
   // preserved.
   bool preserve_spec_constants_;
+
+  // The maximum number of threads passes may use to process independent
+  // functions in parallel.
+  uint32_t num_threads_;
 };
 #endif  // SOURCE_SPIRV_OPTIMIZER_OPTIONS_H_
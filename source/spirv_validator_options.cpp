@@ -115,3 +115,8 @@ void spvValidatorOptionsSetSkipBlockLayout(spv_validator_options options,
                                            bool val) {
   options->skip_block_layout = val;
 }
+
+void spvValidatorOptionsSetNumThreads(spv_validator_options options,
+                                      uint32_t val) {
+  options->num_threads = val > 1 ? val : 1;
+}
@@ -15,6 +15,8 @@
 #ifndef SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
 #define SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
 
+#include <ostream>
+
 #include "spirv-tools/libspirv.h"
 
 // Return true if the command line option for the validator limit is valid (Also
@@ -46,7 +48,9 @@ struct spv_validator_options_t {
         uniform_buffer_standard_layout(false),
         scalar_block_layout(false),
         skip_block_layout(false),
-        before_hlsl_legalization(false) {}
+        before_hlsl_legalization(false),
+        num_threads(1),
+        time_report_stream(nullptr) {}
 
   validator_universal_limits_t universal_limits_;
   bool relax_struct_store;
@@ -56,6 +60,8 @@ struct spv_validator_options_t {
   bool scalar_block_layout;
   bool skip_block_layout;
   bool before_hlsl_legalization;
+  uint32_t num_threads;
+  std::ostream* time_report_stream;
 };
 
 #endif  // SOURCE_SPIRV_VALIDATOR_OPTIONS_H_
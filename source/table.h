@@ -67,6 +67,8 @@ typedef struct spv_operand_desc_group_t {
   const spv_operand_type_t type;
   const uint32_t count;
   const spv_operand_desc_t* entries;
+  // nameIndex[0..count-1] are indices into entries, ordered by entry name.
+  const uint16_t* nameIndex;
 } spv_operand_desc_group_t;
 
 typedef struct spv_ext_inst_desc_t {
@@ -81,11 +83,15 @@ typedef struct spv_ext_inst_group_t {
   const spv_ext_inst_type_t type;
   const uint32_t count;
   const spv_ext_inst_desc_t* entries;
+  // nameIndex[0..count-1] are indices into entries, ordered by entry name.
+  const uint16_t* nameIndex;
 } spv_ext_inst_group_t;
 
 typedef struct spv_opcode_table_t {
   const uint32_t count;
   const spv_opcode_desc_t* entries;
+  // nameIndex[0..count-1] are indices into entries, ordered by entry name.
+  const uint16_t* nameIndex;
 } spv_opcode_table_t;
 
 typedef struct spv_operand_table_t {
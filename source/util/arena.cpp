@@ -0,0 +1,167 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/util/arena.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+// The id of the next arena to be created.  Ids start at 1, so that an empty
+// |Arena::CurrentCache| matches no arena.
+std::atomic<uint64_t> next_arena_id{1};
+
+// Adds |delta| to |counter|, which only the calling thread writes.
+template <typename T>
+T AddTo(std::atomic<T>* counter, T delta) {
+  const T value = counter->load(std::memory_order_relaxed) + delta;
+  counter->store(value, std::memory_order_relaxed);
+  return value;
+}
+
+}  // namespace
+
+thread_local Arena::CurrentCache Arena::current_cache_ = {0, nullptr};
+
+Arena::Arena(size_t slab_size)
+    : slab_size_(slab_size),
+      id_(next_arena_id.fetch_add(1, std::memory_order_relaxed)),
+      bytes_reserved_(0) {}
+
+Arena::ThreadCache* Arena::GetThreadCache() {
+  if (current_cache_.arena_id == id_) return current_cache_.cache;
+
+  // The thread last used another arena, or has not used one yet.
+  const std::thread::id thread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex_);
+  ThreadCache* cache = nullptr;
+  for (const auto& c : caches_) {
+    if (c->thread == thread) {
+      cache = c.get();
+      break;
+    }
+  }
+  if (cache == nullptr) {
+    caches_.emplace_back(new ThreadCache);
+    cache = caches_.back().get();
+    cache->thread = thread;
+  }
+  current_cache_ = {id_, cache};
+  return cache;
+}
+
+char* Arena::AllocateSlab(size_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  slabs_.emplace_back(new char[size]);
+  bytes_reserved_ += size;
+  return slabs_.back().get();
+}
+
+void* Arena::Allocate(size_t size) {
+  size = RoundUp(size);
+  ThreadCache* cache = GetThreadCache();
+  AddTo(&cache->num_allocations, size_t(1));
+  const int64_t in_use =
+      AddTo(&cache->bytes_in_use, static_cast<int64_t>(size));
+  if (in_use > cache->peak_bytes_in_use.load(std::memory_order_relaxed)) {
+    cache->peak_bytes_in_use.store(in_use, std::memory_order_relaxed);
+  }
+
+  const size_t size_class = size / kAlignment - 1;
+  if (size_class < kNumSizeClasses) {
+    FreeBlock*& head = cache->free_lists[size_class];
+    if (head != nullptr) {
+      FreeBlock* block = head;
+      head = block->next;
+      return block;
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto free_list = large_free_lists_.find(size);
+    if (free_list != large_free_lists_.end() && free_list->second != nullptr) {
+      FreeBlock* block = free_list->second;
+      free_list->second = block->next;
+      return block;
+    }
+  }
+
+  // A slab allocated for a single large block does not replace the current
+  // slab, since the current slab may still have room for small blocks.
+  if (size > slab_size_) {
+    return AllocateSlab(size);
+  }
+  if (static_cast<size_t>(cache->end - cache->cur) < size) {
+    cache->cur = AllocateSlab(slab_size_);
+    cache->end = cache->cur + slab_size_;
+  }
+
+  void* result = cache->cur;
+  cache->cur += size;
+  return result;
+}
+
+void Arena::Deallocate(void* p, size_t size) {
+  if (p == nullptr) return;
+  size = RoundUp(size);
+  ThreadCache* cache = GetThreadCache();
+  AddTo(&cache->bytes_in_use, -static_cast<int64_t>(size));
+
+  FreeBlock* block = static_cast<FreeBlock*>(p);
+  const size_t size_class = size / kAlignment - 1;
+  if (size_class < kNumSizeClasses) {
+    block->next = cache->free_lists[size_class];
+    cache->free_lists[size_class] = block;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  FreeBlock*& head = large_free_lists_[size];
+  block->next = head;
+  head = block;
+}
+
+size_t Arena::bytes_reserved() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_reserved_;
+}
+
+size_t Arena::bytes_in_use() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t total = 0;
+  for (const auto& cache : caches_) {
+    total += cache->bytes_in_use.load(std::memory_order_relaxed);
+  }
+  return static_cast<size_t>(total);
+}
+
+size_t Arena::peak_bytes_in_use() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  int64_t total = 0;
+  for (const auto& cache : caches_) {
+    total += cache->peak_bytes_in_use.load(std::memory_order_relaxed);
+  }
+  return static_cast<size_t>(total);
+}
+
+size_t Arena::num_allocations() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t total = 0;
+  for (const auto& cache : caches_) {
+    total += cache->num_allocations.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+}  // namespace utils
+}  // namespace spvtools
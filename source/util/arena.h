@@ -0,0 +1,193 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_ARENA_H_
+#define SOURCE_UTIL_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+// A slab allocator for many small objects that are all freed together.
+//
+// Memory is handed out from large slabs by bumping a pointer.  Freed blocks
+// are kept on a free list for their size and reused by later allocations of
+// the same size, but the slabs themselves are only released when the arena is
+// destroyed.  Every object allocated from an arena must therefore be destroyed
+// before the arena is.
+//
+// Allocation and deallocation may be called from several threads.  Each
+// thread bumps its own slab and keeps its own free lists, one for each size
+// class of small blocks, so they do not take a lock.  A thread only locks the
+// arena to get a new slab, to allocate or free a block larger than any size
+// class, or when it switches between arenas.
+class Arena {
+ public:
+  // The default size of a slab, in bytes.  Larger allocations get a slab of
+  // their own.
+  enum { kDefaultSlabSize = 64 * 1024 };
+
+  explicit Arena(size_t slab_size = kDefaultSlabSize);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // Returns a block of at least |size| bytes aligned for any scalar type.
+  void* Allocate(size_t size);
+
+  // Returns the block |p| of |size| bytes, which must have come from
+  // |Allocate| with the same |size|, to the arena for reuse.
+  void Deallocate(void* p, size_t size);
+
+  // Returns the total size of the slabs owned by the arena.
+  size_t bytes_reserved() const;
+
+  // Returns the number of bytes in blocks that have been allocated and not yet
+  // deallocated.
+  size_t bytes_in_use() const;
+
+  // Returns the largest value |bytes_in_use| has had.  If several threads
+  // allocated, this is the sum of the largest use of each thread, which may
+  // be more.
+  size_t peak_bytes_in_use() const;
+
+  // Returns the number of calls to |Allocate|.
+  size_t num_allocations() const;
+
+ private:
+  // A freed block, linked into the free list for its size.
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Blocks are aligned to, and their sizes rounded up to, multiples of this.
+  enum : size_t { kAlignment = alignof(std::max_align_t) };
+
+  // The blocks of up to |kNumSizeClasses * kAlignment| bytes are small, and
+  // are kept on the free list for their size class, |size / kAlignment - 1|.
+  enum : size_t { kNumSizeClasses = 64 };
+
+  // The slab and free lists of one thread.  Only that thread uses them.  The
+  // counters are atomic so that the accessors may read them from another
+  // thread, but only that thread writes them.
+  struct ThreadCache {
+    std::thread::id thread;
+    char* cur = nullptr;
+    char* end = nullptr;
+    FreeBlock* free_lists[kNumSizeClasses] = {};
+    // Blocks may be freed by another thread than the one that allocated them,
+    // so the use of a single thread may be negative.
+    std::atomic<int64_t> bytes_in_use{0};
+    std::atomic<int64_t> peak_bytes_in_use{0};
+    std::atomic<size_t> num_allocations{0};
+  };
+
+  // The cache a thread used last, and the id of the arena it belongs to.
+  struct CurrentCache {
+    uint64_t arena_id;
+    ThreadCache* cache;
+  };
+
+  // Rounds |size| up so that blocks stay suitably aligned and can hold a
+  // |FreeBlock| once they are freed.
+  static size_t RoundUp(size_t size) {
+    if (size < sizeof(FreeBlock)) size = sizeof(FreeBlock);
+    return (size + kAlignment - 1) & ~(kAlignment - 1);
+  }
+
+  // Returns the cache of the calling thread, creating it if needed.
+  ThreadCache* GetThreadCache();
+
+  // Returns a new slab of |size| bytes.
+  char* AllocateSlab(size_t size);
+
+  const size_t slab_size_;
+
+  // Identifies the arena in |current_cache_|.  Unlike its address, it is not
+  // reused by a later arena.
+  const uint64_t id_;
+
+  static thread_local CurrentCache current_cache_;
+
+  // Guards the members below.
+  mutable std::mutex mutex_;
+
+  std::vector<std::unique_ptr<char[]>> slabs_;
+  std::vector<std::unique_ptr<ThreadCache>> caches_;
+
+  // The heads of the free lists of the blocks that are not small, keyed by
+  // rounded block size.
+  std::unordered_map<size_t, FreeBlock*> large_free_lists_;
+
+  size_t bytes_reserved_;
+};
+
+// Base class that lets objects of class |T| live either on the heap or in an
+// |Arena|:
+//
+//     new T(...)           allocates from the heap
+//     new (arena) T(...)   allocates from |arena|, or the heap if it is null
+//     delete t             returns the memory to wherever it came from
+//
+// Each object is preceded by a pointer to the arena it came from, so that
+// owners such as std::unique_ptr do not need to know how it was allocated.
+template <class T>
+class ArenaAllocatable {
+ public:
+  static void* operator new(size_t size) { return operator new(size, nullptr); }
+
+  static void* operator new(size_t size, Arena* arena) {
+    static_assert(alignof(T) <= kHeaderSize,
+                  "The header would misalign the object.");
+    const size_t total = size + kHeaderSize;
+    void* block = arena ? arena->Allocate(total) : ::operator new(total);
+    *static_cast<Arena**>(block) = arena;
+    return static_cast<char*>(block) + kHeaderSize;
+  }
+
+  static void operator delete(void* p, size_t size) {
+    if (p == nullptr) return;
+    char* block = static_cast<char*>(p) - kHeaderSize;
+    Arena* arena = *reinterpret_cast<Arena**>(block);
+    if (arena) {
+      arena->Deallocate(block, size + kHeaderSize);
+    } else {
+      ::operator delete(block);
+    }
+  }
+
+  // Only called if a constructor throws.  Memory from an arena is not reused,
+  // but it is still released with the arena.
+  static void operator delete(void* p, Arena* arena) {
+    if (arena == nullptr) {
+      ::operator delete(static_cast<char*>(p) - kHeaderSize);
+    }
+  }
+
+ private:
+  enum : size_t { kHeaderSize = sizeof(Arena*) };
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_ARENA_H_
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_SPAN_H_
+#define SOURCE_UTIL_SPAN_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace spvtools {
+namespace utils {
+
+// A view of |size| contiguous elements starting at |data|, which it does not
+// own.  The elements must outlive the span.
+//
+// The public member functions follow those of |std::vector| for reading, so
+// that a span can replace a const reference to a vector.
+template <class T>
+class Span {
+ public:
+  using value_type = T;
+  using iterator = T*;
+  using const_iterator = T*;
+
+  Span() : data_(nullptr), size_(0) {}
+  Span(T* data, size_t size) : data_(data), size_(size) {}
+
+  T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T& operator[](size_t index) const {
+    assert(index < size_);
+    return data_[index];
+  }
+
+  T& front() const { return (*this)[0]; }
+  T& back() const { return (*this)[size_ - 1]; }
+
+  iterator begin() const { return data_; }
+  iterator end() const { return data_ + size_; }
+  const_iterator cbegin() const { return data_; }
+  const_iterator cend() const { return data_ + size_; }
+
+  // Returns true if |other| has the same elements, in the same order.
+  bool operator==(const Span& other) const {
+    return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const Span& other) const { return !(*this == other); }
+
+ private:
+  T* data_;
+  size_t size_;
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_SPAN_H_
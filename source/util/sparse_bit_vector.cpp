@@ -0,0 +1,78 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/util/sparse_bit_vector.h"
+
+namespace spvtools {
+namespace utils {
+
+size_t SparseBitVector::Count() const {
+  size_t count = 0;
+  for (const Element& element : elements_) {
+    for (BitContainer bits = element.bits; bits != 0; bits &= bits - 1) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool SparseBitVector::Or(const SparseBitVector& that) {
+  if (that.elements_.empty()) return false;
+  if (elements_.empty()) {
+    elements_ = that.elements_;
+    return true;
+  }
+
+  // Merge the two sorted lists of words.
+  std::vector<Element> merged;
+  merged.reserve(elements_.size() + that.elements_.size());
+  bool modified = false;
+  auto this_it = elements_.begin();
+  auto that_it = that.elements_.begin();
+  while (this_it != elements_.end() && that_it != that.elements_.end()) {
+    if (this_it->index < that_it->index) {
+      merged.push_back(*this_it++);
+    } else if (that_it->index < this_it->index) {
+      merged.push_back(*that_it++);
+      modified = true;
+    } else {
+      const BitContainer bits = this_it->bits | that_it->bits;
+      modified |= bits != this_it->bits;
+      merged.push_back(Element{this_it->index, bits});
+      ++this_it;
+      ++that_it;
+    }
+  }
+  merged.insert(merged.end(), this_it, elements_.end());
+  if (that_it != that.elements_.end()) {
+    merged.insert(merged.end(), that_it, that.elements_.end());
+    modified = true;
+  }
+  if (modified) elements_.swap(merged);
+  return modified;
+}
+
+bool SparseBitVector::operator==(const SparseBitVector& that) const {
+  if (elements_.size() != that.elements_.size()) return false;
+  for (size_t i = 0; i < elements_.size(); ++i) {
+    if (elements_[i].index != that.elements_[i].index ||
+        elements_[i].bits != that.elements_[i].bits) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace utils
+}  // namespace spvtools
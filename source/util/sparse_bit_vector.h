@@ -0,0 +1,131 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_UTIL_SPARSE_BIT_VECTOR_H_
+#define SOURCE_UTIL_SPARSE_BIT_VECTOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace spvtools {
+namespace utils {
+
+// Implements a bit vector that only stores the 64-bit words holding at least
+// one 1 bit, sorted by their position.  It is meant for sets of small
+// integers that are mostly clustered, such as the values live in a block
+// when the values are numbered in program order: such a set takes memory in
+// proportion to the number of clusters rather than to the largest element.
+//
+// All bits default to zero, and the upper bound is 2^32-1.
+class SparseBitVector {
+ private:
+  using BitContainer = uint64_t;
+  enum { kBitContainerSize = 64 };
+
+  struct Element {
+    uint32_t index;
+    BitContainer bits;
+  };
+
+ public:
+  // Sets the |i|th bit to 1.  Returns the |i|th bit before it was set.
+  bool Set(uint32_t i) {
+    const BitContainer ith_bit = Bit(i);
+    auto it = Find(i / kBitContainerSize);
+    if (it == elements_.end() || it->index != i / kBitContainerSize) {
+      elements_.insert(it, Element{i / kBitContainerSize, ith_bit});
+      return false;
+    }
+    if ((it->bits & ith_bit) != 0) return true;
+    it->bits |= ith_bit;
+    return false;
+  }
+
+  // Sets the |i|th bit to 0.  Returns the |i|th bit before it was cleared.
+  bool Clear(uint32_t i) {
+    const BitContainer ith_bit = Bit(i);
+    auto it = Find(i / kBitContainerSize);
+    if (it == elements_.end() || it->index != i / kBitContainerSize ||
+        (it->bits & ith_bit) == 0) {
+      return false;
+    }
+    it->bits &= ~ith_bit;
+    if (it->bits == 0) elements_.erase(it);
+    return true;
+  }
+
+  // Returns the |i|th bit.
+  bool Get(uint32_t i) const {
+    auto it = Find(i / kBitContainerSize);
+    return it != elements_.end() && it->index == i / kBitContainerSize &&
+           (it->bits & Bit(i)) != 0;
+  }
+
+  // Returns true if every bit is 0.
+  bool Empty() const { return elements_.empty(); }
+
+  // Returns the number of bits that are 1.
+  size_t Count() const;
+
+  // Sets every bit to 0.
+  void ClearAll() { elements_.clear(); }
+
+  // Calls |f| with the position of each bit that is 1, in increasing order.
+  template <typename Func>
+  void ForEach(Func f) const {
+    for (const Element& element : elements_) {
+      BitContainer bits = element.bits;
+      for (uint32_t j = 0; bits != 0; ++j, bits >>= 1) {
+        if ((bits & 1) != 0) f(element.index * kBitContainerSize + j);
+      }
+    }
+  }
+
+  // Performs a bitwise-or operation on |this| and |that|, storing the result in
+  // |this|.  Return true if |this| changed.
+  bool Or(const SparseBitVector& that);
+
+  bool operator==(const SparseBitVector& that) const;
+  bool operator!=(const SparseBitVector& that) const {
+    return !(*this == that);
+  }
+
+ private:
+  static BitContainer Bit(uint32_t i) {
+    return static_cast<BitContainer>(1) << (i % kBitContainerSize);
+  }
+
+  // Returns the first element whose index is not less than |index|.
+  std::vector<Element>::iterator Find(uint32_t index) {
+    return std::lower_bound(
+        elements_.begin(), elements_.end(), index,
+        [](const Element& e, uint32_t value) { return e.index < value; });
+  }
+  std::vector<Element>::const_iterator Find(uint32_t index) const {
+    return std::lower_bound(
+        elements_.begin(), elements_.end(), index,
+        [](const Element& e, uint32_t value) { return e.index < value; });
+  }
+
+  // The words with at least one 1 bit, sorted by index.  Word |index| holds
+  // bits [index * 64, index * 64 + 63].
+  std::vector<Element> elements_;
+};
+
+}  // namespace utils
+}  // namespace spvtools
+
+#endif  // SOURCE_UTIL_SPARSE_BIT_VECTOR_H_
@@ -221,6 +221,13 @@ class Function {
     limitations_.push_back(is_compatible);
   }
 
+  /// Replaces the limitations of this function by those of |other|, which
+  /// must be the same function in an earlier version of the module.
+  void CopyLimitationsFrom(const Function& other) {
+    execution_model_limitations_ = other.execution_model_limitations_;
+    limitations_ = other.limitations_;
+  }
+
   bool CheckLimitations(const ValidationState_t& _, const Function* entry_point,
                         std::string* reason) const;
 
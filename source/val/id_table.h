@@ -0,0 +1,207 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_VAL_ID_TABLE_H_
+#define SOURCE_VAL_ID_TABLE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace spvtools {
+namespace val {
+
+// Associates a value of type |T| with the ids of a module.  An id that was
+// never given a value reads as |T()|.
+//
+// The ids below the bound given to |Reset| find their value through an array
+// indexed by the id, so a lookup does not hash.  A dense table allocates the
+// whole array when it is reset, which suits tables that give most ids a
+// value.  A paged table allocates the array in pages, as they are first
+// written, so the ranges of ids without a value take little memory.  Larger
+// ids are kept in a map, so that they cannot make the table large.  They are
+// still correct, only slower to find, and a valid module whose ids are sparse
+// may have some.
+//
+// References to values stay valid until the table is reset.
+template <class T>
+class IdTable {
+ public:
+  // Whether the array for the ids below the bound is allocated whole, or in
+  // pages as they are written.
+  enum class Layout { kDense, kPaged };
+
+  // Visits the ids that have been given a value, in increasing order, as
+  // pairs of the id and its value.
+  class const_iterator {
+   public:
+    std::pair<uint32_t, const T&> operator*() const {
+      if (id_ < table_->bound_) {
+        return {id_, table_->values_[table_->Slot(id_)]};
+      }
+      return {overflow_->first, table_->values_[overflow_->second]};
+    }
+
+    const_iterator& operator++() {
+      if (id_ < table_->bound_) {
+        ++id_;
+        SkipIdsWithoutValue();
+      } else {
+        ++overflow_;
+      }
+      return *this;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return id_ == other.id_ && overflow_ == other.overflow_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class IdTable;
+
+    const_iterator(const IdTable* table, uint32_t id,
+                   std::map<uint32_t, uint32_t>::const_iterator overflow)
+        : table_(table), id_(id), overflow_(overflow) {
+      SkipIdsWithoutValue();
+    }
+
+    void SkipIdsWithoutValue() {
+      while (id_ < table_->bound_) {
+        if (table_->layout_ == Layout::kPaged &&
+            table_->pages_[id_ >> kPageBits].empty()) {
+          id_ = std::min(table_->bound_, (id_ | kPageMask) + 1);
+        } else if (table_->Slot(id_) == 0) {
+          ++id_;
+        } else {
+          break;
+        }
+      }
+    }
+
+    const IdTable* table_;
+    uint32_t id_;
+    std::map<uint32_t, uint32_t>::const_iterator overflow_;
+  };
+
+  explicit IdTable(Layout layout = Layout::kPaged)
+      : layout_(layout), bound_(0), values_(1) {}
+
+  // Forgets all values, and sizes the array for the ids below |bound|.
+  void Reset(uint32_t bound) {
+    bound_ = bound;
+    if (layout_ == Layout::kDense) {
+      slots_.assign(bound, 0);
+    } else {
+      pages_.clear();
+      pages_.resize((static_cast<size_t>(bound) + kPageMask) >> kPageBits);
+    }
+    overflow_slots_.clear();
+    values_.resize(1);
+  }
+
+  // Returns the value of |id|, giving it the value |T()| if it has none.
+  T& operator[](uint32_t id) {
+    uint32_t& slot = MutableSlot(id);
+    if (slot == 0) {
+      slot = static_cast<uint32_t>(values_.size());
+      values_.emplace_back();
+    }
+    return values_[slot];
+  }
+
+  // Returns the value of |id|, or |T()| if it has none.  Does not give |id| a
+  // value, so it is safe to call from several threads.
+  const T& Get(uint32_t id) const { return values_[Slot(id)]; }
+
+  // Returns true if |id| has been given a value.
+  bool Has(uint32_t id) const { return Slot(id) != 0; }
+
+  // Returns the number of bytes used by the table, not counting the memory
+  // the values own, nor the nodes of the map of large ids.
+  size_t MemoryUsage() const {
+    size_t bytes = slots_.capacity() * sizeof(uint32_t) +
+                   pages_.capacity() * sizeof(pages_[0]) +
+                   values_.size() * sizeof(T);
+    for (const auto& page : pages_) bytes += page.capacity() * sizeof(uint32_t);
+    return bytes;
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this, 0, overflow_slots_.begin());
+  }
+  const_iterator end() const {
+    return const_iterator(this, bound_, overflow_slots_.end());
+  }
+
+ private:
+  // Each page maps 2^kPageBits consecutive ids to their slots.
+  static const uint32_t kPageBits = 10;
+  static const uint32_t kPageMask = (1u << kPageBits) - 1;
+
+  // Returns the index in |values_| of the value of |id|, or 0 if it has none.
+  uint32_t Slot(uint32_t id) const {
+    if (id < bound_) {
+      if (layout_ == Layout::kDense) return slots_[id];
+      const std::vector<uint32_t>& page = pages_[id >> kPageBits];
+      return page.empty() ? 0 : page[id & kPageMask];
+    }
+    const auto it = overflow_slots_.find(id);
+    return it == overflow_slots_.end() ? 0 : it->second;
+  }
+
+  // Returns the index in |values_| of the value of |id|, allocating its page
+  // if needed.
+  uint32_t& MutableSlot(uint32_t id) {
+    if (id >= bound_) return overflow_slots_[id];
+    if (layout_ == Layout::kDense) return slots_[id];
+    std::vector<uint32_t>& page = pages_[id >> kPageBits];
+    if (page.empty()) page.assign(1u << kPageBits, 0);
+    return page[id & kPageMask];
+  }
+
+  Layout layout_;
+
+  // The ids below |bound_| find their slot in |slots_| or |pages_|, and the
+  // others in |overflow_slots_|.
+  uint32_t bound_;
+
+  // The index in |values_| of the value of each id below the bound, or 0 for
+  // the ids without one.  Used by dense tables.
+  std::vector<uint32_t> slots_;
+
+  // The same indices, in pages that are empty until one of their ids is given
+  // a value.  Used by paged tables.
+  std::vector<std::vector<uint32_t>> pages_;
+
+  // The index in |values_| of the value of each id at or above the bound that
+  // has one.
+  std::map<uint32_t, uint32_t> overflow_slots_;
+
+  // The values, in the order the ids were given them.  The first value is
+  // |T()|, read by all the ids without one.  A deque keeps references stable
+  // as it grows.
+  std::deque<T> values_;
+};
+
+}  // namespace val
+}  // namespace spvtools
+
+#endif  // SOURCE_VAL_ID_TABLE_H_
@@ -20,11 +20,7 @@ namespace spvtools {
 namespace val {
 
 Instruction::Instruction(const spv_parsed_instruction_t* inst)
-    : words_(inst->words, inst->words + inst->num_words),
-      operands_(inst->operands, inst->operands + inst->num_operands),
-      inst_({words_.data(), inst->num_words, inst->opcode, inst->ext_inst_type,
-             inst->type_id, inst->result_id, operands_.data(),
-             inst->num_operands}) {}
+    : inst_(*inst) {}
 
 void Instruction::RegisterUse(const Instruction* inst, uint32_t index) {
   uses_.push_back(std::make_pair(inst, index));
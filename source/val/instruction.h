@@ -23,6 +23,7 @@
 
 #include "source/ext_inst.h"
 #include "source/table.h"
+#include "source/util/span.h"
 #include "spirv-tools/libspirv.h"
 
 namespace spvtools {
@@ -35,6 +36,8 @@ class Function;
 /// instruction's result id
 class Instruction {
  public:
+  /// Creates the instruction parsed as |inst|.  The words and the operands of
+  /// |inst| are not copied, so they must outlive the instruction.
   explicit Instruction(const spv_parsed_instruction_t* inst);
 
   /// Registers the use of the Instruction in instruction \p inst at \p index
@@ -63,19 +66,26 @@ class Instruction {
   }
 
   /// The word used to define the Instruction
-  uint32_t word(size_t index) const { return words_[index]; }
+  uint32_t word(size_t index) const {
+    assert(index < inst_.num_words);
+    return inst_.words[index];
+  }
 
   /// The words used to define the Instruction
-  const std::vector<uint32_t>& words() const { return words_; }
+  utils::Span<const uint32_t> words() const {
+    return utils::Span<const uint32_t>(inst_.words, inst_.num_words);
+  }
 
   /// Returns the operand at |idx|.
   const spv_parsed_operand_t& operand(size_t idx) const {
-    return operands_[idx];
+    assert(idx < inst_.num_operands);
+    return inst_.operands[idx];
   }
 
   /// The operands of the Instruction
-  const std::vector<spv_parsed_operand_t>& operands() const {
-    return operands_;
+  utils::Span<const spv_parsed_operand_t> operands() const {
+    return utils::Span<const spv_parsed_operand_t>(inst_.operands,
+                                                    inst_.num_operands);
   }
 
   /// Provides direct access to the stored C instruction object.
@@ -100,18 +110,16 @@ class Instruction {
   // Casts the words belonging to the operand under |index| to |T| and returns.
   template <typename T>
   T GetOperandAs(size_t index) const {
-    const spv_parsed_operand_t& o = operands_.at(index);
+    const spv_parsed_operand_t& o = operand(index);
     assert(o.num_words * 4 >= sizeof(T));
     assert(o.offset + o.num_words <= inst_.num_words);
-    return *reinterpret_cast<const T*>(&words_[o.offset]);
+    return *reinterpret_cast<const T*>(&inst_.words[o.offset]);
   }
 
   size_t LineNum() const { return line_num_; }
   void SetLineNum(size_t pos) { line_num_ = pos; }
 
  private:
-  const std::vector<uint32_t> words_;
-  const std::vector<spv_parsed_operand_t> operands_;
   spv_parsed_instruction_t inst_;
   size_t line_num_ = 0;
 
@@ -22,6 +22,8 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "source/binary.h"
@@ -35,9 +37,13 @@
 #include "source/spirv_endian.h"
 #include "source/spirv_target_env.h"
 #include "source/spirv_validator_options.h"
+#include "source/table.h"
+#include "source/util/span.h"
+#include "source/util/timer.h"
 #include "source/val/construct.h"
 #include "source/val/function.h"
 #include "source/val/instruction.h"
+#include "source/val/validation_profile.h"
 #include "source/val/validation_state.h"
 #include "spirv-tools/libspirv.h"
 
@@ -209,9 +215,387 @@ spv_result_t ValidateEntryPoints(ValidationState_t& _) {
   return SPV_SUCCESS;
 }
 
-spv_result_t ValidateBinaryUsingContextAndValidationState(
-    const spv_context_t& context, const uint32_t* words, const size_t num_words,
-    spv_diagnostic* pDiagnostic, ValidationState_t* vstate) {
+// Returns the indices of the OpFunction instructions in the ordered
+// instructions of |_|.
+std::vector<size_t> FunctionStarts(const ValidationState_t& _) {
+  std::vector<size_t> starts;
+  const auto& instructions = _.ordered_instructions();
+  for (size_t i = 0; i < instructions.size(); ++i) {
+    if (instructions[i].opcode() == SpvOpFunction) starts.push_back(i);
+  }
+  return starts;
+}
+
+// Hashes the words of an instruction, to find instructions with the same
+// words.
+struct WordsHash {
+  size_t operator()(const utils::Span<const uint32_t>& words) const {
+    size_t hash = words.size();
+    for (uint32_t word : words) hash = hash * 31 + word;
+    return hash;
+  }
+};
+
+// Returns true if adding or removing |inst| outside functions may change the
+// checks of every function, rather than only of those using its ids.
+bool ChangesAllFunctions(const Instruction& inst) {
+  switch (inst.opcode()) {
+    case SpvOpCapability:
+    case SpvOpExtension:
+    case SpvOpExtInstImport:
+    case SpvOpMemoryModel:
+    case SpvOpEntryPoint:
+    case SpvOpExecutionMode:
+    case SpvOpExecutionModeId:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Adds to |ids| the result id of |inst| and the ids it uses.
+void AddIds(const Instruction& inst, std::unordered_set<uint32_t>* ids) {
+  if (inst.id() != 0) ids->insert(inst.id());
+  for (const spv_parsed_operand_t& operand : inst.operands()) {
+    if (spvIsIdType(operand.type)) ids->insert(inst.word(operand.offset));
+  }
+}
+
+// Compares the instructions outside functions, from |old_insts[0]| to
+// |old_end| in the earlier version and from |new_insts[0]| to |new_end| in
+// this one.  If the later version only removes or adds instructions, keeping
+// the others in the same order, adds the ids of the removed and added
+// instructions to |changed_ids| and returns true.  Returns false if the
+// instructions were reordered, or if one that affects every function changed.
+bool FindChangedGlobalIds(const std::vector<Instruction>& old_insts,
+                          size_t old_end,
+                          const std::vector<Instruction>& new_insts,
+                          size_t new_end,
+                          std::unordered_set<uint32_t>* changed_ids) {
+  using WordsSet =
+      std::unordered_multiset<utils::Span<const uint32_t>, WordsHash>;
+  WordsSet old_words;
+  WordsSet new_words;
+  for (size_t i = 0; i < old_end; ++i) old_words.insert(old_insts[i].words());
+  for (size_t i = 0; i < new_end; ++i) new_words.insert(new_insts[i].words());
+
+  size_t i = 0;
+  size_t j = 0;
+  while (i < old_end || j < new_end) {
+    const Instruction* changed = nullptr;
+    if (i < old_end && j < new_end &&
+        old_insts[i].words() == new_insts[j].words()) {
+      ++i;
+      ++j;
+      continue;
+    } else if (i < old_end && new_words.count(old_insts[i].words()) == 0) {
+      changed = &old_insts[i++];
+    } else if (j < new_end && old_words.count(new_insts[j].words()) == 0) {
+      changed = &new_insts[j++];
+    } else {
+      return false;
+    }
+    if (ChangesAllFunctions(*changed)) return false;
+    AddIds(*changed, changed_ids);
+  }
+  return true;
+}
+
+// Registers with |vstate| the functions that are unchanged since |previous|,
+// the state kept from a successful validation of an earlier version of the
+// module, and carries over the limitations that their instructions
+// registered.
+//
+// If |changed_functions| is not null, it names the functions that may have
+// changed, and the others are only checked to have as many instructions as
+// before.  Otherwise the functions are compared word by word.
+//
+// The checks of a function depend on the instructions outside functions and
+// on the signatures of the functions it calls.  Instructions outside
+// functions may be added or removed, and the signature of a function may
+// change; the functions that use the ids of those instructions or functions
+// are checked again.  Nothing is carried over if the instructions outside
+// functions were reordered, or if an instruction that affects every function,
+// such as a capability or an entry point, changed.
+void FindUnchangedFunctions(
+    const ValidationState_t& previous,
+    const std::unordered_set<uint32_t>* changed_functions,
+    ValidationState_t* vstate) {
+  const auto& old_insts = previous.ordered_instructions();
+  const auto& new_insts = vstate->ordered_instructions();
+  const std::vector<size_t> old_starts = FunctionStarts(previous);
+  const std::vector<size_t> new_starts = FunctionStarts(*vstate);
+
+  // Returns true if the |count| instructions from |old_begin| in the earlier
+  // version have the same words as those from |new_begin| in this one.
+  auto same_instructions = [&old_insts, &new_insts](
+                               size_t old_begin, size_t new_begin,
+                               size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      if (old_insts[old_begin + i].words() != new_insts[new_begin + i].words())
+        return false;
+    }
+    return true;
+  };
+  // Returns the end of the function starting at |starts[f]|.
+  auto function_end = [](const std::vector<Instruction>& insts,
+                         const std::vector<size_t>& starts, size_t f) {
+    return f + 1 < starts.size() ? starts[f + 1] : insts.size();
+  };
+  // Returns the end of the OpFunctionParameter instructions following the
+  // OpFunction at |begin|.
+  auto signature_end = [](const std::vector<Instruction>& insts, size_t begin,
+                          size_t end) {
+    size_t i = begin + 1;
+    while (i < end && insts[i].opcode() == SpvOpFunctionParameter) ++i;
+    return i;
+  };
+
+  // The ids whose definitions changed, and whose users must be checked again.
+  std::unordered_set<uint32_t> changed_ids;
+  const size_t old_global_end =
+      old_starts.empty() ? old_insts.size() : old_starts.front();
+  const size_t new_global_end =
+      new_starts.empty() ? new_insts.size() : new_starts.front();
+  if (!FindChangedGlobalIds(old_insts, old_global_end, new_insts,
+                            new_global_end, &changed_ids)) {
+    return;
+  }
+
+  std::unordered_map<uint32_t, size_t> old_functions;
+  for (size_t f = 0; f < old_starts.size(); ++f) {
+    old_functions[old_insts[old_starts[f]].id()] = f;
+  }
+
+  std::unordered_set<uint32_t> unchanged;
+  for (size_t f = 0; f < new_starts.size(); ++f) {
+    const uint32_t id = new_insts[new_starts[f]].id();
+    const auto old_function = old_functions.find(id);
+    if (old_function == old_functions.end()) continue;
+    const size_t old_index = old_function->second;
+    old_functions.erase(old_function);
+
+    const size_t old_begin = old_starts[old_index];
+    const size_t old_end = function_end(old_insts, old_starts, old_index);
+    const size_t new_begin = new_starts[f];
+    const size_t new_end = function_end(new_insts, new_starts, f);
+    if (old_end - old_begin != new_end - new_begin) {
+      changed_ids.insert(id);
+      continue;
+    }
+    if (changed_functions && changed_functions->count(id) == 0) {
+      unchanged.insert(id);
+      continue;
+    }
+
+    const size_t signature_size =
+        signature_end(new_insts, new_begin, new_end) - new_begin;
+    if (signature_end(old_insts, old_begin, old_end) - old_begin !=
+            signature_size ||
+        !same_instructions(old_begin, new_begin, signature_size)) {
+      changed_ids.insert(id);
+    } else if (same_instructions(old_begin, new_begin,
+                                 new_end - new_begin)) {
+      unchanged.insert(id);
+    }
+  }
+  // The functions that were removed may still be called.
+  for (const auto& old_function : old_functions) {
+    changed_ids.insert(old_function.first);
+  }
+
+  // A decoration group passes a change of its decorations on to the ids it
+  // decorates.
+  std::vector<uint32_t> worklist(changed_ids.begin(), changed_ids.end());
+  while (!worklist.empty()) {
+    const Instruction* def = vstate->FindDef(worklist.back());
+    worklist.pop_back();
+    if (!def) continue;
+    for (const auto& use : def->uses()) {
+      const Instruction* user = use.first;
+      if (user->function()) {
+        unchanged.erase(user->function()->id());
+      } else if (user->opcode() == SpvOpGroupDecorate ||
+                 user->opcode() == SpvOpGroupMemberDecorate) {
+        std::unordered_set<uint32_t> targets;
+        AddIds(*user, &targets);
+        for (uint32_t target : targets) {
+          if (changed_ids.insert(target).second) worklist.push_back(target);
+        }
+      }
+    }
+  }
+
+  for (uint32_t id : unchanged) {
+    vstate->RegisterUnchangedFunction(id);
+    vstate->function(id)->CopyLimitationsFrom(*previous.function(id));
+  }
+}
+
+// A check of an individual instruction, and the name it is reported under in
+// the time report.
+struct InstructionCheck {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t& _, const Instruction* inst);
+  // Returns true if |check| does anything on instructions with |opcode|.  It
+  // may be null if |check| is not skipped for any opcode.  Only consulted for
+  // kOpcodeChecks.
+  bool (*handles)(SpvOp opcode);
+};
+
+// The checks that register the instructions with the validation state, and
+// must therefore see them in the order of the module.
+const InstructionCheck kLayoutChecks[] = {
+    {"CapabilityPass", CapabilityPass},
+    {"ModuleLayoutPass", ModuleLayoutPass},
+    {"CfgPass", CfgPass},
+    {"InstructionPass", InstructionPass},
+};
+
+// The checks of the individual opcodes.  Keep these passes in the order they
+// appear in the SPIR-V specification sections to maintain test consistency.
+// The |handles| function of a pass must be true for every opcode the pass
+// acts on, or the pass is skipped for that opcode.
+const InstructionCheck kOpcodeChecks[] = {
+    {"MiscPass", MiscPass, MiscPassHandles},
+    {"DebugPass", DebugPass, DebugPassHandles},
+    {"AnnotationPass", AnnotationPass, AnnotationPassHandles},
+    {"ExtensionPass", ExtensionPass, ExtensionPassHandles},
+    {"ModeSettingPass", ModeSettingPass, ModeSettingPassHandles},
+    {"TypePass", TypePass, TypePassHandles},
+    {"ConstantPass", ConstantPass, ConstantPassHandles},
+    {"MemoryPass", MemoryPass, MemoryPassHandles},
+    {"FunctionPass", FunctionPass, FunctionPassHandles},
+    {"ImagePass", ImagePass, ImagePassHandles},
+    {"ConversionPass", ConversionPass, ConversionPassHandles},
+    {"CompositesPass", CompositesPass, CompositesPassHandles},
+    {"ArithmeticsPass", ArithmeticsPass, ArithmeticsPassHandles},
+    {"BitwisePass", BitwisePass, BitwisePassHandles},
+    {"LogicalsPass", LogicalsPass, LogicalsPassHandles},
+    {"ControlFlowPass", ControlFlowPass, ControlFlowPassHandles},
+    {"DerivativesPass", DerivativesPass, DerivativesPassHandles},
+    {"AtomicsPass", AtomicsPass, AtomicsPassHandles},
+    {"PrimitivesPass", PrimitivesPass, PrimitivesPassHandles},
+    {"BarriersPass", BarriersPass, BarriersPassHandles},
+    // Group
+    // Device-Side Enqueue
+    // Pipe
+    {"NonUniformPass", NonUniformPass, NonUniformPassHandles},
+
+    {"LiteralsPass", LiteralsPass, nullptr},
+};
+
+// The checks that need every instruction to have been checked by the opcode
+// checks, which register the limitations they verify.
+const InstructionCheck kLimitationChecks[] = {
+    {"ValidateExecutionLimitations", ValidateExecutionLimitations},
+    {"ValidateSmallTypeUses", ValidateSmallTypeUses},
+};
+
+// Runs |checks| on |inst| in order, and returns the first error.
+template <size_t N>
+spv_result_t RunInstructionChecks(ValidationState_t& _,
+                                  const InstructionCheck (&checks)[N],
+                                  const Instruction* inst) {
+  for (const InstructionCheck& check : checks) {
+    SPIRV_VAL_PROFILE_SCOPED(_.profile(), check.name, inst->opcode());
+    if (auto error = check.check(_, inst)) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+// The checks of kOpcodeChecks that do anything on the instructions of each
+// opcode, in the same order, so that an instruction is not handed to every
+// check just for most of them to return at once.
+class OpcodeDispatchTable {
+ public:
+  OpcodeDispatchTable() {
+    for (const InstructionCheck& check : kOpcodeChecks) {
+      all_checks_.push_back(&check);
+    }
+
+    spv_opcode_table opcodes = nullptr;
+    spvOpcodeTableGet(&opcodes, SPV_ENV_UNIVERSAL_1_0);
+    uint32_t bound = 0;
+    for (uint32_t i = 0; i < opcodes->count; ++i) {
+      const uint32_t opcode =
+          static_cast<uint32_t>(opcodes->entries[i].opcode);
+      bound = std::max(bound, opcode + 1);
+    }
+    begins_.reserve(bound + 1);
+    for (uint32_t opcode = 0; opcode < bound; ++opcode) {
+      begins_.push_back(checks_.size());
+      for (const InstructionCheck& check : kOpcodeChecks) {
+        if (!check.handles || check.handles(static_cast<SpvOp>(opcode))) {
+          checks_.push_back(&check);
+        }
+      }
+    }
+    begins_.push_back(checks_.size());
+  }
+
+  // Returns the checks to run on instructions with |opcode|.  All of them if
+  // |opcode| is not in the grammar.
+  utils::Span<const InstructionCheck* const> checks(SpvOp opcode) const {
+    const size_t index = static_cast<size_t>(opcode);
+    if (index + 1 >= begins_.size()) {
+      return {all_checks_.data(), all_checks_.size()};
+    }
+    return {checks_.data() + begins_[index],
+            begins_[index + 1] - begins_[index]};
+  }
+
+ private:
+  std::vector<const InstructionCheck*> all_checks_;
+  // The checks of each opcode are those from |checks_[begins_[opcode]]| up to
+  // |checks_[begins_[opcode + 1]]|.
+  std::vector<const InstructionCheck*> checks_;
+  std::vector<size_t> begins_;
+};
+
+// Runs the checks of the individual opcodes on |inst|.
+spv_result_t ValidateInstruction(ValidationState_t& _,
+                                 const Instruction* inst) {
+  static const OpcodeDispatchTable dispatch_table;
+  for (const InstructionCheck* check : dispatch_table.checks(inst->opcode())) {
+    SPIRV_VAL_PROFILE_SCOPED(_.profile(), check->name, inst->opcode());
+    if (auto error = check->check(_, inst)) return error;
+  }
+  return SPV_SUCCESS;
+}
+
+// A check of the whole module, and the name it is reported under in the time
+// report.
+struct ModuleCheck {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t& _);
+};
+
+// The checks of the whole module, which need the individual opcodes to have
+// been checked.
+const ModuleCheck kModuleChecks[] = {
+    // Validate the preconditions involving adjacent instructions. e.g.
+    // SpvOpPhi must only be preceeded by SpvOpLabel, SpvOpPhi, or SpvOpLine.
+    {"ValidateAdjacency", ValidateAdjacency},
+    {"ValidateEntryPoints", ValidateEntryPoints},
+    // CFG checks are performed after the binary has been parsed
+    // and the CFGPass has collected information about the control flow
+    {"PerformCfgChecks", PerformCfgChecks},
+    {"CheckIdDefinitionDominateUse", CheckIdDefinitionDominateUse},
+    {"ValidateDecorations", ValidateDecorations},
+    {"ValidateInterfaces", ValidateInterfaces},
+    // TODO(dsinclair): Restructure ValidateBuiltins so we can move into the
+    // for() above as it loops over all ordered_instructions internally.
+    {"ValidateBuiltIns", ValidateBuiltIns},
+};
+
+// Validates the module in |words| with |vstate|.  See
+// ValidateBinaryUsingContextAndValidationState.
+spv_result_t RunValidation(
+    const spv_context_t& context, const uint32_t* words,
+    const size_t num_words, spv_diagnostic* pDiagnostic,
+    ValidationState_t* vstate, const ValidationState_t* previous,
+    const std::unordered_set<uint32_t>* changed_functions) {
   auto binary = std::unique_ptr<spv_const_binary_t>(
       new spv_const_binary_t{words, num_words});
 
@@ -266,10 +650,16 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
 
   // Parse the module and perform inline validation checks. These checks do
   // not require the the knowledge of the whole module.
-  if (auto error = spvBinaryParse(&context, vstate, words, num_words,
-                                  /*parsed_header =*/nullptr,
-                                  ProcessInstruction, pDiagnostic)) {
-    return error;
+  {
+    // Covers the parse and the storing of each instruction.  The layout and
+    // id checks run after it, each under its own name, and any check timed
+    // inside the parse would be left out of its time.
+    SPIRV_VAL_PROFILE_SCOPED(vstate->profile(), "spvBinaryParse");
+    if (auto error = spvBinaryParse(&context, vstate, words, num_words,
+                                    /*parsed_header =*/nullptr,
+                                    ProcessInstruction, pDiagnostic)) {
+      return error;
+    }
   }
 
   std::vector<Instruction*> visited_entry_points;
@@ -339,13 +729,14 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
         }
       }
 
+      SPIRV_VAL_PROFILE_SCOPED(vstate->profile(), "IdPass", inst->opcode());
       if (auto error = IdPass(*vstate, inst)) return error;
     }
 
-    if (auto error = CapabilityPass(*vstate, &instruction)) return error;
-    if (auto error = ModuleLayoutPass(*vstate, &instruction)) return error;
-    if (auto error = CfgPass(*vstate, &instruction)) return error;
-    if (auto error = InstructionPass(*vstate, &instruction)) return error;
+    if (auto error =
+            RunInstructionChecks(*vstate, kLayoutChecks, &instruction)) {
+      return error;
+    }
 
     // Now that all of the checks are done, update the state.
     {
@@ -382,73 +773,86 @@ spv_result_t ValidateBinaryUsingContextAndValidationState(
   // messages.
   for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
     auto& instruction = vstate->ordered_instructions()[i];
+    SPIRV_VAL_PROFILE_SCOPED(vstate->profile(), "UpdateIdUse",
+                             instruction.opcode());
     if (auto error = UpdateIdUse(*vstate, &instruction)) return error;
   }
 
-  // Validate individual opcodes.
-  for (size_t i = 0; i < vstate->ordered_instructions().size(); ++i) {
-    auto& instruction = vstate->ordered_instructions()[i];
-
-    // Keep these passes in the order they appear in the SPIR-V specification
-    // sections to maintain test consistency.
-    if (auto error = MiscPass(*vstate, &instruction)) return error;
-    if (auto error = DebugPass(*vstate, &instruction)) return error;
-    if (auto error = AnnotationPass(*vstate, &instruction)) return error;
-    if (auto error = ExtensionPass(*vstate, &instruction)) return error;
-    if (auto error = ModeSettingPass(*vstate, &instruction)) return error;
-    if (auto error = TypePass(*vstate, &instruction)) return error;
-    if (auto error = ConstantPass(*vstate, &instruction)) return error;
-    if (auto error = MemoryPass(*vstate, &instruction)) return error;
-    if (auto error = FunctionPass(*vstate, &instruction)) return error;
-    if (auto error = ImagePass(*vstate, &instruction)) return error;
-    if (auto error = ConversionPass(*vstate, &instruction)) return error;
-    if (auto error = CompositesPass(*vstate, &instruction)) return error;
-    if (auto error = ArithmeticsPass(*vstate, &instruction)) return error;
-    if (auto error = BitwisePass(*vstate, &instruction)) return error;
-    if (auto error = LogicalsPass(*vstate, &instruction)) return error;
-    if (auto error = ControlFlowPass(*vstate, &instruction)) return error;
-    if (auto error = DerivativesPass(*vstate, &instruction)) return error;
-    if (auto error = AtomicsPass(*vstate, &instruction)) return error;
-    if (auto error = PrimitivesPass(*vstate, &instruction)) return error;
-    if (auto error = BarriersPass(*vstate, &instruction)) return error;
-    // Group
-    // Device-Side Enqueue
-    // Pipe
-    if (auto error = NonUniformPass(*vstate, &instruction)) return error;
-
-    if (auto error = LiteralsPass(*vstate, &instruction)) return error;
+  if (previous) FindUnchangedFunctions(*previous, changed_functions, vstate);
+
+  // Validate individual opcodes.  The instructions before the first function
+  // are checked first, since they register module-level state.  The checks of
+  // the instructions in a function only read that state, apart from
+  // registering limitations on the function itself, so the functions may be
+  // checked in parallel.
+  const auto& instructions = vstate->ordered_instructions();
+  const std::vector<size_t> function_starts = FunctionStarts(*vstate);
+  const size_t global_end =
+      function_starts.empty() ? instructions.size() : function_starts.front();
+  for (size_t i = 0; i < global_end; ++i) {
+    if (auto error = ValidateInstruction(*vstate, &instructions[i]))
+      return error;
   }
+  const auto validate_function = [&](size_t f) {
+    if (vstate->IsFunctionUnchanged(instructions[function_starts[f]].id()))
+      return SPV_SUCCESS;
+    const size_t end = f + 1 < function_starts.size() ? function_starts[f + 1]
+                                                      : instructions.size();
+    for (size_t i = function_starts[f]; i < end; ++i) {
+      if (auto error = ValidateInstruction(*vstate, &instructions[i]))
+        return error;
+    }
+    return SPV_SUCCESS;
+  };
+  if (auto error = vstate->ForEachIndexInParallel(function_starts.size(),
+                                                  validate_function))
+    return error;
 
-  // Validate the preconditions involving adjacent instructions. e.g. SpvOpPhi
-  // must only be preceeded by SpvOpLabel, SpvOpPhi, or SpvOpLine.
-  if (auto error = ValidateAdjacency(*vstate)) return error;
-
-  if (auto error = ValidateEntryPoints(*vstate)) return error;
-  // CFG checks are performed after the binary has been parsed
-  // and the CFGPass has collected information about the control flow
-  if (auto error = PerformCfgChecks(*vstate)) return error;
-  if (auto error = CheckIdDefinitionDominateUse(*vstate)) return error;
-  if (auto error = ValidateDecorations(*vstate)) return error;
-  if (auto error = ValidateInterfaces(*vstate)) return error;
-  // TODO(dsinclair): Restructure ValidateBuiltins so we can move into the
-  // for() above as it loops over all ordered_instructions internally.
-  if (auto error = ValidateBuiltIns(*vstate)) return error;
+  for (const ModuleCheck& check : kModuleChecks) {
+    SPIRV_VAL_PROFILE_SCOPED(vstate->profile(), check.name);
+    if (auto error = check.check(*vstate)) return error;
+  }
   // These checks must be performed after individual opcode checks because
   // those checks register the limitation checked here.
   for (const auto& inst : vstate->ordered_instructions()) {
-    if (auto error = ValidateExecutionLimitations(*vstate, &inst)) return error;
-    if (auto error = ValidateSmallTypeUses(*vstate, &inst)) return error;
+    if (auto error = RunInstructionChecks(*vstate, kLimitationChecks, &inst))
+      return error;
   }
 
   return SPV_SUCCESS;
 }
 
+spv_result_t ValidateBinaryUsingContextAndValidationState(
+    const spv_context_t& context, const uint32_t* words, const size_t num_words,
+    spv_diagnostic* pDiagnostic, ValidationState_t* vstate,
+    const ValidationState_t* previous = nullptr,
+    const std::unordered_set<uint32_t>* changed_functions = nullptr) {
+  spv_result_t result;
+  {
+    SPIRV_TIMER_DESCRIPTION(vstate->options()->time_report_stream,
+                            /* measure_mem_usage = */ true);
+    SPIRV_TIMER_SCOPED(vstate->options()->time_report_stream, "validation",
+                       true);
+    result = RunValidation(context, words, num_words, pDiagnostic, vstate,
+                           previous, changed_functions);
+  }
+#if defined(SPIRV_TIMER_ENABLED)
+  if (vstate->profile()) {
+    vstate->RecordTableMemory();
+    vstate->profile()->Report(vstate->options()->time_report_stream);
+  }
+#endif
+  return result;
+}
+
 }  // namespace
 
 spv_result_t ValidateBinaryAndKeepValidationState(
     const spv_const_context context, spv_const_validator_options options,
     const uint32_t* words, const size_t num_words, spv_diagnostic* pDiagnostic,
-    std::unique_ptr<ValidationState_t>* vstate) {
+    std::unique_ptr<ValidationState_t>* vstate,
+    const ValidationState_t* previous,
+    const std::unordered_set<uint32_t>* changed_functions) {
   spv_context_t hijack_context = *context;
   if (pDiagnostic) {
     *pDiagnostic = nullptr;
@@ -459,7 +863,8 @@ spv_result_t ValidateBinaryAndKeepValidationState(
                                       num_words, kDefaultMaxNumOfWarnings));
 
   return ValidateBinaryUsingContextAndValidationState(
-      hijack_context, words, num_words, pDiagnostic, vstate->get());
+      hijack_context, words, num_words, pDiagnostic, vstate->get(), previous,
+      changed_functions);
 }
 
 }  // namespace val
@@ -17,6 +17,7 @@
 
 #include <functional>
 #include <memory>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -36,6 +37,12 @@ class Instruction;
 using get_blocks_func =
     std::function<const std::vector<BasicBlock*>*(const BasicBlock*)>;
 
+/// A function that checks the instructions of some opcodes.  Several of the
+/// passes below look theirs up by opcode in one switch, which their
+/// XxxPassHandles predicate also consults, so that the opcodes are listed once.
+using InstructionValidator = spv_result_t (*)(ValidationState_t& _,
+                                              const Instruction* inst);
+
 /// @brief Performs the Control Flow Graph checks
 ///
 /// @param[in] _ the validation state of the module
@@ -93,6 +100,9 @@ spv_result_t ValidateInterfaces(ValidationState_t& _);
 /// @return SPV_SUCCESS if no errors are found.
 spv_result_t MemoryPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if MemoryPass checks instructions with |opcode|.
+bool MemoryPassHandles(SpvOp opcode);
+
 /// @brief Updates the immediate dominator for each of the block edges
 ///
 /// Updates the immediate dominator of the blocks for each of the edges
@@ -120,6 +130,9 @@ spv_result_t CfgPass(ValidationState_t& _, const Instruction* inst);
 /// Validates Control Flow Graph instructions.
 spv_result_t ControlFlowPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ControlFlowPass checks instructions with |opcode|.
+bool ControlFlowPassHandles(SpvOp opcode);
+
 /// Performs Id and SSA validation of a module
 spv_result_t IdPass(ValidationState_t& _, Instruction* inst);
 
@@ -136,51 +149,96 @@ spv_result_t ValidateBuiltIns(ValidationState_t& _);
 /// Validates type instructions.
 spv_result_t TypePass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if TypePass checks instructions with |opcode|.
+bool TypePassHandles(SpvOp opcode);
+
 /// Validates constant instructions.
 spv_result_t ConstantPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ConstantPass checks instructions with |opcode|.
+bool ConstantPassHandles(SpvOp opcode);
+
 /// Validates correctness of arithmetic instructions.
 spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ArithmeticsPass checks instructions with |opcode|.
+bool ArithmeticsPassHandles(SpvOp opcode);
+
 /// Validates correctness of composite instructions.
 spv_result_t CompositesPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if CompositesPass checks instructions with |opcode|.
+bool CompositesPassHandles(SpvOp opcode);
+
 /// Validates correctness of conversion instructions.
 spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ConversionPass checks instructions with |opcode|.
+bool ConversionPassHandles(SpvOp opcode);
+
 /// Validates correctness of derivative instructions.
 spv_result_t DerivativesPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if DerivativesPass checks instructions with |opcode|.
+bool DerivativesPassHandles(SpvOp opcode);
+
 /// Validates correctness of logical instructions.
 spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if LogicalsPass checks instructions with |opcode|.
+bool LogicalsPassHandles(SpvOp opcode);
+
 /// Validates correctness of bitwise instructions.
 spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if BitwisePass checks instructions with |opcode|.
+bool BitwisePassHandles(SpvOp opcode);
+
 /// Validates correctness of image instructions.
 spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ImagePass checks instructions with |opcode|.
+bool ImagePassHandles(SpvOp opcode);
+
 /// Validates correctness of atomic instructions.
 spv_result_t AtomicsPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if AtomicsPass checks instructions with |opcode|.
+bool AtomicsPassHandles(SpvOp opcode);
+
 /// Validates correctness of barrier instructions.
 spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if BarriersPass checks instructions with |opcode|.
+bool BarriersPassHandles(SpvOp opcode);
+
 /// Validates correctness of literal numbers.
 spv_result_t LiteralsPass(ValidationState_t& _, const Instruction* inst);
 
 /// Validates correctness of extension instructions.
 spv_result_t ExtensionPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ExtensionPass checks instructions with |opcode|.
+bool ExtensionPassHandles(SpvOp opcode);
+
 /// Validates correctness of annotation instructions.
 spv_result_t AnnotationPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if AnnotationPass checks instructions with |opcode|.
+bool AnnotationPassHandles(SpvOp opcode);
+
 /// Validates correctness of non-uniform group instructions.
 spv_result_t NonUniformPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if NonUniformPass checks instructions with |opcode|.
+bool NonUniformPassHandles(SpvOp opcode);
+
 /// Validates correctness of debug instructions.
 spv_result_t DebugPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if DebugPass checks instructions with |opcode|.
+bool DebugPassHandles(SpvOp opcode);
+
 // Validates that capability declarations use operands allowed in the current
 // context.
 spv_result_t CapabilityPass(ValidationState_t& _, const Instruction* inst);
@@ -188,15 +246,27 @@ spv_result_t CapabilityPass(ValidationState_t& _, const Instruction* inst);
 /// Validates correctness of primitive instructions.
 spv_result_t PrimitivesPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if PrimitivesPass checks instructions with |opcode|.
+bool PrimitivesPassHandles(SpvOp opcode);
+
 /// Validates correctness of mode setting instructions.
 spv_result_t ModeSettingPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if ModeSettingPass checks instructions with |opcode|.
+bool ModeSettingPassHandles(SpvOp opcode);
+
 /// Validates correctness of function instructions.
 spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if FunctionPass checks instructions with |opcode|.
+bool FunctionPassHandles(SpvOp opcode);
+
 /// Validates correctness of miscellaneous instructions.
 spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst);
 
+/// Returns true if MiscPass checks instructions with |opcode|.
+bool MiscPassHandles(SpvOp opcode);
+
 /// Calculates the reachability of basic blocks.
 void ReachabilityPass(ValidationState_t& _);
 
@@ -231,10 +301,26 @@ spv_result_t spvValidateIDs(const spv_instruction_t* pInstructions,
 // The main difference between this API and spvValidateBinary is that the
 // "Validation State" is not destroyed upon function return; it lives on and is
 // pointed to by the vstate unique_ptr.
+//
+// If |previous| is not null, it must be the state kept from a successful
+// validation of an earlier version of the same module, and the binary it was
+// built from must still be alive.  The function-local checks are then skipped
+// for the functions that have not changed since, and that do not use an id
+// whose definition changed outside functions, or a function whose signature
+// changed.  Nothing is skipped if the instructions outside functions were
+// reordered, or if their capabilities, extensions, memory model, entry points
+// or execution modes changed.  Only the instructions and functions of
+// |previous| are read.
+//
+// If |changed_functions| is not null, it names the functions that may have
+// changed since |previous|, so that the others need not be compared with
+// their earlier version.
 spv_result_t ValidateBinaryAndKeepValidationState(
     const spv_const_context context, spv_const_validator_options options,
     const uint32_t* words, const size_t num_words, spv_diagnostic* pDiagnostic,
-    std::unique_ptr<ValidationState_t>* vstate);
+    std::unique_ptr<ValidationState_t>* vstate,
+    const ValidationState_t* previous = nullptr,
+    const std::unordered_set<uint32_t>* changed_functions = nullptr);
 
 }  // namespace val
 }  // namespace spvtools
@@ -406,7 +406,7 @@ spv_result_t RegisterDecorations(ValidationState_t& _,
       // Word 1 is the group <id>. All subsequent words are target <id>s that
       // are going to be decorated with the decorations.
       const uint32_t decoration_group_id = inst->word(1);
-      std::vector<Decoration>& group_decorations =
+      const std::vector<Decoration>& group_decorations =
           _.id_decorations(decoration_group_id);
       for (size_t i = 2; i < inst->words().size(); ++i) {
         const uint32_t target_id = inst->word(i);
@@ -420,7 +420,7 @@ spv_result_t RegisterDecorations(ValidationState_t& _,
       // pairs. All decorations of the group should be applied to all the struct
       // members that are specified in the instructions.
       const uint32_t decoration_group_id = inst->word(1);
-      std::vector<Decoration>& group_decorations =
+      const std::vector<Decoration>& group_decorations =
           _.id_decorations(decoration_group_id);
       // Grammar checks ensures that the number of arguments to this instruction
       // is an odd number: 1 decoration group + (id,literal) pairs.
@@ -441,32 +441,38 @@ spv_result_t RegisterDecorations(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t AnnotationPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// AnnotationPass does not check them.
+InstructionValidator AnnotationValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpDecorate:
-      if (auto error = ValidateDecorate(_, inst)) return error;
-      break;
+      return ValidateDecorate;
     case SpvOpDecorateId:
-      if (auto error = ValidateDecorateId(_, inst)) return error;
-      break;
+      return ValidateDecorateId;
     // TODO(dneto): SpvOpDecorateStringGOOGLE
     // See https://github.com/KhronosGroup/SPIRV-Tools/issues/2253
     case SpvOpMemberDecorate:
-      if (auto error = ValidateMemberDecorate(_, inst)) return error;
-      break;
+      return ValidateMemberDecorate;
     case SpvOpDecorationGroup:
-      if (auto error = ValidateDecorationGroup(_, inst)) return error;
-      break;
+      return ValidateDecorationGroup;
     case SpvOpGroupDecorate:
-      if (auto error = ValidateGroupDecorate(_, inst)) return error;
-      break;
+      return ValidateGroupDecorate;
     case SpvOpGroupMemberDecorate:
-      if (auto error = ValidateGroupMemberDecorate(_, inst)) return error;
-      break;
+      return ValidateGroupMemberDecorate;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool AnnotationPassHandles(SpvOp opcode) {
+  return AnnotationValidator(opcode) != nullptr;
+}
+
+spv_result_t AnnotationPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = AnnotationValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   // In order to validate decoration rules, we need to know all the decorations
@@ -26,11 +26,28 @@
 namespace spvtools {
 namespace val {
 
-// Validates correctness of arithmetic instructions.
-spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
-  const uint32_t result_type = inst->type_id();
-
+namespace {
+
+// The kinds of instructions ArithmeticsPass checks, one for each case of its
+// switch.
+enum class ArithmeticKind {
+  kNone,
+  kFloat,
+  kUnsignedInt,
+  kInt,
+  kDot,
+  kVectorTimesScalar,
+  kMatrixTimesScalar,
+  kVectorTimesMatrix,
+  kMatrixTimesVector,
+  kMatrixTimesMatrix,
+  kOuterProduct,
+  kExtended,
+  kCooperativeMatrixMulAdd,
+};
+
+// Returns the kind of the instructions with |opcode|.
+ArithmeticKind GetArithmeticKind(SpvOp opcode) {
   switch (opcode) {
     case SpvOpFAdd:
     case SpvOpFSub:
@@ -38,7 +55,58 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
     case SpvOpFDiv:
     case SpvOpFRem:
     case SpvOpFMod:
-    case SpvOpFNegate: {
+    case SpvOpFNegate:
+      return ArithmeticKind::kFloat;
+    case SpvOpUDiv:
+    case SpvOpUMod:
+      return ArithmeticKind::kUnsignedInt;
+    case SpvOpISub:
+    case SpvOpIAdd:
+    case SpvOpIMul:
+    case SpvOpSDiv:
+    case SpvOpSMod:
+    case SpvOpSRem:
+    case SpvOpSNegate:
+      return ArithmeticKind::kInt;
+    case SpvOpDot:
+      return ArithmeticKind::kDot;
+    case SpvOpVectorTimesScalar:
+      return ArithmeticKind::kVectorTimesScalar;
+    case SpvOpMatrixTimesScalar:
+      return ArithmeticKind::kMatrixTimesScalar;
+    case SpvOpVectorTimesMatrix:
+      return ArithmeticKind::kVectorTimesMatrix;
+    case SpvOpMatrixTimesVector:
+      return ArithmeticKind::kMatrixTimesVector;
+    case SpvOpMatrixTimesMatrix:
+      return ArithmeticKind::kMatrixTimesMatrix;
+    case SpvOpOuterProduct:
+      return ArithmeticKind::kOuterProduct;
+    case SpvOpIAddCarry:
+    case SpvOpISubBorrow:
+    case SpvOpUMulExtended:
+    case SpvOpSMulExtended:
+      return ArithmeticKind::kExtended;
+    case SpvOpCooperativeMatrixMulAddNV:
+      return ArithmeticKind::kCooperativeMatrixMulAdd;
+    default:
+      return ArithmeticKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool ArithmeticsPassHandles(SpvOp opcode) {
+  return GetArithmeticKind(opcode) != ArithmeticKind::kNone;
+}
+
+// Validates correctness of arithmetic instructions.
+spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  const uint32_t result_type = inst->type_id();
+
+  switch (GetArithmeticKind(opcode)) {
+    case ArithmeticKind::kFloat: {
       bool supportsCoopMat =
           (opcode != SpvOpFMul && opcode != SpvOpFRem && opcode != SpvOpFMod);
       if (!_.IsFloatScalarType(result_type) &&
@@ -59,8 +127,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpUDiv:
-    case SpvOpUMod: {
+    case ArithmeticKind::kUnsignedInt: {
       bool supportsCoopMat = (opcode == SpvOpUDiv);
       if (!_.IsUnsignedIntScalarType(result_type) &&
           !_.IsUnsignedIntVectorType(result_type) &&
@@ -81,13 +148,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpISub:
-    case SpvOpIAdd:
-    case SpvOpIMul:
-    case SpvOpSDiv:
-    case SpvOpSMod:
-    case SpvOpSRem:
-    case SpvOpSNegate: {
+    case ArithmeticKind::kInt: {
       bool supportsCoopMat =
           (opcode != SpvOpIMul && opcode != SpvOpSRem && opcode != SpvOpSMod);
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type) &&
@@ -125,7 +186,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpDot: {
+    case ArithmeticKind::kDot: {
       if (!_.IsFloatScalarType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected float scalar type as Result Type: "
@@ -162,7 +223,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpVectorTimesScalar: {
+    case ArithmeticKind::kVectorTimesScalar: {
       if (!_.IsFloatVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected float vector type as Result Type: "
@@ -185,7 +246,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpMatrixTimesScalar: {
+    case ArithmeticKind::kMatrixTimesScalar: {
       if (!_.IsFloatMatrixType(result_type) &&
           !_.IsCooperativeMatrixType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
@@ -209,7 +270,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpVectorTimesMatrix: {
+    case ArithmeticKind::kVectorTimesMatrix: {
       const uint32_t vector_type_id = _.GetOperandTypeId(inst, 2);
       const uint32_t matrix_type_id = _.GetOperandTypeId(inst, 3);
 
@@ -259,7 +320,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpMatrixTimesVector: {
+    case ArithmeticKind::kMatrixTimesVector: {
       const uint32_t matrix_type_id = _.GetOperandTypeId(inst, 2);
       const uint32_t vector_type_id = _.GetOperandTypeId(inst, 3);
 
@@ -303,7 +364,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpMatrixTimesMatrix: {
+    case ArithmeticKind::kMatrixTimesMatrix: {
       const uint32_t left_type_id = _.GetOperandTypeId(inst, 2);
       const uint32_t right_type_id = _.GetOperandTypeId(inst, 3);
 
@@ -369,7 +430,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpOuterProduct: {
+    case ArithmeticKind::kOuterProduct: {
       const uint32_t left_type_id = _.GetOperandTypeId(inst, 2);
       const uint32_t right_type_id = _.GetOperandTypeId(inst, 3);
 
@@ -407,10 +468,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpIAddCarry:
-    case SpvOpISubBorrow:
-    case SpvOpUMulExtended:
-    case SpvOpSMulExtended: {
+    case ArithmeticKind::kExtended: {
       std::vector<uint32_t> result_types;
       if (!_.GetStructMemberTypes(result_type, &result_types))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
@@ -453,7 +511,7 @@ spv_result_t ArithmeticsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpCooperativeMatrixMulAddNV: {
+    case ArithmeticKind::kCooperativeMatrixMulAdd: {
       const uint32_t D_type_id = _.GetOperandTypeId(inst, 1);
       const uint32_t A_type_id = _.GetOperandTypeId(inst, 2);
       const uint32_t B_type_id = _.GetOperandTypeId(inst, 3);
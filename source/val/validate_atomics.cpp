@@ -50,15 +50,16 @@ bool IsStorageClassAllowedByUniversalRules(uint32_t storage_class) {
 namespace spvtools {
 namespace val {
 
-// Validates correctness of atomic instructions.
-spv_result_t AtomicsPass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
-  const uint32_t result_type = inst->type_id();
-  bool is_atomic_float_opcode = false;
-  if (opcode == SpvOpAtomicLoad || opcode == SpvOpAtomicStore ||
-      opcode == SpvOpAtomicFAddEXT || opcode == SpvOpAtomicExchange) {
-    is_atomic_float_opcode = true;
-  }
+namespace {
+
+// The kinds of instructions AtomicsPass checks.  They are all checked alike.
+enum class AtomicKind {
+  kNone,
+  kAtomic,
+};
+
+// Returns the kind of the instructions with |opcode|.
+AtomicKind GetAtomicKind(SpvOp opcode) {
   switch (opcode) {
     case SpvOpAtomicLoad:
     case SpvOpAtomicStore:
@@ -78,7 +79,30 @@ spv_result_t AtomicsPass(ValidationState_t& _, const Instruction* inst) {
     case SpvOpAtomicOr:
     case SpvOpAtomicXor:
     case SpvOpAtomicFlagTestAndSet:
-    case SpvOpAtomicFlagClear: {
+    case SpvOpAtomicFlagClear:
+      return AtomicKind::kAtomic;
+    default:
+      return AtomicKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool AtomicsPassHandles(SpvOp opcode) {
+  return GetAtomicKind(opcode) != AtomicKind::kNone;
+}
+
+// Validates correctness of atomic instructions.
+spv_result_t AtomicsPass(ValidationState_t& _, const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  const uint32_t result_type = inst->type_id();
+  bool is_atomic_float_opcode = false;
+  if (opcode == SpvOpAtomicLoad || opcode == SpvOpAtomicStore ||
+      opcode == SpvOpAtomicFAddEXT || opcode == SpvOpAtomicExchange) {
+    is_atomic_float_opcode = true;
+  }
+  switch (GetAtomicKind(opcode)) {
+    case AtomicKind::kAtomic: {
       if (_.HasCapability(SpvCapabilityKernel) &&
           (opcode == SpvOpAtomicLoad || opcode == SpvOpAtomicExchange ||
            opcode == SpvOpAtomicCompareExchange)) {
@@ -30,13 +30,47 @@
 namespace spvtools {
 namespace val {
 
+namespace {
+
+// The kinds of instructions BarriersPass checks, one for each case of its
+// switch.
+enum class BarrierKind {
+  kNone,
+  kControlBarrier,
+  kMemoryBarrier,
+  kNamedBarrierInitialize,
+  kMemoryNamedBarrier,
+};
+
+// Returns the kind of the instructions with |opcode|.
+BarrierKind GetBarrierKind(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpControlBarrier:
+      return BarrierKind::kControlBarrier;
+    case SpvOpMemoryBarrier:
+      return BarrierKind::kMemoryBarrier;
+    case SpvOpNamedBarrierInitialize:
+      return BarrierKind::kNamedBarrierInitialize;
+    case SpvOpMemoryNamedBarrier:
+      return BarrierKind::kMemoryNamedBarrier;
+    default:
+      return BarrierKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool BarriersPassHandles(SpvOp opcode) {
+  return GetBarrierKind(opcode) != BarrierKind::kNone;
+}
+
 // Validates correctness of barrier instructions.
 spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
 
-  switch (opcode) {
-    case SpvOpControlBarrier: {
+  switch (GetBarrierKind(opcode)) {
+    case BarrierKind::kControlBarrier: {
       if (_.version() < SPV_SPIRV_VERSION_WORD(1, 3)) {
         _.function(inst->function()->id())
             ->RegisterExecutionModelLimitation(
@@ -75,7 +109,7 @@ spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpMemoryBarrier: {
+    case BarrierKind::kMemoryBarrier: {
       const uint32_t memory_scope = inst->word(1);
 
       if (auto error = ValidateMemoryScope(_, inst, memory_scope)) {
@@ -88,7 +122,7 @@ spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpNamedBarrierInitialize: {
+    case BarrierKind::kNamedBarrierInitialize: {
       if (_.GetIdOpcode(result_type) != SpvOpTypeNamedBarrier) {
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << spvOpcodeString(opcode)
@@ -105,7 +139,7 @@ spv_result_t BarriersPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpMemoryNamedBarrier: {
+    case BarrierKind::kMemoryNamedBarrier: {
       const uint32_t named_barrier_type = _.GetOperandTypeId(inst, 0);
       if (_.GetIdOpcode(named_barrier_type) != SpvOpTypeNamedBarrier) {
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
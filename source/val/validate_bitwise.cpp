@@ -24,15 +24,59 @@
 namespace spvtools {
 namespace val {
 
+namespace {
+
+// The kinds of instructions BitwisePass checks, one for each case of its
+// switch.
+enum class BitwiseKind {
+  kNone,
+  kShift,
+  kBitwise,
+  kBitFieldInsert,
+  kBitFieldExtract,
+  kBitReverse,
+  kBitCount,
+};
+
+// Returns the kind of the instructions with |opcode|.
+BitwiseKind GetBitwiseKind(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpShiftLeftLogical:
+      return BitwiseKind::kShift;
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpBitwiseAnd:
+    case SpvOpNot:
+      return BitwiseKind::kBitwise;
+    case SpvOpBitFieldInsert:
+      return BitwiseKind::kBitFieldInsert;
+    case SpvOpBitFieldSExtract:
+    case SpvOpBitFieldUExtract:
+      return BitwiseKind::kBitFieldExtract;
+    case SpvOpBitReverse:
+      return BitwiseKind::kBitReverse;
+    case SpvOpBitCount:
+      return BitwiseKind::kBitCount;
+    default:
+      return BitwiseKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool BitwisePassHandles(SpvOp opcode) {
+  return GetBitwiseKind(opcode) != BitwiseKind::kNone;
+}
+
 // Validates correctness of bitwise instructions.
 spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
 
-  switch (opcode) {
-    case SpvOpShiftRightLogical:
-    case SpvOpShiftRightArithmetic:
-    case SpvOpShiftLeftLogical: {
+  switch (GetBitwiseKind(opcode)) {
+    case BitwiseKind::kShift: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -71,10 +115,7 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitwiseOr:
-    case SpvOpBitwiseXor:
-    case SpvOpBitwiseAnd:
-    case SpvOpNot: {
+    case BitwiseKind::kBitwise: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -108,7 +149,7 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitFieldInsert: {
+    case BitwiseKind::kBitFieldInsert: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -141,8 +182,7 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitFieldSExtract:
-    case SpvOpBitFieldUExtract: {
+    case BitwiseKind::kBitFieldExtract: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -169,7 +209,7 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitReverse: {
+    case BitwiseKind::kBitReverse: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -184,7 +224,7 @@ spv_result_t BitwisePass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitCount: {
+    case BitwiseKind::kBitCount: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -917,119 +917,130 @@ spv_result_t PerformWebGPUCfgChecks(ValidationState_t& _, Function* function) {
   return SPV_SUCCESS;
 }
 
-spv_result_t PerformCfgChecks(ValidationState_t& _) {
-  for (auto& function : _.functions()) {
-    // Check all referenced blocks are defined within a function
-    if (function.undefined_block_count() != 0) {
-      std::string undef_blocks("{");
-      bool first = true;
-      for (auto undefined_block : function.undefined_blocks()) {
-        undef_blocks += _.getIdName(undefined_block);
-        if (!first) {
-          undef_blocks += " ";
-        }
-        first = false;
+// Performs the CFG checks of |function|.  Only modifies the state of
+// |function|, so several functions may be checked at the same time.
+spv_result_t PerformFunctionCfgChecks(ValidationState_t& _,
+                                      Function& function) {
+  // Check all referenced blocks are defined within a function
+  if (function.undefined_block_count() != 0) {
+    std::string undef_blocks("{");
+    bool first = true;
+    for (auto undefined_block : function.undefined_blocks()) {
+      undef_blocks += _.getIdName(undefined_block);
+      if (!first) {
+        undef_blocks += " ";
       }
-      return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(function.id()))
-             << "Block(s) " << undef_blocks << "}"
-             << " are referenced but not defined in function "
-             << _.getIdName(function.id());
+      first = false;
     }
+    return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(function.id()))
+           << "Block(s) " << undef_blocks << "}"
+           << " are referenced but not defined in function "
+           << _.getIdName(function.id());
+  }
 
-    // Set each block's immediate dominator and immediate postdominator,
-    // and find all back-edges.
-    //
-    // We want to analyze all the blocks in the function, even in degenerate
-    // control flow cases including unreachable blocks.  So use the augmented
-    // CFG to ensure we cover all the blocks.
-    std::vector<const BasicBlock*> postorder;
-    std::vector<const BasicBlock*> postdom_postorder;
-    std::vector<std::pair<uint32_t, uint32_t>> back_edges;
-    auto ignore_block = [](const BasicBlock*) {};
-    auto ignore_edge = [](const BasicBlock*, const BasicBlock*) {};
-    if (!function.ordered_blocks().empty()) {
-      /// calculate dominators
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.first_block(), function.AugmentedCFGSuccessorsFunction(),
-          ignore_block, [&](const BasicBlock* b) { postorder.push_back(b); },
-          ignore_edge);
-      auto edges = CFA<BasicBlock>::CalculateDominators(
-          postorder, function.AugmentedCFGPredecessorsFunction());
-      for (auto edge : edges) {
-        if (edge.first != edge.second)
-          edge.first->SetImmediateDominator(edge.second);
-      }
+  // Set each block's immediate dominator and immediate postdominator,
+  // and find all back-edges.
+  //
+  // We want to analyze all the blocks in the function, even in degenerate
+  // control flow cases including unreachable blocks.  So use the augmented
+  // CFG to ensure we cover all the blocks.
+  std::vector<const BasicBlock*> postorder;
+  std::vector<const BasicBlock*> postdom_postorder;
+  std::vector<std::pair<uint32_t, uint32_t>> back_edges;
+  auto ignore_block = [](const BasicBlock*) {};
+  auto ignore_edge = [](const BasicBlock*, const BasicBlock*) {};
+  if (!function.ordered_blocks().empty()) {
+    /// calculate dominators
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function.first_block(), function.AugmentedCFGSuccessorsFunction(),
+        ignore_block, [&](const BasicBlock* b) { postorder.push_back(b); },
+        ignore_edge);
+    auto edges = CFA<BasicBlock>::CalculateDominators(
+        postorder, function.AugmentedCFGPredecessorsFunction());
+    for (auto edge : edges) {
+      if (edge.first != edge.second)
+        edge.first->SetImmediateDominator(edge.second);
+    }
 
-      /// calculate post dominators
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.pseudo_exit_block(),
-          function.AugmentedCFGPredecessorsFunction(), ignore_block,
-          [&](const BasicBlock* b) { postdom_postorder.push_back(b); },
-          ignore_edge);
-      auto postdom_edges = CFA<BasicBlock>::CalculateDominators(
-          postdom_postorder, function.AugmentedCFGSuccessorsFunction());
-      for (auto edge : postdom_edges) {
-        edge.first->SetImmediatePostDominator(edge.second);
-      }
-      /// calculate back edges.
-      CFA<BasicBlock>::DepthFirstTraversal(
-          function.pseudo_entry_block(),
-          function
-              .AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
-          ignore_block, ignore_block,
-          [&](const BasicBlock* from, const BasicBlock* to) {
-            back_edges.emplace_back(from->id(), to->id());
-          });
+    /// calculate post dominators
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function.pseudo_exit_block(),
+        function.AugmentedCFGPredecessorsFunction(), ignore_block,
+        [&](const BasicBlock* b) { postdom_postorder.push_back(b); },
+        ignore_edge);
+    auto postdom_edges = CFA<BasicBlock>::CalculateDominators(
+        postdom_postorder, function.AugmentedCFGSuccessorsFunction());
+    for (auto edge : postdom_edges) {
+      edge.first->SetImmediatePostDominator(edge.second);
     }
-    UpdateContinueConstructExitBlocks(function, back_edges);
-
-    auto& blocks = function.ordered_blocks();
-    if (!blocks.empty()) {
-      // Check if the order of blocks in the binary appear before the blocks
-      // they dominate
-      for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
-        if (auto idom = (*block)->immediate_dominator()) {
-          if (idom != function.pseudo_entry_block() &&
-              block == std::find(begin(blocks), block, idom)) {
-            return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(idom->id()))
-                   << "Block " << _.getIdName((*block)->id())
-                   << " appears in the binary before its dominator "
-                   << _.getIdName(idom->id());
-          }
+    /// calculate back edges.
+    CFA<BasicBlock>::DepthFirstTraversal(
+        function.pseudo_entry_block(),
+        function
+            .AugmentedCFGSuccessorsFunctionIncludingHeaderToContinueEdge(),
+        ignore_block, ignore_block,
+        [&](const BasicBlock* from, const BasicBlock* to) {
+          back_edges.emplace_back(from->id(), to->id());
+        });
+  }
+  UpdateContinueConstructExitBlocks(function, back_edges);
+
+  // The remaining checks only look at this function, so they need not be
+  // repeated if it is unchanged since it was last validated.
+  if (_.IsFunctionUnchanged(function.id())) return SPV_SUCCESS;
+
+  auto& blocks = function.ordered_blocks();
+  if (!blocks.empty()) {
+    // Check if the order of blocks in the binary appear before the blocks
+    // they dominate
+    for (auto block = begin(blocks) + 1; block != end(blocks); ++block) {
+      if (auto idom = (*block)->immediate_dominator()) {
+        if (idom != function.pseudo_entry_block() &&
+            block == std::find(begin(blocks), block, idom)) {
+          return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef(idom->id()))
+                 << "Block " << _.getIdName((*block)->id())
+                 << " appears in the binary before its dominator "
+                 << _.getIdName(idom->id());
         }
+      }
 
-        // For WebGPU check that all unreachable blocks are degenerate cases for
-        // merge-block or continue-target.
-        if (spvIsWebGPUEnv(_.context()->target_env)) {
-          spv_result_t result = PerformWebGPUCfgChecks(_, &function);
-          if (result != SPV_SUCCESS) return result;
-        }
+      // For WebGPU check that all unreachable blocks are degenerate cases for
+      // merge-block or continue-target.
+      if (spvIsWebGPUEnv(_.context()->target_env)) {
+        spv_result_t result = PerformWebGPUCfgChecks(_, &function);
+        if (result != SPV_SUCCESS) return result;
       }
-      // If we have structed control flow, check that no block has a control
-      // flow nesting depth larger than the limit.
-      if (_.HasCapability(SpvCapabilityShader)) {
-        const int control_flow_nesting_depth_limit =
-            _.options()->universal_limits_.max_control_flow_nesting_depth;
-        for (auto block = begin(blocks); block != end(blocks); ++block) {
-          if (function.GetBlockDepth(*block) >
-              control_flow_nesting_depth_limit) {
-            return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef((*block)->id()))
-                   << "Maximum Control Flow nesting depth exceeded.";
-          }
+    }
+    // If we have structed control flow, check that no block has a control
+    // flow nesting depth larger than the limit.
+    if (_.HasCapability(SpvCapabilityShader)) {
+      const int control_flow_nesting_depth_limit =
+          _.options()->universal_limits_.max_control_flow_nesting_depth;
+      for (auto block = begin(blocks); block != end(blocks); ++block) {
+        if (function.GetBlockDepth(*block) >
+            control_flow_nesting_depth_limit) {
+          return _.diag(SPV_ERROR_INVALID_CFG, _.FindDef((*block)->id()))
+                 << "Maximum Control Flow nesting depth exceeded.";
         }
       }
     }
+  }
 
-    /// Structured control flow checks are only required for shader capabilities
-    if (_.HasCapability(SpvCapabilityShader)) {
-      if (auto error =
-              StructuredControlFlowChecks(_, &function, back_edges, postorder))
-        return error;
-    }
+  /// Structured control flow checks are only required for shader capabilities
+  if (_.HasCapability(SpvCapabilityShader)) {
+    if (auto error =
+            StructuredControlFlowChecks(_, &function, back_edges, postorder))
+      return error;
   }
   return SPV_SUCCESS;
 }
 
+spv_result_t PerformCfgChecks(ValidationState_t& _) {
+  return _.ForEachIndexInParallel(_.functions().size(), [&_](size_t i) {
+    return PerformFunctionCfgChecks(_, _.functions()[i]);
+  });
+}
+
 spv_result_t CfgPass(ValidationState_t& _, const Instruction* inst) {
   SpvOp opcode = inst->opcode();
   switch (opcode) {
@@ -1136,28 +1147,38 @@ void ReachabilityPass(ValidationState_t& _) {
   }
 }
 
-spv_result_t ControlFlowPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+namespace {
+
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// ControlFlowPass does not check them.
+InstructionValidator ControlFlowValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpPhi:
-      if (auto error = ValidatePhi(_, inst)) return error;
-      break;
+      return ValidatePhi;
     case SpvOpBranch:
-      if (auto error = ValidateBranch(_, inst)) return error;
-      break;
+      return ValidateBranch;
     case SpvOpBranchConditional:
-      if (auto error = ValidateBranchConditional(_, inst)) return error;
-      break;
+      return ValidateBranchConditional;
     case SpvOpReturnValue:
-      if (auto error = ValidateReturnValue(_, inst)) return error;
-      break;
+      return ValidateReturnValue;
     case SpvOpSwitch:
-      if (auto error = ValidateSwitch(_, inst)) return error;
-      break;
+      return ValidateSwitch;
     case SpvOpLoopMerge:
-      if (auto error = ValidateLoopMerge(_, inst)) return error;
-      break;
+      return ValidateLoopMerge;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool ControlFlowPassHandles(SpvOp opcode) {
+  return ControlFlowValidator(opcode) != nullptr;
+}
+
+spv_result_t ControlFlowPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = ControlFlowValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
@@ -585,31 +585,43 @@ spv_result_t ValidateCopyLogical(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // anonymous namespace
-
-// Validates correctness of composite instructions.
-spv_result_t CompositesPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// CompositesPass does not check them.
+InstructionValidator CompositesValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpVectorExtractDynamic:
-      return ValidateVectorExtractDynamic(_, inst);
+      return ValidateVectorExtractDynamic;
     case SpvOpVectorInsertDynamic:
-      return ValidateVectorInsertDyanmic(_, inst);
+      return ValidateVectorInsertDyanmic;
     case SpvOpVectorShuffle:
-      return ValidateVectorShuffle(_, inst);
+      return ValidateVectorShuffle;
     case SpvOpCompositeConstruct:
-      return ValidateCompositeConstruct(_, inst);
+      return ValidateCompositeConstruct;
     case SpvOpCompositeExtract:
-      return ValidateCompositeExtract(_, inst);
+      return ValidateCompositeExtract;
     case SpvOpCompositeInsert:
-      return ValidateCompositeInsert(_, inst);
+      return ValidateCompositeInsert;
     case SpvOpCopyObject:
-      return ValidateCopyObject(_, inst);
+      return ValidateCopyObject;
     case SpvOpTranspose:
-      return ValidateTranspose(_, inst);
+      return ValidateTranspose;
     case SpvOpCopyLogical:
-      return ValidateCopyLogical(_, inst);
+      return ValidateCopyLogical;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // anonymous namespace
+
+bool CompositesPassHandles(SpvOp opcode) {
+  return CompositesValidator(opcode) != nullptr;
+}
+
+// Validates correctness of composite instructions.
+spv_result_t CompositesPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = CompositesValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
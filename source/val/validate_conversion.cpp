@@ -25,13 +25,79 @@
 namespace spvtools {
 namespace val {
 
+namespace {
+
+// The kinds of instructions ConversionPass checks, one for each case of its
+// switch.
+enum class ConversionKind {
+  kNone,
+  kConvertFToU,
+  kConvertFToS,
+  kConvertIToF,
+  kUConvert,
+  kSConvert,
+  kFConvert,
+  kQuantizeToF16,
+  kConvertPtrToU,
+  kSatConvert,
+  kConvertUToPtr,
+  kPtrCastToGeneric,
+  kGenericCastToPtr,
+  kGenericCastToPtrExplicit,
+  kBitcast,
+};
+
+// Returns the kind of the instructions with |opcode|.
+ConversionKind GetConversionKind(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpConvertFToU:
+      return ConversionKind::kConvertFToU;
+    case SpvOpConvertFToS:
+      return ConversionKind::kConvertFToS;
+    case SpvOpConvertSToF:
+    case SpvOpConvertUToF:
+      return ConversionKind::kConvertIToF;
+    case SpvOpUConvert:
+      return ConversionKind::kUConvert;
+    case SpvOpSConvert:
+      return ConversionKind::kSConvert;
+    case SpvOpFConvert:
+      return ConversionKind::kFConvert;
+    case SpvOpQuantizeToF16:
+      return ConversionKind::kQuantizeToF16;
+    case SpvOpConvertPtrToU:
+      return ConversionKind::kConvertPtrToU;
+    case SpvOpSatConvertSToU:
+    case SpvOpSatConvertUToS:
+      return ConversionKind::kSatConvert;
+    case SpvOpConvertUToPtr:
+      return ConversionKind::kConvertUToPtr;
+    case SpvOpPtrCastToGeneric:
+      return ConversionKind::kPtrCastToGeneric;
+    case SpvOpGenericCastToPtr:
+      return ConversionKind::kGenericCastToPtr;
+    case SpvOpGenericCastToPtrExplicit:
+      return ConversionKind::kGenericCastToPtrExplicit;
+    case SpvOpBitcast:
+      return ConversionKind::kBitcast;
+    default:
+      return ConversionKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool ConversionPassHandles(SpvOp opcode) {
+  return GetConversionKind(opcode) != ConversionKind::kNone;
+}
+
 // Validates correctness of conversion instructions.
 spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
 
-  switch (opcode) {
-    case SpvOpConvertFToU: {
+  switch (GetConversionKind(opcode)) {
+    case ConversionKind::kConvertFToU: {
       if (!_.IsUnsignedIntScalarType(result_type) &&
           !_.IsUnsignedIntVectorType(result_type) &&
           !_.IsUnsignedIntCooperativeMatrixType(result_type))
@@ -62,7 +128,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpConvertFToS: {
+    case ConversionKind::kConvertFToS: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type) &&
           !_.IsIntCooperativeMatrixType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
@@ -92,8 +158,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpConvertSToF:
-    case SpvOpConvertUToF: {
+    case ConversionKind::kConvertIToF: {
       if (!_.IsFloatScalarType(result_type) &&
           !_.IsFloatVectorType(result_type) &&
           !_.IsFloatCooperativeMatrixType(result_type))
@@ -124,7 +189,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpUConvert: {
+    case ConversionKind::kUConvert: {
       if (!_.IsUnsignedIntScalarType(result_type) &&
           !_.IsUnsignedIntVectorType(result_type) &&
           !_.IsUnsignedIntCooperativeMatrixType(result_type))
@@ -160,7 +225,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpSConvert: {
+    case ConversionKind::kSConvert: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type) &&
           !_.IsIntCooperativeMatrixType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
@@ -195,7 +260,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpFConvert: {
+    case ConversionKind::kFConvert: {
       if (!_.IsFloatScalarType(result_type) &&
           !_.IsFloatVectorType(result_type) &&
           !_.IsFloatCooperativeMatrixType(result_type))
@@ -231,7 +296,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpQuantizeToF16: {
+    case ConversionKind::kQuantizeToF16: {
       if ((!_.IsFloatScalarType(result_type) &&
            !_.IsFloatVectorType(result_type)) ||
           _.GetBitWidth(result_type) != 32)
@@ -247,7 +312,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpConvertPtrToU: {
+    case ConversionKind::kConvertPtrToU: {
       if (!_.IsUnsignedIntScalarType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected unsigned int scalar type as Result Type: "
@@ -277,8 +342,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpSatConvertSToU:
-    case SpvOpSatConvertUToS: {
+    case ConversionKind::kSatConvert: {
       if (!_.IsIntScalarType(result_type) && !_.IsIntVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected int scalar or vector type as Result Type: "
@@ -298,7 +362,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpConvertUToPtr: {
+    case ConversionKind::kConvertUToPtr: {
       if (!_.IsPointerType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected Result Type to be a pointer: "
@@ -328,7 +392,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpPtrCastToGeneric: {
+    case ConversionKind::kPtrCastToGeneric: {
       uint32_t result_storage_class = 0;
       uint32_t result_data_type = 0;
       if (!_.GetPointerTypeInfo(result_type, &result_data_type,
@@ -364,7 +428,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpGenericCastToPtr: {
+    case ConversionKind::kGenericCastToPtr: {
       uint32_t result_storage_class = 0;
       uint32_t result_data_type = 0;
       if (!_.GetPointerTypeInfo(result_type, &result_data_type,
@@ -400,7 +464,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpGenericCastToPtrExplicit: {
+    case ConversionKind::kGenericCastToPtrExplicit: {
       uint32_t result_storage_class = 0;
       uint32_t result_data_type = 0;
       if (!_.GetPointerTypeInfo(result_type, &result_data_type,
@@ -442,7 +506,7 @@ spv_result_t ConversionPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpBitcast: {
+    case ConversionKind::kBitcast: {
       const uint32_t input_type = _.GetOperandTypeId(inst, 2);
       if (!input_type)
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
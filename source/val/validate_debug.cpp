@@ -53,18 +53,28 @@ spv_result_t ValidateLine(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t DebugPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// DebugPass does not check them.
+InstructionValidator DebugValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpMemberName:
-      if (auto error = ValidateMemberName(_, inst)) return error;
-      break;
+      return ValidateMemberName;
     case SpvOpLine:
-      if (auto error = ValidateLine(_, inst)) return error;
-      break;
+      return ValidateLine;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool DebugPassHandles(SpvOp opcode) {
+  return DebugValidator(opcode) != nullptr;
+}
+
+spv_result_t DebugPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = DebugValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
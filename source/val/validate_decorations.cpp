@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <set>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -67,6 +68,52 @@ struct LayoutConstraints {
 using MemberConstraints = std::unordered_map<std::pair<uint32_t, uint32_t>,
                                              LayoutConstraints, PairHash>;
 
+// Identifies a layout value of a type: the type, whether structs and arrays
+// are rounded up to a multiple of 16 bytes, and the layout constraints
+// inherited by matrices.
+struct LayoutKey {
+  uint32_t type_id;
+  bool round_up;
+  MatrixLayout majorness;
+  uint32_t matrix_stride;
+
+  bool operator==(const LayoutKey& other) const {
+    return type_id == other.type_id && round_up == other.round_up &&
+           majorness == other.majorness &&
+           matrix_stride == other.matrix_stride;
+  }
+};
+
+// A functor for hashing layout keys.
+struct LayoutKeyHash {
+  std::size_t operator()(const LayoutKey& key) const {
+    const std::size_t flags =
+        (key.round_up ? 1 : 0) | (key.majorness == kRowMajor ? 2 : 0);
+    return ((key.type_id * 31u + key.matrix_stride) << 2) ^ flags;
+  }
+};
+
+// The layout computations of the buffers of a module.  Nested types are
+// usually shared by many buffers, and each buffer is checked again for every
+// storage class and decoration combination, so the values are computed once
+// and shared by all the checks.
+struct LayoutCache {
+  // The member constraints of the structs in |constrained_structs|, and of
+  // all the structs they contain.  Those do not depend on the buffer the
+  // structs are found in.
+  MemberConstraints constraints;
+  std::unordered_set<uint32_t> constrained_structs;
+
+  std::unordered_map<LayoutKey, uint32_t, LayoutKeyHash> base_alignments;
+  std::unordered_map<uint32_t, uint32_t> scalar_alignments;
+  std::unordered_map<LayoutKey, uint32_t, LayoutKeyHash> sizes;
+
+  // The (struct id, block rules, offset) combinations that checkLayout found
+  // to be laid out correctly.  Failures need not be recorded, since they end
+  // the validation.
+  std::set<std::tuple<uint32_t, bool, uint32_t>> checked_layouts;
+};
+
 // Returns the array stride of the given array type.
 uint32_t GetArrayStride(uint32_t array_id, ValidationState_t& vstate) {
   for (auto& decoration : vstate.id_decorations(array_id)) {
@@ -156,13 +203,45 @@ uint32_t align(uint32_t x, uint32_t alignment) {
   return (x + alignment - 1) & ~(alignment - 1);
 }
 
+// Returns the key of the layout value of |type_id| under |round_up| and
+// |inherited|.  Only matrices, and the arrays that may contain them, depend on
+// the inherited constraints, so those are left out of the key of other types.
+LayoutKey getLayoutKey(uint32_t type_id, bool round_up,
+                       const LayoutConstraints& inherited,
+                       ValidationState_t& vstate) {
+  switch (vstate.FindDef(type_id)->opcode()) {
+    case SpvOpTypeMatrix:
+    case SpvOpTypeArray:
+    case SpvOpTypeRuntimeArray:
+      return {type_id, round_up, inherited.majorness, inherited.matrix_stride};
+    default:
+      return {type_id, round_up, kColumnMajor, 0};
+  }
+}
+
+uint32_t computeBaseAlignment(uint32_t member_id, bool roundUp,
+                              const LayoutConstraints& inherited,
+                              LayoutCache& cache, ValidationState_t& vstate);
+
 // Returns base alignment of struct member. If |roundUp| is true, also
 // ensure that structs and arrays are aligned at least to a multiple of 16
 // bytes.
 uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
                           const LayoutConstraints& inherited,
-                          MemberConstraints& constraints,
-                          ValidationState_t& vstate) {
+                          LayoutCache& cache, ValidationState_t& vstate) {
+  const LayoutKey key = getLayoutKey(member_id, roundUp, inherited, vstate);
+  const auto cached = cache.base_alignments.find(key);
+  if (cached != cache.base_alignments.end()) return cached->second;
+  const uint32_t alignment =
+      computeBaseAlignment(member_id, roundUp, inherited, cache, vstate);
+  cache.base_alignments[key] = alignment;
+  return alignment;
+}
+
+// Computes the value returned by getBaseAlignment.
+uint32_t computeBaseAlignment(uint32_t member_id, bool roundUp,
+                              const LayoutConstraints& inherited,
+                              LayoutCache& cache, ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(member_id);
   const auto& words = inst->words();
   // Minimal alignment is byte-aligned.
@@ -176,7 +255,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
       const auto componentId = words[2];
       const auto numComponents = words[3];
       const auto componentAlignment = getBaseAlignment(
-          componentId, roundUp, inherited, constraints, vstate);
+          componentId, roundUp, inherited, cache, vstate);
       baseAlignment =
           componentAlignment * (numComponents == 3 ? 4 : numComponents);
       break;
@@ -184,8 +263,8 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
     case SpvOpTypeMatrix: {
       const auto column_type = words[2];
       if (inherited.majorness == kColumnMajor) {
-        baseAlignment = getBaseAlignment(column_type, roundUp, inherited,
-                                         constraints, vstate);
+        baseAlignment =
+            getBaseAlignment(column_type, roundUp, inherited, cache, vstate);
       } else {
         // A row-major matrix of C columns has a base alignment equal to the
         // base alignment of a vector of C matrix components.
@@ -193,7 +272,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
         const auto component_inst = vstate.FindDef(column_type);
         const auto component_id = component_inst->words()[2];
         const auto componentAlignment = getBaseAlignment(
-            component_id, roundUp, inherited, constraints, vstate);
+            component_id, roundUp, inherited, cache, vstate);
         baseAlignment =
             componentAlignment * (num_columns == 3 ? 4 : num_columns);
       }
@@ -201,7 +280,7 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
     case SpvOpTypeArray:
     case SpvOpTypeRuntimeArray:
       baseAlignment =
-          getBaseAlignment(words[2], roundUp, inherited, constraints, vstate);
+          getBaseAlignment(words[2], roundUp, inherited, cache, vstate);
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
       break;
     case SpvOpTypeStruct: {
@@ -210,10 +289,10 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
            memberIdx < numMembers; ++memberIdx) {
         const auto id = members[memberIdx];
         const auto& constraint =
-            constraints[std::make_pair(member_id, memberIdx)];
-        baseAlignment = std::max(
-            baseAlignment,
-            getBaseAlignment(id, roundUp, constraint, constraints, vstate));
+            cache.constraints[std::make_pair(member_id, memberIdx)];
+        baseAlignment =
+            std::max(baseAlignment,
+                     getBaseAlignment(id, roundUp, constraint, cache, vstate));
       }
       if (roundUp) baseAlignment = align(baseAlignment, 16u);
       break;
@@ -229,8 +308,22 @@ uint32_t getBaseAlignment(uint32_t member_id, bool roundUp,
   return baseAlignment;
 }
 
+uint32_t computeScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                                ValidationState_t& vstate);
+
 // Returns scalar alignment of a type.
-uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
+uint32_t getScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                            ValidationState_t& vstate) {
+  const auto cached = cache.scalar_alignments.find(type_id);
+  if (cached != cache.scalar_alignments.end()) return cached->second;
+  const uint32_t alignment = computeScalarAlignment(type_id, cache, vstate);
+  cache.scalar_alignments[type_id] = alignment;
+  return alignment;
+}
+
+// Computes the value returned by getScalarAlignment.
+uint32_t computeScalarAlignment(uint32_t type_id, LayoutCache& cache,
+                                ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(type_id);
   const auto& words = inst->words();
   switch (inst->opcode()) {
@@ -242,7 +335,7 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
     case SpvOpTypeArray:
     case SpvOpTypeRuntimeArray: {
       const auto compositeMemberTypeId = words[2];
-      return getScalarAlignment(compositeMemberTypeId, vstate);
+      return getScalarAlignment(compositeMemberTypeId, cache, vstate);
     }
     case SpvOpTypeStruct: {
       const auto members = getStructMembers(type_id, vstate);
@@ -250,7 +343,7 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
       for (uint32_t memberIdx = 0, numMembers = uint32_t(members.size());
            memberIdx < numMembers; ++memberIdx) {
         const auto id = members[memberIdx];
-        uint32_t member_alignment = getScalarAlignment(id, vstate);
+        uint32_t member_alignment = getScalarAlignment(id, cache, vstate);
         if (member_alignment > max_member_alignment) {
           max_member_alignment = member_alignment;
         }
@@ -267,10 +360,24 @@ uint32_t getScalarAlignment(uint32_t type_id, ValidationState_t& vstate) {
   return 1;
 }
 
+uint32_t computeSize(uint32_t member_id, const LayoutConstraints& inherited,
+                     LayoutCache& cache, ValidationState_t& vstate);
+
 // Returns size of a struct member. Doesn't include padding at the end of struct
 // or array.  Assumes that in the struct case, all members have offsets.
 uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
-                 MemberConstraints& constraints, ValidationState_t& vstate) {
+                 LayoutCache& cache, ValidationState_t& vstate) {
+  const LayoutKey key = getLayoutKey(member_id, false, inherited, vstate);
+  const auto cached = cache.sizes.find(key);
+  if (cached != cache.sizes.end()) return cached->second;
+  const uint32_t size = computeSize(member_id, inherited, cache, vstate);
+  cache.sizes[key] = size;
+  return size;
+}
+
+// Computes the value returned by getSize.
+uint32_t computeSize(uint32_t member_id, const LayoutConstraints& inherited,
+                     LayoutCache& cache, ValidationState_t& vstate) {
   const auto inst = vstate.FindDef(member_id);
   const auto& words = inst->words();
   switch (inst->opcode()) {
@@ -280,8 +387,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
     case SpvOpTypeVector: {
       const auto componentId = words[2];
       const auto numComponents = words[3];
-      const auto componentSize =
-          getSize(componentId, inherited, constraints, vstate);
+      const auto componentSize = getSize(componentId, inherited, cache, vstate);
       const auto size = componentSize * numComponents;
       return size;
     }
@@ -291,8 +397,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       assert(SpvOpConstant == sizeInst->opcode());
       const uint32_t num_elem = sizeInst->words()[3];
       const uint32_t elem_type = words[2];
-      const uint32_t elem_size =
-          getSize(elem_type, inherited, constraints, vstate);
+      const uint32_t elem_size = getSize(elem_type, inherited, cache, vstate);
       // Account for gaps due to alignments in the first N-1 elements,
       // then add the size of the last element.
       const auto size =
@@ -312,7 +417,7 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
         const auto num_rows = component_inst->words()[3];
         const auto scalar_elem_type = component_inst->words()[2];
         const uint32_t scalar_elem_size =
-            getSize(scalar_elem_type, inherited, constraints, vstate);
+            getSize(scalar_elem_type, inherited, cache, vstate);
         return (num_rows - 1) * inherited.matrix_stride +
                num_columns * scalar_elem_size;
       }
@@ -333,8 +438,9 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
       // This check depends on the fact that all members have offsets.  This
       // has been checked earlier in the flow.
       assert(offset != 0xffffffff);
-      const auto& constraint = constraints[std::make_pair(lastMember, lastIdx)];
-      return offset + getSize(lastMember, constraint, constraints, vstate);
+      const auto& constraint =
+          cache.constraints[std::make_pair(lastMember, lastIdx)];
+      return offset + getSize(lastMember, constraint, cache, vstate);
     }
     case SpvOpTypePointer:
       return vstate.pointer_size_and_alignment();
@@ -353,9 +459,8 @@ uint32_t getSize(uint32_t member_id, const LayoutConstraints& inherited,
 // decorations placing its first byte at a non-integer multiple of 16.
 bool hasImproperStraddle(uint32_t id, uint32_t offset,
                          const LayoutConstraints& inherited,
-                         MemberConstraints& constraints,
-                         ValidationState_t& vstate) {
-  const auto size = getSize(id, inherited, constraints, vstate);
+                         LayoutCache& cache, ValidationState_t& vstate) {
+  const auto size = getSize(id, inherited, cache, vstate);
   const auto F = offset;
   const auto L = offset + size - 1;
   if (size <= 16) {
@@ -379,8 +484,7 @@ bool IsAlignedTo(uint32_t offset, uint32_t alignment) {
 // or row major-ness.
 spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
                          const char* decoration_str, bool blockRules,
-                         uint32_t incoming_offset,
-                         MemberConstraints& constraints,
+                         uint32_t incoming_offset, LayoutCache& cache,
                          ValidationState_t& vstate) {
   if (vstate.options()->skip_block_layout) return SPV_SUCCESS;
 
@@ -388,6 +492,9 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
   // standard layout extension is being used.
   if (vstate.options()->uniform_buffer_standard_layout) blockRules = false;
 
+  const auto checked = std::make_tuple(struct_id, blockRules, incoming_offset);
+  if (cache.checked_layouts.count(checked)) return SPV_SUCCESS;
+
   // Relaxed layout and scalar layout can both be in effect at the same time.
   // For example, relaxed layout is implied by Vulkan 1.1.  But scalar layout
   // is more permissive than relaxed layout.
@@ -452,17 +559,17 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     const auto offset = member_offset.offset;
     auto id = members[member_offset.member];
     const LayoutConstraints& constraint =
-        constraints[std::make_pair(struct_id, uint32_t(memberIdx))];
+        cache.constraints[std::make_pair(struct_id, uint32_t(memberIdx))];
     // Scalar layout takes precedence because it's more permissive, and implying
     // an alignment that divides evenly into the alignment that would otherwise
     // be used.
     const auto alignment =
         scalar_block_layout
-            ? getScalarAlignment(id, vstate)
-            : getBaseAlignment(id, blockRules, constraint, constraints, vstate);
+            ? getScalarAlignment(id, cache, vstate)
+            : getBaseAlignment(id, blockRules, constraint, cache, vstate);
     const auto inst = vstate.FindDef(id);
     const auto opcode = inst->opcode();
-    const auto size = getSize(id, constraint, constraints, vstate);
+    const auto size = getSize(id, constraint, cache, vstate);
     // Check offset.
     if (offset == 0xffffffff)
       return fail(memberIdx) << "is missing an Offset decoration";
@@ -471,7 +578,8 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
       // In relaxed block layout, the vector offset must be aligned to the
       // vector's scalar element type.
       const auto componentId = inst->words()[2];
-      const auto scalar_alignment = getScalarAlignment(componentId, vstate);
+      const auto scalar_alignment =
+          getScalarAlignment(componentId, cache, vstate);
       if (!IsAlignedTo(offset, scalar_alignment)) {
         return fail(memberIdx)
                << "at offset " << offset
@@ -492,7 +600,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     if (!scalar_block_layout && relaxed_block_layout) {
       // Check improper straddle of vectors.
       if (SpvOpTypeVector == opcode &&
-          hasImproperStraddle(id, offset, constraint, constraints, vstate))
+          hasImproperStraddle(id, offset, constraint, cache, vstate))
         return fail(memberIdx)
                << "is an improperly straddling vector at offset " << offset;
     }
@@ -501,7 +609,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
     if (SpvOpTypeStruct == opcode &&
         SPV_SUCCESS != (recursive_status = checkLayout(
                             id, storage_class_str, decoration_str, blockRules,
-                            offset, constraints, vstate)))
+                            offset, cache, vstate)))
       return recursive_status;
     // Check matrix stride.
     if (SpvOpTypeMatrix == opcode) {
@@ -553,7 +661,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
         if (SpvOpTypeStruct == element_inst->opcode() &&
             SPV_SUCCESS != (recursive_status = checkLayout(
                                 typeId, storage_class_str, decoration_str,
-                                blockRules, next_offset, constraints, vstate)))
+                                blockRules, next_offset, cache, vstate)))
           return recursive_status;
         // If offsets accumulate up to a 16-byte multiple stop checking since
         // it will just repeat.
@@ -562,13 +670,14 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
 
       // Proceed to the element in case it is an array.
       array_inst = element_inst;
-      array_alignment = scalar_block_layout
-                            ? getScalarAlignment(array_inst->id(), vstate)
-                            : getBaseAlignment(array_inst->id(), blockRules,
-                                               constraint, constraints, vstate);
+      array_alignment =
+          scalar_block_layout
+              ? getScalarAlignment(array_inst->id(), cache, vstate)
+              : getBaseAlignment(array_inst->id(), blockRules, constraint,
+                                 cache, vstate);
 
       const auto element_size =
-          getSize(element_inst->id(), constraint, constraints, vstate);
+          getSize(element_inst->id(), constraint, cache, vstate);
       if (element_size > array_stride) {
         return fail(memberIdx)
                << "contains an array with stride " << array_stride
@@ -583,6 +692,7 @@ spv_result_t checkLayout(uint32_t struct_id, const char* storage_class_str,
       nextValidOffset = align(nextValidOffset, alignment);
     }
   }
+  cache.checked_layouts.insert(checked);
   return SPV_SUCCESS;
 }
 
@@ -866,6 +976,7 @@ void ComputeMemberConstraintsForArray(MemberConstraints* constraints,
 spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
   // Set of entry points that are known to use a push constant.
   std::unordered_set<uint32_t> uses_push_constant;
+  LayoutCache layout_cache;
   for (const auto& inst : vstate.ordered_instructions()) {
     const auto& words = inst.words();
     if (SpvOpVariable == inst.opcode()) {
@@ -955,9 +1066,10 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
         }
         // Struct requirement is checked on variables so just move on here.
         if (SpvOpTypeStruct != id_inst->opcode()) continue;
-        MemberConstraints constraints;
-        ComputeMemberConstraintsForStruct(&constraints, id, LayoutConstraints(),
-                                          vstate);
+        if (layout_cache.constrained_structs.insert(id).second) {
+          ComputeMemberConstraintsForStruct(&layout_cache.constraints, id,
+                                            LayoutConstraints(), vstate);
+        }
         // Prepare for messages
         const char* sc_str =
             uniform ? "Uniform"
@@ -1073,12 +1185,12 @@ spv_result_t CheckDecorationsOfBuffers(ValidationState_t& vstate) {
             } else if (blockRules &&
                        (SPV_SUCCESS != (recursive_status = checkLayout(
                                             id, sc_str, deco_str, true, 0,
-                                            constraints, vstate)))) {
+                                            layout_cache, vstate)))) {
               return recursive_status;
             } else if (bufferRules &&
                        (SPV_SUCCESS != (recursive_status = checkLayout(
                                             id, sc_str, deco_str, false, 0,
-                                            constraints, vstate)))) {
+                                            layout_cache, vstate)))) {
               return recursive_status;
             }
           }
@@ -26,11 +26,17 @@
 namespace spvtools {
 namespace val {
 
-// Validates correctness of derivative instructions.
-spv_result_t DerivativesPass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
-  const uint32_t result_type = inst->type_id();
+namespace {
+
+// The kinds of instructions DerivativesPass checks.  They are all checked
+// alike.
+enum class DerivativeKind {
+  kNone,
+  kDerivative,
+};
 
+// Returns the kind of the instructions with |opcode|.
+DerivativeKind GetDerivativeKind(SpvOp opcode) {
   switch (opcode) {
     case SpvOpDPdx:
     case SpvOpDPdy:
@@ -40,7 +46,26 @@ spv_result_t DerivativesPass(ValidationState_t& _, const Instruction* inst) {
     case SpvOpFwidthFine:
     case SpvOpDPdxCoarse:
     case SpvOpDPdyCoarse:
-    case SpvOpFwidthCoarse: {
+    case SpvOpFwidthCoarse:
+      return DerivativeKind::kDerivative;
+    default:
+      return DerivativeKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool DerivativesPassHandles(SpvOp opcode) {
+  return GetDerivativeKind(opcode) != DerivativeKind::kNone;
+}
+
+// Validates correctness of derivative instructions.
+spv_result_t DerivativesPass(ValidationState_t& _, const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  const uint32_t result_type = inst->type_id();
+
+  switch (GetDerivativeKind(opcode)) {
+    case DerivativeKind::kDerivative: {
       if (!_.IsFloatScalarOrVectorType(result_type)) {
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected Result Type to be float scalar or vector type: "
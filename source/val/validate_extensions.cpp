@@ -2489,11 +2489,33 @@ spv_result_t ValidateExtInst(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+namespace {
+
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// ExtensionPass does not check them.
+InstructionValidator ExtensionValidator(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpExtension:
+      return ValidateExtension;
+    case SpvOpExtInstImport:
+      return ValidateExtInstImport;
+    case SpvOpExtInst:
+      return ValidateExtInst;
+    default:
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool ExtensionPassHandles(SpvOp opcode) {
+  return ExtensionValidator(opcode) != nullptr;
+}
+
 spv_result_t ExtensionPass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
-  if (opcode == SpvOpExtension) return ValidateExtension(_, inst);
-  if (opcode == SpvOpExtInstImport) return ValidateExtInstImport(_, inst);
-  if (opcode == SpvOpExtInst) return ValidateExtInst(_, inst);
+  if (InstructionValidator validator = ExtensionValidator(inst->opcode())) {
+    return validator(_, inst);
+  }
 
   return SPV_SUCCESS;
 }
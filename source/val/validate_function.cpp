@@ -334,21 +334,30 @@ spv_result_t ValidateFunctionCall(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// FunctionPass does not check them.
+InstructionValidator FunctionValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpFunction:
-      if (auto error = ValidateFunction(_, inst)) return error;
-      break;
+      return ValidateFunction;
     case SpvOpFunctionParameter:
-      if (auto error = ValidateFunctionParameter(_, inst)) return error;
-      break;
+      return ValidateFunctionParameter;
     case SpvOpFunctionCall:
-      if (auto error = ValidateFunctionCall(_, inst)) return error;
-      break;
+      return ValidateFunctionCall;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool FunctionPassHandles(SpvOp opcode) {
+  return FunctionValidator(opcode) != nullptr;
+}
+
+spv_result_t FunctionPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = FunctionValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
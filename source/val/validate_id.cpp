@@ -50,6 +50,58 @@ spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst) {
   return SPV_SUCCESS;
 }
 
+namespace {
+
+// Checks that the uses of the id defined by |inst| are dominated by its
+// definition, or, for function-scoped ids outside blocks, appear in the same
+// function.  The OpPhi users, whose operands are checked separately, are
+// appended to |phi_uses|.
+spv_result_t CheckUsesOfDefinition(ValidationState_t& _,
+                                   const Instruction& inst,
+                                   std::vector<const Instruction*>* phi_uses) {
+  if (inst.id() == 0) return SPV_SUCCESS;
+  if (const Function* func = inst.function()) {
+    if (const BasicBlock* block = inst.block()) {
+      // If the Id is defined within a block then make sure all references to
+      // that Id appear in a blocks that are dominated by the defining block
+      for (auto& use_index_pair : inst.uses()) {
+        const Instruction* use = use_index_pair.first;
+        if (const BasicBlock* use_block = use->block()) {
+          if (use_block->reachable() == false) continue;
+          if (use->opcode() == SpvOpPhi) {
+            phi_uses->push_back(use);
+          } else if (!block->dominates(*use->block())) {
+            return _.diag(SPV_ERROR_INVALID_ID, use_block->label())
+                   << "ID " << _.getIdName(inst.id()) << " defined in block "
+                   << _.getIdName(block->id())
+                   << " does not dominate its use in block "
+                   << _.getIdName(use_block->id());
+          }
+        }
+      }
+    } else {
+      // If the Ids defined within a function but not in a block(i.e. function
+      // parameters, block ids), then make sure all references to that Id
+      // appear within the same function
+      for (auto use : inst.uses()) {
+        const Instruction* user = use.first;
+        if (user->function() && user->function() != func) {
+          return _.diag(SPV_ERROR_INVALID_ID, _.FindDef(func->id()))
+                 << "ID " << _.getIdName(inst.id()) << " used in function "
+                 << _.getIdName(user->function()->id())
+                 << " is used outside of it's defining function "
+                 << _.getIdName(func->id());
+        }
+      }
+    }
+  }
+  // NOTE: Ids defined outside of functions must appear before they are used
+  // This check is being performed in the IdPass function
+  return SPV_SUCCESS;
+}
+
+}  // namespace
+
 /// This function checks all ID definitions dominate their use in the CFG.
 ///
 /// This function will iterate over all ID definitions that are defined in the
@@ -59,49 +111,33 @@ spv_result_t UpdateIdUse(ValidationState_t& _, const Instruction* inst) {
 /// NOTE: This function does NOT check module scoped functions which are
 /// checked during the initial binary parse in the IdPass below
 spv_result_t CheckIdDefinitionDominateUse(ValidationState_t& _) {
+  // The definitions are checked in chunks, which may run in parallel.  The
+  // OpPhi users found by each chunk are merged in order afterwards, so they
+  // are checked in the same order whatever the number of threads.
+  const size_t kChunkSize = 4096;
+  const auto& instructions = _.ordered_instructions();
+  const size_t num_chunks = (instructions.size() + kChunkSize - 1) / kChunkSize;
+  std::vector<std::vector<const Instruction*>> chunk_phi_uses(num_chunks);
+  const auto check_chunk = [&](size_t chunk) {
+    const size_t end = std::min(instructions.size(), (chunk + 1) * kChunkSize);
+    for (size_t i = chunk * kChunkSize; i < end; ++i) {
+      if (auto error = CheckUsesOfDefinition(_, instructions[i],
+                                             &chunk_phi_uses[chunk]))
+        return error;
+    }
+    return SPV_SUCCESS;
+  };
+  if (auto error = _.ForEachIndexInParallel(num_chunks, check_chunk))
+    return error;
+
   std::vector<const Instruction*> phi_instructions;
   std::unordered_set<uint32_t> phi_ids;
-  for (const auto& inst : _.ordered_instructions()) {
-    if (inst.id() == 0) continue;
-    if (const Function* func = inst.function()) {
-      if (const BasicBlock* block = inst.block()) {
-        // If the Id is defined within a block then make sure all references to
-        // that Id appear in a blocks that are dominated by the defining block
-        for (auto& use_index_pair : inst.uses()) {
-          const Instruction* use = use_index_pair.first;
-          if (const BasicBlock* use_block = use->block()) {
-            if (use_block->reachable() == false) continue;
-            if (use->opcode() == SpvOpPhi) {
-              if (phi_ids.insert(use->id()).second) {
-                phi_instructions.push_back(use);
-              }
-            } else if (!block->dominates(*use->block())) {
-              return _.diag(SPV_ERROR_INVALID_ID, use_block->label())
-                     << "ID " << _.getIdName(inst.id()) << " defined in block "
-                     << _.getIdName(block->id())
-                     << " does not dominate its use in block "
-                     << _.getIdName(use_block->id());
-            }
-          }
-        }
-      } else {
-        // If the Ids defined within a function but not in a block(i.e. function
-        // parameters, block ids), then make sure all references to that Id
-        // appear within the same function
-        for (auto use : inst.uses()) {
-          const Instruction* user = use.first;
-          if (user->function() && user->function() != func) {
-            return _.diag(SPV_ERROR_INVALID_ID, _.FindDef(func->id()))
-                   << "ID " << _.getIdName(inst.id()) << " used in function "
-                   << _.getIdName(user->function()->id())
-                   << " is used outside of it's defining function "
-                   << _.getIdName(func->id());
-          }
-        }
+  for (const auto& phi_uses : chunk_phi_uses) {
+    for (const Instruction* phi : phi_uses) {
+      if (phi_ids.insert(phi->id()).second) {
+        phi_instructions.push_back(phi);
       }
     }
-    // NOTE: Ids defined outside of functions must appear before they are used
-    // This check is being performed in the IdPass function
   }
 
   // Check all OpPhi parent blocks are dominated by the variable's defining
@@ -1884,62 +1884,18 @@ spv_result_t ValidateImageSparseTexelsResident(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-// Validates correctness of image instructions.
-spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
-  if (IsImplicitLod(opcode)) {
-    _.function(inst->function()->id())
-        ->RegisterExecutionModelLimitation([opcode](SpvExecutionModel model,
-                                                    std::string* message) {
-          if (model != SpvExecutionModelFragment &&
-              model != SpvExecutionModelGLCompute) {
-            if (message) {
-              *message =
-                  std::string(
-                      "ImplicitLod instructions require Fragment or GLCompute "
-                      "execution model: ") +
-                  spvOpcodeString(opcode);
-            }
-            return false;
-          }
-          return true;
-        });
-    _.function(inst->function()->id())
-        ->RegisterLimitation([opcode](const ValidationState_t& state,
-                                      const Function* entry_point,
-                                      std::string* message) {
-          const auto* models = state.GetExecutionModels(entry_point->id());
-          const auto* modes = state.GetExecutionModes(entry_point->id());
-          if (models->find(SpvExecutionModelGLCompute) != models->end() &&
-              modes->find(SpvExecutionModeDerivativeGroupLinearNV) ==
-                  modes->end() &&
-              modes->find(SpvExecutionModeDerivativeGroupQuadsNV) ==
-                  modes->end()) {
-            if (message) {
-              *message =
-                  std::string(
-                      "ImplicitLod instructions require DerivativeGroupQuadsNV "
-                      "or DerivativeGroupLinearNV execution mode for GLCompute "
-                      "execution model: ") +
-                  spvOpcodeString(opcode);
-            }
-            return false;
-          }
-          return true;
-        });
-  }
-
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// ImagePass does not check them.
+InstructionValidator ImageValidator(SpvOp opcode) {
   switch (opcode) {
     case SpvOpTypeImage:
-      return ValidateTypeImage(_, inst);
+      return ValidateTypeImage;
     case SpvOpTypeSampledImage:
-      return ValidateTypeSampledImage(_, inst);
+      return ValidateTypeSampledImage;
     case SpvOpSampledImage:
-      return ValidateSampledImage(_, inst);
+      return ValidateSampledImage;
     case SpvOpImageTexelPointer:
-      return ValidateImageTexelPointer(_, inst);
+      return ValidateImageTexelPointer;
 
     case SpvOpImageSampleImplicitLod:
     case SpvOpImageSampleExplicitLod:
@@ -1947,7 +1903,7 @@ spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst) {
     case SpvOpImageSampleProjExplicitLod:
     case SpvOpImageSparseSampleImplicitLod:
     case SpvOpImageSparseSampleExplicitLod:
-      return ValidateImageLod(_, inst);
+      return ValidateImageLod;
 
     case SpvOpImageSampleDrefImplicitLod:
     case SpvOpImageSampleDrefExplicitLod:
@@ -1955,54 +1911,109 @@ spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst) {
     case SpvOpImageSampleProjDrefExplicitLod:
     case SpvOpImageSparseSampleDrefImplicitLod:
     case SpvOpImageSparseSampleDrefExplicitLod:
-      return ValidateImageDrefLod(_, inst);
+      return ValidateImageDrefLod;
 
     case SpvOpImageFetch:
     case SpvOpImageSparseFetch:
-      return ValidateImageFetch(_, inst);
+      return ValidateImageFetch;
 
     case SpvOpImageGather:
     case SpvOpImageDrefGather:
     case SpvOpImageSparseGather:
     case SpvOpImageSparseDrefGather:
-      return ValidateImageGather(_, inst);
+      return ValidateImageGather;
 
     case SpvOpImageRead:
     case SpvOpImageSparseRead:
-      return ValidateImageRead(_, inst);
+      return ValidateImageRead;
 
     case SpvOpImageWrite:
-      return ValidateImageWrite(_, inst);
+      return ValidateImageWrite;
 
     case SpvOpImage:
-      return ValidateImage(_, inst);
+      return ValidateImage;
 
     case SpvOpImageQueryFormat:
     case SpvOpImageQueryOrder:
-      return ValidateImageQueryFormatOrOrder(_, inst);
+      return ValidateImageQueryFormatOrOrder;
 
     case SpvOpImageQuerySizeLod:
-      return ValidateImageQuerySizeLod(_, inst);
+      return ValidateImageQuerySizeLod;
     case SpvOpImageQuerySize:
-      return ValidateImageQuerySize(_, inst);
+      return ValidateImageQuerySize;
     case SpvOpImageQueryLod:
-      return ValidateImageQueryLod(_, inst);
+      return ValidateImageQueryLod;
 
     case SpvOpImageQueryLevels:
     case SpvOpImageQuerySamples:
-      return ValidateImageQueryLevelsOrSamples(_, inst);
+      return ValidateImageQueryLevelsOrSamples;
 
     case SpvOpImageSparseSampleProjImplicitLod:
     case SpvOpImageSparseSampleProjExplicitLod:
     case SpvOpImageSparseSampleProjDrefImplicitLod:
     case SpvOpImageSparseSampleProjDrefExplicitLod:
-      return ValidateImageSparseLod(_, inst);
+      return ValidateImageSparseLod;
 
     case SpvOpImageSparseTexelsResident:
-      return ValidateImageSparseTexelsResident(_, inst);
-
+      return ValidateImageSparseTexelsResident;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool ImagePassHandles(SpvOp opcode) {
+  return ImageValidator(opcode) != nullptr;
+}
+
+// Validates correctness of image instructions.
+spv_result_t ImagePass(ValidationState_t& _, const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  if (IsImplicitLod(opcode)) {
+    _.function(inst->function()->id())
+        ->RegisterExecutionModelLimitation([opcode](SpvExecutionModel model,
+                                                    std::string* message) {
+          if (model != SpvExecutionModelFragment &&
+              model != SpvExecutionModelGLCompute) {
+            if (message) {
+              *message =
+                  std::string(
+                      "ImplicitLod instructions require Fragment or GLCompute "
+                      "execution model: ") +
+                  spvOpcodeString(opcode);
+            }
+            return false;
+          }
+          return true;
+        });
+    _.function(inst->function()->id())
+        ->RegisterLimitation([opcode](const ValidationState_t& state,
+                                      const Function* entry_point,
+                                      std::string* message) {
+          const auto* models = state.GetExecutionModels(entry_point->id());
+          const auto* modes = state.GetExecutionModes(entry_point->id());
+          if (models->find(SpvExecutionModelGLCompute) != models->end() &&
+              modes->find(SpvExecutionModeDerivativeGroupLinearNV) ==
+                  modes->end() &&
+              modes->find(SpvExecutionModeDerivativeGroupQuadsNV) ==
+                  modes->end()) {
+            if (message) {
+              *message =
+                  std::string(
+                      "ImplicitLod instructions require DerivativeGroupQuadsNV "
+                      "or DerivativeGroupLinearNV execution mode for GLCompute "
+                      "execution model: ") +
+                  spvOpcodeString(opcode);
+            }
+            return false;
+          }
+          return true;
+        });
+  }
+
+  if (InstructionValidator validator = ImageValidator(opcode)) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
@@ -24,14 +24,87 @@
 namespace spvtools {
 namespace val {
 
+namespace {
+
+// The kinds of instructions LogicalsPass checks, one for each case of its
+// switch.
+enum class LogicalKind {
+  kNone,
+  kAnyOrAll,
+  kFloatClass,
+  kFloatCompare,
+  kLogicalBinary,
+  kLogicalNot,
+  kSelect,
+  kIntCompare,
+};
+
+// Returns the kind of the instructions with |opcode|.
+LogicalKind GetLogicalKind(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpAny:
+    case SpvOpAll:
+      return LogicalKind::kAnyOrAll;
+    case SpvOpIsNan:
+    case SpvOpIsInf:
+    case SpvOpIsFinite:
+    case SpvOpIsNormal:
+    case SpvOpSignBitSet:
+      return LogicalKind::kFloatClass;
+    case SpvOpFOrdEqual:
+    case SpvOpFUnordEqual:
+    case SpvOpFOrdNotEqual:
+    case SpvOpFUnordNotEqual:
+    case SpvOpFOrdLessThan:
+    case SpvOpFUnordLessThan:
+    case SpvOpFOrdGreaterThan:
+    case SpvOpFUnordGreaterThan:
+    case SpvOpFOrdLessThanEqual:
+    case SpvOpFUnordLessThanEqual:
+    case SpvOpFOrdGreaterThanEqual:
+    case SpvOpFUnordGreaterThanEqual:
+    case SpvOpLessOrGreater:
+    case SpvOpOrdered:
+    case SpvOpUnordered:
+      return LogicalKind::kFloatCompare;
+    case SpvOpLogicalEqual:
+    case SpvOpLogicalNotEqual:
+    case SpvOpLogicalOr:
+    case SpvOpLogicalAnd:
+      return LogicalKind::kLogicalBinary;
+    case SpvOpLogicalNot:
+      return LogicalKind::kLogicalNot;
+    case SpvOpSelect:
+      return LogicalKind::kSelect;
+    case SpvOpIEqual:
+    case SpvOpINotEqual:
+    case SpvOpUGreaterThan:
+    case SpvOpUGreaterThanEqual:
+    case SpvOpULessThan:
+    case SpvOpULessThanEqual:
+    case SpvOpSGreaterThan:
+    case SpvOpSGreaterThanEqual:
+    case SpvOpSLessThan:
+    case SpvOpSLessThanEqual:
+      return LogicalKind::kIntCompare;
+    default:
+      return LogicalKind::kNone;
+  }
+}
+
+}  // namespace
+
+bool LogicalsPassHandles(SpvOp opcode) {
+  return GetLogicalKind(opcode) != LogicalKind::kNone;
+}
+
 // Validates correctness of logical instructions.
 spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
   const uint32_t result_type = inst->type_id();
 
-  switch (opcode) {
-    case SpvOpAny:
-    case SpvOpAll: {
+  switch (GetLogicalKind(opcode)) {
+    case LogicalKind::kAnyOrAll: {
       if (!_.IsBoolScalarType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar type as Result Type: "
@@ -46,11 +119,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpIsNan:
-    case SpvOpIsInf:
-    case SpvOpIsFinite:
-    case SpvOpIsNormal:
-    case SpvOpSignBitSet: {
+    case LogicalKind::kFloatClass: {
       if (!_.IsBoolScalarType(result_type) && !_.IsBoolVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar or vector type as Result Type: "
@@ -72,21 +141,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpFOrdEqual:
-    case SpvOpFUnordEqual:
-    case SpvOpFOrdNotEqual:
-    case SpvOpFUnordNotEqual:
-    case SpvOpFOrdLessThan:
-    case SpvOpFUnordLessThan:
-    case SpvOpFOrdGreaterThan:
-    case SpvOpFUnordGreaterThan:
-    case SpvOpFOrdLessThanEqual:
-    case SpvOpFUnordLessThanEqual:
-    case SpvOpFOrdGreaterThanEqual:
-    case SpvOpFUnordGreaterThanEqual:
-    case SpvOpLessOrGreater:
-    case SpvOpOrdered:
-    case SpvOpUnordered: {
+    case LogicalKind::kFloatCompare: {
       if (!_.IsBoolScalarType(result_type) && !_.IsBoolVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar or vector type as Result Type: "
@@ -113,10 +168,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpLogicalEqual:
-    case SpvOpLogicalNotEqual:
-    case SpvOpLogicalOr:
-    case SpvOpLogicalAnd: {
+    case LogicalKind::kLogicalBinary: {
       if (!_.IsBoolScalarType(result_type) && !_.IsBoolVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar or vector type as Result Type: "
@@ -131,7 +183,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpLogicalNot: {
+    case LogicalKind::kLogicalNot: {
       if (!_.IsBoolScalarType(result_type) && !_.IsBoolVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar or vector type as Result Type: "
@@ -145,7 +197,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       break;
     }
 
-    case SpvOpSelect: {
+    case LogicalKind::kSelect: {
       uint32_t dimension = 1;
       {
         const Instruction* type_inst = _.FindDef(result_type);
@@ -226,16 +278,7 @@ spv_result_t LogicalsPass(ValidationState_t& _, const Instruction* inst) {
       }
     }
 
-    case SpvOpIEqual:
-    case SpvOpINotEqual:
-    case SpvOpUGreaterThan:
-    case SpvOpUGreaterThanEqual:
-    case SpvOpULessThan:
-    case SpvOpULessThanEqual:
-    case SpvOpSGreaterThan:
-    case SpvOpSGreaterThanEqual:
-    case SpvOpSLessThan:
-    case SpvOpSLessThanEqual: {
+    case LogicalKind::kIntCompare: {
       if (!_.IsBoolScalarType(result_type) && !_.IsBoolVectorType(result_type))
         return _.diag(SPV_ERROR_INVALID_DATA, inst)
                << "Expected bool scalar or vector type as Result Type: "
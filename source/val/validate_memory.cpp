@@ -1616,51 +1616,51 @@ spv_result_t ValidatePtrComparison(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t MemoryPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// MemoryPass does not check them.
+InstructionValidator MemoryValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpVariable:
-      if (auto error = ValidateVariable(_, inst)) return error;
-      break;
+      return ValidateVariable;
     case SpvOpLoad:
-      if (auto error = ValidateLoad(_, inst)) return error;
-      break;
+      return ValidateLoad;
     case SpvOpStore:
-      if (auto error = ValidateStore(_, inst)) return error;
-      break;
+      return ValidateStore;
     case SpvOpCopyMemory:
     case SpvOpCopyMemorySized:
-      if (auto error = ValidateCopyMemory(_, inst)) return error;
-      break;
+      return ValidateCopyMemory;
     case SpvOpPtrAccessChain:
-      if (auto error = ValidatePtrAccessChain(_, inst)) return error;
-      break;
+      return ValidatePtrAccessChain;
     case SpvOpAccessChain:
     case SpvOpInBoundsAccessChain:
     case SpvOpInBoundsPtrAccessChain:
-      if (auto error = ValidateAccessChain(_, inst)) return error;
-      break;
+      return ValidateAccessChain;
     case SpvOpArrayLength:
-      if (auto error = ValidateArrayLength(_, inst)) return error;
-      break;
+      return ValidateArrayLength;
     case SpvOpCooperativeMatrixLoadNV:
     case SpvOpCooperativeMatrixStoreNV:
-      if (auto error = ValidateCooperativeMatrixLoadStoreNV(_, inst))
-        return error;
-      break;
+      return ValidateCooperativeMatrixLoadStoreNV;
     case SpvOpCooperativeMatrixLengthNV:
-      if (auto error = ValidateCooperativeMatrixLengthNV(_, inst)) return error;
-      break;
+      return ValidateCooperativeMatrixLengthNV;
     case SpvOpPtrEqual:
     case SpvOpPtrNotEqual:
     case SpvOpPtrDiff:
-      if (auto error = ValidatePtrComparison(_, inst)) return error;
-      break;
-    case SpvOpImageTexelPointer:
-    case SpvOpGenericPtrMemSemantics:
+      return ValidatePtrComparison;
+    // OpImageTexelPointer and OpGenericPtrMemSemantics are not checked here.
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool MemoryPassHandles(SpvOp opcode) {
+  return MemoryValidator(opcode) != nullptr;
+}
+
+spv_result_t MemoryPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = MemoryValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
 
   return SPV_SUCCESS;
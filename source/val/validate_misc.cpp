@@ -72,19 +72,47 @@ spv_result_t ValidateShaderClock(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
+// The kinds of instructions MiscPass checks, one for each case of its switch.
+enum class MiscKind {
+  kNone,
+  kUndef,
+  kInvocationInterlock,
+  kDemoteToHelperInvocation,
+  kIsHelperInvocation,
+  kReadClock,
+};
+
+// Returns the kind of the instructions with |opcode|.
+MiscKind GetMiscKind(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpUndef:
+      return MiscKind::kUndef;
+    case SpvOpBeginInvocationInterlockEXT:
+    case SpvOpEndInvocationInterlockEXT:
+      return MiscKind::kInvocationInterlock;
+    case SpvOpDemoteToHelperInvocationEXT:
+      return MiscKind::kDemoteToHelperInvocation;
+    case SpvOpIsHelperInvocationEXT:
+      return MiscKind::kIsHelperInvocation;
+    case SpvOpReadClockKHR:
+      return MiscKind::kReadClock;
+    default:
+      return MiscKind::kNone;
+  }
+}
+
 }  // namespace
 
+bool MiscPassHandles(SpvOp opcode) {
+  return GetMiscKind(opcode) != MiscKind::kNone;
+}
+
 spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
-    case SpvOpUndef:
+  switch (GetMiscKind(inst->opcode())) {
+    case MiscKind::kUndef:
       if (auto error = ValidateUndef(_, inst)) return error;
       break;
-    default:
-      break;
-  }
-  switch (inst->opcode()) {
-    case SpvOpBeginInvocationInterlockEXT:
-    case SpvOpEndInvocationInterlockEXT:
+    case MiscKind::kInvocationInterlock:
       _.function(inst->function()->id())
           ->RegisterExecutionModelLimitation(
               SpvExecutionModelFragment,
@@ -128,14 +156,14 @@ spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst) {
             return true;
           });
       break;
-    case SpvOpDemoteToHelperInvocationEXT:
+    case MiscKind::kDemoteToHelperInvocation:
       _.function(inst->function()->id())
           ->RegisterExecutionModelLimitation(
               SpvExecutionModelFragment,
               "OpDemoteToHelperInvocationEXT requires Fragment execution "
               "model");
       break;
-    case SpvOpIsHelperInvocationEXT: {
+    case MiscKind::kIsHelperInvocation: {
       const uint32_t result_type = inst->type_id();
       _.function(inst->function()->id())
           ->RegisterExecutionModelLimitation(
@@ -147,7 +175,7 @@ spv_result_t MiscPass(ValidationState_t& _, const Instruction* inst) {
                << spvOpcodeString(inst->opcode());
       break;
     }
-    case SpvOpReadClockKHR:
+    case MiscKind::kReadClock:
       if (auto error = ValidateShaderClock(_, inst)) {
         return error;
       }
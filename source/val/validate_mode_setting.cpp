@@ -519,22 +519,31 @@ spv_result_t ValidateMemoryModel(ValidationState_t& _,
   return SPV_SUCCESS;
 }
 
-}  // namespace
-
-spv_result_t ModeSettingPass(ValidationState_t& _, const Instruction* inst) {
-  switch (inst->opcode()) {
+// Returns the function that checks instructions with |opcode|, or nullptr if
+// ModeSettingPass does not check them.
+InstructionValidator ModeSettingValidator(SpvOp opcode) {
+  switch (opcode) {
     case SpvOpEntryPoint:
-      if (auto error = ValidateEntryPoint(_, inst)) return error;
-      break;
+      return ValidateEntryPoint;
     case SpvOpExecutionMode:
     case SpvOpExecutionModeId:
-      if (auto error = ValidateExecutionMode(_, inst)) return error;
-      break;
+      return ValidateExecutionMode;
     case SpvOpMemoryModel:
-      if (auto error = ValidateMemoryModel(_, inst)) return error;
-      break;
+      return ValidateMemoryModel;
     default:
-      break;
+      return nullptr;
+  }
+}
+
+}  // namespace
+
+bool ModeSettingPassHandles(SpvOp opcode) {
+  return ModeSettingValidator(opcode) != nullptr;
+}
+
+spv_result_t ModeSettingPass(ValidationState_t& _, const Instruction* inst) {
+  if (InstructionValidator validator = ModeSettingValidator(inst->opcode())) {
+    if (auto error = validator(_, inst)) return error;
   }
   return SPV_SUCCESS;
 }
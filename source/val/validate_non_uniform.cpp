@@ -52,6 +52,10 @@ spv_result_t ValidateGroupNonUniformBallotBitCount(ValidationState_t& _,
 
 }  // namespace
 
+bool NonUniformPassHandles(SpvOp opcode) {
+  return spvOpcodeIsNonUniformGroupOperation(opcode);
+}
+
 // Validates correctness of non-uniform group instructions.
 spv_result_t NonUniformPass(ValidationState_t& _, const Instruction* inst) {
   const SpvOp opcode = inst->opcode();
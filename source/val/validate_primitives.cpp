@@ -26,46 +26,62 @@
 namespace spvtools {
 namespace val {
 
-// Validates correctness of primitive instructions.
-spv_result_t PrimitivesPass(ValidationState_t& _, const Instruction* inst) {
-  const SpvOp opcode = inst->opcode();
+namespace {
 
+// The kinds of instructions PrimitivesPass checks.  Stream primitives are
+// checked like the others, and have their Stream operand checked as well.
+enum class PrimitiveKind {
+  kNone,
+  kPrimitive,
+  kStreamPrimitive,
+};
+
+// Returns the kind of the instructions with |opcode|.
+PrimitiveKind GetPrimitiveKind(SpvOp opcode) {
   switch (opcode) {
     case SpvOpEmitVertex:
     case SpvOpEndPrimitive:
+      return PrimitiveKind::kPrimitive;
     case SpvOpEmitStreamVertex:
     case SpvOpEndStreamPrimitive:
-      _.function(inst->function()->id())
-          ->RegisterExecutionModelLimitation(
-              SpvExecutionModelGeometry,
-              std::string(spvOpcodeString(opcode)) +
-                  " instructions require Geometry execution model");
-      break;
+      return PrimitiveKind::kStreamPrimitive;
     default:
-      break;
+      return PrimitiveKind::kNone;
   }
+}
 
-  switch (opcode) {
-    case SpvOpEmitStreamVertex:
-    case SpvOpEndStreamPrimitive: {
-      const uint32_t stream_id = inst->word(1);
-      const uint32_t stream_type = _.GetTypeId(stream_id);
-      if (!_.IsIntScalarType(stream_type)) {
-        return _.diag(SPV_ERROR_INVALID_DATA, inst)
-               << spvOpcodeString(opcode)
-               << ": expected Stream to be int scalar";
-      }
-
-      const SpvOp stream_opcode = _.GetIdOpcode(stream_id);
-      if (!spvOpcodeIsConstant(stream_opcode)) {
-        return _.diag(SPV_ERROR_INVALID_DATA, inst)
-               << spvOpcodeString(opcode)
-               << ": expected Stream to be constant instruction";
-      }
+}  // namespace
+
+bool PrimitivesPassHandles(SpvOp opcode) {
+  return GetPrimitiveKind(opcode) != PrimitiveKind::kNone;
+}
+
+// Validates correctness of primitive instructions.
+spv_result_t PrimitivesPass(ValidationState_t& _, const Instruction* inst) {
+  const SpvOp opcode = inst->opcode();
+  const PrimitiveKind kind = GetPrimitiveKind(opcode);
+  if (kind == PrimitiveKind::kNone) return SPV_SUCCESS;
+
+  _.function(inst->function()->id())
+      ->RegisterExecutionModelLimitation(
+          SpvExecutionModelGeometry,
+          std::string(spvOpcodeString(opcode)) +
+              " instructions require Geometry execution model");
+
+  if (kind == PrimitiveKind::kStreamPrimitive) {
+    const uint32_t stream_id = inst->word(1);
+    const uint32_t stream_type = _.GetTypeId(stream_id);
+    if (!_.IsIntScalarType(stream_type)) {
+      return _.diag(SPV_ERROR_INVALID_DATA, inst)
+             << spvOpcodeString(opcode) << ": expected Stream to be int scalar";
     }
 
-    default:
-      break;
+    const SpvOp stream_opcode = _.GetIdOpcode(stream_id);
+    if (!spvOpcodeIsConstant(stream_opcode)) {
+      return _.diag(SPV_ERROR_INVALID_DATA, inst)
+             << spvOpcodeString(opcode)
+             << ": expected Stream to be constant instruction";
+    }
   }
 
   return SPV_SUCCESS;
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#if defined(SPIRV_TIMER_ENABLED)
+
+#include "source/val/validation_profile.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "source/opcode.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using Clock = ValidationProfile::Clock;
+
+double Milliseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// The total calls and time of the checks summed up by a line of the report.
+struct Totals {
+  uint64_t calls = 0;
+  Clock::duration duration{};
+};
+
+// Writes |lines| to |out| under a header naming their kind, in decreasing
+// order of time.
+void WriteLines(const char* kind, const std::map<std::string, Totals>& lines,
+                std::ostream* out) {
+  std::vector<std::pair<std::string, Totals>> sorted(lines.begin(),
+                                                     lines.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const std::pair<std::string, Totals>& a,
+                      const std::pair<std::string, Totals>& b) {
+                     return a.second.duration > b.second.duration;
+                   });
+  *out << std::setw(30) << kind << std::setw(12) << "Calls" << std::setw(12)
+       << "WALL ms" << std::endl;
+  for (const auto& line : sorted) {
+    *out << std::setw(30) << line.first << std::setw(12) << line.second.calls
+         << std::setw(12) << Milliseconds(line.second.duration) << std::endl;
+  }
+}
+
+}  // namespace
+
+thread_local ScopedCheckTimer* ScopedCheckTimer::innermost_ = nullptr;
+
+void ValidationProfile::Record(const char* check, SpvOp opcode,
+                               Clock::duration duration) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Counter& counter = counters_[std::make_pair(check, opcode)];
+  ++counter.calls;
+  counter.duration += duration;
+}
+
+void ValidationProfile::RecordMemory(const char* table, size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  memory_.emplace_back(table, bytes);
+}
+
+void ValidationProfile::Report(std::ostream* out) const {
+  std::map<std::string, Totals> checks;
+  std::map<std::string, Totals> opcodes;
+  std::vector<std::pair<const char*, size_t>> memory;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory = memory_;
+    for (const auto& kv : counters_) {
+      const Counter& counter = kv.second;
+      Totals& check = checks[kv.first.first];
+      check.calls += counter.calls;
+      check.duration += counter.duration;
+      if (kv.first.second != kWholeModule) {
+        Totals& opcode = opcodes[spvOpcodeString(kv.first.second)];
+        opcode.calls += counter.calls;
+        opcode.duration += counter.duration;
+      }
+    }
+  }
+
+  const auto saved_flags = out->flags();
+  const auto saved_precision = out->precision();
+  *out << std::fixed << std::setprecision(3);
+  WriteLines("Check", checks, out);
+  WriteLines("Opcode", opcodes, out);
+
+  std::stable_sort(memory.begin(), memory.end(),
+                   [](const std::pair<const char*, size_t>& a,
+                      const std::pair<const char*, size_t>& b) {
+                     return a.second > b.second;
+                   });
+  *out << std::setw(30) << "Table" << std::setw(24) << "KB" << std::endl;
+  for (const auto& table : memory) {
+    *out << std::setw(30) << table.first << std::setw(24)
+         << static_cast<double>(table.second) / 1024 << std::endl;
+  }
+  out->flags(saved_flags);
+  out->precision(saved_precision);
+}
+
+}  // namespace val
+}  // namespace spvtools
+
+#endif  // defined(SPIRV_TIMER_ENABLED)
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_VAL_VALIDATION_PROFILE_H_
+#define SOURCE_VAL_VALIDATION_PROFILE_H_
+
+#if defined(SPIRV_TIMER_ENABLED)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "source/latest_version_spirv_header.h"
+
+// Measures the wall time of the rest of the surrounding scope, and records it
+// in a profile, as one call of a check:
+//
+//   SPIRV_VAL_PROFILE_SCOPED(_.profile(), "ImagePass", inst->opcode());
+//
+// The opcode may be left out for a check of the whole module.  The time of
+// the timers nested in the scope on the same thread is left out, so that no
+// time is counted twice.  Nothing is measured if the profile is null.  The
+// statement is removed, arguments included, when timers are disabled.
+#define SPIRV_VAL_PROFILE_SCOPED(...) \
+  SPIRV_VAL_PROFILE_SCOPED_LINE(__LINE__, __VA_ARGS__)
+// |line| goes through one more macro so that it is expanded before it is
+// pasted, which gives nested timers distinct names.
+#define SPIRV_VAL_PROFILE_SCOPED_LINE(line, ...) \
+  SPIRV_VAL_PROFILE_SCOPED_AT(line, __VA_ARGS__)
+#define SPIRV_VAL_PROFILE_SCOPED_AT(line, ...) \
+  spvtools::val::ScopedCheckTimer check_timer_##line(__VA_ARGS__)
+
+namespace spvtools {
+namespace val {
+
+// Collects how many times each check of the validator ran and how long it
+// took, for each opcode it ran on.  Checks on different functions may be
+// recorded from several threads at once; their times are summed.  Also
+// collects the memory used by the tables of the validation state.
+class ValidationProfile {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  // The opcode recorded for checks of the whole module.
+  static const SpvOp kWholeModule = SpvOpMax;
+
+  // Adds one call of |check| on an instruction with |opcode|, which took
+  // |duration|.  |check| must outlive the profile.
+  void Record(const char* check, SpvOp opcode, Clock::duration duration);
+
+  // Records that |table| uses |bytes| bytes.  |table| must outlive the
+  // profile.
+  void RecordMemory(const char* table, size_t bytes);
+
+  // Writes the time taken by each check, and by the checks of each opcode,
+  // to |out|, in decreasing order of time, followed by the memory used by
+  // each table, in decreasing order of size.
+  void Report(std::ostream* out) const;
+
+ private:
+  struct Counter {
+    uint64_t calls = 0;
+    Clock::duration duration{};
+  };
+
+  mutable std::mutex mutex_;
+  // Keyed by the address of the name of the check, to keep recording cheap.
+  std::map<std::pair<const char*, SpvOp>, Counter> counters_;
+  std::vector<std::pair<const char*, size_t>> memory_;
+};
+
+// Records, on destruction, the time since its construction as a call of a
+// check in a profile, less the time of the timers nested in it on the same
+// thread.  See SPIRV_VAL_PROFILE_SCOPED.
+class ScopedCheckTimer {
+ public:
+  ScopedCheckTimer(ValidationProfile* profile, const char* check,
+                   SpvOp opcode = ValidationProfile::kWholeModule)
+      : profile_(profile), check_(check), opcode_(opcode) {
+    if (profile_) {
+      parent_ = innermost_;
+      innermost_ = this;
+      start_ = ValidationProfile::Clock::now();
+    }
+  }
+
+  ~ScopedCheckTimer() {
+    if (profile_) {
+      const auto duration = ValidationProfile::Clock::now() - start_;
+      innermost_ = parent_;
+      if (parent_) parent_->nested_ += duration;
+      profile_->Record(check_, opcode_, duration - nested_);
+    }
+  }
+
+ private:
+  // The innermost timer that is running on this thread.
+  static thread_local ScopedCheckTimer* innermost_;
+
+  ValidationProfile* profile_;
+  const char* check_;
+  SpvOp opcode_;
+  ScopedCheckTimer* parent_ = nullptr;
+  ValidationProfile::Clock::time_point start_;
+  // The time of the timers nested in this one.
+  ValidationProfile::Clock::duration nested_{};
+};
+
+}  // namespace val
+}  // namespace spvtools
+
+#else  // defined(SPIRV_TIMER_ENABLED)
+
+#define SPIRV_VAL_PROFILE_SCOPED(...)
+
+#endif  // defined(SPIRV_TIMER_ENABLED)
+
+#endif  // SOURCE_VAL_VALIDATION_PROFILE_H_
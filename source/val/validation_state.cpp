@@ -14,12 +14,15 @@
 
 #include "source/val/validation_state.h"
 
+#include <atomic>
 #include <cassert>
 #include <stack>
+#include <thread>
 #include <utility>
 
 #include "source/opcode.h"
 #include "source/spirv_constant.h"
+#include "source/spirv_endian.h"
 #include "source/spirv_target_env.h"
 #include "source/val/basic_block.h"
 #include "source/val/construct.h"
@@ -30,6 +33,18 @@ namespace spvtools {
 namespace val {
 namespace {
 
+// A message emitted on a worker thread of ForEachIndexInParallel.
+struct DeferredMessage {
+  spv_message_level_t level;
+  std::string source;
+  spv_position_t position;
+  std::string message;
+};
+
+// Where diag() stores the messages emitted on the current thread, or null if
+// they go straight to the context's consumer.
+thread_local std::vector<DeferredMessage>* deferred_messages = nullptr;
+
 bool IsInstructionInLayoutSection(ModuleLayoutSection layout, SpvOp op) {
   // See Section 2.4
   bool out = false;
@@ -140,28 +155,6 @@ bool IsInstructionInLayoutSection(ModuleLayoutSection layout, SpvOp op) {
   return out;
 }
 
-// Counts the number of instructions and functions in the file.
-spv_result_t CountInstructions(void* user_data,
-                               const spv_parsed_instruction_t* inst) {
-  ValidationState_t& _ = *(reinterpret_cast<ValidationState_t*>(user_data));
-  if (inst->opcode == SpvOpFunction) _.increment_total_functions();
-  _.increment_total_instructions();
-
-  return SPV_SUCCESS;
-}
-
-spv_result_t setHeader(void* user_data, spv_endianness_t, uint32_t,
-                       uint32_t version, uint32_t generator, uint32_t id_bound,
-                       uint32_t) {
-  ValidationState_t& vstate =
-      *(reinterpret_cast<ValidationState_t*>(user_data));
-  vstate.setIdBound(id_bound);
-  vstate.setGenerator(generator);
-  vstate.setVersion(version);
-
-  return SPV_SUCCESS;
-}
-
 // Add features based on SPIR-V core version number.
 void UpdateFeaturesBasedOnSpirvVersion(ValidationState_t::Feature* features,
                                        uint32_t version) {
@@ -192,11 +185,9 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       module_capabilities_(),
       module_extensions_(),
       ordered_instructions_(),
-      all_definitions_(),
+      all_definitions_(IdTable<Instruction*>::Layout::kDense),
       global_vars_(),
       local_vars_(),
-      struct_nesting_depth_(),
-      struct_has_nested_blockorbufferblock_struct_(),
       grammar_(ctx),
       addressing_model_(SpvAddressingModelMax),
       memory_model_(SpvMemoryModelMax),
@@ -206,6 +197,10 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
       max_num_of_warnings_(max_warnings) {
   assert(opt && "Validator options may not be Null.");
 
+#if defined(SPIRV_TIMER_ENABLED)
+  if (opt->time_report_stream) profile_.reset(new ValidationProfile);
+#endif
+
   const auto env = context_->target_env;
 
   if (spvIsVulkanEnv(env)) {
@@ -215,19 +210,31 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
     }
   }
 
-  // Only attempt to count if we have words, otherwise let the other validation
-  // fail and generate an error.
-  if (num_words > 0) {
-    // Count the number of instructions in the binary.
-    // This parse should not produce any error messages. Hijack the context and
-    // replace the message consumer so that we do not pollute any state in input
-    // consumer.
-    spv_context_t hijacked_context = *ctx;
-    hijacked_context.consumer = [](spv_message_level_t, const char*,
-                                   const spv_position_t&, const char*) {};
-    spvBinaryParse(&hijacked_context, this, words, num_words, setHeader,
-                   CountInstructions,
-                   /* diagnostic = */ nullptr);
+  // Only attempt to count if we have a header, otherwise let the other
+  // validation fail and generate an error.
+  spv_const_binary_t binary = {words, num_words};
+  spv_endianness_t endian;
+  if (num_words >= SPV_INDEX_INSTRUCTION &&
+      spvBinaryEndianness(&binary, &endian) == SPV_SUCCESS) {
+    setVersion(spvFixWord(words[SPV_INDEX_VERSION_NUMBER], endian));
+    setGenerator(spvFixWord(words[SPV_INDEX_GENERATOR_NUMBER], endian));
+    setIdBound(spvFixWord(words[SPV_INDEX_BOUND], endian));
+    requires_endian_conversion_ = !spvIsHostEndian(endian);
+
+    // Count the instructions in the binary from their word counts, without
+    // parsing them.  The scan stops where the parser would fail to delimit
+    // an instruction, so no instruction that gets parsed is left out.
+    size_t index = SPV_INDEX_INSTRUCTION;
+    while (index < num_words) {
+      uint16_t word_count = 0;
+      uint16_t opcode = 0;
+      spvOpcodeSplit(spvFixWord(words[index], endian), &word_count, &opcode);
+      if (word_count == 0 || word_count > num_words - index) break;
+      if (opcode == SpvOpFunction) ++total_functions_;
+      ++total_instructions_;
+      total_operands_ += word_count - 1u;
+      index += word_count;
+    }
     preallocateStorage();
   }
   UpdateFeaturesBasedOnSpirvVersion(&features_, version_);
@@ -240,6 +247,10 @@ ValidationState_t::ValidationState_t(const spv_const_context ctx,
 void ValidationState_t::preallocateStorage() {
   ordered_instructions_.reserve(total_instructions_);
   module_functions_.reserve(total_functions_);
+  operand_pool_.reserve(total_operands_);
+  if (requires_endian_conversion_) {
+    word_pool_.reserve(total_operands_ + total_instructions_);
+  }
 }
 
 spv_result_t ValidationState_t::ForwardDeclareId(uint32_t id) {
@@ -284,19 +295,15 @@ std::vector<uint32_t> ValidationState_t::UnresolvedForwardIds() const {
 }
 
 bool ValidationState_t::IsDefinedId(uint32_t id) const {
-  return all_definitions_.find(id) != std::end(all_definitions_);
+  return all_definitions_.Has(id);
 }
 
 const Instruction* ValidationState_t::FindDef(uint32_t id) const {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return all_definitions_.Get(id);
 }
 
 Instruction* ValidationState_t::FindDef(uint32_t id) {
-  auto it = all_definitions_.find(id);
-  if (it == all_definitions_.end()) return nullptr;
-  return it->second;
+  return all_definitions_.Get(id);
 }
 
 ModuleLayoutSection ValidationState_t::current_layout_section() const {
@@ -317,6 +324,22 @@ bool ValidationState_t::IsOpcodeInCurrentLayoutSection(SpvOp op) {
 
 DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
                                          const Instruction* inst) {
+  std::string disassembly;
+  if (inst) disassembly = Disassemble(*inst);
+  const spv_position_t position = {0, 0, inst ? inst->LineNum() : 0};
+
+  // Deferred warnings are counted when they are replayed.
+  if (deferred_messages) {
+    std::vector<DeferredMessage>* messages = deferred_messages;
+    return DiagnosticStream(
+        position,
+        [messages](spv_message_level_t level, const char* source,
+                   const spv_position_t& pos, const char* message) {
+          messages->push_back({level, source, pos, message});
+        },
+        disassembly, error_code);
+  }
+
   if (error_code == SPV_WARNING) {
     if (num_of_warnings_ == max_num_of_warnings_) {
       DiagnosticStream({0, 0, 0}, context_->consumer, "", error_code)
@@ -328,11 +351,64 @@ DiagnosticStream ValidationState_t::diag(spv_result_t error_code,
     ++num_of_warnings_;
   }
 
-  std::string disassembly;
-  if (inst) disassembly = Disassemble(*inst);
+  return DiagnosticStream(position, context_->consumer, disassembly,
+                          error_code);
+}
+
+spv_result_t ValidationState_t::ForEachIndexInParallel(
+    size_t count, const std::function<spv_result_t(size_t)>& check) {
+  const size_t num_threads =
+      std::min(static_cast<size_t>(options()->num_threads), count);
+  if (num_threads <= 1 || deferred_messages) {
+    for (size_t i = 0; i < count; ++i) {
+      if (auto error = check(i)) return error;
+    }
+    return SPV_SUCCESS;
+  }
 
-  return DiagnosticStream({0, 0, inst ? inst->LineNum() : 0},
-                          context_->consumer, disassembly, error_code);
+  std::vector<spv_result_t> results(count, SPV_SUCCESS);
+  std::vector<std::vector<DeferredMessage>> messages(count);
+  std::atomic<size_t> next_index(0);
+  // The lowest index whose check failed.  Indices are handed out in
+  // increasing order, so every index below it gets checked.
+  std::atomic<size_t> first_failure(count);
+  auto worker = [&]() {
+    for (size_t i = next_index++; i < first_failure; i = next_index++) {
+      deferred_messages = &messages[i];
+      results[i] = check(i);
+      deferred_messages = nullptr;
+      if (results[i] != SPV_SUCCESS) {
+        size_t failure = first_failure;
+        while (i < failure &&
+               !first_failure.compare_exchange_weak(failure, i)) {
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads) thread.join();
+
+  for (size_t i = 0; i < count; ++i) {
+    for (const auto& message : messages[i]) {
+      if (message.level == SPV_MSG_WARNING) {
+        if (num_of_warnings_ == max_num_of_warnings_) {
+          DiagnosticStream({0, 0, 0}, context_->consumer, "", SPV_WARNING)
+              << "Other warnings have been suppressed.\n";
+        }
+        if (num_of_warnings_ >= max_num_of_warnings_) continue;
+        ++num_of_warnings_;
+      }
+      if (context_->consumer) {
+        context_->consumer(message.level, message.source.c_str(),
+                           message.position, message.message.c_str());
+      }
+    }
+    if (results[i] != SPV_SUCCESS) return results[i];
+  }
+  return SPV_SUCCESS;
 }
 
 std::vector<Function>& ValidationState_t::functions() {
@@ -350,15 +426,11 @@ const Function& ValidationState_t::current_function() const {
 }
 
 const Function* ValidationState_t::function(uint32_t id) const {
-  const auto it = id_to_function_.find(id);
-  if (it == id_to_function_.end()) return nullptr;
-  return it->second;
+  return id_to_function_.Get(id);
 }
 
 Function* ValidationState_t::function(uint32_t id) {
-  auto it = id_to_function_.find(id);
-  if (it == id_to_function_.end()) return nullptr;
-  return it->second;
+  return id_to_function_.Get(id);
 }
 
 bool ValidationState_t::in_function_body() const { return in_function_; }
@@ -495,7 +567,8 @@ spv_result_t ValidationState_t::RegisterFunction(
   in_function_ = true;
   module_functions_.emplace_back(id, ret_type_id, function_control,
                                  function_type_id);
-  id_to_function_.emplace(id, &current_function());
+  Function*& function = id_to_function_[id];
+  if (!function) function = &current_function();
 
   // TODO(umar): validate function type and type_id
 
@@ -516,7 +589,25 @@ spv_result_t ValidationState_t::RegisterFunctionEnd() {
 
 Instruction* ValidationState_t::AddOrderedInstruction(
     const spv_parsed_instruction_t* inst) {
-  ordered_instructions_.emplace_back(inst);
+  // The storage of |inst| is transient.  The pools were sized for all the
+  // instructions of the binary, so appending to them never moves the
+  // operands and words of the earlier instructions.
+  spv_parsed_instruction_t stored = *inst;
+  assert(operand_pool_.size() + inst->num_operands <=
+         operand_pool_.capacity());
+  stored.operands = operand_pool_.data() + operand_pool_.size();
+  operand_pool_.insert(operand_pool_.end(), inst->operands,
+                       inst->operands + inst->num_operands);
+  if (requires_endian_conversion_) {
+    // The parser converts the words of each instruction into a buffer that
+    // it reuses for the next one.
+    assert(word_pool_.size() + inst->num_words <= word_pool_.capacity());
+    stored.words = word_pool_.data() + word_pool_.size();
+    word_pool_.insert(word_pool_.end(), inst->words,
+                      inst->words + inst->num_words);
+  }
+
+  ordered_instructions_.emplace_back(&stored);
   ordered_instructions_.back().SetLineNum(ordered_instructions_.size());
   return &ordered_instructions_.back();
 }
@@ -550,7 +641,10 @@ void ValidationState_t::RegisterDebugInstruction(const Instruction* inst) {
 }
 
 void ValidationState_t::RegisterInstruction(Instruction* inst) {
-  if (inst->id()) all_definitions_.insert(std::make_pair(inst->id(), inst));
+  if (inst->id()) {
+    Instruction*& def = all_definitions_[inst->id()];
+    if (!def) def = inst;
+  }
 
   // If the instruction is using an OpTypeSampledImage as an operand, it should
   // be recorded. The validator will ensure that all usages of an
@@ -584,7 +678,40 @@ void ValidationState_t::RegisterSampledImageConsumer(uint32_t sampled_image_id,
 
 uint32_t ValidationState_t::getIdBound() const { return id_bound_; }
 
-void ValidationState_t::setIdBound(const uint32_t bound) { id_bound_ = bound; }
+void ValidationState_t::setIdBound(const uint32_t bound) {
+  id_bound_ = bound;
+
+  // A module defines fewer ids than it has words, so arrays of that size are
+  // enough for a module whose ids are dense, whatever the header claims.  The
+  // ids are not always dense, even in a valid module, so the ids at or above
+  // that size go to the overflow map of each table.  Most ids have a
+  // definition, so that table is dense.  The other tables only hold some
+  // kinds of ids, and only allocate the pages they write.
+  const uint32_t table_bound =
+      static_cast<uint32_t>(std::min<size_t>(bound, num_words_));
+  all_definitions_.Reset(table_bound);
+  entry_point_descriptions_.Reset(table_bound);
+  struct_nesting_depth_.Reset(table_bound);
+  struct_has_nested_blockorbufferblock_struct_.Reset(table_bound);
+  id_decorations_.Reset(table_bound);
+  id_to_function_.Reset(table_bound);
+}
+
+#if defined(SPIRV_TIMER_ENABLED)
+void ValidationState_t::RecordTableMemory() const {
+  if (!profile_) return;
+  profile_->RecordMemory("all_definitions", all_definitions_.MemoryUsage());
+  profile_->RecordMemory("entry_point_descriptions",
+                         entry_point_descriptions_.MemoryUsage());
+  profile_->RecordMemory("struct_nesting_depth",
+                         struct_nesting_depth_.MemoryUsage());
+  profile_->RecordMemory(
+      "struct_has_nested_block",
+      struct_has_nested_blockorbufferblock_struct_.MemoryUsage());
+  profile_->RecordMemory("id_decorations", id_decorations_.MemoryUsage());
+  profile_->RecordMemory("id_to_function", id_to_function_.MemoryUsage());
+}
+#endif
 
 bool ValidationState_t::RegisterUniqueTypeDeclaration(const Instruction* inst) {
   std::vector<uint32_t> key;
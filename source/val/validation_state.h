@@ -16,6 +16,7 @@
 #define SOURCE_VAL_VALIDATION_STATE_H_
 
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -34,7 +35,9 @@
 #include "source/spirv_validator_options.h"
 #include "source/val/decoration.h"
 #include "source/val/function.h"
+#include "source/val/id_table.h"
 #include "source/val/instruction.h"
+#include "source/val/validation_profile.h"
 #include "spirv-tools/libspirv.h"
 
 namespace spvtools {
@@ -130,6 +133,16 @@ class ValidationState_t {
   /// Returns the command line options
   spv_const_validator_options options() const { return options_; }
 
+#if defined(SPIRV_TIMER_ENABLED)
+  /// Returns the profile of the checks, or nullptr if the options do not ask
+  /// for a time report.
+  ValidationProfile* profile() const { return profile_.get(); }
+
+  /// Records the memory used by the id tables in the profile, if there is
+  /// one.
+  void RecordTableMemory() const;
+#endif
+
   /// Sets the ID of the generator for this module.
   void setGenerator(uint32_t gen) { generator_ = gen; }
 
@@ -165,7 +178,8 @@ class ValidationState_t {
   /// Accessor function for ID bound.
   uint32_t getIdBound() const;
 
-  /// Mutator function for ID bound.
+  /// Mutator function for ID bound.  Also sizes the tables indexed by id, and
+  /// forgets what they hold, so it must be called before any id is registered.
   void setIdBound(uint32_t bound);
 
   /// Returns the number of ID which have been forward referenced but not
@@ -178,15 +192,10 @@ class ValidationState_t {
   /// Returns true if the id has been defined
   bool IsDefinedId(uint32_t id) const;
 
-  /// Increments the total number of instructions in the file.
-  void increment_total_instructions() { total_instructions_++; }
-
-  /// Increments the total number of functions in the file.
-  void increment_total_functions() { total_functions_++; }
-
   /// Allocates internal storage. Note, calling this will invalidate any
-  /// pointers to |ordered_instructions_| or |module_functions_| and, hence,
-  /// should only be called at the beginning of validation.
+  /// pointers to |ordered_instructions_|, |module_functions_| or the operand
+  /// and word pools and, hence, should only be called at the beginning of
+  /// validation.
   void preallocateStorage();
 
   /// Returns the current layout section which is being processed
@@ -200,6 +209,15 @@ class ValidationState_t {
 
   DiagnosticStream diag(spv_result_t error_code, const Instruction* inst);
 
+  /// Calls |check| with each index in [0, |count|), spreading the calls over
+  /// the number of threads given in the validator options.  Messages emitted
+  /// through diag() by the calls are held back and replayed in index order,
+  /// so the result and the messages are the same as calling |check| for each
+  /// index in turn and stopping at the first failure.  The calls must only
+  /// read shared state.
+  spv_result_t ForEachIndexInParallel(
+      size_t count, const std::function<spv_result_t(size_t)>& check);
+
   /// Returns the function states
   std::vector<Function>& functions();
 
@@ -211,6 +229,24 @@ class ValidationState_t {
   const Function* function(uint32_t id) const;
   Function* function(uint32_t id);
 
+  /// Records that the function with the given id is unchanged since an
+  /// earlier version of the module passed validation, so its function-local
+  /// checks need not be repeated.
+  void RegisterUnchangedFunction(uint32_t id) {
+    unchanged_functions_.insert(id);
+  }
+
+  /// Returns true if the function-local checks of the function with the given
+  /// id may be skipped.  See RegisterUnchangedFunction.
+  bool IsFunctionUnchanged(uint32_t id) const {
+    return unchanged_functions_.count(id) != 0;
+  }
+
+  /// Returns the number of functions registered as unchanged.
+  size_t num_unchanged_functions() const {
+    return unchanged_functions_.size();
+  }
+
   /// Returns true if the called after a function instruction but before the
   /// function end instruction
   bool in_function_body() const;
@@ -250,7 +286,7 @@ class ValidationState_t {
   /// Returns the interface descriptions of a given entry point.
   const std::vector<EntryPointDescription>& entry_point_descriptions(
       uint32_t entry_point) {
-    return entry_point_descriptions_.at(entry_point);
+    return entry_point_descriptions_.Get(entry_point);
   }
 
   /// Returns Execution Models for the given Entry Point.
@@ -305,7 +341,7 @@ class ValidationState_t {
   }
 
   bool IsFunctionCallDefined(const uint32_t id) {
-    return (id_to_function_.find(id) != id_to_function_.end());
+    return id_to_function_.Has(id);
   }
   /// Registers the capability and its dependent capabilities
   void RegisterCapability(SpvCapability cap);
@@ -372,6 +408,8 @@ class ValidationState_t {
   const AssemblyGrammar& grammar() const { return grammar_; }
 
   /// Inserts the instruction into the list of ordered instructions in the file.
+  /// Its words are referenced in the binary being validated, and its operands
+  /// are copied to a pool shared by all the instructions.
   Instruction* AddOrderedInstruction(const spv_parsed_instruction_t* inst);
 
   /// Registers the instruction. This will add the instruction to the list of
@@ -409,26 +447,24 @@ class ValidationState_t {
     }
   }
 
-  /// Returns all the decorations for the given <id>. If no decorations exist
-  /// for the <id>, it registers an empty vector for it in the map and
-  /// returns the empty vector.
-  std::vector<Decoration>& id_decorations(uint32_t id) {
-    return id_decorations_[id];
+  /// Returns all the decorations for the given <id>, or an empty vector if it
+  /// has none.  Does not add an entry for the <id>, so it is safe to call
+  /// from several threads.
+  const std::vector<Decoration>& id_decorations(uint32_t id) const {
+    return id_decorations_.Get(id);
   }
 
-  // Returns const pointer to the internal decoration container.
-  const std::map<uint32_t, std::vector<Decoration>>& id_decorations() const {
+  // Returns the decorations of all the ids, in increasing order of ids.
+  const IdTable<std::vector<Decoration>>& id_decorations() const {
     return id_decorations_;
   }
 
   /// Returns true if the given id <id> has the given decoration <dec>,
   /// otherwise returns false.
   bool HasDecoration(uint32_t id, SpvDecoration dec) {
-    const auto& decorations = id_decorations_.find(id);
-    if (decorations == id_decorations_.end()) return false;
-
+    const auto& decorations = id_decorations_.Get(id);
     return std::any_of(
-        decorations->second.begin(), decorations->second.end(),
+        decorations.begin(), decorations.end(),
         [dec](const Decoration& d) { return dec == d.dec_type(); });
   }
 
@@ -445,8 +481,8 @@ class ValidationState_t {
     return ordered_instructions_;
   }
 
-  /// Returns a map of instructions mapped by their result id
-  const std::unordered_map<uint32_t, Instruction*>& all_definitions() const {
+  /// Returns the instructions that define an id, in increasing order of ids
+  const IdTable<Instruction*>& all_definitions() const {
     return all_definitions_;
   }
 
@@ -489,7 +525,7 @@ class ValidationState_t {
 
   /// Returns the nesting depth of a given structure ID
   uint32_t struct_nesting_depth(uint32_t id) {
-    return struct_nesting_depth_[id];
+    return struct_nesting_depth_.Get(id);
   }
 
   /// Records the has a nested block/bufferblock decorated struct for a given
@@ -501,7 +537,7 @@ class ValidationState_t {
   /// For a given struct ID returns true if it has a nested block/bufferblock
   /// decorated struct
   bool GetHasNestedBlockOrBufferBlockStruct(uint32_t id) {
-    return struct_has_nested_blockorbufferblock_struct_[id];
+    return struct_has_nested_blockorbufferblock_struct_.Get(id);
   }
 
   /// Records that the structure type has a member decorated with a built-in.
@@ -729,6 +765,11 @@ class ValidationState_t {
   size_t total_instructions_ = 0;
   /// The total number of functions in the binary.
   size_t total_functions_ = 0;
+  /// An upper bound of the number of operands of all the instructions in the
+  /// binary: the number of words that follow their opcode words.
+  size_t total_operands_ = 0;
+  /// True if the binary is not in host byte order.
+  bool requires_endian_conversion_ = false;
 
   /// IDs which have been forward declared but have not been defined
   std::unordered_set<uint32_t> unresolved_forward_ids_;
@@ -761,15 +802,24 @@ class ValidationState_t {
   /// List of all instructions in the order they appear in the binary
   std::vector<Instruction> ordered_instructions_;
 
+  /// The operands of |ordered_instructions_|.  The instructions point into
+  /// this pool, so it is allocated once by preallocateStorage and never
+  /// grows beyond that.
+  std::vector<spv_parsed_operand_t> operand_pool_;
+
+  /// The words of |ordered_instructions_|, in host byte order, if the binary
+  /// requires endian conversion.  Otherwise the instructions point directly
+  /// into the binary.  Allocated once, like |operand_pool_|.
+  std::vector<uint32_t> word_pool_;
+
   /// Instructions that can be referenced by Ids
-  std::unordered_map<uint32_t, Instruction*> all_definitions_;
+  IdTable<Instruction*> all_definitions_;
 
   /// IDs that are entry points, ie, arguments to OpEntryPoint.
   std::vector<uint32_t> entry_points_;
 
   /// Maps an entry point id to its desciptions.
-  std::unordered_map<uint32_t, std::vector<EntryPointDescription>>
-      entry_point_descriptions_;
+  IdTable<std::vector<EntryPointDescription>> entry_point_descriptions_;
 
   /// IDs that are entry points, ie, arguments to OpEntryPoint, and root a call
   /// graph that recurses.
@@ -791,14 +841,13 @@ class ValidationState_t {
   std::unordered_set<uint32_t> builtin_structs_;
 
   /// Structure Nesting Depth
-  std::unordered_map<uint32_t, uint32_t> struct_nesting_depth_;
+  IdTable<uint32_t> struct_nesting_depth_;
 
   /// Structure has nested blockorbufferblock struct
-  std::unordered_map<uint32_t, bool>
-      struct_has_nested_blockorbufferblock_struct_;
+  IdTable<bool> struct_has_nested_blockorbufferblock_struct_;
 
   /// Stores the list of decorations for a given <id>
-  std::map<uint32_t, std::vector<Decoration>> id_decorations_;
+  IdTable<std::vector<Decoration>> id_decorations_;
 
   /// Stores type declarations which need to be unique (i.e. non-aggregates),
   /// in the form [opcode, operand words], result_id is not stored.
@@ -822,7 +871,7 @@ class ValidationState_t {
   Feature features_;
 
   /// Maps function ids to function stat objects.
-  std::unordered_map<uint32_t, Function*> id_to_function_;
+  IdTable<Function*> id_to_function_;
 
   /// Mapping entry point -> execution models. It is presumed that the same
   /// function could theoretically be used as 'main' by multiple OpEntryPoint
@@ -856,6 +905,9 @@ class ValidationState_t {
   // TypePass.
   std::unordered_set<uint32_t> pointer_to_storage_image_;
 
+  /// The functions whose function-local checks are skipped.
+  std::unordered_set<uint32_t> unchanged_functions_;
+
   /// Maps ids to friendly names.
   std::unique_ptr<spvtools::FriendlyNameMapper> friendly_mapper_;
   spvtools::NameMapper name_mapper_;
@@ -863,6 +915,11 @@ class ValidationState_t {
   /// Variables used to reduce the number of diagnostic messages.
   uint32_t num_of_warnings_;
   uint32_t max_num_of_warnings_;
+
+#if defined(SPIRV_TIMER_ENABLED)
+  /// The time taken by the checks, if the options ask for a time report.
+  std::unique_ptr<ValidationProfile> profile_;
+#endif
 };
 
 }  // namespace val
@@ -156,6 +156,47 @@ TEST_F(BinaryToText, InvalidMagicNumber) {
   spvDiagnosticDestroy(diagnostic);
 }
 
+// Appends each chunk to the std::vector<std::string> in |user_data|.
+spv_result_t CollectChunk(void* user_data, const char* text, size_t length) {
+  static_cast<std::vector<std::string>*>(user_data)->emplace_back(
+      text, text + length);
+  return SPV_SUCCESS;
+}
+
+TEST_F(BinaryToText, StreamMatchesAccumulatedText) {
+  const uint32_t options = SPV_BINARY_TO_TEXT_OPTION_FRIENDLY_NAMES |
+                           SPV_BINARY_TO_TEXT_OPTION_INDENT;
+  spv_text text = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvBinaryToText(context, binary->code,
+                                         binary->wordCount, options, &text,
+                                         nullptr));
+  std::vector<std::string> chunks;
+  ASSERT_EQ(SPV_SUCCESS,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  options, &chunks, CollectChunk, nullptr));
+
+  std::string streamed;
+  for (const auto& chunk : chunks) streamed += chunk;
+  EXPECT_EQ(std::string(text->str, text->length), streamed);
+  // One chunk for the header, and one for each of the 19 instructions.
+  EXPECT_EQ(20u, chunks.size());
+  spvTextDestroy(text);
+}
+
+TEST_F(BinaryToText, StreamStopsWhenChunkFunctionFails) {
+  size_t num_chunks = 0;
+  auto stop_after_two = [](void* user_data, const char*,
+                           size_t) -> spv_result_t {
+    auto count = static_cast<size_t*>(user_data);
+    return ++*count == 2 ? SPV_REQUESTED_TERMINATION : SPV_SUCCESS;
+  };
+  EXPECT_EQ(SPV_REQUESTED_TERMINATION,
+            spvBinaryToTextStream(context, binary->code, binary->wordCount,
+                                  SPV_BINARY_TO_TEXT_OPTION_NONE, &num_chunks,
+                                  stop_after_two, nullptr));
+  EXPECT_EQ(2u, num_chunks);
+}
+
 struct FailedDecodeCase {
   std::string source_text;
   std::vector<uint32_t> appended_instruction;
@@ -0,0 +1,239 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "source/cfa.h"
+
+namespace spvtools {
+namespace {
+
+// A minimal basic block for CFA: an id and its edges.
+struct Block {
+  explicit Block(uint32_t block_id) : id_(block_id) {}
+  uint32_t id() const { return id_; }
+
+  uint32_t id_;
+  std::vector<Block*> successors;
+  std::vector<Block*> predecessors;
+};
+
+// A control flow graph whose entry is block 0.
+class Graph {
+ public:
+  explicit Graph(uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+      blocks_.emplace_back(new Block(i));
+    }
+  }
+
+  void AddEdge(uint32_t from, uint32_t to) {
+    blocks_[from]->successors.push_back(blocks_[to].get());
+    blocks_[to]->predecessors.push_back(blocks_[from].get());
+  }
+
+  uint32_t size() const { return static_cast<uint32_t>(blocks_.size()); }
+  Block* block(uint32_t id) const { return blocks_[id].get(); }
+
+  // Returns the blocks reachable from the entry in postorder, and sets
+  // |back_edges| to the number of back edges found on the way.
+  std::vector<const Block*> Postorder(size_t* back_edges = nullptr) const {
+    std::vector<const Block*> postorder;
+    size_t count = 0;
+    CFA<Block>::DepthFirstTraversal(
+        block(0), [](const Block* b) { return &b->successors; },
+        [](const Block*) {},
+        [&postorder](const Block* b) { postorder.push_back(b); },
+        [&count](const Block*, const Block*) { ++count; });
+    if (back_edges) *back_edges = count;
+    return postorder;
+  }
+
+  // Returns the immediate dominator of each block, computed by
+  // CFA::CalculateDominators.  Unreachable blocks map to themselves.
+  std::vector<uint32_t> ImmediateDominators() const {
+    std::vector<uint32_t> idom(size());
+    for (uint32_t i = 0; i < size(); ++i) idom[i] = i;
+    const auto postorder = Postorder();
+    const auto edges = CFA<Block>::CalculateDominators(
+        postorder, [](const Block* b) { return &b->predecessors; });
+    EXPECT_EQ(postorder.size(), edges.size());
+    for (size_t i = 0; i < edges.size(); ++i) {
+      // The edges are ordered by the postorder index of the block.
+      EXPECT_EQ(postorder[i], edges[i].first);
+      idom[edges[i].first->id()] = edges[i].second->id();
+    }
+    return idom;
+  }
+
+  // Returns the immediate dominator of each block, computed by solving the
+  // dominator data flow equations iteratively.
+  std::vector<uint32_t> ReferenceImmediateDominators() const {
+    const uint32_t n = size();
+    std::vector<bool> reachable(n, false);
+    for (const Block* b : Postorder()) reachable[b->id()] = true;
+
+    // dom[i][j] is true if j dominates i.
+    std::vector<std::vector<bool>> dom(n, std::vector<bool>(n, true));
+    dom[0].assign(n, false);
+    dom[0][0] = true;
+    for (bool changed = true; changed;) {
+      changed = false;
+      for (uint32_t i = 1; i < n; ++i) {
+        if (!reachable[i]) continue;
+        std::vector<bool> meet(n, true);
+        for (const Block* pred : block(i)->predecessors) {
+          if (!reachable[pred->id()]) continue;
+          for (uint32_t j = 0; j < n; ++j) {
+            meet[j] = meet[j] && dom[pred->id()][j];
+          }
+        }
+        meet[i] = true;
+        if (meet != dom[i]) {
+          dom[i] = meet;
+          changed = true;
+        }
+      }
+    }
+
+    // The immediate dominator is the strict dominator that is dominated by
+    // all the other strict dominators.
+    std::vector<uint32_t> idom(n);
+    for (uint32_t i = 0; i < n; ++i) {
+      idom[i] = i;
+      if (i == 0 || !reachable[i]) continue;
+      for (uint32_t j = 0; j < n; ++j) {
+        if (j == i || !dom[i][j]) continue;
+        bool dominated_by_all = true;
+        for (uint32_t k = 0; k < n && dominated_by_all; ++k) {
+          if (k != i && dom[i][k] && !dom[j][k]) dominated_by_all = false;
+        }
+        if (dominated_by_all) idom[i] = j;
+      }
+    }
+    return idom;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Block>> blocks_;
+};
+
+TEST(CFADominatorsTest, Diamond) {
+  Graph graph(4);
+  graph.AddEdge(0, 1);
+  graph.AddEdge(0, 2);
+  graph.AddEdge(1, 3);
+  graph.AddEdge(2, 3);
+  EXPECT_EQ(graph.ImmediateDominators(), (std::vector<uint32_t>{0, 0, 0, 0}));
+}
+
+TEST(CFADominatorsTest, Loop) {
+  Graph graph(5);
+  graph.AddEdge(0, 1);
+  graph.AddEdge(1, 2);
+  graph.AddEdge(2, 3);
+  graph.AddEdge(3, 1);
+  graph.AddEdge(2, 4);
+  EXPECT_EQ(graph.ImmediateDominators(),
+            (std::vector<uint32_t>{0, 0, 1, 2, 2}));
+}
+
+TEST(CFADominatorsTest, Irreducible) {
+  Graph graph(4);
+  graph.AddEdge(0, 1);
+  graph.AddEdge(0, 2);
+  graph.AddEdge(1, 2);
+  graph.AddEdge(2, 1);
+  graph.AddEdge(1, 3);
+  EXPECT_EQ(graph.ImmediateDominators(), (std::vector<uint32_t>{0, 0, 0, 1}));
+}
+
+TEST(CFADominatorsTest, IgnoresUnreachablePredecessors) {
+  Graph graph(4);
+  graph.AddEdge(0, 1);
+  graph.AddEdge(1, 2);
+  graph.AddEdge(3, 2);
+  graph.AddEdge(3, 1);
+  EXPECT_EQ(graph.ImmediateDominators(), (std::vector<uint32_t>{0, 0, 1, 3}));
+}
+
+TEST(CFADominatorsTest, RandomGraphsMatchDataFlow) {
+  std::mt19937 rng(20200315);
+  auto random = [&rng](uint32_t bound) {
+    return static_cast<uint32_t>(rng() % bound);
+  };
+  for (int trial = 0; trial < 20; ++trial) {
+    const uint32_t size = 150;
+    // The last few blocks are unreachable, but branch into the graph.
+    const uint32_t reachable = size - 10;
+    Graph graph(size);
+    for (uint32_t i = 1; i < size; ++i) {
+      if (i < reachable) graph.AddEdge(random(i), i);
+      for (uint32_t extra = random(3); extra > 0; --extra) {
+        const uint32_t to = random(reachable);
+        if (to != 0) graph.AddEdge(i, to);
+      }
+    }
+    EXPECT_EQ(graph.ImmediateDominators(),
+              graph.ReferenceImmediateDominators())
+        << "trial " << trial;
+  }
+}
+
+// The following graphs are large enough that a quadratic step in the
+// traversal or the dominator calculation makes the tests time out.
+
+TEST(CFADominatorsTest, LongChainWithBackEdges) {
+  const uint32_t size = 100000;
+  Graph graph(size);
+  for (uint32_t i = 1; i < size; ++i) {
+    graph.AddEdge(i - 1, i);
+    graph.AddEdge(i, 1);
+  }
+  size_t back_edges = 0;
+  EXPECT_EQ(size, graph.Postorder(&back_edges).size());
+  EXPECT_EQ(size - 1, back_edges);
+
+  const auto idom = graph.ImmediateDominators();
+  EXPECT_EQ(0u, idom[0]);
+  for (uint32_t i = 1; i < size; ++i) ASSERT_EQ(i - 1, idom[i]) << i;
+}
+
+TEST(CFADominatorsTest, LadderOfDiamonds) {
+  // Each diamond is a header, two arms, and the next header.
+  const uint32_t diamonds = 30000;
+  Graph graph(3 * diamonds + 1);
+  for (uint32_t d = 0; d < diamonds; ++d) {
+    const uint32_t header = 3 * d;
+    graph.AddEdge(header, header + 1);
+    graph.AddEdge(header, header + 2);
+    graph.AddEdge(header + 1, header + 3);
+    graph.AddEdge(header + 2, header + 3);
+  }
+
+  const auto idom = graph.ImmediateDominators();
+  for (uint32_t d = 0; d < diamonds; ++d) {
+    const uint32_t header = 3 * d;
+    ASSERT_EQ(header, idom[header + 1]);
+    ASSERT_EQ(header, idom[header + 2]);
+    ASSERT_EQ(header, idom[header + 3]);
+  }
+}
+
+}  // namespace
+}  // namespace spvtools
@@ -141,6 +141,20 @@ TEST(CppInterface, DisassembleOverloads) {
     EXPECT_TRUE(t.Disassemble(binary.data(), binary.size(), &output_text));
     EXPECT_EQ(input_text, output_text);
   }
+  {
+    std::string output_text;
+    EXPECT_TRUE(t.Disassemble(binary.data(), binary.size(),
+                              [&output_text](const char* text, size_t length) {
+                                output_text.append(text, length);
+                                return true;
+                              }));
+    EXPECT_EQ(input_text, output_text);
+  }
+  {
+    // Returning false from the sink stops disassembling.
+    EXPECT_FALSE(t.Disassemble(binary.data(), binary.size(),
+                               [](const char*, size_t) { return false; }));
+  }
 }
 
 TEST(CppInterface, SuccessfulValidation) {
@@ -222,6 +236,24 @@ TEST(CppInterface, ValidateWithOptionsFail) {
           "Number of OpTypeStruct members (10) has exceeded the limit (9)"));
 }
 
+TEST(CppInterface, ValidateWithTimeReport) {
+  SpirvTools t(SPV_ENV_UNIVERSAL_1_1);
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(t.Assemble(MakeModuleHavingStruct(10), &binary));
+  ValidatorOptions opts;
+  std::stringstream report;
+  opts.SetTimeReport(&report);
+
+  EXPECT_TRUE(t.Validate(binary.data(), binary.size(), opts));
+#if defined(SPIRV_TIMER_ENABLED)
+  EXPECT_THAT(report.str(), HasSubstr("TypePass"));
+  EXPECT_THAT(report.str(), HasSubstr("ValidateDecorations"));
+  EXPECT_THAT(report.str(), HasSubstr("TypeStruct"));
+#else
+  EXPECT_EQ("", report.str());
+#endif
+}
+
 // Checks that after running the given optimizer |opt| on the given |original|
 // source code, we can get the given |optimized| source code.
 void CheckOptimization(const std::string& original,
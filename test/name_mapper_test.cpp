@@ -54,6 +54,27 @@ TEST_P(FriendlyNameTest, SingleMapping) {
       << " for id " << GetParam().id;
 }
 
+using FriendlyNameInternTest = spvtest::TextToBinaryTest;
+
+TEST_F(FriendlyNameInternTest, FindNameForIdReturnsInternedName) {
+  ScopedContext context(SPV_ENV_UNIVERSAL_1_1);
+  auto words = CompileSuccessfully(
+      "OpName %1 \"x\" OpName %2 \"x\" %1 = OpTypeVoid %2 = OpTypeBool",
+      SPV_ENV_UNIVERSAL_1_1);
+  FriendlyNameMapper friendly_mapper(context.context, words.data(),
+                                     words.size());
+  const std::string* first = friendly_mapper.FindNameForId(1);
+  const std::string* second = friendly_mapper.FindNameForId(2);
+  ASSERT_NE(nullptr, first);
+  ASSERT_NE(nullptr, second);
+  EXPECT_THAT(*first, Eq("x"));
+  EXPECT_THAT(*second, Eq("x_0"));
+  EXPECT_EQ(first, friendly_mapper.FindNameForId(1));
+  // Ids the module does not define have no interned name.
+  EXPECT_EQ(nullptr, friendly_mapper.FindNameForId(3));
+  EXPECT_THAT(friendly_mapper.NameForId(3), Eq("3"));
+}
+
 INSTANTIATE_TEST_SUITE_P(ScalarType, FriendlyNameTest,
                          ::testing::ValuesIn(std::vector<NameIdCase>{
                              {"%1 = OpTypeVoid", 1, "void"},
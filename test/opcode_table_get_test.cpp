@@ -12,6 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "test/unit_spirv.h"
 
@@ -28,6 +31,57 @@ TEST_P(GetTargetOpcodeTableGetTest, SanityCheck) {
   ASSERT_NE(nullptr, table->entries);
 }
 
+TEST_P(GetTargetOpcodeTableGetTest, NameIndexIsSortedPermutation) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  ASSERT_NE(nullptr, table->nameIndex);
+  std::vector<bool> seen(table->count, false);
+  for (uint32_t i = 0; i < table->count; ++i) {
+    const uint16_t index = table->nameIndex[i];
+    ASSERT_LT(index, table->count);
+    EXPECT_FALSE(seen[index]);
+    seen[index] = true;
+    if (i > 0) {
+      const uint16_t prev = table->nameIndex[i - 1];
+      const int cmp =
+          strcmp(table->entries[prev].name, table->entries[index].name);
+      EXPECT_TRUE(cmp < 0 || (cmp == 0 && prev < index))
+          << table->entries[prev].name << " " << table->entries[index].name;
+    }
+  }
+}
+
+TEST_P(GetTargetOpcodeTableGetTest, NameLookupFindsEveryAvailableOpcode) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  for (uint32_t i = 0; i < table->count; ++i) {
+    const spv_opcode_desc_t& entry = table->entries[i];
+    spv_opcode_desc by_value = nullptr;
+    if (spvOpcodeTableValueLookup(GetParam(), table, entry.opcode, &by_value))
+      continue;
+    spv_opcode_desc by_name = nullptr;
+    ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableNameLookup(GetParam(), table,
+                                                    by_value->name, &by_name));
+    EXPECT_STREQ(by_value->name, by_name->name);
+    EXPECT_EQ(by_value->opcode, by_name->opcode);
+  }
+}
+
+TEST_P(GetTargetOpcodeTableGetTest, NameLookupRejectsPrefixes) {
+  spv_opcode_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&table, GetParam()));
+  spv_opcode_desc entry = nullptr;
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "TypeIn", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "Nopp", &entry));
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOpcodeTableNameLookup(GetParam(), table, "", &entry));
+  ASSERT_EQ(SPV_SUCCESS,
+            spvOpcodeTableNameLookup(GetParam(), table, "TypeInt", &entry));
+  EXPECT_EQ(SpvOpTypeInt, entry->opcode);
+}
+
 TEST_P(GetTargetOpcodeTableGetTest, InvalidPointerTable) {
   ASSERT_EQ(SPV_ERROR_INVALID_POINTER, spvOpcodeTableGet(nullptr, GetParam()));
 }
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstring>
 #include <vector>
 
 #include "test/unit_spirv.h"
@@ -38,6 +39,51 @@ INSTANTIATE_TEST_SUITE_P(OperandTableGet, GetTargetTest,
                              SPV_ENV_UNIVERSAL_1_0, SPV_ENV_UNIVERSAL_1_1,
                              SPV_ENV_VULKAN_1_0}));
 
+TEST_P(GetTargetTest, NameIndexIsSortedPermutation) {
+  spv_operand_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOperandTableGet(&table, GetParam()));
+  for (uint32_t typeIndex = 0; typeIndex < table->count; ++typeIndex) {
+    const auto& group = table->types[typeIndex];
+    ASSERT_NE(nullptr, group.nameIndex);
+    std::vector<bool> seen(group.count, false);
+    for (uint32_t i = 0; i < group.count; ++i) {
+      const uint16_t index = group.nameIndex[i];
+      ASSERT_LT(index, group.count);
+      EXPECT_FALSE(seen[index]);
+      seen[index] = true;
+      if (i > 0) {
+        const uint16_t prev = group.nameIndex[i - 1];
+        const int cmp =
+            strcmp(group.entries[prev].name, group.entries[index].name);
+        EXPECT_TRUE(cmp < 0 || (cmp == 0 && prev < index))
+            << group.entries[prev].name << " " << group.entries[index].name;
+      }
+    }
+  }
+}
+
+TEST_P(GetTargetTest, NameLookupUsesOnlyGivenLength) {
+  spv_operand_table table;
+  ASSERT_EQ(SPV_SUCCESS, spvOperandTableGet(&table, GetParam()));
+  spv_operand_desc entry = nullptr;
+  // "Uniform" is a prefix of "UniformConstant".
+  const char* text = "UniformConstant|Bogus";
+  ASSERT_EQ(SPV_SUCCESS,
+            spvOperandTableNameLookup(GetParam(), table,
+                                      SPV_OPERAND_TYPE_STORAGE_CLASS, text,
+                                      strlen("Uniform"), &entry));
+  EXPECT_EQ(uint32_t(SpvStorageClassUniform), entry->value);
+  ASSERT_EQ(SPV_SUCCESS,
+            spvOperandTableNameLookup(GetParam(), table,
+                                      SPV_OPERAND_TYPE_STORAGE_CLASS, text,
+                                      strlen("UniformConstant"), &entry));
+  EXPECT_EQ(uint32_t(SpvStorageClassUniformConstant), entry->value);
+  EXPECT_EQ(SPV_ERROR_INVALID_LOOKUP,
+            spvOperandTableNameLookup(GetParam(), table,
+                                      SPV_OPERAND_TYPE_STORAGE_CLASS, text,
+                                      strlen("Uni"), &entry));
+}
+
 TEST(OperandString, AllAreDefinedExceptVariable) {
   // None has no string, so don't test it.
   EXPECT_EQ(0u, SPV_OPERAND_TYPE_NONE);
@@ -12,7 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <list>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -200,6 +202,137 @@ OpFunctionEnd
                            ContainerEq(expected_result2)));
 }
 
+const std::string kLoopWithIf = R"(
+OpCapability Shader
+%1 = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Vertex %main "main"
+OpName %main "main"
+%bool = OpTypeBool
+%true = OpConstantTrue %bool
+%void = OpTypeVoid
+%4 = OpTypeFunction %void
+%main = OpFunction %void None %4
+%8 = OpLabel
+OpBranch %9
+%9 = OpLabel
+OpLoopMerge %14 %13 None
+OpBranch %10
+%10 = OpLabel
+OpSelectionMerge %12 None
+OpBranchConditional %true %11 %12
+%11 = OpLabel
+OpBranch %12
+%12 = OpLabel
+OpBranchConditional %true %14 %13
+%13 = OpLabel
+OpBranch %9
+%14 = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(CFGTest, FunctionGraphNumbersBlocksInOrder) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kLoopWithIf,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  Function* function = &*context->module()->begin();
+  FunctionGraph* graph = context->cfg()->GetFunctionGraph(function);
+  ASSERT_EQ(7u, graph->size());
+  EXPECT_TRUE(graph->complete());
+  for (uint32_t i = 0; i < graph->size(); ++i) {
+    EXPECT_EQ(8 + i, graph->block(i)->id());
+    EXPECT_EQ(i, graph->index(8 + i));
+  }
+  EXPECT_EQ(FunctionGraph::kNoIndex, graph->index(100));
+
+  auto edges = [](IteratorRange<const uint32_t*> range) {
+    return std::vector<uint32_t>(range.begin(), range.end());
+  };
+  EXPECT_THAT(edges(graph->successors(4)),
+              ContainerEq(std::vector<uint32_t>{6, 5}));
+  EXPECT_THAT(edges(graph->predecessors(1)),
+              ContainerEq(std::vector<uint32_t>{0, 5}));
+  EXPECT_THAT(edges(graph->predecessors(4)),
+              ContainerEq(std::vector<uint32_t>{2, 3}));
+  EXPECT_TRUE(graph->predecessors(0).empty());
+  EXPECT_TRUE(graph->successors(6).empty());
+
+  // The merge block and continue target come first.
+  EXPECT_THAT(edges(graph->structured_successors(1)),
+              ContainerEq(std::vector<uint32_t>{6, 5, 2}));
+  EXPECT_THAT(edges(graph->structured_successors(2)),
+              ContainerEq(std::vector<uint32_t>{4, 3, 4}));
+}
+
+TEST_F(CFGTest, BlockOrdersAreMemoized) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kLoopWithIf,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  CFG* cfg = context->cfg();
+  Function* function = &*context->module()->begin();
+  EXPECT_EQ(nullptr, cfg->FindFunctionGraph(function));
+
+  std::list<BasicBlock*> order;
+  cfg->ComputeStructuredOrder(function, &*function->begin(), &order);
+  std::vector<uint32_t> ids;
+  for (BasicBlock* bb : order) ids.push_back(bb->id());
+  EXPECT_THAT(ids, ContainerEq(std::vector<uint32_t>{8, 9, 10, 11, 12, 13,
+                                                     14}));
+
+  FunctionGraph* graph = cfg->GetFunctionGraph(function);
+  EXPECT_EQ(graph, cfg->FindFunctionGraph(function));
+  EXPECT_THAT(graph->StructuredOrder(),
+              ContainerEq(std::vector<uint32_t>{0, 1, 2, 3, 4, 5, 6}));
+
+  // A traversal from a block other than the entry is not memoized.
+  order.clear();
+  cfg->ComputeStructuredOrder(function, cfg->block(10), &order);
+  ids.clear();
+  for (BasicBlock* bb : order) ids.push_back(bb->id());
+  EXPECT_THAT(ids, ContainerEq(std::vector<uint32_t>{10, 11, 12, 13, 9, 14}));
+
+  ids.clear();
+  cfg->ForEachBlockInPostOrder(
+      &*function->begin(), [&ids](BasicBlock* bb) { ids.push_back(bb->id()); });
+  EXPECT_EQ(7u, ids.size());
+  EXPECT_EQ(8u, ids.back());
+  EXPECT_EQ(graph, cfg->FindFunctionGraph(function));
+
+  // Changing the CFG drops the graph.
+  cfg->RemoveEdge(13, 9);
+  EXPECT_EQ(nullptr, cfg->FindFunctionGraph(function));
+}
+
+TEST_F(CFGTest, FunctionGraphIsRebuiltAfterDirectChanges) {
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kLoopWithIf,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  CFG* cfg = context->cfg();
+  Function* function = &*context->module()->begin();
+  FunctionGraph* graph = cfg->GetFunctionGraph(function);
+  EXPECT_TRUE(graph->IsCurrent());
+
+  // Rewrite the terminator of %10 without telling the CFG, so that %11 is no
+  // longer reachable.
+  Instruction* branch = cfg->block(10)->terminator();
+  branch->SetOpcode(SpvOpBranch);
+  branch->SetInOperands({{SPV_OPERAND_TYPE_ID, {12}}});
+  EXPECT_FALSE(graph->IsCurrent());
+
+  std::vector<uint32_t> ids;
+  cfg->ForEachBlockInReversePostOrder(
+      &*function->begin(), [&ids](BasicBlock* bb) { ids.push_back(bb->id()); });
+  EXPECT_THAT(ids, ContainerEq(std::vector<uint32_t>{8, 9, 10, 12, 13, 14}));
+  EXPECT_TRUE(cfg->FindFunctionGraph(function)->IsCurrent());
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
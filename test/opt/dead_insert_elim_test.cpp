@@ -563,6 +563,13 @@ OpFunctionEnd
                                             after_predefs + after, true, true);
 }
 
+TEST_F(DeadInsertElimTest, ParallelFunctions) {
+  // Each function has its own dead insert.  The live inserts are marked for
+  // the functions on separate threads, and both inserts must still be removed.
+  SinglePassRunAndMatchInParallel<DeadInsertElimPass>(
+      ModuleWithDeadInsertInEachFunction(), true, 2);
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 
@@ -1711,6 +1711,55 @@ TEST_F(UpdateUsesTest, KeepOldUses) {
   UserEntry entry = {def, use};
   EXPECT_THAT(users, Contains(entry));
 }
+
+TEST_F(UpdateUsesTest, KillManyUsers) {
+  const std::vector<const char*> text = {
+      // clang-format off
+      "OpCapability Shader",
+      "OpMemoryModel Logical GLSL450",
+      "OpEntryPoint Vertex %main \"main\"",
+      "%void = OpTypeVoid",
+      "%4 = OpTypeFunction %void",
+      "%uint = OpTypeInt 32 0",
+      "%uint_5 = OpConstant %uint 5",
+      "%main = OpFunction %void None %4",
+      "%8 = OpLabel",
+      "%9 = OpIMul %uint %uint_5 %uint_5",
+      "%10 = OpIAdd %uint %uint_5 %uint_5",
+      "%11 = OpISub %uint %uint_5 %uint_5",
+      "%12 = OpIMul %uint %9 %uint_5",
+      "%13 = OpIMul %uint %10 %11",
+      "OpReturn",
+      "OpFunctionEnd"
+      // clang-format on
+  };
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, JoinAllInsts(text),
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  DefUseManager* def_use_mgr = context->get_def_use_mgr();
+  const uint32_t uint_5 = def_use_mgr->GetDef(9)->GetSingleWordInOperand(0);
+  EXPECT_EQ(4u, def_use_mgr->NumUsers(uint_5));
+  EXPECT_EQ(7u, def_use_mgr->NumUses(uint_5));
+
+  context->KillInst(def_use_mgr->GetDef(13));
+  context->KillInst(def_use_mgr->GetDef(11));
+  context->KillInst(def_use_mgr->GetDef(10));
+  EXPECT_EQ(2u, def_use_mgr->NumUsers(uint_5));
+  EXPECT_EQ(3u, def_use_mgr->NumUses(uint_5));
+  EXPECT_EQ(nullptr, def_use_mgr->GetDef(11));
+
+  std::vector<uint32_t> users;
+  def_use_mgr->ForEachUser(uint_5, [&users](Instruction* user) {
+    users.push_back(user->result_id());
+  });
+  EXPECT_THAT(users, ::testing::ElementsAre(9, 12));
+
+  DefUseManager rebuilt(context->module());
+  EXPECT_TRUE(rebuilt == *def_use_mgr);
+}
 // clang-format on
 
 }  // namespace
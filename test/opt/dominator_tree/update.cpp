@@ -0,0 +1,323 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "source/opt/block_merge_pass.h"
+#include "source/opt/dead_branch_elim_pass.h"
+#include "source/opt/dominator_analysis.h"
+#include "source/opt/pass.h"
+#include "test/opt/assembly_builder.h"
+#include "test/opt/function_utils.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using PassClassTest = PassTest<::testing::Test>;
+
+const std::string kHeader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+               OpExecutionMode %1 OriginUpperLeft
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %4 = OpTypeBool
+          %9 = OpConstantTrue %4
+          %1 = OpFunction %2 None %3
+)";
+
+std::unique_ptr<IRContext> Build(const std::string& body) {
+  return BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, kHeader + body,
+                     SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+}
+
+// Checks that |analysis|, which has been updated for the changes made to |f|,
+// matches a tree built from scratch for the current CFG of |f|.
+template <typename Analysis>
+void ExpectMatchesNewTree(IRContext* context, const Function* f,
+                          const Analysis& analysis) {
+  Analysis expected;
+  expected.InitializeTree(*context->cfg(), f);
+  for (const auto& a : *f) {
+    EXPECT_EQ(expected.IsReachable(&a), analysis.IsReachable(&a)) << a.id();
+    EXPECT_EQ(expected.ImmediateDominator(&a), analysis.ImmediateDominator(&a))
+        << a.id();
+    for (const auto& b : *f) {
+      EXPECT_EQ(expected.Dominates(&a, &b), analysis.Dominates(&a, &b))
+          << a.id() << " " << b.id();
+    }
+  }
+}
+
+// Changes the target of the conditional branch ending |block| for the
+// condition being false to |target|, and updates the CFG for it.
+void SetFalseTarget(IRContext* context, BasicBlock* block, uint32_t target) {
+  Instruction* branch = block->terminator();
+  ASSERT_EQ(SpvOpBranchConditional, branch->opcode());
+  const uint32_t old_target = branch->GetSingleWordInOperand(2);
+  const uint32_t true_target = branch->GetSingleWordInOperand(1);
+  branch->SetInOperand(2, {target});
+  if (old_target != true_target) {
+    context->cfg()->RemoveEdge(block->id(), old_target);
+  }
+  if (target != true_target) {
+    context->cfg()->AddEdge(block->id(), target);
+  }
+}
+
+TEST_F(PassClassTest, InsertEdgeUpdatesDominators) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpBranchConditional %9 %6 %6
+          %6 = OpLabel
+               OpBranch %7
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+  EXPECT_EQ(7u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(6u, post->ImmediateDominator(5)->id());
+
+  SetFalseTarget(context.get(), context->cfg()->block(5), 8);
+  dom->InsertEdge(*context->cfg(), context->cfg()->block(5),
+                  context->cfg()->block(8));
+  post->InsertEdge(*context->cfg(), context->cfg()->block(5),
+                   context->cfg()->block(8));
+
+  EXPECT_EQ(5u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(8u, post->ImmediateDominator(5)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+}
+
+TEST_F(PassClassTest, DeleteEdgeUpdatesDominators) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpBranchConditional %9 %6 %8
+          %6 = OpLabel
+               OpBranch %7
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+  EXPECT_EQ(5u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(8u, post->ImmediateDominator(5)->id());
+
+  SetFalseTarget(context.get(), context->cfg()->block(5), 6);
+  dom->DeleteEdge(*context->cfg(), context->cfg()->block(5),
+                  context->cfg()->block(8));
+  post->DeleteEdge(*context->cfg(), context->cfg()->block(5),
+                   context->cfg()->block(8));
+
+  EXPECT_EQ(7u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(6u, post->ImmediateDominator(5)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+}
+
+TEST_F(PassClassTest, DeleteEdgeMakesBlockUnreachable) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpBranchConditional %9 %6 %7
+          %6 = OpLabel
+               OpBranch %8
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  EXPECT_TRUE(dom->IsReachable(7));
+  EXPECT_EQ(5u, dom->ImmediateDominator(8)->id());
+
+  SetFalseTarget(context.get(), context->cfg()->block(5), 6);
+  dom->DeleteEdge(*context->cfg(), context->cfg()->block(5),
+                  context->cfg()->block(7));
+
+  EXPECT_FALSE(dom->IsReachable(7));
+  EXPECT_EQ(6u, dom->ImmediateDominator(8)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+}
+
+TEST_F(PassClassTest, EdgeInLoopUpdatesDominators) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpBranch %6
+          %6 = OpLabel
+               OpLoopMerge %10 %8 None
+               OpBranch %7
+          %7 = OpLabel
+               OpBranchConditional %9 %11 %11
+         %11 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpBranchConditional %9 %6 %10
+         %10 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+
+  SetFalseTarget(context.get(), context->cfg()->block(7), 10);
+  dom->InsertEdge(*context->cfg(), context->cfg()->block(7),
+                  context->cfg()->block(10));
+  post->InsertEdge(*context->cfg(), context->cfg()->block(7),
+                   context->cfg()->block(10));
+  EXPECT_EQ(7u, dom->ImmediateDominator(10)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+
+  SetFalseTarget(context.get(), context->cfg()->block(7), 11);
+  dom->DeleteEdge(*context->cfg(), context->cfg()->block(7),
+                  context->cfg()->block(10));
+  post->DeleteEdge(*context->cfg(), context->cfg()->block(7),
+                   context->cfg()->block(10));
+  EXPECT_EQ(8u, dom->ImmediateDominator(10)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+}
+
+TEST_F(PassClassTest, BlockMergeKeepsDominators) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpSelectionMerge %8 None
+               OpBranchConditional %9 %6 %7
+          %6 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+               OpBranch %8
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpBranch %11
+         %11 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+
+  BlockMergePass pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(4u, f->end() - f->begin());
+
+  // The trees were kept up to date instead of being invalidated.
+  EXPECT_EQ(dom, context->FindDominatorAnalysis(f));
+  EXPECT_EQ(post, context->FindPostDominatorAnalysis(f));
+  EXPECT_EQ(5u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(8u, post->ImmediateDominator(6)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+  EXPECT_TRUE(context->IsConsistent());
+}
+
+TEST_F(PassClassTest, DeadBranchElimKeepsDominators) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpSelectionMerge %8 None
+               OpBranchConditional %9 %6 %7
+          %6 = OpLabel
+               OpBranch %8
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+  EXPECT_EQ(5u, dom->ImmediateDominator(8)->id());
+
+  DeadBranchElimPass pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(3u, f->end() - f->begin());
+
+  // The trees were kept up to date instead of being invalidated.
+  EXPECT_EQ(dom, context->FindDominatorAnalysis(f));
+  EXPECT_EQ(post, context->FindPostDominatorAnalysis(f));
+  EXPECT_EQ(6u, dom->ImmediateDominator(8)->id());
+  EXPECT_EQ(6u, post->ImmediateDominator(5)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+  EXPECT_TRUE(context->IsConsistent());
+}
+
+TEST_F(PassClassTest, DeadBranchElimKeepsPostDominatorsOfRemovedExits) {
+  const std::string text = R"(
+          %5 = OpLabel
+               OpSelectionMerge %8 None
+               OpBranchConditional %9 %6 %7
+          %6 = OpLabel
+               OpReturn
+          %7 = OpLabel
+               OpBranch %8
+          %8 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context = Build(text);
+  ASSERT_NE(nullptr, context);
+  Function* f = spvtest::GetFunction(context->module(), 1);
+  DominatorAnalysis* dom = context->GetDominatorAnalysis(f);
+  PostDominatorAnalysis* post = context->GetPostDominatorAnalysis(f);
+
+  DeadBranchElimPass pass;
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(2u, f->end() - f->begin());
+
+  EXPECT_EQ(dom, context->FindDominatorAnalysis(f));
+  EXPECT_EQ(post, context->FindPostDominatorAnalysis(f));
+  EXPECT_EQ(6u, post->ImmediateDominator(5)->id());
+  ExpectMatchesNewTree(context.get(), f, *dom);
+  ExpectMatchesNewTree(context.get(), f, *post);
+  EXPECT_TRUE(context->IsConsistent());
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
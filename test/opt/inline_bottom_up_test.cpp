@@ -0,0 +1,242 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "source/opt/build_module.h"
+#include "source/opt/inline_bottom_up_pass.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::HasSubstr;
+using InlineBottomUpTest = PassTest<::testing::Test>;
+
+// Returns a module whose entry point holds |calls|.  It has two functions to
+// call: %small, with 6 instructions, and %large, with 15 instructions.
+std::string ModuleWithCalls(const std::string& calls) {
+  return R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpName %main "main"
+               OpName %small "small"
+               OpName %large "large"
+       %void = OpTypeVoid
+      %float = OpTypeFloat 32
+    %fn_void = OpTypeFunction %void
+   %fn_float = OpTypeFunction %float %float
+        %one = OpConstant %float 1
+       %main = OpFunction %void None %fn_void
+ %main_entry = OpLabel
+)" + calls + R"(
+               OpReturn
+               OpFunctionEnd
+      %small = OpFunction %float None %fn_float
+    %small_x = OpFunctionParameter %float
+%small_entry = OpLabel
+    %small_y = OpFAdd %float %small_x %one
+               OpReturnValue %small_y
+               OpFunctionEnd
+      %large = OpFunction %float None %fn_float
+    %large_x = OpFunctionParameter %float
+%large_entry = OpLabel
+         %l1 = OpFAdd %float %large_x %one
+         %l2 = OpFMul %float %l1 %l1
+         %l3 = OpFAdd %float %l2 %one
+         %l4 = OpFMul %float %l3 %l3
+         %l5 = OpFAdd %float %l4 %one
+         %l6 = OpFMul %float %l5 %l5
+         %l7 = OpFAdd %float %l6 %one
+         %l8 = OpFMul %float %l7 %l7
+         %l9 = OpFAdd %float %l8 %one
+        %l10 = OpFMul %float %l9 %l9
+               OpReturnValue %l10
+               OpFunctionEnd
+)";
+}
+
+TEST_F(InlineBottomUpTest, InlineSmallFunctionsOnly) {
+  const std::string calls = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall %float %small
+; CHECK: OpFunctionCall %float %large
+; CHECK: OpFunctionCall %float %large
+; CHECK-NOT: OpFunctionCall %float %small
+; CHECK: OpFunctionEnd
+         %c1 = OpFunctionCall %float %small %one
+         %c2 = OpFunctionCall %float %large %c1
+         %c3 = OpFunctionCall %float %large %c2
+         %c4 = OpFunctionCall %float %small %c3
+)";
+  SinglePassRunAndMatch<InlineBottomUpPass>(ModuleWithCalls(calls), true, 100,
+                                            12);
+}
+
+TEST_F(InlineBottomUpTest, InlineSingleCallOfLargeFunction) {
+  const std::string calls = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+         %c1 = OpFunctionCall %float %large %one
+)";
+  SinglePassRunAndMatch<InlineBottomUpPass>(ModuleWithCalls(calls), true, 100,
+                                            0);
+}
+
+TEST_F(InlineBottomUpTest, StopAtGrowthBudget) {
+  // The entry point has 6 instructions, so its budget is 6 + 20.  There is
+  // room for one copy of %large only.
+  const std::string calls = R"(
+         %c1 = OpFunctionCall %float %large %one
+         %c2 = OpFunctionCall %float %large %c1
+)";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, ModuleWithCalls(calls),
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  InlineBottomUpPass pass(0, 20);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(1u, pass.statistics().calls_inlined);
+  EXPECT_EQ(1u, pass.statistics().calls_kept);
+  EXPECT_EQ(27u, pass.statistics().size_before);
+  EXPECT_LT(pass.statistics().size_before, pass.statistics().size_after);
+  std::ostringstream statistics;
+  pass.PrintStatistics(statistics);
+  EXPECT_THAT(statistics.str(),
+              HasSubstr("inline-bottom-up: 1 calls inlined, 1 kept; 27 "
+                        "instructions before"));
+
+  uint32_t num_calls = 0;
+  context->module()->ForEachInst([&num_calls](const Instruction* inst) {
+    if (inst->opcode() == SpvOpFunctionCall) ++num_calls;
+  });
+  EXPECT_EQ(1u, num_calls);
+}
+
+TEST_F(InlineBottomUpTest, InlineCalleesFirst) {
+  // %middle is processed first, so %large is inlined into it.  %middle is then
+  // inlined into the entry point, as the only call to it, and the calls it
+  // brought along are not considered again.
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+; CHECK: %middle = OpFunction
+; CHECK-NOT: OpFunctionCall
+; CHECK: OpFunctionEnd
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpName %main "main"
+               OpName %middle "middle"
+       %void = OpTypeVoid
+      %float = OpTypeFloat 32
+    %fn_void = OpTypeFunction %void
+   %fn_float = OpTypeFunction %float %float
+        %one = OpConstant %float 1
+       %main = OpFunction %void None %fn_void
+ %main_entry = OpLabel
+         %c1 = OpFunctionCall %float %middle %one
+               OpReturn
+               OpFunctionEnd
+     %middle = OpFunction %float None %fn_float
+   %middle_x = OpFunctionParameter %float
+%middle_entry = OpLabel
+   %middle_y = OpFunctionCall %float %small %middle_x
+               OpReturnValue %middle_y
+               OpFunctionEnd
+      %small = OpFunction %float None %fn_float
+    %small_x = OpFunctionParameter %float
+%small_entry = OpLabel
+    %small_y = OpFAdd %float %small_x %one
+               OpReturnValue %small_y
+               OpFunctionEnd
+)";
+  SinglePassRunAndMatch<InlineBottomUpPass>(text, true, 100, 64);
+}
+
+TEST_F(InlineBottomUpTest, BudgetCalleeWithSeveralCallers) {
+  // %large is inlined into %middle, as the only call to it.  The entry point
+  // calls %middle twice, so those calls are subject to the budget of 6 + 30,
+  // which has room for one copy of %middle only.
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+       %void = OpTypeVoid
+      %float = OpTypeFloat 32
+    %fn_void = OpTypeFunction %void
+   %fn_float = OpTypeFunction %float %float
+        %one = OpConstant %float 1
+       %main = OpFunction %void None %fn_void
+ %main_entry = OpLabel
+         %c1 = OpFunctionCall %float %middle %one
+         %c2 = OpFunctionCall %float %middle %c1
+               OpReturn
+               OpFunctionEnd
+     %middle = OpFunction %float None %fn_float
+   %middle_x = OpFunctionParameter %float
+%middle_entry = OpLabel
+   %middle_y = OpFunctionCall %float %large %middle_x
+   %middle_z = OpFAdd %float %middle_y %one
+               OpReturnValue %middle_z
+               OpFunctionEnd
+      %large = OpFunction %float None %fn_float
+    %large_x = OpFunctionParameter %float
+%large_entry = OpLabel
+         %l1 = OpFAdd %float %large_x %one
+         %l2 = OpFMul %float %l1 %l1
+         %l3 = OpFAdd %float %l2 %one
+         %l4 = OpFMul %float %l3 %l3
+         %l5 = OpFAdd %float %l4 %one
+         %l6 = OpFMul %float %l5 %l5
+         %l7 = OpFAdd %float %l6 %one
+         %l8 = OpFMul %float %l7 %l7
+         %l9 = OpFAdd %float %l8 %one
+        %l10 = OpFMul %float %l9 %l9
+               OpReturnValue %l10
+               OpFunctionEnd
+)";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+
+  InlineBottomUpPass pass(0, 30);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, pass.Run(context.get()));
+  EXPECT_EQ(2u, pass.statistics().calls_inlined);
+  EXPECT_EQ(1u, pass.statistics().calls_kept);
+
+  uint32_t num_calls = 0;
+  context->module()->ForEachInst([&num_calls](const Instruction* inst) {
+    if (inst->opcode() == SpvOpFunctionCall) ++num_calls;
+  });
+  EXPECT_EQ(1u, num_calls);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -17,7 +17,9 @@
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "OpenCLDebugInfo100.h"
 #include "gmock/gmock.h"
@@ -288,6 +290,85 @@ TEST_F(IRContextTest, TakeNextUniqueIdIncrementing) {
     EXPECT_EQ(i, localContext.TakeNextUniqueId());
 }
 
+TEST_F(IRContextTest, TakeNextIdFromManyThreads) {
+  const uint32_t kNumThreads = 4;
+  const uint32_t kIdsPerThread = 1000;
+  IRContext localContext(SPV_ENV_UNIVERSAL_1_2, nullptr);
+  localContext.module()->SetIdBound(1);
+
+  std::vector<std::vector<uint32_t>> ids(kNumThreads);
+  std::vector<std::thread> threads;
+  for (uint32_t t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&localContext, &ids, t]() {
+      for (uint32_t i = 0; i < kIdsPerThread; ++i) {
+        ids[t].push_back(localContext.TakeNextId());
+        localContext.TakeNextUniqueId();
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  // Every id must have been handed out exactly once.
+  std::vector<uint32_t> all_ids;
+  for (const auto& thread_ids : ids) {
+    all_ids.insert(all_ids.end(), thread_ids.begin(), thread_ids.end());
+  }
+  std::sort(all_ids.begin(), all_ids.end());
+  for (uint32_t i = 0; i < all_ids.size(); ++i) {
+    EXPECT_EQ(i + 1, all_ids[i]);
+  }
+  EXPECT_EQ(kNumThreads * kIdsPerThread + 1, localContext.module()->IdBound());
+  EXPECT_EQ(kNumThreads * kIdsPerThread + 1, localContext.TakeNextUniqueId());
+}
+
+TEST_F(IRContextTest, ArenaHoldsLoadedModule) {
+  const std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %1 "main"
+OpExecutionMode %1 OriginUpperLeft
+%2 = OpTypeVoid
+%3 = OpTypeFunction %2
+%4 = OpTypeFloat 32
+%5 = OpConstant %4 1
+%1 = OpFunction %2 None %3
+%6 = OpLabel
+%7 = OpFAdd %4 %5 %5
+OpReturn
+OpFunctionEnd
+)";
+
+  std::vector<uint32_t> binary;
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_2);
+  ASSERT_TRUE(tools.Assemble(text, &binary));
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, binary.data(),
+                  binary.size(), /* use_arena = */ true);
+  ASSERT_NE(nullptr, context);
+  const utils::Arena* arena = context->arena();
+  ASSERT_NE(nullptr, arena);
+
+  // Every instruction and the one basic block come from the arena.
+  EXPECT_EQ(14u, arena->num_allocations());
+  const size_t bytes_after_load = arena->bytes_in_use();
+
+  // Killing an instruction returns its memory to the arena, and a clone reuses
+  // it.
+  context->KillDef(7);
+  EXPECT_LT(arena->bytes_in_use(), bytes_after_load);
+  std::unique_ptr<Instruction> clone(
+      context->get_def_use_mgr()->GetDef(5)->Clone(context.get()));
+  EXPECT_EQ(15u, arena->num_allocations());
+  EXPECT_EQ(bytes_after_load, arena->bytes_in_use());
+  clone.reset();
+
+  std::vector<uint32_t> output;
+  context->module()->ToBinary(&output, /* skip_nop = */ true);
+  std::string disassembly;
+  ASSERT_TRUE(tools.Disassemble(output, &disassembly,
+                                SPV_BINARY_TO_TEXT_OPTION_NO_HEADER));
+  EXPECT_EQ(std::string::npos, disassembly.find("OpFAdd"));
+}
+
 TEST_F(IRContextTest, KillGroupDecorationWitNoDecorations) {
   const std::string text = R"(
                OpCapability Shader
@@ -1099,6 +1180,129 @@ OpFunctionEnd)";
   EXPECT_EQ(dbg_value->GetSingleWordOperand(kDebugValueOperandValueIndex), 7);
 }
 
+TEST_F(IRContextTest, ChangeJournalCatchesUpWithNewInstructions) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeInt 32 1
+          %6 = OpConstant %5 1
+          %2 = OpFunction %3 None %4
+          %7 = OpLabel
+          %8 = OpIAdd %5 %6 %6
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  const Analysis journaled = IRContext::kAnalysisDefUse |
+                             IRContext::kAnalysisInstrToBlockMapping |
+                             IRContext::kAnalysisDecorations;
+  context->BuildInvalidAnalyses(journaled);
+  context->StartChangeJournal();
+
+  // Add an instruction and a decoration of it, without telling the analyses.
+  Instruction* add = context->get_def_use_mgr()->GetDef(8);
+  Instruction* new_add = add->NextNode()->InsertBefore(MakeUnique<Instruction>(
+      context.get(), SpvOpIAdd, 5, 9,
+      std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {8}},
+                                     {SPV_OPERAND_TYPE_ID, {6}}}));
+  context->module()->AddAnnotationInst(MakeUnique<Instruction>(
+      context.get(), SpvOpDecorate, 0, 0,
+      std::initializer_list<Operand>{
+          {SPV_OPERAND_TYPE_ID, {9}},
+          {SPV_OPERAND_TYPE_DECORATION, {SpvDecorationRelaxedPrecision}}}));
+
+  // An instruction that is killed before the analyses catch up is forgotten.
+  Instruction* dead_add = new_add->InsertBefore(MakeUnique<Instruction>(
+      context.get(), SpvOpIAdd, 5, 10,
+      std::initializer_list<Operand>{{SPV_OPERAND_TYPE_ID, {6}},
+                                     {SPV_OPERAND_TYPE_ID, {6}}}));
+  context->KillInst(dead_add);
+
+  EXPECT_EQ(new_add, context->get_def_use_mgr()->GetDef(9));
+  EXPECT_EQ(nullptr, context->get_def_use_mgr()->GetDef(10));
+  EXPECT_EQ(1u, context->get_def_use_mgr()->NumUsers(8));
+  EXPECT_EQ(context->get_instr_block(add), context->get_instr_block(new_add));
+  EXPECT_EQ(1u, context->get_decoration_mgr()->GetDecorationsFor(9, false)
+                    .size());
+
+  EXPECT_EQ(journaled, context->StopChangeJournal());
+  EXPECT_TRUE(context->IsConsistent());
+}
+
+TEST_F(IRContextTest, ChangeJournalCannotMapNewBlock) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %2 = OpFunction %3 None %4
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text);
+  context->BuildInvalidAnalyses(IRContext::kAnalysisDefUse |
+                                IRContext::kAnalysisInstrToBlockMapping);
+  context->StartChangeJournal();
+
+  // Add a block.  Labels are not in a list, so the new one is reported.
+  std::unique_ptr<BasicBlock> block(new BasicBlock(MakeUnique<Instruction>(
+      context.get(), SpvOpLabel, 0, 6, std::initializer_list<Operand>{})));
+  context->AnalyzeDefUse(block->GetLabelInst());
+  block->AddInstruction(MakeUnique<Instruction>(context.get(), SpvOpReturn));
+  context->module()->begin()->AddBasicBlock(std::move(block));
+
+  // None of the instructions in the block are mapped, so the mapping is
+  // invalidated.
+  EXPECT_EQ(IRContext::kAnalysisDefUse, context->StopChangeJournal());
+  EXPECT_FALSE(
+      context->AreAnalysesValid(IRContext::kAnalysisInstrToBlockMapping));
+  EXPECT_TRUE(context->IsConsistent());
+}
+
+TEST_F(IRContextTest, StaleFunctionGraphIsConsistent) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %2 = OpFunction %3 None %4
+          %5 = OpLabel
+               OpBranch %6
+          %6 = OpLabel
+               OpBranch %7
+          %7 = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  ASSERT_NE(nullptr, context);
+  Function* function = &*context->module()->begin();
+  const FunctionGraph* graph = context->cfg()->GetFunctionGraph(function);
+
+  // Moving a block leaves the edges of the CFG as they are, but the flat
+  // graph is no longer current.  It is rebuilt the next time it is used, so
+  // the context is still consistent.
+  function->MoveBasicBlockToAfter(6, context->cfg()->block(7));
+  EXPECT_FALSE(graph->IsCurrent());
+  EXPECT_TRUE(context->IsConsistent());
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
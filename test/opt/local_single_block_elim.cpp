@@ -1452,6 +1452,91 @@ TEST_F(LocalSingleBlockLoadStoreElimTest, DebugValueTest) {
   SinglePassRunAndMatch<LocalSingleBlockLoadStoreElimPass>(text, false);
 }
 
+TEST_F(LocalSingleBlockLoadStoreElimTest, StoreOfReplacedLoad) {
+  // The load of %w is replaced by the value stored to %w, which is the load
+  // of %v that is itself replaced.
+  const std::string text = R"(
+; CHECK: [[value:%\w+]] = OpLoad %float %in
+; CHECK-NOT: OpLoad %float %v
+; CHECK: OpStore %w [[value]]
+; CHECK-NOT: OpLoad %float %w
+; CHECK: OpStore %out [[value]]
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%ptr_in = OpTypePointer Input %float
+%ptr_out = OpTypePointer Output %float
+%ptr_func = OpTypePointer Function %float
+%in = OpVariable %ptr_in Input
+%out = OpVariable %ptr_out Output
+%main = OpFunction %void None %fn
+%1 = OpLabel
+%v = OpVariable %ptr_func Function
+%w = OpVariable %ptr_func Function
+%2 = OpLoad %float %in
+OpStore %v %2
+%3 = OpLoad %float %v
+OpStore %w %3
+%4 = OpLoad %float %w
+OpStore %out %4
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LocalSingleBlockLoadStoreElimPass>(text, true);
+}
+
+TEST_F(LocalSingleBlockLoadStoreElimTest, ParallelFunctions) {
+  // Each function has its own redundant load.  The loads to eliminate are
+  // found for the functions on separate threads, and both must be replaced.
+  const std::string text = R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpLoad %float %v
+; CHECK: OpFunctionEnd
+; CHECK: %foo = OpFunction
+; CHECK-NOT: OpLoad %float %w
+; CHECK: OpFunctionEnd
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%ptr_in = OpTypePointer Input %float
+%ptr_out = OpTypePointer Output %float
+%ptr_func = OpTypePointer Function %float
+%in = OpVariable %ptr_in Input
+%out = OpVariable %ptr_out Output
+%main = OpFunction %void None %fn
+%1 = OpLabel
+%v = OpVariable %ptr_func Function
+%2 = OpLoad %float %in
+OpStore %v %2
+%3 = OpLoad %float %v
+OpStore %out %3
+%4 = OpFunctionCall %void %foo
+OpReturn
+OpFunctionEnd
+%foo = OpFunction %void None %fn
+%5 = OpLabel
+%w = OpVariable %ptr_func Function
+%6 = OpLoad %float %in
+OpStore %w %6
+%7 = OpLoad %float %w
+OpStore %out %7
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatchInParallel<LocalSingleBlockLoadStoreElimPass>(
+      text, true, 2);
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 //    Other target variable types
@@ -0,0 +1,169 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/optimization_cache.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(OptimizationCacheKeyTest, KeyDependsOnEveryInput) {
+  const std::vector<uint32_t> words = {0x07230203, 0x00010000, 1, 2};
+
+  OptimizationCacheKey a;
+  a.AddWords(words.data(), words.size());
+  a.Add(std::string("--ccp"));
+
+  OptimizationCacheKey b;
+  b.AddWords(words.data(), words.size());
+  b.Add(std::string("--ccp"));
+  EXPECT_EQ(a.Digest(), b.Digest());
+  EXPECT_EQ(32u, a.Digest().size());
+
+  OptimizationCacheKey c;
+  c.AddWords(words.data(), words.size() - 1);
+  c.Add(std::string("--ccp"));
+  EXPECT_NE(a.Digest(), c.Digest());
+
+  // The strings are delimited, so moving a character from one to the next
+  // changes the key.
+  OptimizationCacheKey d;
+  d.Add(std::string("ab"));
+  d.Add(std::string("c"));
+  OptimizationCacheKey e;
+  e.Add(std::string("a"));
+  e.Add(std::string("bc"));
+  EXPECT_NE(d.Digest(), e.Digest());
+}
+
+TEST(DirectoryOptimizationCacheTest, StoreAndLookup) {
+  auto cache = DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20);
+  cache->Clear();
+
+  std::vector<uint32_t> binary;
+  EXPECT_FALSE(cache->Lookup("0123456789abcdef0123456789abcdef", &binary));
+
+  cache->Store("0123456789abcdef0123456789abcdef", {1, 2, 3});
+  EXPECT_TRUE(cache->Lookup("0123456789abcdef0123456789abcdef", &binary));
+  EXPECT_THAT(binary, ElementsAre(1, 2, 3));
+  EXPECT_EQ(1u, cache->num_entries());
+
+  // Storing a key again replaces its module.
+  cache->Store("0123456789abcdef0123456789abcdef", {4});
+  EXPECT_TRUE(cache->Lookup("0123456789abcdef0123456789abcdef", &binary));
+  EXPECT_THAT(binary, ElementsAre(4));
+  EXPECT_EQ(1u, cache->num_entries());
+
+  // Another instance for the same directory sees the same modules.
+  DirectoryOptimizationCache other(::testing::TempDir(), 1 << 20);
+  EXPECT_TRUE(other.Lookup("0123456789abcdef0123456789abcdef", &binary));
+  EXPECT_THAT(binary, ElementsAre(4));
+
+  cache->Clear();
+  EXPECT_FALSE(cache->Lookup("0123456789abcdef0123456789abcdef", &binary));
+  EXPECT_EQ(0u, cache->num_entries());
+}
+
+TEST(DirectoryOptimizationCacheTest, EvictsLeastRecentlyUsed) {
+  // Each module below takes 16 bytes, so two of them fit.
+  auto cache = DirectoryOptimizationCache::Get(::testing::TempDir(), 40);
+  cache->Clear();
+
+  cache->Store("00000000000000000000000000000001", {1, 1});
+  cache->Store("00000000000000000000000000000002", {2, 2});
+  EXPECT_EQ(32u, cache->size());
+
+  // Using the first module makes the second one the least recently used.
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(cache->Lookup("00000000000000000000000000000001", &binary));
+  cache->Store("00000000000000000000000000000003", {3, 3});
+  EXPECT_EQ(2u, cache->num_entries());
+  EXPECT_EQ(32u, cache->size());
+
+  EXPECT_TRUE(cache->Lookup("00000000000000000000000000000001", &binary));
+  EXPECT_THAT(binary, ElementsAre(1, 1));
+  EXPECT_FALSE(cache->Lookup("00000000000000000000000000000002", &binary));
+  EXPECT_TRUE(cache->Lookup("00000000000000000000000000000003", &binary));
+  EXPECT_THAT(binary, ElementsAre(3, 3));
+
+  cache->Clear();
+}
+
+TEST(DirectoryOptimizationCacheTest, ModulesAreStoredLittleEndian) {
+  auto cache = DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20);
+  cache->Clear();
+
+  const std::string key = "0123456789abcdef0123456789abcdef";
+  cache->Store(key, {0x04030201});
+  std::ifstream file(::testing::TempDir() + "/" + key + ".spv",
+                     std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                                std::istreambuf_iterator<char>());
+  EXPECT_THAT(bytes, ElementsAre('C', 'S', 'P', 'O', 1, 0, 0, 0, 1, 2, 3, 4));
+
+  cache->Clear();
+}
+
+TEST(DirectoryOptimizationCacheTest, DamagedModulesAreMisses) {
+  auto cache = DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20);
+  cache->Clear();
+
+  // The header claims far more words than the file holds.
+  const std::string key = "0123456789abcdef0123456789abcdef";
+  cache->Store(key, {1});
+  {
+    std::ofstream file(::testing::TempDir() + "/" + key + ".spv",
+                       std::ios::binary | std::ios::trunc);
+    const char bytes[] = {'C', 'S', 'P', 'O', '\xff', '\xff', '\xff', '\xff',
+                          1,   0,   0,   0};
+    file.write(bytes, sizeof(bytes));
+  }
+  std::vector<uint32_t> binary;
+  EXPECT_FALSE(cache->Lookup(key, &binary));
+  EXPECT_TRUE(binary.empty());
+  EXPECT_EQ(0u, cache->num_entries());
+
+  cache->Clear();
+}
+
+TEST(DirectoryOptimizationCacheTest, HitsAreRecordedWhenDestroyed) {
+  {
+    DirectoryOptimizationCache cache(::testing::TempDir(), 1 << 20);
+    cache.Clear();
+    cache.Store("00000000000000000000000000000001", {1, 1});
+    cache.Store("00000000000000000000000000000002", {2, 2});
+    std::vector<uint32_t> binary;
+    EXPECT_TRUE(cache.Lookup("00000000000000000000000000000001", &binary));
+  }
+
+  // The first module was used last, so the second one is evicted.
+  DirectoryOptimizationCache cache(::testing::TempDir(), 40);
+  cache.Store("00000000000000000000000000000003", {3, 3});
+  std::vector<uint32_t> binary;
+  EXPECT_TRUE(cache.Lookup("00000000000000000000000000000001", &binary));
+  EXPECT_FALSE(cache.Lookup("00000000000000000000000000000002", &binary));
+  cache.Clear();
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
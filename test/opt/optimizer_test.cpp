@@ -16,6 +16,8 @@
 #include <vector>
 
 #include "gmock/gmock.h"
+#include "source/opt/optimization_cache.h"
+#include "source/util/make_unique.h"
 #include "spirv-tools/libspirv.hpp"
 #include "spirv-tools/optimizer.hpp"
 #include "test/opt/pass_fixture.h"
@@ -762,6 +764,170 @@ OpFunctionEnd
       << "Was expecting the OpNop to have been removed.";
 }
 
+// A pass that counts how many times it is run.
+class CountingPass : public Pass {
+ public:
+  explicit CountingPass(int* runs) : runs_(runs) {}
+  const char* name() const override { return "counting"; }
+  Status Process() override {
+    ++*runs_;
+    return Status::SuccessWithoutChange;
+  }
+
+ private:
+  int* runs_;
+};
+
+TEST(Optimizer, CacheHitSkipsPasses) {
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binary);
+
+  // A pass can only be run once, so each run needs its own optimizer.
+  int runs = 0;
+  std::vector<uint32_t> first;
+  {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir())
+        .SetCacheKeySalt("strip-debug,counting");
+    opt.RegisterPass(CreateStripDebugInfoPass())
+        .RegisterPass(Optimizer::PassToken(MakeUnique<CountingPass>(&runs)));
+    ASSERT_TRUE(opt.Run(binary.data(), binary.size(), &first));
+  }
+  EXPECT_EQ(1, runs);
+
+  std::vector<uint32_t> second;
+  {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir())
+        .SetCacheKeySalt("strip-debug,counting");
+    opt.RegisterPass(CreateStripDebugInfoPass())
+        .RegisterPass(Optimizer::PassToken(MakeUnique<CountingPass>(&runs)));
+    ASSERT_TRUE(opt.Run(binary.data(), binary.size(), &second));
+  }
+  EXPECT_EQ(1, runs);
+  EXPECT_EQ(first, second);
+
+  std::string disassembly;
+  tools.Disassemble(second.data(), second.size(), &disassembly);
+  EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
+
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+}
+
+TEST(Optimizer, CacheKeyIncludesPassesAndOptions) {
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binary);
+
+  int runs = 0;
+  auto run = [&binary, &runs](const std::string& flag,
+                              const OptimizerOptions& options) {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir()).SetCacheKeySalt("counting");
+    opt.RegisterPassFromFlag(flag);
+    opt.RegisterPass(Optimizer::PassToken(MakeUnique<CountingPass>(&runs)));
+    std::vector<uint32_t> optimized;
+    EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized, options));
+  };
+
+  OptimizerOptions options;
+  run("--strip-debug", options);
+  EXPECT_EQ(1, runs);
+  run("--strip-debug", options);
+  EXPECT_EQ(1, runs);
+
+  // Different passes, pass arguments or options are not hits.
+  run("--eliminate-dead-code-aggressive", options);
+  EXPECT_EQ(2, runs);
+  run("--scalar-replacement=10", options);
+  EXPECT_EQ(3, runs);
+  run("--scalar-replacement=20", options);
+  EXPECT_EQ(4, runs);
+  options.set_preserve_bindings(true);
+  run("--strip-debug", options);
+  EXPECT_EQ(5, runs);
+
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+}
+
+TEST(Optimizer, CacheNeedsSaltForPassesRegisteredWithoutFlag) {
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binary);
+
+  // The two passes have the same name but not the same argument, so the
+  // result of one cannot be used for the other.
+  int runs = 0;
+  auto run = [&binary, &runs](uint32_t size_limit, const std::string& salt) {
+    Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+    opt.SetCacheDirectory(::testing::TempDir()).SetCacheKeySalt(salt);
+    opt.RegisterPass(CreateScalarReplacementPass(size_limit));
+    opt.RegisterPass(Optimizer::PassToken(MakeUnique<CountingPass>(&runs)));
+    std::vector<uint32_t> optimized;
+    EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  };
+
+  run(100, "");
+  run(0, "");
+  run(100, "");
+  EXPECT_EQ(3, runs);
+  EXPECT_EQ(0u, DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)
+                    ->num_entries());
+
+  // With a salt for each set of arguments, each result is cached under its
+  // own key.
+  run(100, "scalar-replacement=100");
+  run(0, "scalar-replacement=0");
+  EXPECT_EQ(5, runs);
+  run(100, "scalar-replacement=100");
+  run(0, "scalar-replacement=0");
+  EXPECT_EQ(5, runs);
+  EXPECT_EQ(2u, DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)
+                    ->num_entries());
+
+  DirectoryOptimizationCache::Get(::testing::TempDir(), 1 << 20)->Clear();
+}
+
+TEST(Optimizer, RunRegistersPassesAgainFromTheirFlags) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "OpName %foo \"foo\"\n%foo = OpTypeVoid",
+                 &binary);
+
+  // The passes of the first run are used up, so the second run needs new
+  // ones.
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPassFromFlag("--strip-debug");
+  for (int run = 0; run < 2; ++run) {
+    std::vector<uint32_t> optimized;
+    ASSERT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+    std::string disassembly;
+    tools.Disassemble(optimized.data(), optimized.size(), &disassembly);
+    EXPECT_THAT(disassembly, Eq(Header() + "%void = OpTypeVoid\n"));
+  }
+}
+
+TEST(Optimizer, RunFailsAgainWithPassesWithoutFlag) {
+  SpirvTools tools(SPV_ENV_UNIVERSAL_1_0);
+  std::vector<uint32_t> binary;
+  tools.Assemble(Header() + "%void = OpTypeVoid", &binary);
+
+  int runs = 0;
+  Optimizer opt(SPV_ENV_UNIVERSAL_1_0);
+  opt.RegisterPass(Optimizer::PassToken(MakeUnique<CountingPass>(&runs)));
+  std::vector<uint32_t> optimized;
+  EXPECT_TRUE(opt.Run(binary.data(), binary.size(), &optimized));
+  EXPECT_FALSE(opt.Run(binary.data(), binary.size(), &optimized));
+  EXPECT_EQ(1, runs);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -70,6 +70,7 @@ class PassTest : public TestT {
     context()->set_preserve_bindings(OptimizerOptions()->preserve_bindings_);
     context()->set_preserve_spec_constants(
         OptimizerOptions()->preserve_spec_constants_);
+    context()->set_num_threads(OptimizerOptions()->num_threads_);
 
     const auto status = pass->Run(context());
 
@@ -189,6 +190,19 @@ class PassTest : public TestT {
         << disassembly;
   }
 
+  // Same as SinglePassRunAndMatch, but lets the pass process up to
+  // |num_threads| functions in parallel.
+  template <typename PassT, typename... Args>
+  void SinglePassRunAndMatchInParallel(const std::string& original,
+                                       bool do_validation, uint32_t num_threads,
+                                       Args&&... args) {
+    const uint32_t old_num_threads = OptimizerOptions()->num_threads_;
+    OptimizerOptions()->num_threads_ = num_threads;
+    SinglePassRunAndMatch<PassT>(original, do_validation,
+                                 std::forward<Args>(args)...);
+    OptimizerOptions()->num_threads_ = old_num_threads;
+  }
+
   // Runs a single pass of class |PassT| on the binary assembled from the
   // |original| assembly. Check for failure and expect an Effcee matcher
   // to pass when run on the diagnostic messages. This does *not* involve
@@ -239,6 +253,7 @@ class PassTest : public TestT {
     context()->set_preserve_bindings(OptimizerOptions()->preserve_bindings_);
     context()->set_preserve_spec_constants(
         OptimizerOptions()->preserve_spec_constants_);
+    context()->set_num_threads(OptimizerOptions()->num_threads_);
 
     auto status = manager_->Run(context());
     EXPECT_NE(status, Pass::Status::Failure);
@@ -286,6 +301,51 @@ class PassTest : public TestT {
   spv_target_env env_;
 };
 
+// Returns a module with two functions that each have a dead
+// OpCompositeInsert, with the Effcee checks that both inserts are removed.
+// Passes that find dead inserts use it to test processing the functions in
+// parallel.
+inline std::string ModuleWithDeadInsertInEachFunction() {
+  return R"(
+; CHECK: %main = OpFunction
+; CHECK-NOT: OpCompositeInsert
+; CHECK: OpFunctionEnd
+; CHECK: %foo = OpFunction
+; CHECK-NOT: OpCompositeInsert
+; CHECK: OpFunctionEnd
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%fn = OpTypeFunction %void
+%float = OpTypeFloat 32
+%v2float = OpTypeVector %float 2
+%ptr_in = OpTypePointer Input %v2float
+%ptr_out = OpTypePointer Output %float
+%in = OpVariable %ptr_in Input
+%out = OpVariable %ptr_out Output
+%float_1 = OpConstant %float 1
+%main = OpFunction %void None %fn
+%1 = OpLabel
+%2 = OpLoad %v2float %in
+%3 = OpCompositeInsert %v2float %float_1 %2 1
+%4 = OpCompositeExtract %float %3 0
+OpStore %out %4
+%5 = OpFunctionCall %void %foo
+OpReturn
+OpFunctionEnd
+%foo = OpFunction %void None %fn
+%6 = OpLabel
+%7 = OpLoad %v2float %in
+%8 = OpCompositeInsert %v2float %float_1 %7 0
+%9 = OpCompositeExtract %float %8 1
+OpStore %out %9
+OpReturn
+OpFunctionEnd
+)";
+}
+
 }  // namespace opt
 }  // namespace spvtools
 
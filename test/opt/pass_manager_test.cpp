@@ -14,6 +14,7 @@
 
 #include <initializer_list>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,7 +29,9 @@ namespace opt {
 namespace {
 
 using spvtest::GetIdBound;
+using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 
 // A null pass whose construtors accept arguments
 class NullPassWithArgs : public NullPass {
@@ -186,6 +189,381 @@ TEST(PassManager, RecomputeIdBoundAutomatically) {
   EXPECT_THAT(GetIdBound(*context.module()), Eq(201u));
 }
 
+// A pass that counts its runs, and prints the count as its statistics.
+class CountRunsPass : public Pass {
+ public:
+  const char* name() const override { return "count-runs"; }
+  Status Process() override {
+    ++runs_;
+    return Status::SuccessWithoutChange;
+  }
+  void PrintStatistics(std::ostream& out) const override {
+    out << name() << ": " << runs_ << " runs" << std::endl;
+  }
+
+ private:
+  int runs_ = 0;
+};
+
+TEST(PassManager, TimeReportHasPassStatistics) {
+  PassManager manager;
+  std::ostringstream report;
+  manager.AddPass<CountRunsPass>();
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, MakeUnique<Module>(),
+                    manager.consumer());
+
+  // Nothing is printed without a time report.
+  manager.Run(&context);
+  EXPECT_EQ("", report.str());
+
+  manager.SetTimeReport(&report);
+  manager.AddPass<CountRunsPass>();
+  manager.Run(&context);
+  EXPECT_THAT(report.str(), HasSubstr("count-runs: 1 runs\n"));
+}
+
+// A pass that takes two new ids, and changes nothing else.
+class TakeTwoIdsPass : public Pass {
+ public:
+  const char* name() const override { return "TakeTwoIds"; }
+  Status Process() override {
+    context()->TakeNextId();
+    context()->TakeNextId();
+    return Status::SuccessWithChange;
+  }
+};
+
+// A pass that rebuilds the def-use manager, and changes nothing.
+class RebuildDefUsePass : public Pass {
+ public:
+  const char* name() const override { return "RebuildDefUse"; }
+  Status Process() override {
+    context()->InvalidateAnalyses(IRContext::kAnalysisDefUse);
+    context()->get_def_use_mgr();
+    return Status::SuccessWithoutChange;
+  }
+};
+
+TEST(PassManager, ProfileRecordsEachPass) {
+  PassManager manager;
+  std::unique_ptr<Module> module(new Module());
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                    manager.consumer());
+  context.module()->SetIdBound(10);
+  PassProfile profile;
+  manager.SetPassProfile(&profile);
+  manager.AddPass<AppendOpNopPass>();
+  manager.AddPass<TakeTwoIdsPass>();
+  manager.AddPass<RebuildDefUsePass>();
+  manager.Run(&context);
+
+  const auto& entries = profile.entries();
+  ASSERT_EQ(3u, entries.size());
+
+  EXPECT_EQ("AppendOpNop", entries[0].pass_name);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, entries[0].status);
+  EXPECT_EQ(0u, entries[0].instructions_before);
+  EXPECT_EQ(1u, entries[0].instructions_after);
+  EXPECT_TRUE(entries[0].analysis_builds.empty());
+
+  EXPECT_EQ(1u, entries[1].instructions_before);
+  EXPECT_EQ(1u, entries[1].instructions_after);
+  EXPECT_EQ(10u, entries[1].id_bound_before);
+  EXPECT_EQ(12u, entries[1].id_bound_after);
+
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, entries[2].status);
+  ASSERT_EQ(1u, entries[2].analysis_builds.size());
+  EXPECT_EQ(IRContext::kAnalysisDefUse, entries[2].analysis_builds[0].analysis);
+
+  std::ostringstream json;
+  profile.WriteJson(&json);
+  EXPECT_THAT(json.str(),
+              HasSubstr("{\"name\": \"RebuildDefUse\", \"status\": "
+                        "\"unchanged\""));
+  EXPECT_THAT(json.str(), HasSubstr("{\"name\": \"def-use\", \"builds\": 1"));
+
+  std::ostringstream trace;
+  profile.WriteChromeTrace(&trace);
+  EXPECT_THAT(trace.str(), HasSubstr("\"cat\": \"analysis\""));
+}
+
+// Adds an empty function with the result id |id| to |module|.
+void AddEmptyFunction(IRContext* context, uint32_t id) {
+  std::unique_ptr<Function> function(new Function(MakeUnique<Instruction>(
+      context, SpvOpFunction, 0, id, std::vector<Operand>{})));
+  std::unique_ptr<BasicBlock> block(new BasicBlock(MakeUnique<Instruction>(
+      context, SpvOpLabel, 0, id + 1, std::vector<Operand>{})));
+  block->AddInstruction(MakeUnique<Instruction>(context, SpvOpReturn));
+  function->AddBasicBlock(std::move(block));
+  function->SetFunctionEnd(MakeUnique<Instruction>(context, SpvOpFunctionEnd));
+  context->module()->AddFunction(std::move(function));
+}
+
+// Returns the number of OpNop instructions in the function |id|.
+uint32_t CountNops(IRContext* context, uint32_t id) {
+  uint32_t count = 0;
+  for (Function& function : *context->module()) {
+    if (function.result_id() != id) continue;
+    function.ForEachInst([&count](Instruction* inst) {
+      if (inst->opcode() == SpvOpNop) ++count;
+    });
+  }
+  return count;
+}
+
+// A pass that adds an OpNop to the function with the result id 1 if it has
+// fewer than four of them, and their number is even or odd, as given.  Each
+// pass records its name in |runs| when it runs.
+class AddNopPass : public Pass {
+ public:
+  AddNopPass(bool if_even, std::vector<std::string>* runs)
+      : if_even_(if_even), runs_(runs) {}
+
+  const char* name() const override {
+    return if_even_ ? "add-nop-if-even" : "add-nop-if-odd";
+  }
+  Status Process() override {
+    runs_->push_back(name());
+    const uint32_t nops = CountNops(context(), 1);
+    if (nops >= 4 || (nops % 2 == 0) != if_even_) {
+      return Status::SuccessWithoutChange;
+    }
+    for (Function& function : *get_module()) {
+      if (function.result_id() != 1) continue;
+      function.begin()->begin().InsertBefore(
+          MakeUnique<Instruction>(context(), SpvOpNop));
+    }
+    return Status::SuccessWithChange;
+  }
+
+ private:
+  bool if_even_;
+  std::vector<std::string>* runs_;
+};
+
+// A function local pass that records the functions it processes, and
+// changes nothing.
+class RecordFunctionsPass : public Pass {
+ public:
+  explicit RecordFunctionsPass(std::vector<uint32_t>* processed)
+      : processed_(processed) {}
+
+  const char* name() const override { return "record-functions"; }
+  bool IsFunctionLocal() const override { return true; }
+  Status Process() override {
+    for (Function& function : *get_module()) {
+      if (context()->ShouldProcessFunction(function)) {
+        processed_->push_back(function.result_id());
+      }
+    }
+    return Status::SuccessWithoutChange;
+  }
+
+ private:
+  std::vector<uint32_t>* processed_;
+};
+
+TEST(PassManager, FixedPointRunsPassesUntilNothingChanges) {
+  for (uint32_t max_rounds : {0u, 1u, 10u}) {
+    PassManager manager;
+    std::unique_ptr<Module> module(new Module());
+    IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                      manager.consumer());
+    AddEmptyFunction(&context, 1);
+    AddEmptyFunction(&context, 3);
+
+    std::vector<std::string> runs;
+    std::vector<uint32_t> processed;
+    manager.AddPass<RecordFunctionsPass>(&processed);
+    manager.AddPass<AddNopPass>(true, &runs);
+    manager.AddPass<AddNopPass>(false, &runs);
+    manager.AddPass<RecordFunctionsPass>(&processed);
+    manager.SetFixedPoint(
+        max_rounds, {"record", "even", "odd", "record"}, [&runs, &processed]() {
+          std::vector<std::unique_ptr<Pass>> passes;
+          passes.push_back(MakeUnique<RecordFunctionsPass>(&processed));
+          passes.push_back(MakeUnique<AddNopPass>(true, &runs));
+          passes.push_back(MakeUnique<AddNopPass>(false, &runs));
+          passes.push_back(MakeUnique<RecordFunctionsPass>(&processed));
+          return passes;
+        });
+    EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(&context));
+
+    if (max_rounds == 0) {
+      // Every pass runs once, on every function.
+      EXPECT_EQ(2u, CountNops(&context, 1));
+      EXPECT_THAT(processed, ElementsAre(1, 3, 1, 3));
+    } else if (max_rounds == 1) {
+      // The second time it runs, the function local pass only processes the
+      // function that changed.
+      EXPECT_EQ(2u, CountNops(&context, 1));
+      EXPECT_THAT(processed, ElementsAre(1, 3, 1));
+    } else {
+      // A pass is skipped if nothing changed since it last ran, and the
+      // third round, which changes nothing, is the last one.
+      EXPECT_EQ(4u, CountNops(&context, 1));
+      EXPECT_THAT(processed, ElementsAre(1, 3, 1, 1));
+      EXPECT_THAT(runs,
+                  ElementsAre("add-nop-if-even", "add-nop-if-odd",
+                              "add-nop-if-even", "add-nop-if-odd",
+                              "add-nop-if-even"));
+    }
+  }
+}
+
+TEST(PassManager, FixedPointSkipsRepeatedPassInFirstRound) {
+  PassManager manager;
+  std::unique_ptr<Module> module(new Module());
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                    manager.consumer());
+  AddEmptyFunction(&context, 1);
+  AddEmptyFunction(&context, 3);
+
+  // The second pass has the same key as the first, and nothing changed since
+  // the first one ran.
+  std::vector<uint32_t> processed;
+  manager.AddPass<RecordFunctionsPass>(&processed);
+  manager.AddPass<RecordFunctionsPass>(&processed);
+  manager.SetFixedPoint(1, {"record", "record"}, nullptr);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, manager.Run(&context));
+  EXPECT_THAT(processed, ElementsAre(1, 3));
+}
+
+TEST(PassManager, FixedPointTellsPassesApartByKey) {
+  PassManager manager;
+  std::unique_ptr<Module> module(new Module());
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                    manager.consumer());
+  AddEmptyFunction(&context, 1);
+  AddEmptyFunction(&context, 3);
+
+  // The two record passes have the same name but different keys, as passes
+  // with different arguments do.  The second one has not run when the
+  // schedule reaches it, so it processes every function.
+  std::vector<std::string> runs;
+  std::vector<uint32_t> first;
+  std::vector<uint32_t> second;
+  manager.AddPass<RecordFunctionsPass>(&first);
+  manager.AddPass<AddNopPass>(true, &runs);
+  manager.AddPass<RecordFunctionsPass>(&second);
+  manager.SetFixedPoint(
+      10, {"record=first", "even", "record=second"},
+      [&runs, &first, &second]() {
+        std::vector<std::unique_ptr<Pass>> passes;
+        passes.push_back(MakeUnique<RecordFunctionsPass>(&first));
+        passes.push_back(MakeUnique<AddNopPass>(true, &runs));
+        passes.push_back(MakeUnique<RecordFunctionsPass>(&second));
+        return passes;
+      });
+  EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(&context));
+
+  // In the second round, only the first pass has a change to process.
+  EXPECT_EQ(1u, CountNops(&context, 1));
+  EXPECT_THAT(first, ElementsAre(1, 3, 1));
+  EXPECT_THAT(second, ElementsAre(1, 3));
+  EXPECT_THAT(runs, ElementsAre("add-nop-if-even"));
+}
+
+TEST(PassManager, ValidateAfterAllReportsValidatorMessages) {
+  // The module has no OpCapability, so it fails validation after the pass.
+  struct Message {
+    spv_message_level_t level;
+    std::string source;
+    std::string text;
+  };
+  std::vector<Message> messages;
+  PassManager manager;
+  manager.SetMessageConsumer(
+      [&messages](spv_message_level_t level, const char* source,
+                  const spv_position_t&, const char* message) {
+        messages.push_back({level, source ? source : "", message});
+      });
+  ValidatorOptions validator_options;
+  manager.SetValidatorOptions(validator_options);
+  manager.SetValidateAfterAll(true);
+  manager.AddPass<AppendOpNopPass>();
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, manager.consumer(),
+                  "OpMemoryModel Logical GLSL450\n");
+  ASSERT_NE(nullptr, context);
+  EXPECT_EQ(Pass::Status::Failure, manager.Run(context.get()));
+
+  // The validator reports to the consumer itself, before the pass manager
+  // reports which pass the module failed validation after.
+  ASSERT_GE(messages.size(), 2u);
+  EXPECT_EQ(SPV_MSG_ERROR, messages.front().level);
+  EXPECT_EQ("input", messages.front().source);
+  EXPECT_EQ(SPV_MSG_INTERNAL_ERROR, messages.back().level);
+  EXPECT_THAT(messages.back().text,
+              HasSubstr("Validation failed after pass AppendOpNop"));
+}
+
+// A pass that removes the instruction with the result id |id|.
+class KillInstPass : public Pass {
+ public:
+  explicit KillInstPass(uint32_t id) : id_(id) {}
+
+  const char* name() const override { return "kill-inst"; }
+  Status Process() override {
+    Instruction* inst = get_def_use_mgr()->GetDef(id_);
+    if (inst == nullptr) return Status::SuccessWithoutChange;
+    context()->KillInst(inst);
+    return Status::SuccessWithChange;
+  }
+
+ private:
+  uint32_t id_;
+};
+
+TEST(PassManager, ValidateAfterAllOnlyChecksChangedFunctions) {
+  PassManager manager;
+  ValidatorOptions validator_options;
+  manager.SetValidatorOptions(validator_options);
+  manager.SetValidateAfterAll(true);
+  std::ostringstream report;
+  manager.SetTimeReport(&report);
+  manager.AddPass<KillInstPass>(12);
+  manager.AddPass<KillInstPass>(22);
+  manager.AddPass<KillInstPass>(22);
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, manager.consumer(), R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%1 = OpTypeVoid
+%2 = OpTypeFunction %1
+%3 = OpTypeInt 32 0
+%4 = OpConstant %3 1
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpIAdd %3 %4 %4
+OpReturn
+OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpIAdd %3 %4 %4
+OpReturn
+OpFunctionEnd
+)");
+  ASSERT_NE(nullptr, context);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(context.get()));
+
+  // The first validation checks everything.  After the second pass, only the
+  // function it changed is checked again, and after the third, which changes
+  // nothing, no function is.
+  EXPECT_THAT(report.str(),
+              HasSubstr("Validation after kill-inst: 0 of 2 functions "
+                        "unchanged\n"));
+  EXPECT_THAT(report.str(),
+              HasSubstr("Validation after kill-inst: 1 of 2 functions "
+                        "unchanged\n"));
+  EXPECT_THAT(report.str(),
+              HasSubstr("Validation after kill-inst: 2 of 2 functions "
+                        "unchanged\n"));
+}
+
 }  // anonymous namespace
 }  // namespace opt
 }  // namespace spvtools
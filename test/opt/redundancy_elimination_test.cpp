@@ -272,6 +272,252 @@ TEST_F(RedundancyEliminationTest, KeepRedundantAddWithoutPhi) {
   EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
 }
 
+// Compute the partially redundant add in the predecessor where it is missing,
+// and replace it by a phi.
+TEST_F(RedundancyEliminationTest, RemovePartiallyRedundantAdd) {
+  const std::string text = R"(
+; CHECK: [[load:%\w+]] = OpLoad
+; CHECK: OpBranchConditional
+; CHECK: [[bb1:%\w+]] = OpLabel
+; CHECK-NEXT: [[add1:%\w+]] = OpFAdd {{%\w+}} [[load]] [[load]]
+; CHECK-NEXT: OpBranch [[merge:%\w+]]
+; CHECK: [[bb2:%\w+]] = OpLabel
+; CHECK-NEXT: [[add2:%\w+]] = OpFAdd {{%\w+}} [[load]] [[load]]
+; CHECK-NEXT: OpBranch [[merge]]
+; CHECK: [[merge]] = OpLabel
+; CHECK-NEXT: [[phi:%\w+]] = OpPhi {{%\w+}} [[add1]] [[bb1]] [[add2]] [[bb2]]
+; CHECK-NOT: OpFAdd
+; CHECK: OpFMul {{%\w+}} [[phi]] [[phi]]
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %10 = OpVariable %6 Function
+         %11 = OpLoad %5 %10
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %14
+         %13 = OpLabel
+        %add = OpFAdd %5 %11 %11
+               OpBranch %15
+         %14 = OpLabel
+               OpBranch %15
+         %15 = OpLabel
+         %16 = OpFAdd %5 %11 %11
+         %17 = OpFMul %5 %16 %16
+               OpReturn
+               OpFunctionEnd
+  )";
+  SinglePassRunAndMatch<RedundancyEliminationPass>(text, false, true);
+}
+
+// Replace an add that is computed before a diamond by that add, instead of by
+// a phi of it from both sides of the diamond.
+TEST_F(RedundancyEliminationTest, RemoveFullyRedundantAddAfterDiamond) {
+  const std::string text = R"(
+; CHECK: [[load:%\w+]] = OpLoad
+; CHECK-NEXT: [[add:%\w+]] = OpFAdd {{%\w+}} [[load]] [[load]]
+; CHECK-NOT: OpFAdd
+; CHECK-NOT: OpPhi
+; CHECK: OpFMul {{%\w+}} [[add]] [[add]]
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %10 = OpVariable %6 Function
+         %11 = OpLoad %5 %10
+        %add = OpFAdd %5 %11 %11
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %14
+         %13 = OpLabel
+               OpBranch %15
+         %14 = OpLabel
+               OpBranch %15
+         %15 = OpLabel
+         %16 = OpFAdd %5 %11 %11
+         %17 = OpFMul %5 %16 %16
+               OpReturn
+               OpFunctionEnd
+  )";
+  SinglePassRunAndMatch<RedundancyEliminationPass>(text, false, true);
+}
+
+// Keep the partially redundant add when computing it in a predecessor would
+// need a critical edge to be split.
+TEST_F(RedundancyEliminationTest, KeepPartiallyRedundantAddOnCriticalEdge) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %10 = OpVariable %6 Function
+         %11 = OpLoad %5 %10
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %15
+         %13 = OpLabel
+        %add = OpFAdd %5 %11 %11
+               OpBranch %15
+         %15 = OpLabel
+         %16 = OpFAdd %5 %11 %11
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto result = SinglePassRunAndDisassemble<RedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+
+// Keep a partially redundant access chain, since it would need a phi of
+// pointers.
+TEST_F(RedundancyEliminationTest, KeepPartiallyRedundantAccessChain) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+         %20 = OpTypeInt 32 0
+         %21 = OpConstant %20 0
+         %22 = OpTypeVector %5 4
+         %23 = OpTypePointer Function %22
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %10 = OpVariable %23 Function
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %14
+         %13 = OpLabel
+        %ac1 = OpAccessChain %6 %10 %21
+               OpBranch %15
+         %14 = OpLabel
+               OpBranch %15
+         %15 = OpLabel
+        %ac2 = OpAccessChain %6 %10 %21
+       %load = OpLoad %5 %ac2
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto result = SinglePassRunAndDisassemble<RedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+// Keep a partially redundant derivative, since its value depends on the
+// invocations that compute it.
+TEST_F(RedundancyEliminationTest, KeepPartiallyRedundantDerivative) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %10 = OpVariable %6 Function
+         %11 = OpLoad %5 %10
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %14
+         %13 = OpLabel
+         %d1 = OpDPdx %5 %11
+               OpBranch %15
+         %14 = OpLabel
+               OpBranch %15
+         %15 = OpLabel
+         %d2 = OpDPdx %5 %11
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto result = SinglePassRunAndDisassemble<RedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+// Keep a partially redundant sample with an implicit level of detail, since
+// the level of detail is computed from derivatives.
+TEST_F(RedundancyEliminationTest, KeepPartiallyRedundantImplicitLodSample) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %2 "main"
+               OpExecutionMode %2 OriginUpperLeft
+               OpSource GLSL 430
+          %3 = OpTypeVoid
+          %4 = OpTypeFunction %3
+          %5 = OpTypeFloat 32
+          %6 = OpTypePointer Function %5
+          %7 = OpTypeBool
+          %8 = OpConstantTrue %7
+         %20 = OpTypeImage %5 2D 0 0 0 1 Unknown
+         %21 = OpTypeSampledImage %20
+         %22 = OpTypePointer UniformConstant %21
+         %23 = OpTypeVector %5 2
+         %24 = OpTypeVector %5 4
+         %25 = OpConstantNull %23
+         %26 = OpVariable %22 UniformConstant
+          %2 = OpFunction %3 None %4
+          %9 = OpLabel
+         %11 = OpLoad %21 %26
+               OpSelectionMerge %15 None
+               OpBranchConditional %8 %13 %14
+         %13 = OpLabel
+         %s1 = OpImageSampleImplicitLod %24 %11 %25
+               OpBranch %15
+         %14 = OpLabel
+               OpBranch %15
+         %15 = OpLabel
+         %s2 = OpImageSampleImplicitLod %24 %11 %25
+               OpReturn
+               OpFunctionEnd
+  )";
+  auto result = SinglePassRunAndDisassemble<RedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false, true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -960,6 +960,51 @@ OpMemoryModel Logical GLSL450
   EXPECT_EQ(nullptr, context->get_type_mgr()->GetType(id));
 }
 
+TEST(TypeManager, RegisteredTypesAreUnique) {
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+)";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  EXPECT_NE(context, nullptr);
+  TypeManager* type_mgr = context->get_type_mgr();
+
+  Integer u32(32, false);
+  Vector v4(&u32, 4);
+  Struct st({&v4, &u32});
+  st.AddDecoration({SpvDecorationBlock});
+  type_mgr->RegisterType(1u, v4);
+  type_mgr->RegisterType(2u, st);
+
+  // An equivalent type built from different objects maps to the same
+  // registered type.
+  Integer other_u32(32, false);
+  Vector other_v4(&other_u32, 4);
+  type_mgr->RegisterType(3u, other_v4);
+  Type* registered_v4 = type_mgr->GetType(1u);
+  EXPECT_EQ(registered_v4, type_mgr->GetType(3u));
+  EXPECT_EQ(registered_v4,
+            type_mgr->GetType(2u)->AsStruct()->element_types()[0]);
+
+  // Registered types are compared by pointer, and other types by structure.
+  EXPECT_FALSE(registered_v4->IsSame(type_mgr->GetType(2u)));
+  EXPECT_TRUE(registered_v4->IsSame(&other_v4));
+  EXPECT_TRUE(other_v4.IsSame(registered_v4));
+
+  // A copy of a registered type is not registered.
+  std::unique_ptr<Type> clone = type_mgr->GetType(2u)->Clone();
+  EXPECT_TRUE(clone->IsSame(type_mgr->GetType(2u)));
+  EXPECT_EQ(clone->HashValue(), type_mgr->GetType(2u)->HashValue());
+  std::unique_ptr<Type> undecorated = clone->RemoveDecorations();
+  EXPECT_FALSE(undecorated->IsSame(type_mgr->GetType(2u)));
+  type_mgr->RegisterType(4u, *undecorated);
+  EXPECT_NE(type_mgr->GetType(2u), type_mgr->GetType(4u));
+  EXPECT_FALSE(type_mgr->GetType(4u)->IsSame(type_mgr->GetType(2u)));
+}
+
 TEST(TypeManager, GetTypeInstructionInt) {
   const std::string text = R"(
 ; CHECK: OpTypeInt 32 0
@@ -383,6 +383,24 @@ TEST(Types, RemoveDecorations) {
   }
 }
 
+TEST(Types, HashValueIgnoresDecorationOrder) {
+  Integer u32(32, false);
+  Struct a({&u32, &u32});
+  a.AddDecoration({10});
+  a.AddDecoration({11});
+  a.AddMemberDecoration(1, {{35, 4}});
+  a.AddMemberDecoration(1, {{36, 5}});
+
+  Struct b({&u32, &u32});
+  b.AddDecoration({11});
+  b.AddDecoration({10});
+  b.AddMemberDecoration(1, {{36, 5}});
+  b.AddMemberDecoration(1, {{35, 4}});
+
+  EXPECT_TRUE(a.IsSame(&b));
+  EXPECT_EQ(a.HashValue(), b.HashValue());
+}
+
 }  // namespace
 }  // namespace analysis
 }  // namespace opt
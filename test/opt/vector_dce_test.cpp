@@ -1351,6 +1351,13 @@ OpFunctionEnd
   SinglePassRunAndMatch<VectorDCE>(text, true);
 }
 
+TEST_F(VectorDCETest, ParallelFunctions) {
+  // Each function has its own dead insert.  The live components are found for
+  // the functions on separate threads, and both inserts must still be removed.
+  SinglePassRunAndMatchInParallel<VectorDCE>(
+      ModuleWithDeadInsertInEachFunction(), true, 2);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -14,7 +14,9 @@
 
 import placeholder
 import expect
+import os
 import re
+import subprocess
 
 from spirv_test_framework import inside_spirv_testsuite
 
@@ -66,7 +68,8 @@ class TestValidPassFlags(expect.ValidObjectFile1_5,
       '--eliminate-local-multi-store', '--eliminate-local-single-block',
       '--eliminate-local-single-store', '--flatten-decorations',
       '--fold-spec-const-op-composite', '--freeze-spec-const',
-      '--if-conversion', '--inline-entry-points-exhaustive', '--loop-fission',
+      '--if-conversion', '--inline-bottom-up', '--inline-bottom-up=50',
+      '--inline-entry-points-exhaustive', '--loop-fission',
       '20', '--loop-fusion', '5', '--loop-unroll', '--loop-unroll-partial', '3',
       '--loop-peeling', '--merge-blocks', '--merge-return', '--loop-unswitch',
       '--private-to-local', '--reduce-load-size', '--redundancy-elimination',
@@ -101,6 +104,8 @@ class TestValidPassFlags(expect.ValidObjectFile1_5,
       'fold-spec-const-op-composite',
       'freeze-spec-const',
       'if-conversion',
+      'inline-bottom-up',
+      'inline-bottom-up',
       'inline-entry-points-exhaustive',
       'loop-fission',
       'loop-fusion',
@@ -299,6 +304,14 @@ class TestScalarReplacementArgsInvalidNumber(expect.ErrorMessageSubstr):
   expected_error_substr = 'must have no arguments or a non-negative integer argument'
 
 
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestInlineBottomUpArgsInvalidNumber(expect.ErrorMessageSubstr):
+  """Tests invalid arguments to --inline-bottom-up."""
+
+  spirv_args = ['--inline-bottom-up=a10f']
+  expected_error_substr = 'must have no arguments or a non-negative integer argument'
+
+
 @inside_spirv_testsuite('SpirvOptFlags')
 class TestLoopFissionArgsNegative(expect.ErrorMessageSubstr):
   """Tests invalid arguments to --loop-fission."""
@@ -403,3 +416,117 @@ class TestWebGPUToVulkanThenTargetEnvIsInvalid(expect.ReturnCodeIsNonZero, expec
 
   spirv_args = ['--webgpu-to-vulkan', '--target-env=opengl4.0']
   expected_error_substr = 'defines the target environment'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestBatchJobsArgsZero(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --batch-jobs requires at least one job."""
+
+  spirv_args = ['--batch=manifest.txt', '--batch-jobs=0']
+  expected_error_substr = 'number of batch jobs must be at least 1'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestBatchWithInputFileIsInvalid(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --batch cannot be used together with an input file."""
+
+  spirv_args = ['--batch=manifest.txt', 'input.spv']
+  expected_error_substr = 'cannot be combined with an input or output file'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestBatchMissingManifest(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that a missing batch manifest is reported."""
+
+  spirv_args = ['--batch=does-not-exist.txt']
+  expected_error_substr = 'Could not open batch manifest'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestProfileFormatInvalid(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --profile-format only accepts json or chrome-trace."""
+
+  spirv_args = ['--profile-format=xml']
+  expected_error_substr = '--profile-format must be json or chrome-trace'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestProfilePassesWithBatchIsInvalid(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --profile-passes cannot be used together with --batch."""
+
+  spirv_args = ['--batch=manifest.txt', '--profile-passes=profile.json']
+  expected_error_substr = '--profile-passes cannot be combined with --batch'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestCacheSizeInvalid(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --cache-size must be at least one megabyte."""
+
+  spirv_args = ['--cache-dir=.', '--cache-size=0']
+  expected_error_substr = 'The cache size must be at least 1 megabyte'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestFixedPointRoundsNegative(expect.ReturnCodeIsNonZero, expect.ErrorMessageSubstr):
+  """Tests that --fixed-point-rounds does not accept a negative number."""
+
+  spirv_args = ['--fixed-point-rounds=-1']
+  expected_error_substr = 'The number of rounds must not be negative'
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestBatchOptimizesEveryModule(expect.ReturnCodeIsZero,
+                                    expect.StderrMatch):
+  """Tests that --batch optimizes every module of the manifest, and that
+  --time-report reports the time of each module and of the whole batch."""
+
+  outputs = ['first.spv', 'second.spv']
+  manifest = placeholder.BatchManifest([
+      (placeholder.FileSPIRVShader(empty_main_assembly(), '.spvasm'),
+       placeholder.TempFileName(output)) for output in outputs
+  ])
+  spirv_args = [manifest, '--strip-debug', '--batch-jobs=2', '--time-report']
+  expected_stderr = re.compile(
+      r'^Module .+:\n.*^Module WALL time: [0-9.]+ s\n'
+      r'^Module .+:\n.*^Module WALL time: [0-9.]+ s\n'
+      r'^Batch of 2 modules on 2 jobs, 0 failed\n'
+      r'  WALL time: [0-9.]+ s\n'
+      r'  Sum of module times: [0-9.]+ s\n'
+      r'  Mean module time: [0-9.]+ s\n'
+      r'  Slowest module: .+ \([0-9.]+ s\)\n', re.MULTILINE | re.DOTALL)
+
+  def check_every_module_is_optimized(self, status):
+    for output in self.outputs:
+      filename = os.path.join(status.directory, output)
+      if not os.path.isfile(filename):
+        return False, 'Cannot find file: ' + filename
+      process = subprocess.Popen(
+          args=[status.test_manager.disassembler_path, '--no-color', filename],
+          stdout=subprocess.PIPE,
+          stderr=subprocess.PIPE,
+          universal_newlines=True,
+          cwd=status.directory)
+      disassembly = process.communicate()[0]
+      if 'OpName' in disassembly:
+        return False, ('Debug instructions were not stripped from ' +
+                       output + ':\n' + disassembly)
+    return True, ''
+
+
+@inside_spirv_testsuite('SpirvOptFlags')
+class TestValidateAfterAllSkipsUnchangedFunctions(expect.ValidObjectFile1_5,
+                                                  expect.StderrMatch):
+  """Tests that --validate-after-all only checks again the functions that a
+  pass changed."""
+
+  shader = placeholder.FileSPIRVShader(empty_main_assembly(), '.spvasm')
+  output = placeholder.TempFileName('output.spv')
+  spirv_args = [
+      shader, '-o', output, '--validate-after-all', '--time-report',
+      '--strip-debug', '--strip-debug'
+  ]
+  expected_object_filenames = (output)
+  expected_stderr = re.compile(
+      r'^Validation after strip-debug: 0 of 1 functions unchanged\n'
+      r'.*^Validation after strip-debug: 1 of 1 functions unchanged\n',
+      re.MULTILINE | re.DOTALL)
@@ -116,6 +116,39 @@ class ConfigFlagsFile(PlaceHolder):
     return self.filename
 
 
+class BatchManifest(PlaceHolder):
+  """Stands for a spirv-opt batch manifest listing modules to optimize."""
+
+  def __init__(self, entries):
+    # Each entry is a pair of placeholders, for the input module and the
+    # file the optimized module is written to.
+    assert isinstance(entries, list)
+    self.entries = entries
+    self.filename = None
+
+  def instantiate_for_spirv_args(self, testcase):
+    """Instantiates the entries and writes them into a temporary file.
+
+        Returns:
+            The --batch flag naming the temporary file.
+    """
+    lines = [
+        '%s %s\n' % (an_input.instantiate_for_spirv_args(testcase),
+                     output.instantiate_for_spirv_args(testcase))
+        for an_input, output in self.entries
+    ]
+    temp_fd, self.filename = tempfile.mkstemp(
+        dir=testcase.directory, suffix='.txt')
+    fd = os.fdopen(temp_fd, 'w')
+    fd.write(''.join(lines))
+    fd.close()
+    return '--batch=%s' % self.filename
+
+  def instantiate_for_expectation(self, testcase):
+    assert self.filename is not None
+    return self.filename
+
+
 class FileSPIRVShader(PlaceHolder):
   """Stands for a source shader file which must be converted to SPIR-V."""
 
@@ -0,0 +1,166 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "source/util/arena.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using ArenaTest = ::testing::Test;
+
+TEST(ArenaTest, AllocationsAreAlignedAndDistinct) {
+  Arena arena(256);
+  std::vector<char*> blocks;
+  for (size_t size = 1; size < 100; size += 7) {
+    char* block = static_cast<char*>(arena.Allocate(size));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) %
+                      alignof(std::max_align_t));
+    for (char* other : blocks) {
+      EXPECT_NE(block, other);
+    }
+    blocks.push_back(block);
+  }
+  EXPECT_EQ(blocks.size(), arena.num_allocations());
+  EXPECT_GT(arena.bytes_reserved(), 256u);
+}
+
+TEST(ArenaTest, FreedBlocksAreReused) {
+  Arena arena;
+  void* first = arena.Allocate(40);
+  EXPECT_EQ(48u, arena.bytes_in_use());
+  arena.Deallocate(first, 40);
+  EXPECT_EQ(0u, arena.bytes_in_use());
+
+  // A block of a different size does not reuse the freed block, one of the
+  // same size does.
+  void* second = arena.Allocate(100);
+  EXPECT_NE(first, second);
+  void* third = arena.Allocate(40);
+  EXPECT_EQ(first, third);
+  EXPECT_EQ(160u, arena.bytes_in_use());
+  EXPECT_EQ(160u, arena.peak_bytes_in_use());
+}
+
+TEST(ArenaTest, LargeAllocationGetsItsOwnSlab) {
+  Arena arena(128);
+  void* small = arena.Allocate(16);
+  void* large = arena.Allocate(1000);
+  void* next = arena.Allocate(16);
+  EXPECT_NE(small, large);
+  // The small blocks still come from the first slab.
+  EXPECT_EQ(static_cast<char*>(small) + 16, static_cast<char*>(next));
+  EXPECT_EQ(128u + 1008u, arena.bytes_reserved());
+}
+
+TEST(ArenaTest, LargeFreedBlocksAreReused) {
+  Arena arena(4096);
+  void* first = arena.Allocate(2000);
+  arena.Deallocate(first, 2000);
+  EXPECT_EQ(first, arena.Allocate(2000));
+  EXPECT_EQ(2000u, arena.bytes_in_use());
+}
+
+TEST(ArenaTest, SwitchingArenasKeepsFreeLists) {
+  Arena first_arena;
+  Arena second_arena;
+  void* first = first_arena.Allocate(32);
+  void* second = second_arena.Allocate(32);
+  first_arena.Deallocate(first, 32);
+  second_arena.Deallocate(second, 32);
+  EXPECT_EQ(first, first_arena.Allocate(32));
+  EXPECT_EQ(second, second_arena.Allocate(32));
+  EXPECT_EQ(first_arena.bytes_reserved(), Arena::kDefaultSlabSize);
+  EXPECT_EQ(second_arena.bytes_reserved(), Arena::kDefaultSlabSize);
+}
+
+TEST(ArenaTest, ThreadsAllocateFromTheirOwnSlabs) {
+  Arena arena(1024);
+  const int kNumThreads = 4;
+  const int kNumBlocks = 1000;
+  std::vector<std::vector<void*>> blocks(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&arena, &blocks, t]() {
+      for (int i = 0; i < kNumBlocks; ++i) {
+        blocks[t].push_back(arena.Allocate(24));
+      }
+      // Free half of them, and reuse them.
+      for (int i = 0; i < kNumBlocks / 2; ++i) {
+        arena.Deallocate(blocks[t][i], 24);
+      }
+      for (int i = 0; i < kNumBlocks / 2; ++i) {
+        blocks[t][i] = arena.Allocate(24);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  std::vector<void*> all;
+  for (const auto& b : blocks) {
+    all.insert(all.end(), b.begin(), b.end());
+  }
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(all.end(), std::adjacent_find(all.begin(), all.end()));
+  EXPECT_EQ(size_t(kNumThreads * kNumBlocks * 3 / 2), arena.num_allocations());
+  EXPECT_EQ(size_t(kNumThreads * kNumBlocks * 32), arena.bytes_in_use());
+
+  // Blocks may be freed by another thread than the one that allocated them.
+  for (void* block : all) {
+    arena.Deallocate(block, 24);
+  }
+  EXPECT_EQ(0u, arena.bytes_in_use());
+}
+
+// A class that counts how many of its objects are alive.
+class Counted : public ArenaAllocatable<Counted> {
+ public:
+  Counted() { ++live_; }
+  ~Counted() { --live_; }
+
+  static int live_;
+
+ private:
+  uint64_t payload_[3];
+};
+
+int Counted::live_ = 0;
+
+TEST(ArenaTest, ArenaAllocatableObjects) {
+  Arena arena;
+  {
+    std::unique_ptr<Counted> on_heap(new Counted());
+    std::unique_ptr<Counted> in_arena(new (&arena) Counted());
+    std::unique_ptr<Counted> null_arena(new (nullptr) Counted());
+    EXPECT_EQ(3, Counted::live_);
+    EXPECT_EQ(1u, arena.num_allocations());
+    EXPECT_NE(0u, arena.bytes_in_use());
+  }
+  EXPECT_EQ(0, Counted::live_);
+  EXPECT_EQ(0u, arena.bytes_in_use());
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
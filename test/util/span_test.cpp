@@ -0,0 +1,66 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/util/span.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(SpanTest, Empty) {
+  Span<const uint32_t> span;
+
+  EXPECT_TRUE(span.empty());
+  EXPECT_EQ(0u, span.size());
+  EXPECT_EQ(span.begin(), span.end());
+}
+
+TEST(SpanTest, ViewsElements) {
+  std::vector<uint32_t> vec = {1, 2, 3, 4};
+  Span<uint32_t> span(vec.data() + 1, 2);
+
+  EXPECT_FALSE(span.empty());
+  EXPECT_EQ(2u, span.size());
+  EXPECT_EQ(2u, span.front());
+  EXPECT_EQ(3u, span.back());
+  EXPECT_THAT(std::vector<uint32_t>(span.begin(), span.end()),
+              ElementsAre(2, 3));
+
+  // The elements are not copied.
+  span[0] = 5;
+  EXPECT_THAT(vec, ElementsAre(1, 5, 3, 4));
+}
+
+TEST(SpanTest, ComparesElements) {
+  const std::vector<uint32_t> a = {1, 2, 1, 2};
+  const std::vector<uint32_t> b = {1, 2, 3};
+
+  EXPECT_EQ(Span<const uint32_t>(a.data(), 2),
+            Span<const uint32_t>(a.data() + 2, 2));
+  EXPECT_EQ(Span<const uint32_t>(a.data(), 2),
+            Span<const uint32_t>(b.data(), 2));
+  EXPECT_NE(Span<const uint32_t>(a.data(), 3),
+            Span<const uint32_t>(b.data(), 3));
+  EXPECT_NE(Span<const uint32_t>(a.data(), 2),
+            Span<const uint32_t>(b.data(), 3));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
@@ -0,0 +1,109 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <set>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+#include "source/util/sparse_bit_vector.h"
+
+namespace spvtools {
+namespace utils {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<uint32_t> Elements(const SparseBitVector& bvec) {
+  std::vector<uint32_t> result;
+  bvec.ForEach([&result](uint32_t i) { result.push_back(i); });
+  return result;
+}
+
+TEST(SparseBitVectorTest, Initialize) {
+  SparseBitVector bvec;
+  EXPECT_TRUE(bvec.Empty());
+  for (uint32_t i = 1; i < 10000; i *= 2) {
+    EXPECT_FALSE(bvec.Get(i));
+  }
+  EXPECT_FALSE(bvec.Get(0xFFFFFFFF));
+}
+
+TEST(SparseBitVectorTest, SetAndClear) {
+  SparseBitVector bvec;
+  EXPECT_FALSE(bvec.Set(100000));
+  EXPECT_FALSE(bvec.Set(3));
+  EXPECT_FALSE(bvec.Set(64));
+  EXPECT_FALSE(bvec.Set(0xFFFFFFFF));
+  EXPECT_TRUE(bvec.Set(3));
+  EXPECT_EQ(4u, bvec.Count());
+  EXPECT_THAT(Elements(bvec), ElementsAre(3, 64, 100000, 0xFFFFFFFF));
+
+  EXPECT_TRUE(bvec.Get(64));
+  EXPECT_FALSE(bvec.Get(65));
+  EXPECT_TRUE(bvec.Clear(64));
+  EXPECT_FALSE(bvec.Clear(64));
+  EXPECT_FALSE(bvec.Clear(7));
+  EXPECT_FALSE(bvec.Get(64));
+  EXPECT_THAT(Elements(bvec), ElementsAre(3, 100000, 0xFFFFFFFF));
+
+  bvec.ClearAll();
+  EXPECT_TRUE(bvec.Empty());
+  EXPECT_EQ(0u, bvec.Count());
+}
+
+TEST(SparseBitVectorTest, Or) {
+  SparseBitVector a;
+  SparseBitVector b;
+  a.Set(1);
+  a.Set(200);
+  b.Set(1);
+  EXPECT_FALSE(a.Or(b));
+  b.Set(130);
+  b.Set(5000);
+  EXPECT_TRUE(a.Or(b));
+  EXPECT_THAT(Elements(a), ElementsAre(1, 130, 200, 5000));
+  EXPECT_FALSE(a.Or(b));
+  EXPECT_FALSE(a.Or(SparseBitVector()));
+
+  SparseBitVector c;
+  EXPECT_TRUE(c.Or(a));
+  EXPECT_EQ(a, c);
+  c.Clear(130);
+  EXPECT_NE(a, c);
+}
+
+TEST(SparseBitVectorTest, MatchesSet) {
+  // Mixes operations on clustered and scattered bits, and checks them against
+  // std::set.
+  SparseBitVector bvec;
+  std::set<uint32_t> expected;
+  uint32_t x = 12345;
+  for (int step = 0; step < 5000; ++step) {
+    x = x * 1103515245u + 12345u;
+    const uint32_t i = (x >> 8) % (step % 2 ? 300 : 100000);
+    if ((x & 3) == 0) {
+      EXPECT_EQ(expected.erase(i) != 0, bvec.Clear(i));
+    } else {
+      EXPECT_EQ(!expected.insert(i).second, bvec.Set(i));
+    }
+  }
+  EXPECT_EQ(expected.size(), bvec.Count());
+  EXPECT_EQ(std::vector<uint32_t>(expected.begin(), expected.end()),
+            Elements(bvec));
+}
+
+}  // namespace
+}  // namespace utils
+}  // namespace spvtools
@@ -2452,6 +2452,46 @@ TEST_F(ValidateDecorations, PushConstantArrayBadAlignmentBad) {
           "member 1 at offset 7 is not aligned to 4"));
 }
 
+TEST_F(ValidateDecorations, BlockLayoutCheckedAgainForEachRuleSetBad) {
+  // The struct of the previous tests is laid out correctly for the push
+  // constant, but not for the uniform buffer that follows it, whose array
+  // must be aligned to 16 bytes.
+  std::string spirv = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Vertex %main "main"
+               OpSource GLSL 450
+               OpDecorate %_arr_float_uint_2 ArrayStride 4
+               OpMemberDecorate %S 0 Offset 0
+               OpMemberDecorate %S 1 Offset 8
+               OpDecorate %S Block
+       %void = OpTypeVoid
+          %3 = OpTypeFunction %void
+      %float = OpTypeFloat 32
+    %v2float = OpTypeVector %float 2
+       %uint = OpTypeInt 32 0
+     %uint_2 = OpConstant %uint 2
+%_arr_float_uint_2 = OpTypeArray %float %uint_2
+          %S = OpTypeStruct %v2float %_arr_float_uint_2
+%_ptr_PushConstant_S = OpTypePointer PushConstant %S
+          %p = OpVariable %_ptr_PushConstant_S PushConstant
+%_ptr_Uniform_S = OpTypePointer Uniform %S
+          %u = OpVariable %_ptr_Uniform_S Uniform
+       %main = OpFunction %void None %3
+          %5 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_ERROR_INVALID_ID, ValidateAndRetrieveValidationState());
+  EXPECT_THAT(
+      getDiagnosticString(),
+      HasSubstr("decorated as Block for variable in Uniform storage class "
+                "must follow standard uniform buffer layout rules: member 1 "
+                "at offset 8 is not aligned to 16"));
+}
+
 TEST_F(ValidateDecorations,
        PushConstantLayoutPermitsTightVec3ScalarPackingGood) {
   // See https://github.com/KhronosGroup/SPIRV-Tools/issues/1666
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 #include "source/val/validation_state.h"
 #include "spirv-tools/libspirv.h"
@@ -62,6 +63,15 @@ class ValidateBase : public ::testing::Test,
   spv_result_t ValidateAndRetrieveValidationState(
       spv_target_env env = SPV_ENV_UNIVERSAL_1_0);
 
+  // Performs validation like ValidateAndRetrieveValidationState, reusing the
+  // results of |previous|, the state of an earlier version of the module.
+  // |changed_functions|, if not null, names the functions that may have
+  // changed since.
+  spv_result_t RevalidateAndRetrieveValidationState(
+      const spvtools::val::ValidationState_t* previous,
+      spv_target_env env = SPV_ENV_UNIVERSAL_1_0,
+      const std::unordered_set<uint32_t>* changed_functions = nullptr);
+
   // Destroys the stored binary.
   void DestroyBinary() {
     spvBinaryDestroy(binary_);
@@ -165,6 +175,17 @@ spv_result_t ValidateBase<T>::ValidateAndRetrieveValidationState(
       get_const_binary()->wordCount, &diagnostic_, &vstate_);
 }
 
+template <typename T>
+spv_result_t ValidateBase<T>::RevalidateAndRetrieveValidationState(
+    const spvtools::val::ValidationState_t* previous, spv_target_env env,
+    const std::unordered_set<uint32_t>* changed_functions) {
+  DestroyDiagnostic();
+  return spvtools::val::ValidateBinaryAndKeepValidationState(
+      ScopedContext(env).context, options_, get_const_binary()->code,
+      get_const_binary()->wordCount, &diagnostic_, &vstate_, previous,
+      changed_functions);
+}
+
 template <typename T>
 std::string ValidateBase<T>::getDiagnosticString() {
   return diagnostic_ == nullptr ? std::string()
@@ -0,0 +1,153 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Unit tests for IdTable.
+
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/val/id_table.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+// Returns the ids that have a value in |table|, with their values, in the
+// order the table visits them.
+std::vector<std::pair<uint32_t, int>> Contents(const IdTable<int>& table) {
+  std::vector<std::pair<uint32_t, int>> contents;
+  for (const auto& kv : table) contents.emplace_back(kv.first, kv.second);
+  return contents;
+}
+
+TEST(IdTableTest, IdsWithoutValueReadAsDefault) {
+  IdTable<int> table;
+  table.Reset(10);
+  EXPECT_EQ(0, table.Get(3));
+  EXPECT_EQ(0, table.Get(100));
+  EXPECT_FALSE(table.Has(3));
+  EXPECT_FALSE(table.Has(100));
+  EXPECT_THAT(Contents(table), ElementsAre());
+}
+
+TEST(IdTableTest, IdsBelowAndAboveBound) {
+  IdTable<int> table;
+  table.Reset(10);
+  table[100] = 4;
+  table[7] = 3;
+  table[1] = 2;
+  table[50] = 5;
+  EXPECT_EQ(3, table.Get(7));
+  EXPECT_EQ(4, table.Get(100));
+  EXPECT_TRUE(table.Has(1));
+  EXPECT_TRUE(table.Has(50));
+  EXPECT_FALSE(table.Has(2));
+  EXPECT_FALSE(table.Has(51));
+  EXPECT_THAT(Contents(table), ElementsAre(Pair(1, 2), Pair(7, 3), Pair(50, 5),
+                                           Pair(100, 4)));
+}
+
+TEST(IdTableTest, WorksWithoutBound) {
+  IdTable<int> table;
+  table[2] = 1;
+  EXPECT_EQ(1, table.Get(2));
+  EXPECT_EQ(0, table.Get(1));
+  EXPECT_THAT(Contents(table), ElementsAre(Pair(2, 1)));
+}
+
+TEST(IdTableTest, DefaultValueCountsAsValue) {
+  IdTable<int> table;
+  table.Reset(10);
+  table[4];
+  EXPECT_TRUE(table.Has(4));
+  EXPECT_THAT(Contents(table), ElementsAre(Pair(4, 0)));
+}
+
+TEST(IdTableTest, ResetForgetsValues) {
+  IdTable<int> table;
+  table.Reset(10);
+  table[4] = 1;
+  table[40] = 2;
+  table.Reset(5);
+  EXPECT_EQ(0, table.Get(4));
+  EXPECT_EQ(0, table.Get(40));
+  EXPECT_THAT(Contents(table), ElementsAre());
+}
+
+TEST(IdTableTest, ReferencesStayValid) {
+  IdTable<std::vector<int>> table;
+  table.Reset(1000);
+  std::vector<int>& first = table[1];
+  first.push_back(7);
+  for (uint32_t id = 2; id < 2000; ++id) table[id].push_back(1);
+  EXPECT_EQ(&first, &table.Get(1));
+  EXPECT_THAT(first, ElementsAre(7));
+}
+
+TEST(IdTableTest, BoolValues) {
+  IdTable<bool> table;
+  table.Reset(10);
+  table[3] = true;
+  EXPECT_TRUE(table.Get(3));
+  EXPECT_FALSE(table.Get(4));
+}
+
+TEST(IdTableTest, DenseTable) {
+  IdTable<int> table(IdTable<int>::Layout::kDense);
+  table.Reset(10);
+  table[100] = 4;
+  table[7] = 3;
+  table[1] = 2;
+  EXPECT_EQ(3, table.Get(7));
+  EXPECT_EQ(4, table.Get(100));
+  EXPECT_FALSE(table.Has(2));
+  EXPECT_THAT(Contents(table),
+              ElementsAre(Pair(1, 2), Pair(7, 3), Pair(100, 4)));
+}
+
+TEST(IdTableTest, PagedTableVisitsIdsAcrossPages) {
+  IdTable<int> table;
+  table.Reset(10000);
+  table[9999] = 3;
+  table[1024] = 2;
+  table[1023] = 1;
+  table[20000] = 4;
+  EXPECT_FALSE(table.Has(5000));
+  EXPECT_THAT(Contents(table), ElementsAre(Pair(1023, 1), Pair(1024, 2),
+                                           Pair(9999, 3), Pair(20000, 4)));
+}
+
+TEST(IdTableTest, PagedTableOnlyAllocatesWrittenPages) {
+  const uint32_t bound = 1u << 20;
+  IdTable<int> dense(IdTable<int>::Layout::kDense);
+  IdTable<int> paged;
+  dense.Reset(bound);
+  paged.Reset(bound);
+  EXPECT_GE(dense.MemoryUsage(), bound * sizeof(uint32_t));
+  EXPECT_LT(paged.MemoryUsage(), bound * sizeof(uint32_t) / 16);
+
+  const size_t empty_usage = paged.MemoryUsage();
+  paged[1] = 1;
+  paged[2] = 2;
+  EXPECT_EQ(1, paged.Get(1));
+  EXPECT_LT(paged.MemoryUsage(), empty_usage + 8 * 1024);
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -0,0 +1,122 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests that the opcode predicates of the validation passes agree with the
+// passes.  The validator only runs a pass on the opcodes its predicate
+// accepts, so an opcode missing from a predicate would silently go
+// unchecked.
+
+#include <tuple>
+
+#include "gtest/gtest.h"
+#include "source/opcode.h"
+#include "source/spirv_validator_options.h"
+#include "source/val/function.h"
+#include "source/val/instruction.h"
+#include "source/val/validate.h"
+#include "source/val/validation_state.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+struct OpcodeCheck {
+  const char* name;
+  spv_result_t (*check)(ValidationState_t& _, const Instruction* inst);
+  bool (*handles)(SpvOp opcode);
+};
+
+// The passes that are only run on some opcodes.
+const OpcodeCheck kOpcodeChecks[] = {
+    {"MiscPass", MiscPass, MiscPassHandles},
+    {"DebugPass", DebugPass, DebugPassHandles},
+    {"AnnotationPass", AnnotationPass, AnnotationPassHandles},
+    {"ExtensionPass", ExtensionPass, ExtensionPassHandles},
+    {"ModeSettingPass", ModeSettingPass, ModeSettingPassHandles},
+    {"TypePass", TypePass, TypePassHandles},
+    {"ConstantPass", ConstantPass, ConstantPassHandles},
+    {"MemoryPass", MemoryPass, MemoryPassHandles},
+    {"FunctionPass", FunctionPass, FunctionPassHandles},
+    {"ImagePass", ImagePass, ImagePassHandles},
+    {"ConversionPass", ConversionPass, ConversionPassHandles},
+    {"CompositesPass", CompositesPass, CompositesPassHandles},
+    {"ArithmeticsPass", ArithmeticsPass, ArithmeticsPassHandles},
+    {"BitwisePass", BitwisePass, BitwisePassHandles},
+    {"LogicalsPass", LogicalsPass, LogicalsPassHandles},
+    {"ControlFlowPass", ControlFlowPass, ControlFlowPassHandles},
+    {"DerivativesPass", DerivativesPass, DerivativesPassHandles},
+    {"AtomicsPass", AtomicsPass, AtomicsPassHandles},
+    {"PrimitivesPass", PrimitivesPass, PrimitivesPassHandles},
+    {"BarriersPass", BarriersPass, BarriersPassHandles},
+    {"NonUniformPass", NonUniformPass, NonUniformPassHandles},
+};
+
+// This is all we need for these tests.
+static uint32_t kFakeBinary[] = {0};
+
+using ValidateOpcodeChecks =
+    ::testing::TestWithParam<std::tuple<spv_target_env, bool>>;
+
+// Each pass is run on an instruction of every opcode its predicate rejects,
+// in each environment, both inside and outside a function.  The instruction
+// has no operands, so a pass that checks it either reports an error or, in a
+// debug build, trips an assertion on a missing operand.
+TEST_P(ValidateOpcodeChecks, PassesDoNothingOnOpcodesTheyDoNotHandle) {
+  const spv_target_env env = std::get<0>(GetParam());
+  const bool in_function = std::get<1>(GetParam());
+  spv_context context = spvContextCreate(env);
+  spv_validator_options options = spvValidatorOptionsCreate();
+  ValidationState_t state(context, options, kFakeBinary, 0, 1);
+  Function* function = nullptr;
+  if (in_function) {
+    ASSERT_EQ(SPV_SUCCESS,
+              state.RegisterFunction(1, 2, SpvFunctionControlMaskNone, 3));
+    ASSERT_EQ(SPV_SUCCESS, state.RegisterFunctionEnd());
+    function = state.function(1);
+  }
+
+  spv_opcode_table opcodes = nullptr;
+  ASSERT_EQ(SPV_SUCCESS, spvOpcodeTableGet(&opcodes, env));
+  for (uint32_t i = 0; i < opcodes->count; ++i) {
+    const SpvOp opcode = opcodes->entries[i].opcode;
+    const uint32_t words[] = {(1u << 16) | static_cast<uint32_t>(opcode)};
+    spv_parsed_instruction_t parsed = {
+        words, 1, static_cast<uint16_t>(opcode), SPV_EXT_INST_TYPE_NONE,
+        0,     0, nullptr,                       0};
+    Instruction inst(&parsed);
+    inst.set_function(function);
+
+    for (const OpcodeCheck& check : kOpcodeChecks) {
+      if (check.handles(opcode)) continue;
+      EXPECT_EQ(SPV_SUCCESS, check.check(state, &inst))
+          << check.name << " checks Op" << opcodes->entries[i].name
+          << ", which " << check.name << "Handles rejects";
+    }
+  }
+
+  spvValidatorOptionsDestroy(options);
+  spvContextDestroy(context);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllPasses, ValidateOpcodeChecks,
+    ::testing::Combine(::testing::Values(SPV_ENV_UNIVERSAL_1_0,
+                                         SPV_ENV_UNIVERSAL_1_5,
+                                         SPV_ENV_VULKAN_1_0, SPV_ENV_VULKAN_1_2,
+                                         SPV_ENV_OPENCL_2_2, SPV_ENV_WEBGPU_0),
+                       ::testing::Bool()));
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
@@ -0,0 +1,121 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Unit tests for ValidationProfile.
+
+#if defined(SPIRV_TIMER_ENABLED)
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/val/validation_profile.h"
+
+namespace spvtools {
+namespace val {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using std::chrono::milliseconds;
+
+// Returns the lines of |text|.
+std::vector<std::string> Lines(const std::string& text) {
+  std::vector<std::string> lines;
+  std::istringstream stream(text);
+  for (std::string line; std::getline(stream, line);) lines.push_back(line);
+  return lines;
+}
+
+TEST(ValidationProfileTest, ReportsChecksAndOpcodesByDecreasingTime) {
+  ValidationProfile profile;
+  profile.Record("TypePass", SpvOpTypeInt, milliseconds(1));
+  profile.Record("TypePass", SpvOpTypeFloat, milliseconds(2));
+  profile.Record("MemoryPass", SpvOpLoad, milliseconds(5));
+  profile.Record("ValidateDecorations", ValidationProfile::kWholeModule,
+                 milliseconds(4));
+
+  std::ostringstream out;
+  profile.Report(&out);
+  const std::vector<std::string> lines = Lines(out.str());
+  ASSERT_EQ(9u, lines.size());
+  EXPECT_THAT(lines[0], HasSubstr("Check"));
+  EXPECT_THAT(lines[1], HasSubstr("MemoryPass"));
+  EXPECT_THAT(lines[2], HasSubstr("ValidateDecorations"));
+  EXPECT_THAT(lines[3], HasSubstr("TypePass"));
+  EXPECT_THAT(lines[3], HasSubstr(" 2 "));
+  EXPECT_THAT(lines[3], HasSubstr("3.000"));
+  EXPECT_THAT(lines[4], HasSubstr("Opcode"));
+  EXPECT_THAT(lines[5], HasSubstr("Load"));
+  EXPECT_THAT(lines[6], HasSubstr("TypeFloat"));
+  EXPECT_THAT(lines[7], HasSubstr("TypeInt"));
+  // No table recorded its memory.
+  EXPECT_THAT(lines[8], HasSubstr("Table"));
+}
+
+TEST(ValidationProfileTest, SumsRecordsFromSeveralThreads) {
+  ValidationProfile profile;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&profile]() {
+      for (int i = 0; i < 1000; ++i) {
+        profile.Record("ImagePass", SpvOpImageRead, milliseconds(0));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::ostringstream out;
+  profile.Report(&out);
+  EXPECT_THAT(out.str(), HasSubstr(" 4000 "));
+}
+
+TEST(ValidationProfileTest, ScopedTimerIgnoresNullProfile) {
+  { SPIRV_VAL_PROFILE_SCOPED(nullptr, "ImagePass", SpvOpImageRead); }
+
+  ValidationProfile profile;
+  { SPIRV_VAL_PROFILE_SCOPED(&profile, "ValidateBuiltIns"); }
+  std::ostringstream out;
+  profile.Report(&out);
+  EXPECT_THAT(out.str(), HasSubstr("ValidateBuiltIns"));
+  EXPECT_THAT(out.str(), Not(HasSubstr("ImagePass")));
+}
+
+TEST(ValidationProfileTest, NestedTimersAreNotCountedTwice) {
+  ValidationProfile profile;
+  {
+    SPIRV_VAL_PROFILE_SCOPED(&profile, "spvBinaryParse");
+    {
+      SPIRV_VAL_PROFILE_SCOPED(&profile, "IdPass", SpvOpLoad);
+      std::this_thread::sleep_for(milliseconds(50));
+    }
+  }
+
+  std::ostringstream out;
+  profile.Report(&out);
+  const std::vector<std::string> lines = Lines(out.str());
+  ASSERT_LE(3u, lines.size());
+  // The nested check took most of the time, so it comes first.
+  EXPECT_THAT(lines[1], HasSubstr("IdPass"));
+  EXPECT_THAT(lines[2], HasSubstr("spvBinaryParse"));
+}
+
+}  // namespace
+}  // namespace val
+}  // namespace spvtools
+
+#endif  // defined(SPIRV_TIMER_ENABLED)
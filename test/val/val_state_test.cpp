@@ -15,6 +15,7 @@
 
 // Unit tests for ValidationState_t.
 
+#include <string>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -134,6 +135,39 @@ TEST_F(ValidationState_HasAnyOfExtensions, MultiCapMask) {
   EXPECT_FALSE(state_.HasAnyOfExtensions(set2));
 }
 
+// A test of ValidationState_t::ForEachIndexInParallel().
+using ValidationState_ForEachIndexInParallel = ValidationStateTest;
+
+TEST_F(ValidationState_ForEachIndexInParallel, SameResultForAnyThreadCount) {
+  std::vector<std::string> messages;
+  SetContextMessageConsumer(
+      context_, [&messages](spv_message_level_t, const char*,
+                            const spv_position_t&, const char* message) {
+        messages.push_back(message);
+      });
+
+  for (uint32_t num_threads : {1u, 4u}) {
+    messages.clear();
+    spvValidatorOptionsSetNumThreads(options_, num_threads);
+    std::vector<int> checked(100, 0);
+    const spv_result_t result =
+        state_.ForEachIndexInParallel(100, [&](size_t i) -> spv_result_t {
+          checked[i] = 1;
+          if (i == 5) {
+            state_.diag(SPV_ERROR_INVALID_ID, nullptr) << "note " << i;
+          }
+          if (i == 30 || i == 70) {
+            return state_.diag(SPV_ERROR_INVALID_DATA, nullptr)
+                   << "failure " << i;
+          }
+          return SPV_SUCCESS;
+        });
+    EXPECT_EQ(SPV_ERROR_INVALID_DATA, result);
+    EXPECT_EQ(std::vector<std::string>({"note 5", "failure 30"}), messages);
+    for (size_t i = 0; i <= 30; ++i) EXPECT_EQ(1, checked[i]) << i;
+  }
+}
+
 }  // namespace
 }  // namespace val
 }  // namespace spvtools
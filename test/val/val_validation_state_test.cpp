@@ -14,9 +14,13 @@
 
 // Basic tests for the ValidationState_t datastructure.
 
+#include <memory>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "gmock/gmock.h"
+#include "source/spirv_constant.h"
 #include "source/spirv_validator_options.h"
 #include "test/unit_spirv.h"
 #include "test/val/val_fixtures.h"
@@ -356,6 +360,225 @@ OpEntryPoint Vertex %func_1 "main"
                 "in WebGPU env.\n  %1 = OpFunction %void None %3\n"));
 }
 
+// Functions may be checked on several threads, but the error reported is
+// still the first one in module order.
+TEST_F(ValidationStateTest, CheckWithThreadsReportsFirstError) {
+  std::string spirv = std::string(kHeader) + R"(
+%void   = OpTypeVoid
+%void_f = OpTypeFunction %void
+%bool   = OpTypeBool
+%uint   = OpTypeInt 32 0
+%float  = OpTypeFloat 32
+%one    = OpConstant %uint 1
+%good   = OpFunction %void None %void_f
+%good_label = OpLabel
+%sum    = OpIAdd %uint %one %one
+          OpReturn
+          OpFunctionEnd
+%first  = OpFunction %void None %void_f
+%first_label = OpLabel
+%first_bad = OpIAdd %bool %one %one
+          OpReturn
+          OpFunctionEnd
+%second = OpFunction %void None %void_f
+%second_label = OpLabel
+%second_bad = OpFAdd %uint %one %one
+          OpReturn
+          OpFunctionEnd
+)";
+
+  spvValidatorOptionsSetNumThreads(getValidatorOptions(), 4);
+  CompileSuccessfully(spirv);
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, ValidateInstructions());
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Expected int scalar or vector type as Result Type: "
+                        "IAdd"));
+}
+
+TEST_F(ValidationStateTest, InstructionsReferenceTheWordsOfTheBinary) {
+  CompileSuccessfully(std::string(kHeader) + kVoidFVoid);
+  ASSERT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+
+  const uint32_t* words = binary_->code + SPV_INDEX_INSTRUCTION;
+  for (const auto& inst : vstate_->ordered_instructions()) {
+    EXPECT_EQ(words, inst.words().data());
+    words += inst.words().size();
+  }
+  EXPECT_EQ(binary_->code + binary_->wordCount, words);
+}
+
+TEST_F(ValidationStateTest, InstructionsOfSwappedBinaryAreInHostByteOrder) {
+  CompileSuccessfully(std::string(kHeader) + kVoidFVoid);
+  const std::vector<uint32_t> host_words(binary_->code,
+                                         binary_->code + binary_->wordCount);
+  for (size_t i = 0; i < binary_->wordCount; ++i) {
+    const uint32_t word = binary_->code[i];
+    binary_->code[i] = (word >> 24) | ((word >> 8) & 0xff00) |
+                       ((word << 8) & 0xff0000) | (word << 24);
+  }
+  ASSERT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+
+  size_t index = SPV_INDEX_INSTRUCTION;
+  for (const auto& inst : vstate_->ordered_instructions()) {
+    for (const uint32_t word : inst.words()) {
+      EXPECT_EQ(host_words[index++], word);
+    }
+  }
+  EXPECT_EQ(host_words.size(), index);
+}
+
+const char kTwoFunctionsTypes[] = R"(
+%1  = OpTypeVoid
+%2  = OpTypeFunction %1
+%3  = OpTypeInt 32 0
+%4  = OpConstant %3 1
+%5  = OpTypeBool
+)";
+
+const char kTwoFunctionsBodies[] = R"(
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpIAdd %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+      OpReturn
+      OpFunctionEnd
+)";
+
+// Validates kTwoFunctions*, then |spirv| with the state kept from the first
+// validation as the previous state.
+class RevalidationTest : public ValidationStateTest {
+ public:
+  spv_result_t Revalidate(
+      const std::string& spirv,
+      const std::unordered_set<uint32_t>* changed_functions = nullptr) {
+    CompileSuccessfully(std::string(kHeader) + kTwoFunctionsTypes +
+                        kTwoFunctionsBodies);
+    EXPECT_EQ(SPV_SUCCESS, ValidateAndRetrieveValidationState());
+
+    // The previous binary must outlive the previous state.
+    spv_binary previous_binary = binary_;
+    binary_ = nullptr;
+    std::unique_ptr<ValidationState_t> previous = std::move(vstate_);
+    CompileSuccessfully(spirv);
+    const spv_result_t result = RevalidateAndRetrieveValidationState(
+        previous.get(), SPV_ENV_UNIVERSAL_1_0, changed_functions);
+    previous.reset();
+    spvBinaryDestroy(previous_binary);
+    return result;
+  }
+};
+
+TEST_F(RevalidationTest, OnlyChangedFunctionsAreChecked) {
+  std::string spirv = std::string(kHeader) + kTwoFunctionsTypes + R"(
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpIAdd %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpIAdd %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+)";
+
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv));
+  EXPECT_TRUE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(20));
+}
+
+TEST_F(RevalidationTest, ErrorsInChangedFunctionsAreFound) {
+  std::string spirv = std::string(kHeader) + kTwoFunctionsTypes + R"(
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpIAdd %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpIAdd %5 %4 %4
+      OpReturn
+      OpFunctionEnd
+)";
+
+  EXPECT_EQ(SPV_ERROR_INVALID_DATA, Revalidate(spirv));
+  EXPECT_THAT(getDiagnosticString(),
+              HasSubstr("Expected int scalar or vector type as Result Type: "
+                        "IAdd"));
+}
+
+TEST_F(RevalidationTest, AppendedGlobalsKeepFunctionsUnchanged) {
+  std::string spirv = std::string(kHeader) + kTwoFunctionsTypes +
+                      "%6 = OpTypeFloat 32\n" + kTwoFunctionsBodies;
+
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv));
+  EXPECT_TRUE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_TRUE(vstate_->IsFunctionUnchanged(20));
+}
+
+TEST_F(RevalidationTest, ChangedGlobalsRecheckTheirUsers) {
+  // %4 is only used by the first function.
+  std::string spirv = std::string(kHeader) + R"(
+%1  = OpTypeVoid
+%2  = OpTypeFunction %1
+%3  = OpTypeInt 32 0
+%4  = OpConstant %3 2
+%5  = OpTypeBool
+)" + kTwoFunctionsBodies;
+
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_TRUE(vstate_->IsFunctionUnchanged(20));
+}
+
+TEST_F(RevalidationTest, ChangedCapabilitiesRecheckAllFunctions) {
+  std::string spirv = " OpCapability Int64" + std::string(kHeader) +
+                      kTwoFunctionsTypes + kTwoFunctionsBodies;
+
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(20));
+}
+
+TEST_F(RevalidationTest, ReorderedGlobalsRecheckAllFunctions) {
+  std::string spirv = std::string(kHeader) + R"(
+%1  = OpTypeVoid
+%2  = OpTypeFunction %1
+%5  = OpTypeBool
+%3  = OpTypeInt 32 0
+%4  = OpConstant %3 1
+)" + kTwoFunctionsBodies;
+
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(20));
+}
+
+TEST_F(RevalidationTest, OnlyNamedFunctionsAreCompared) {
+  // The first function changed, but it is not named, so it is taken as
+  // unchanged since it has as many instructions as before.
+  std::string spirv = std::string(kHeader) + kTwoFunctionsTypes + R"(
+%10 = OpFunction %1 None %2
+%11 = OpLabel
+%12 = OpISub %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+%20 = OpFunction %1 None %2
+%21 = OpLabel
+%22 = OpIAdd %3 %4 %4
+      OpReturn
+      OpFunctionEnd
+)";
+
+  const std::unordered_set<uint32_t> changed_functions = {20};
+  EXPECT_EQ(SPV_SUCCESS, Revalidate(spirv, &changed_functions));
+  EXPECT_TRUE(vstate_->IsFunctionUnchanged(10));
+  EXPECT_FALSE(vstate_->IsFunctionUnchanged(20));
+}
+
 }  // namespace
 }  // namespace val
 }  // namespace spvtools
@@ -25,6 +25,17 @@
 #include "spirv-tools/libspirv.h"
 #include "tools/io.h"
 
+// Writes a chunk of disassembled text to the FILE* in |user_data|.
+static spv_result_t WriteTextChunk(void* user_data, const char* text,
+                                   size_t length) {
+  FILE* out = static_cast<FILE*>(user_data);
+  if (fwrite(text, 1, length, out) != length) {
+    fprintf(stderr, "error: could not write disassembly\n");
+    return SPV_ERROR_INTERNAL;
+  }
+  return SPV_SUCCESS;
+}
+
 static void print_usage(char* argv0) {
   printf(
       R"(%s - Disassemble a SPIR-V binary module
@@ -172,38 +183,61 @@ int main(int argc, char** argv) {
   }
 
   // Read the input binary.
-  std::vector<uint32_t> contents;
-  if (!ReadFile<uint32_t>(inFile, "rb", &contents)) return 1;
+  InputBinary contents;
+  if (!contents.Read(inFile)) return 1;
 
   // If printing to standard output, then spvBinaryToText should
   // do the printing.  In particular, colour printing on Windows is
   // controlled by modifying console objects synchronously while
   // outputting to the stream rather than by injecting escape codes
   // into the output stream.
-  // If the printing option is off, then save the text in memory, so
-  // it can be emitted later in this function.
+  // If the printing option is off, then stream the text into a temporary
+  // file one instruction at a time, so the whole text is never held in
+  // memory.  The temporary file only replaces the output file once the whole
+  // module has been disassembled, so a failure leaves the output untouched.
   const bool print_to_stdout = SPV_BINARY_TO_TEXT_OPTION_PRINT & options;
-  spv_text text = nullptr;
-  spv_text* textOrNull = print_to_stdout ? nullptr : &text;
+  std::string temp_file;
+  FILE* out = nullptr;
+  if (!print_to_stdout) {
+    temp_file = std::string(outFile) + ".tmp";
+    out = fopen(temp_file.c_str(), "w");
+    if (!out) {
+      fprintf(stderr, "error: could not open file '%s'\n", temp_file.c_str());
+      return 1;
+    }
+  }
   spv_diagnostic diagnostic = nullptr;
   spv_context context = spvContextCreate(kDefaultEnvironment);
   spv_result_t error =
-      spvBinaryToText(context, contents.data(), contents.size(), options,
-                      textOrNull, &diagnostic);
+      print_to_stdout
+          ? spvBinaryToText(context, contents.data(), contents.size(), options,
+                            nullptr, &diagnostic)
+          : spvBinaryToTextStream(context, contents.data(), contents.size(),
+                                  options, out, WriteTextChunk, &diagnostic);
   spvContextDestroy(context);
-  if (error) {
-    spvDiagnosticPrint(diagnostic);
-    spvDiagnosticDestroy(diagnostic);
-    return error;
+  if (out) {
+    if (fclose(out) != 0 && !error) {
+      fprintf(stderr, "error: could not write to file '%s'\n",
+              temp_file.c_str());
+      error = SPV_ERROR_INTERNAL;
+    }
+#if defined(_WIN32)
+    // rename() does not replace an existing file on Windows.
+    if (!error) std::remove(outFile);
+#endif
+    if (!error && std::rename(temp_file.c_str(), outFile) != 0) {
+      fprintf(stderr, "error: could not write to file '%s'\n", outFile);
+      error = SPV_ERROR_INTERNAL;
+    }
+    if (error) std::remove(temp_file.c_str());
   }
-
-  if (!print_to_stdout) {
-    if (!WriteFile<char>(outFile, "w", text->str, text->length)) {
-      spvTextDestroy(text);
-      return 1;
+  if (error) {
+    if (diagnostic) {
+      spvDiagnosticPrint(diagnostic);
+      spvDiagnosticDestroy(diagnostic);
     }
+    return error;
   }
-  spvTextDestroy(text);
 
   return 0;
 }
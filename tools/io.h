@@ -17,15 +17,39 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
+#include <string>
 #include <vector>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SPIRV_TOOLS_IO_USE_MMAP 1
+#else
+#define SPIRV_TOOLS_IO_USE_MMAP 0
+#endif
+
+// Reports an error of the functions below.  The |message| is stored in |error|
+// if it is not nullptr, and written to standard error otherwise.
+inline void ReportIOError(const std::string& message, std::string* error) {
+  if (error) {
+    *error = message;
+  } else {
+    fprintf(stderr, "error: %s\n", message.c_str());
+  }
+}
+
 // Appends the content from the file named as |filename| to |data|, assuming
 // each element in the file is of type |T|. The file is opened with the given
 // |mode|. If |filename| is nullptr or "-", reads from the standard input, but
-// reopened with the given mode. If any error occurs, writes error messages to
-// standard error and returns false.
+// reopened with the given mode. If any error occurs, reports it as
+// ReportIOError does and returns false.
 template <typename T>
-bool ReadFile(const char* filename, const char* mode, std::vector<T>* data) {
+bool ReadFile(const char* filename, const char* mode, std::vector<T>* data,
+              std::string* error = nullptr) {
+  const std::string name = filename ? filename : "-";
   const int buf_size = 1024;
   const bool use_file = filename && strcmp("-", filename);
   if (FILE* fp =
@@ -36,47 +60,119 @@ bool ReadFile(const char* filename, const char* mode, std::vector<T>* data) {
     }
     if (ftell(fp) == -1L) {
       if (ferror(fp)) {
-        fprintf(stderr, "error: error reading file '%s'\n", filename);
+        ReportIOError("error reading file '" + name + "'", error);
         if (use_file) fclose(fp);
         return false;
       }
     } else {
       if (sizeof(T) != 1 && (ftell(fp) % sizeof(T))) {
-        fprintf(
-            stderr,
-            "error: file size should be a multiple of %zd; file '%s' corrupt\n",
-            sizeof(T), filename);
+        ReportIOError("file size should be a multiple of " +
+                          std::to_string(sizeof(T)) + "; file '" + name +
+                          "' corrupt",
+                      error);
         if (use_file) fclose(fp);
         return false;
       }
     }
     if (use_file) fclose(fp);
   } else {
-    fprintf(stderr, "error: file does not exist '%s'\n", filename);
+    ReportIOError("file does not exist '" + name + "'", error);
     return false;
   }
   return true;
 }
 
+// Gives read-only access to the words of a SPIR-V binary file.  Where the
+// platform supports it, a regular file is memory mapped so the binary can be
+// parsed directly from the mapped pages without being copied.  The standard
+// input, non-regular files and other platforms fall back to ReadFile.
+class InputBinary {
+ public:
+  InputBinary() = default;
+  InputBinary(const InputBinary&) = delete;
+  InputBinary& operator=(const InputBinary&) = delete;
+  ~InputBinary() { Release(); }
+
+  // Makes the content of the file named as |filename| available through
+  // data() and size().  |filename| and |error| follow the conventions of
+  // ReadFile.  If any error occurs, reports it and returns false.
+  bool Read(const char* filename, std::string* error = nullptr) {
+    Release();
+#if SPIRV_TOOLS_IO_USE_MMAP
+    if (filename && strcmp("-", filename) && Map(filename)) return true;
+#endif
+    return ReadFile<uint32_t>(filename, "rb", &words_, error);
+  }
+
+  // Returns the words of the binary.
+  const uint32_t* data() const { return mapped_ ? mapped_ : words_.data(); }
+
+  // Returns the number of words in the binary.
+  size_t size() const { return mapped_ ? mapped_size_ : words_.size(); }
+
+ private:
+#if SPIRV_TOOLS_IO_USE_MMAP
+  // Maps the file named as |filename|.  Returns false if the file cannot be
+  // mapped, in which case the caller reads it the ordinary way so that errors
+  // are reported consistently.
+  bool Map(const char* filename) {
+    const int fd = open(filename, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0 ||
+        st.st_size % sizeof(uint32_t)) {
+      close(fd);
+      return false;
+    }
+    const size_t num_bytes = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, num_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (addr == MAP_FAILED) return false;
+    madvise(addr, num_bytes, MADV_SEQUENTIAL);
+    mapped_ = static_cast<const uint32_t*>(addr);
+    mapped_size_ = num_bytes / sizeof(uint32_t);
+    return true;
+  }
+#endif
+
+  void Release() {
+#if SPIRV_TOOLS_IO_USE_MMAP
+    if (mapped_) {
+      munmap(const_cast<uint32_t*>(mapped_), mapped_size_ * sizeof(uint32_t));
+    }
+#endif
+    mapped_ = nullptr;
+    mapped_size_ = 0;
+    words_.clear();
+  }
+
+  // The mapped file, or nullptr if the content was read into |words_|.
+  const uint32_t* mapped_ = nullptr;
+  size_t mapped_size_ = 0;
+  std::vector<uint32_t> words_;
+};
+
 // Writes the given |data| into the file named as |filename| using the given
 // |mode|, assuming |data| is an array of |count| elements of type |T|. If
 // |filename| is nullptr or "-", writes to standard output. If any error occurs,
-// returns false and outputs error message to standard error.
+// reports it as ReportIOError does and returns false.
 template <typename T>
 bool WriteFile(const char* filename, const char* mode, const T* data,
-               size_t count) {
+               size_t count, std::string* error = nullptr) {
+  const std::string name = filename ? filename : "-";
   const bool use_stdout =
       !filename || (filename[0] == '-' && filename[1] == '\0');
   if (FILE* fp = (use_stdout ? stdout : fopen(filename, mode))) {
     size_t written = fwrite(data, sizeof(T), count, fp);
     if (count != written) {
-      fprintf(stderr, "error: could not write to file '%s'\n", filename);
+      ReportIOError("could not write to file '" + name + "'", error);
       if (!use_stdout) fclose(fp);
       return false;
     }
     if (!use_stdout) fclose(fp);
   } else {
-    fprintf(stderr, "error: could not open file '%s'\n", filename);
+    ReportIOError("could not open file '" + name + "'", error);
     return false;
   }
   return true;
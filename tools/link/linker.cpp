@@ -119,9 +119,13 @@ int main(int argc, char** argv) {
     return 1;
   }
 
-  std::vector<std::vector<uint32_t>> contents(inFiles.size());
+  std::vector<InputBinary> contents(inFiles.size());
+  std::vector<const uint32_t*> binaries(inFiles.size());
+  std::vector<size_t> binary_sizes(inFiles.size());
   for (size_t i = 0u; i < inFiles.size(); ++i) {
-    if (!ReadFile<uint32_t>(inFiles[i], "rb", &contents[i])) return 1;
+    if (!contents[i].Read(inFiles[i])) return 1;
+    binaries[i] = contents[i].data();
+    binary_sizes[i] = contents[i].size();
   }
 
   const spvtools::MessageConsumer consumer = [](spv_message_level_t level,
@@ -150,7 +154,8 @@ int main(int argc, char** argv) {
   context.SetMessageConsumer(consumer);
 
   std::vector<uint32_t> linkingResult;
-  spv_result_t status = Link(context, contents, &linkingResult, options);
+  spv_result_t status = Link(context, binaries.data(), binary_sizes.data(),
+                              binaries.size(), &linkingResult, options);
 
   if (!WriteFile<uint32_t>(outFile, "wb", linkingResult.data(),
                            linkingResult.size()))
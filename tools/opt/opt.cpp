@@ -13,13 +13,18 @@
 // limitations under the License.
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "source/opt/log.h"
@@ -32,6 +37,8 @@
 
 namespace {
 
+const auto kDefaultEnvironment = SPV_ENV_UNIVERSAL_1_5;
+
 // Status and actions to perform after parsing command-line arguments.
 enum OptActions { OPT_CONTINUE, OPT_STOP };
 
@@ -40,6 +47,58 @@ struct OptStatus {
   int code;
 };
 
+// Settings for batch mode, in which every module listed in a manifest is
+// optimized with the same flags by a pool of worker threads.
+struct BatchOptions {
+  // The manifest file, or "-" for standard input.  Null when not in batch
+  // mode.
+  const char* manifest = nullptr;
+
+  // The number of modules optimized concurrently.  Zero means one per hardware
+  // thread.
+  uint32_t jobs = 0;
+};
+
+// Settings for --profile-passes.
+struct ProfileOptions {
+  // The file the pass profile is written to.  Null when not profiling.
+  const char* file = nullptr;
+
+  spvtools::Optimizer::ProfileFormat format =
+      spvtools::Optimizer::ProfileFormat::kJson;
+};
+
+// How the flags configure the optimizer.  They are parsed once, and applied
+// by SetUpOptimizer to the main optimizer and to that of each batch worker.
+struct OptimizerSetup {
+  // The canonical flags of the passes to run, see CanonicalizeFlag.  Their
+  // passes run after those of --vulkan-to-webgpu and --webgpu-to-vulkan.
+  std::vector<std::string> pass_flags;
+
+  spv_target_env target_env = kDefaultEnvironment;
+  bool vulkan_to_webgpu = false;
+  bool webgpu_to_vulkan = false;
+
+  uint32_t fixed_point_rounds = 0;
+  bool validate_after_all = false;
+
+  // The cache directory, or null when not caching.
+  const char* cache_dir = nullptr;
+  uint64_t cache_size_mb = 256;
+
+  // Whether --print-all and --time-report were given.  The caller chooses
+  // the stream their output goes to: in batch mode it is collected per module
+  // instead of being written to stderr as it is produced.
+  bool print_all = false;
+  bool time_report = false;
+};
+
+// A module to optimize in batch mode.
+struct BatchEntry {
+  std::string in_file;
+  std::string out_file;
+};
+
 // Message consumer for this tool.  Used to emit diagnostics during
 // initialization and setup. Note that |source| and |position| are irrelevant
 // here because we are still not processing a SPIR-V input file.
@@ -59,8 +118,6 @@ std::string GetListOfPassesAsString(const spvtools::Optimizer& optimizer) {
   return ss.str();
 }
 
-const auto kDefaultEnvironment = SPV_ENV_UNIVERSAL_1_5;
-
 std::string GetLegalizationPasses() {
   spvtools::Optimizer optimizer(kDefaultEnvironment);
   optimizer.RegisterLegalizationPasses();
@@ -98,26 +155,56 @@ void PrintUsage(const char* program) {
       R"(%s - Optimize a SPIR-V binary file.
 
 USAGE: %s [options] [<input>] -o <output>
+       %s [options] --batch=<manifest>
 
 The SPIR-V binary is read from <input>. If no file is specified,
 or if <input> is "-", then the binary is read from standard input.
 if <output> is "-", then the optimized output is written to
 standard output.
 
+In batch mode, each line of <manifest> names an input and an output
+file, separated by whitespace.  Every input is optimized with the same
+options, and several modules are optimized at the same time.  Empty
+lines and lines starting with '#' are ignored.  If <manifest> is "-",
+it is read from standard input.
+
 NOTE: The optimizer is a work in progress.
 
 Options (in lexicographical order):)",
-      program, program);
+      program, program, program);
   printf(R"(
   --amd-ext-to-khr
                Replaces the extensions VK_AMD_shader_ballot, VK_AMD_gcn_shader,
                and VK_AMD_shader_trinary_minmax with equivalent code using core
                instructions and capabilities.)");
   printf(R"(
+  --batch=<manifest>
+               Optimizes every module listed in <manifest> instead of a single
+               input.  See above for the format of the manifest.  The exit
+               code is non-zero if any module fails.)");
+  printf(R"(
+  --batch-jobs=<n>
+               The number of modules optimized at the same time in batch mode.
+               The default is the number of hardware threads.)");
+  printf(R"(
   --before-hlsl-legalization
                Forwards this option to the validator.  See the validator help
                for details.)");
   printf(R"(
+  --cache-dir=<dir>
+               Cache optimized modules in <dir>, which must exist.  A module
+               that was already optimized with the same flags, target
+               environment and version of spirv-opt is read from the cache
+               instead of being validated and optimized again.  The directory
+               can be shared by concurrent runs of spirv-opt.  On a cache hit
+               --print-all, --time-report and --profile-passes print
+               nothing.)");
+  printf(R"(
+  --cache-size=<megabytes>
+               The size the modules in the --cache-dir directory are kept
+               under, by removing the least recently used ones.  The default
+               is 256.)");
+  printf(R"(
   --ccp
                Apply the conditional constant propagation transform.  This will
                propagate constant values throughout the program, and simplify
@@ -221,6 +308,13 @@ Options (in lexicographical order):)",
                loads and stores. Performed only on entry point call tree
                functions.)");
   printf(R"(
+  --fixed-point-rounds=<n>
+               Runs the passes given on the command line again, in the same
+               order, until a round of them makes no change or <n> rounds
+               have run.  A pass is skipped when nothing changed since it
+               last ran, and some passes are only run on the functions that
+               changed.  The default is 0, which runs the passes once.)");
+  printf(R"(
   --flatten-decorations
                Replace decoration groups with repeated OpDecorate and
                OpMemberDecorate instructions.)");
@@ -246,6 +340,15 @@ Options (in lexicographical order):)",
   --if-conversion
                Convert if-then-else like assignments into OpSelect.)");
   printf(R"(
+  --inline-bottom-up[=<percent>]
+               Inlines function calls chosen by a cost model, processing the
+               call graph from the leaves up.  Small functions and functions
+               with a single call are always inlined.  Other functions are
+               inlined only while the caller grows by at most <percent> of
+               its size; the default is 100.  --time-report prints how many
+               calls were inlined and the code size before and after, and
+               --profile-passes shows the effect on optimization time.)");
+  printf(R"(
   --inline-entry-points-exhaustive
                Exhaustively inline all function calls in entry point call tree
                functions. Currently does not inline calls to functions with
@@ -335,6 +438,11 @@ Options (in lexicographical order):)",
                the loop on each branch of the conditional and adjusting each
                copy of the loop.)");
   printf(R"(
+  --num-threads=<n>
+               Allows passes that support it to process up to <n> functions
+               in parallel.  The default is 1, which runs everything on the
+               calling thread.)");
+  printf(R"(
   -O
                Optimize for performance. Apply a sequence of transformations
                in an attempt to improve the performance of the generated
@@ -383,6 +491,12 @@ Options (in lexicographical order):)",
                --merge-blocks followed by all the transformations implied by
                -O.)");
   printf(R"(
+  --partial-redundancy-elimination
+               Same as --redundancy-elimination, but also looks for
+               instructions that compute a value already computed on some of
+               the paths leading to them.  The value is computed on the other
+               paths, and the instructions are replaced by a phi.)");
+  printf(R"(
   --preserve-bindings
                Ensure that the optimizer preserves all bindings declared within
                the module, even when those bindings are unused.)");
@@ -399,6 +513,21 @@ Options (in lexicographical order):)",
                Change the scope of private variables that are used in a single
                function to that function.)");
   printf(R"(
+  --profile-format={json,chrome-trace}
+               The format of the file written by --profile-passes.  json, the
+               default, writes one object per pass with a summary of the
+               analyses it built.  chrome-trace writes every pass and every
+               analysis build as a trace event, to be viewed in
+               chrome://tracing or Perfetto.)");
+  printf(R"(
+  --profile-passes=<file>
+               Write a profile of each pass to <file>: its wall time, the
+               number of instructions and the id bound before and after it
+               ran, and how many times each analysis (def-use, CFG,
+               dominators, decorations, types, constants, ...) was built
+               while it ran, and how long that took.  Cannot be combined with
+               --batch.)");
+  printf(R"(
   --reduce-load-size
                Replaces loads of composite objects where not every component is
                used by loads of just the elements that are used.)");
@@ -501,7 +630,12 @@ Options (in lexicographical order):)",
                systems. This option is the same as -ftime-report in GCC. It
                prints CPU/WALL/USR/SYS time (and RSS if possible), but note that
                USR/SYS time are returned by getrusage() and can have a small
-               error.)");
+               error.  Passes that keep statistics, such as
+               --inline-bottom-up, print them too.  In batch mode the report
+               of each module is printed when that module is done, followed
+               by a summary of the whole batch.
+               Since getrusage() measures the whole process, the per-pass CPU
+               times of modules optimized at the same time overlap.)");
   printf(R"(
   --upgrade-memory-model
                Upgrades the Logical GLSL450 memory model to Logical VulkanKHR.
@@ -613,24 +747,27 @@ bool ReadFlagsFromFile(const char* oconfig_flag,
   return true;
 }
 
-OptStatus ParseFlags(int argc, const char** argv,
-                     spvtools::Optimizer* optimizer, const char** in_file,
-                     const char** out_file,
+OptStatus ParseFlags(int argc, const char** argv, OptimizerSetup* setup,
+                     const char** in_file, const char** out_file,
                      spvtools::ValidatorOptions* validator_options,
-                     spvtools::OptimizerOptions* optimizer_options);
+                     spvtools::OptimizerOptions* optimizer_options,
+                     BatchOptions* batch_options,
+                     ProfileOptions* profile_options);
 
 // Parses and handles the -Oconfig flag. |prog_name| contains the name of
 // the spirv-opt binary (used to build a new argv vector for the recursive
 // invocation to ParseFlags). |opt_flag| contains the -Oconfig=FILENAME flag.
-// |optimizer|, |in_file|, |out_file|, |validator_options|, and
-// |optimizer_options| are as in ParseFlags.
+// |setup|, |in_file|, |out_file|, |validator_options|, |optimizer_options|,
+// |batch_options| and |profile_options| are as in ParseFlags.
 //
 // This returns the same OptStatus instance returned by ParseFlags.
 OptStatus ParseOconfigFlag(const char* prog_name, const char* opt_flag,
-                           spvtools::Optimizer* optimizer, const char** in_file,
+                           OptimizerSetup* setup, const char** in_file,
                            const char** out_file,
                            spvtools::ValidatorOptions* validator_options,
-                           spvtools::OptimizerOptions* optimizer_options) {
+                           spvtools::OptimizerOptions* optimizer_options,
+                           BatchOptions* batch_options,
+                           ProfileOptions* profile_options) {
   std::vector<std::string> flags;
   flags.push_back(prog_name);
 
@@ -654,8 +791,9 @@ OptStatus ParseOconfigFlag(const char* prog_name, const char* opt_flag,
   }
 
   auto ret_val =
-      ParseFlags(static_cast<int>(flags.size()), new_argv, optimizer, in_file,
-                 out_file, validator_options, optimizer_options);
+      ParseFlags(static_cast<int>(flags.size()), new_argv, setup, in_file,
+                 out_file, validator_options, optimizer_options, batch_options,
+                 profile_options);
   delete[] new_argv;
   return ret_val;
 }
@@ -701,18 +839,21 @@ std::string CanonicalizeFlag(const char** argv, int argc, int* argi) {
 }
 
 // Parses command-line flags. |argc| contains the number of command-line flags.
-// |argv| points to an array of strings holding the flags. |optimizer| is the
-// Optimizer instance used to optimize the program.
+// |argv| points to an array of strings holding the flags. The way the flags
+// configure the optimizer is stored in |setup|, to be applied with
+// SetUpOptimizer.
 //
 // On return, this function stores the name of the input program in |in_file|.
-// The name of the output file in |out_file|. The return value indicates whether
-// optimization should continue and a status code indicating an error or
-// success.
-OptStatus ParseFlags(int argc, const char** argv,
-                     spvtools::Optimizer* optimizer, const char** in_file,
-                     const char** out_file,
+// The name of the output file in |out_file|. The batch mode settings are
+// stored in |batch_options|, and the pass profile settings in
+// |profile_options|. The return value indicates whether optimization should
+// continue and a status code indicating an error or success.
+OptStatus ParseFlags(int argc, const char** argv, OptimizerSetup* setup,
+                     const char** in_file, const char** out_file,
                      spvtools::ValidatorOptions* validator_options,
-                     spvtools::OptimizerOptions* optimizer_options) {
+                     spvtools::OptimizerOptions* optimizer_options,
+                     BatchOptions* batch_options,
+                     ProfileOptions* profile_options) {
   std::vector<std::string> pass_flags;
   bool target_env_set = false;
   bool vulkan_to_webgpu_set = false;
@@ -745,21 +886,73 @@ OptStatus ParseFlags(int argc, const char** argv,
         }
       } else if (0 == strncmp(cur_arg, "-Oconfig=", sizeof("-Oconfig=") - 1)) {
         OptStatus status =
-            ParseOconfigFlag(argv[0], cur_arg, optimizer, in_file, out_file,
-                             validator_options, optimizer_options);
+            ParseOconfigFlag(argv[0], cur_arg, setup, in_file, out_file,
+                             validator_options, optimizer_options,
+                             batch_options, profile_options);
         if (status.action != OPT_CONTINUE) {
           return status;
         }
       } else if (0 == strcmp(cur_arg, "--skip-validation")) {
         optimizer_options->set_run_validator(false);
       } else if (0 == strcmp(cur_arg, "--print-all")) {
-        optimizer->SetPrintAll(&std::cerr);
+        setup->print_all = true;
       } else if (0 == strcmp(cur_arg, "--preserve-bindings")) {
         optimizer_options->set_preserve_bindings(true);
       } else if (0 == strcmp(cur_arg, "--preserve-spec-constants")) {
         optimizer_options->set_preserve_spec_constants(true);
       } else if (0 == strcmp(cur_arg, "--time-report")) {
-        optimizer->SetTimeReport(&std::cerr);
+        setup->time_report = true;
+      } else if (0 == strncmp(cur_arg, "--profile-passes=",
+                              sizeof("--profile-passes=") - 1)) {
+        profile_options->file = cur_arg + sizeof("--profile-passes=") - 1;
+      } else if (0 == strncmp(cur_arg, "--profile-format=",
+                              sizeof("--profile-format=") - 1)) {
+        const char* format = cur_arg + sizeof("--profile-format=") - 1;
+        if (0 == strcmp(format, "json")) {
+          profile_options->format = spvtools::Optimizer::ProfileFormat::kJson;
+        } else if (0 == strcmp(format, "chrome-trace")) {
+          profile_options->format =
+              spvtools::Optimizer::ProfileFormat::kChromeTrace;
+        } else {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "--profile-format must be json or chrome-trace");
+          return {OPT_STOP, 1};
+        }
+      } else if (0 == strncmp(cur_arg, "--batch=", sizeof("--batch=") - 1)) {
+        batch_options->manifest = cur_arg + sizeof("--batch=") - 1;
+      } else if (0 == strncmp(cur_arg, "--batch-jobs=",
+                              sizeof("--batch-jobs=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        const int jobs = atoi(split_flag.second.c_str());
+        if (jobs < 1) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "The number of batch jobs must be at least 1");
+          return {OPT_STOP, 1};
+        }
+        batch_options->jobs = static_cast<uint32_t>(jobs);
+      } else if (0 == strncmp(cur_arg, "--cache-dir=",
+                              sizeof("--cache-dir=") - 1)) {
+        setup->cache_dir = cur_arg + sizeof("--cache-dir=") - 1;
+      } else if (0 == strncmp(cur_arg, "--cache-size=",
+                              sizeof("--cache-size=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        const int cache_size = atoi(split_flag.second.c_str());
+        if (cache_size < 1) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "The cache size must be at least 1 megabyte");
+          return {OPT_STOP, 1};
+        }
+        setup->cache_size_mb = static_cast<uint64_t>(cache_size);
+      } else if (0 == strncmp(cur_arg, "--fixed-point-rounds=",
+                              sizeof("--fixed-point-rounds=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        const int rounds = atoi(split_flag.second.c_str());
+        if (rounds < 0) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "The number of rounds must not be negative");
+          return {OPT_STOP, 1};
+        }
+        setup->fixed_point_rounds = static_cast<uint32_t>(rounds);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
         validator_options->SetRelaxStructStore(true);
       } else if (0 == strncmp(cur_arg, "--max-id-bound=",
@@ -779,6 +972,16 @@ OptStatus ParseFlags(int argc, const char** argv,
         optimizer_options->set_max_id_bound(max_id_bound);
         validator_options->SetUniversalLimit(spv_validator_limit_max_id_bound,
                                              max_id_bound);
+      } else if (0 == strncmp(cur_arg, "--num-threads=",
+                              sizeof("--num-threads=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        const int num_threads = atoi(split_flag.second.c_str());
+        if (num_threads < 1) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "The number of threads must be at least 1");
+          return {OPT_STOP, 1};
+        }
+        optimizer_options->set_num_threads(static_cast<uint32_t>(num_threads));
       } else if (0 == strncmp(cur_arg,
                               "--target-env=", sizeof("--target-env=") - 1)) {
         target_env_set = true;
@@ -802,7 +1005,7 @@ OptStatus ParseFlags(int argc, const char** argv,
                           "Invalid value passed to --target-env");
           return {OPT_STOP, 1};
         }
-        optimizer->SetTargetEnv(target_env);
+        setup->target_env = target_env;
       } else if (0 == strcmp(cur_arg, "--vulkan-to-webgpu")) {
         vulkan_to_webgpu_set = true;
         if (target_env_set) {
@@ -819,8 +1022,8 @@ OptStatus ParseFlags(int argc, const char** argv,
           return {OPT_STOP, 1};
         }
 
-        optimizer->SetTargetEnv(SPV_ENV_VULKAN_1_1);
-        optimizer->RegisterVulkanToWebGPUPasses();
+        setup->target_env = SPV_ENV_VULKAN_1_1;
+        setup->vulkan_to_webgpu = true;
       } else if (0 == strcmp(cur_arg, "--webgpu-to-vulkan")) {
         webgpu_to_vulkan_set = true;
         if (target_env_set) {
@@ -837,10 +1040,10 @@ OptStatus ParseFlags(int argc, const char** argv,
           return {OPT_STOP, 1};
         }
 
-        optimizer->SetTargetEnv(SPV_ENV_WEBGPU_0);
-        optimizer->RegisterWebGPUToVulkanPasses();
+        setup->target_env = SPV_ENV_WEBGPU_0;
+        setup->webgpu_to_vulkan = true;
       } else if (0 == strcmp(cur_arg, "--validate-after-all")) {
-        optimizer->SetValidateAfterAll(true);
+        setup->validate_after_all = true;
       } else if (0 == strcmp(cur_arg, "--before-hlsl-legalization")) {
         validator_options->SetBeforeHlslLegalization(true);
       } else if (0 == strcmp(cur_arg, "--relax-logical-pointer")) {
@@ -875,11 +1078,226 @@ OptStatus ParseFlags(int argc, const char** argv,
     }
   }
 
-  if (!optimizer->RegisterPassesFromFlags(pass_flags)) {
-    return {OPT_STOP, 1};
+  setup->pass_flags.insert(setup->pass_flags.end(), pass_flags.begin(),
+                           pass_flags.end());
+  return {OPT_CONTINUE, 0};
+}
+
+// Configures |optimizer| as described by |setup|.  The output of --print-all
+// and --time-report goes to |log|.
+//
+// This function returns true on success, false on failure.
+bool SetUpOptimizer(const OptimizerSetup& setup, std::ostream* log,
+                    spvtools::Optimizer* optimizer) {
+  optimizer->SetTargetEnv(setup.target_env);
+  if (setup.vulkan_to_webgpu) optimizer->RegisterVulkanToWebGPUPasses();
+  if (setup.webgpu_to_vulkan) optimizer->RegisterWebGPUToVulkanPasses();
+  if (!optimizer->RegisterPassesFromFlags(setup.pass_flags)) {
+    return false;
   }
 
-  return {OPT_CONTINUE, 0};
+  optimizer->SetFixedPointRounds(setup.fixed_point_rounds);
+  optimizer->SetValidateAfterAll(setup.validate_after_all);
+  optimizer->SetPrintAll(setup.print_all ? log : nullptr);
+  optimizer->SetTimeReport(setup.time_report ? log : nullptr);
+  if (setup.cache_dir) {
+    optimizer->SetCacheDirectory(setup.cache_dir,
+                                 setup.cache_size_mb * 1024 * 1024);
+  }
+  return true;
+}
+
+// Reads the batch manifest |manifest|, or standard input if it is "-", and
+// appends the modules it lists to |entries|.
+//
+// This function returns true on success, false on failure.
+bool ReadBatchManifest(const char* manifest, std::vector<BatchEntry>* entries) {
+  std::ifstream manifest_file;
+  std::istream* input = &std::cin;
+  if (0 != strcmp(manifest, "-")) {
+    manifest_file.open(manifest);
+    if (manifest_file.fail()) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "Could not open batch manifest '%s'", manifest);
+      return false;
+    }
+    input = &manifest_file;
+  }
+
+  std::string line;
+  for (uint32_t line_number = 1; std::getline(*input, line); ++line_number) {
+    std::istringstream iss(line);
+    BatchEntry entry;
+    // Ignore empty lines and lines starting with the comment marker '#'.
+    if (!(iss >> entry.in_file) || entry.in_file[0] == '#') {
+      continue;
+    }
+
+    std::string extra;
+    if (!(iss >> entry.out_file) || (iss >> extra)) {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "%s:%u: expected an input and an output file", manifest,
+                       line_number);
+      return false;
+    }
+
+    // Modules are read and written concurrently, so they cannot share the
+    // standard streams.
+    if (entry.in_file == "-" || entry.out_file == "-") {
+      spvtools::Errorf(opt_diagnostic, nullptr, {},
+                       "%s:%u: standard input and output cannot be used in "
+                       "batch mode",
+                       manifest, line_number);
+      return false;
+    }
+    entries->push_back(std::move(entry));
+  }
+
+  return true;
+}
+
+// Optimizes the module described by |entry| with |optimizer|, which has been
+// set up by SetUpOptimizer, and |optimizer_options|.  Diagnostics, and the
+// output of --print-all and --time-report, are written to |log| rather than to
+// the standard streams, so that the output of modules optimized at the same
+// time does not interleave.
+//
+// This function returns true on success, false on failure.
+bool OptimizeBatchEntry(const OptimizerSetup& setup,
+                        const spvtools::OptimizerOptions& optimizer_options,
+                        const BatchEntry& entry, std::ostream* log,
+                        spvtools::Optimizer* optimizer) {
+  const std::string& in_file = entry.in_file;
+  optimizer->SetMessageConsumer(
+      [log, &in_file](spv_message_level_t level, const char*,
+                      const spv_position_t& position, const char* message) {
+        switch (level) {
+          case SPV_MSG_FATAL:
+          case SPV_MSG_INTERNAL_ERROR:
+          case SPV_MSG_ERROR:
+            *log << in_file << ": error: line " << position.index << ": "
+                 << message << std::endl;
+            break;
+          case SPV_MSG_WARNING:
+            *log << in_file << ": warning: line " << position.index << ": "
+                 << message << std::endl;
+            break;
+          default:
+            break;
+        }
+      });
+  optimizer->SetPrintAll(setup.print_all ? log : nullptr);
+  optimizer->SetTimeReport(setup.time_report ? log : nullptr);
+
+  InputBinary input;
+  std::string error;
+  if (!input.Read(entry.in_file.c_str(), &error)) {
+    *log << in_file << ": error: " << error << std::endl;
+    return false;
+  }
+
+  std::vector<uint32_t> binary;
+  bool ok =
+      optimizer->Run(input.data(), input.size(), &binary, optimizer_options);
+  if (!ok) {
+    *log << in_file << ": error: optimization failed" << std::endl;
+    binary.assign(input.data(), input.data() + input.size());
+  }
+
+  if (!WriteFile<uint32_t>(entry.out_file.c_str(), "wb", binary.data(),
+                           binary.size(), &error)) {
+    *log << in_file << ": error: " << error << std::endl;
+    return false;
+  }
+
+  return ok;
+}
+
+// Optimizes every module listed in the batch manifest on a pool of worker
+// threads.  |setup| and |optimizer_options| are applied to every module.
+// Returns the exit code of spirv-opt.
+int RunBatch(const OptimizerSetup& setup,
+             const spvtools::OptimizerOptions& optimizer_options,
+             const BatchOptions& batch_options) {
+  std::vector<BatchEntry> entries;
+  if (!ReadBatchManifest(batch_options.manifest, &entries)) {
+    return 1;
+  }
+
+  uint32_t jobs = batch_options.jobs;
+  if (jobs == 0) {
+    jobs = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  jobs = std::min(jobs, static_cast<uint32_t>(entries.size()));
+
+  using Clock = std::chrono::steady_clock;
+  const auto batch_start = Clock::now();
+  std::vector<double> seconds(entries.size());
+  std::atomic<size_t> next_entry(0);
+  std::atomic<uint32_t> num_failed(0);
+  std::mutex output_mutex;
+  auto worker = [&]() {
+    // Each worker sets up one optimizer, which registers its passes again
+    // from their flags for each module.  The flags were checked when the main
+    // optimizer was set up, so setting up this one cannot fail.
+    spvtools::Optimizer optimizer(kDefaultEnvironment);
+    SetUpOptimizer(setup, nullptr, &optimizer);
+    for (size_t i = next_entry++; i < entries.size(); i = next_entry++) {
+      std::ostringstream log;
+      if (setup.time_report) {
+        log << "Module " << entries[i].in_file << ":" << std::endl;
+      }
+      const auto start = Clock::now();
+      if (!OptimizeBatchEntry(setup, optimizer_options, entries[i], &log,
+                              &optimizer)) {
+        ++num_failed;
+      }
+      seconds[i] = std::chrono::duration<double>(Clock::now() - start).count();
+      if (setup.time_report) {
+        log << "Module WALL time: " << std::fixed << std::setprecision(6)
+            << seconds[i] << " s" << std::endl;
+      }
+
+      std::lock_guard<std::mutex> lock(output_mutex);
+      std::cerr << log.str();
+    }
+  };
+
+  // The main thread is one of the workers.
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < jobs; ++i) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& t : workers) {
+    t.join();
+  }
+
+  if (setup.time_report) {
+    const double wall_seconds =
+        std::chrono::duration<double>(Clock::now() - batch_start).count();
+    double total_seconds = 0;
+    size_t slowest = 0;
+    for (size_t i = 0; i < seconds.size(); ++i) {
+      total_seconds += seconds[i];
+      if (seconds[i] > seconds[slowest]) slowest = i;
+    }
+    std::cerr << std::fixed << std::setprecision(6) << "Batch of "
+              << entries.size() << " modules on " << jobs << " jobs, "
+              << num_failed << " failed" << std::endl
+              << "  WALL time: " << wall_seconds << " s" << std::endl
+              << "  Sum of module times: " << total_seconds << " s"
+              << std::endl;
+    if (!entries.empty()) {
+      std::cerr << "  Mean module time: "
+                << total_seconds / static_cast<double>(entries.size())
+                << " s" << std::endl
+                << "  Slowest module: " << entries[slowest].in_file << " ("
+                << seconds[slowest] << " s)" << std::endl;
+    }
+  }
+
+  return num_failed == 0 ? 0 : 1;
 }
 
 }  // namespace
@@ -893,30 +1311,67 @@ int main(int argc, const char** argv) {
   spvtools::Optimizer optimizer(target_env);
   optimizer.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);
 
+  OptimizerSetup setup;
   spvtools::ValidatorOptions validator_options;
   spvtools::OptimizerOptions optimizer_options;
-  OptStatus status = ParseFlags(argc, argv, &optimizer, &in_file, &out_file,
-                                &validator_options, &optimizer_options);
+  BatchOptions batch_options;
+  ProfileOptions profile_options;
+  OptStatus status = ParseFlags(argc, argv, &setup, &in_file, &out_file,
+                                &validator_options, &optimizer_options,
+                                &batch_options, &profile_options);
   optimizer_options.set_validator_options(validator_options);
 
   if (status.action == OPT_STOP) {
     return status.code;
   }
 
+  if (!SetUpOptimizer(setup, &std::cerr, &optimizer)) {
+    return 1;
+  }
+
+  if (batch_options.manifest) {
+    if (in_file || out_file) {
+      spvtools::Error(opt_diagnostic, nullptr, {},
+                      "--batch cannot be combined with an input or output "
+                      "file");
+      return 1;
+    }
+    if (profile_options.file) {
+      spvtools::Error(opt_diagnostic, nullptr, {},
+                      "--profile-passes cannot be combined with --batch");
+      return 1;
+    }
+    return RunBatch(setup, optimizer_options, batch_options);
+  }
+
+  std::ofstream profile_stream;
+  if (profile_options.file) {
+    profile_stream.open(profile_options.file);
+    if (!profile_stream) {
+      spvtools::Error(opt_diagnostic, nullptr, {},
+                      "Could not open pass profile file");
+      return 1;
+    }
+    optimizer.SetPassProfile(&profile_stream, profile_options.format);
+  }
+
   if (out_file == nullptr) {
     spvtools::Error(opt_diagnostic, nullptr, {}, "-o required");
     return 1;
   }
 
-  std::vector<uint32_t> binary;
-  if (!ReadFile<uint32_t>(in_file, "rb", &binary)) {
+  // The input is parsed straight from the mapped file, so the optimized
+  // module is written to a separate vector.
+  InputBinary input;
+  if (!input.Read(in_file)) {
     return 1;
   }
 
-  // By using the same vector as input and output, we save time in the case
-  // that there was no change.
+  std::vector<uint32_t> binary;
   bool ok =
-      optimizer.Run(binary.data(), binary.size(), &binary, optimizer_options);
+      optimizer.Run(input.data(), input.size(), &binary, optimizer_options);
+  // A failed run writes the input unchanged.
+  if (!ok) binary.assign(input.data(), input.data() + input.size());
 
   if (!WriteFile<uint32_t>(out_file, "wb", binary.data(), binary.size())) {
     return 1;
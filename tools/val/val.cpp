@@ -65,6 +65,11 @@ Options:
                                    members.
   --before-hlsl-legalization       Allows code patterns that are intended to be
                                    fixed by spirv-opt's legalization passes.
+  --num-threads                    <maximum number of threads used to check functions>
+  --time-report                    Print the wall time taken by each check, and by the checks
+                                   of each opcode, to standard error output.  The times of
+                                   functions checked in parallel are summed.  Only available
+                                   when built with timers enabled.
   --version                        Display validator version information.
   --target-env                     {%s}
                                    Use validation rules from the specified environment.
@@ -139,6 +144,17 @@ int main(int argc, char** argv) {
           continue_processing = false;
           return_code = 1;
         }
+      } else if (0 == strcmp(cur_arg, "--num-threads")) {
+        uint32_t num_threads = 0;
+        if (argi + 1 < argc && sscanf(argv[++argi], "%u", &num_threads)) {
+          options.SetNumThreads(num_threads);
+        } else {
+          fprintf(stderr, "error: Missing argument to --num-threads\n");
+          continue_processing = false;
+          return_code = 1;
+        }
+      } else if (0 == strcmp(cur_arg, "--time-report")) {
+        options.SetTimeReport(&std::cerr);
       } else if (0 == strcmp(cur_arg, "--before-hlsl-legalization")) {
         options.SetBeforeHlslLegalization(true);
       } else if (0 == strcmp(cur_arg, "--relax-logical-pointer")) {
@@ -183,8 +199,8 @@ int main(int argc, char** argv) {
     return return_code;
   }
 
-  std::vector<uint32_t> contents;
-  if (!ReadFile<uint32_t>(inFile, "rb", &contents)) return 1;
+  InputBinary contents;
+  if (!contents.Read(inFile)) return 1;
 
   spvtools::SpirvTools tools(target_env);
   tools.SetMessageConsumer(spvtools::utils::CLIMessageConsumer);